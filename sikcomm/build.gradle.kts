@@ -14,6 +14,9 @@ android {
         externalNativeBuild {
             cmake {
                 cppFlags += ""
+                // 热路径详细日志，排查问题时用 -Psikcomm.verboseLog=true 打开
+                val verboseLog = project.findProperty("sikcomm.verboseLog") == "true"
+                arguments += "-DSIKCOMM_VERBOSE_LOG=${if (verboseLog) "ON" else "OFF"}"
             }
         }
     }
@@ -0,0 +1,197 @@
+#include <jni.h>
+#include <errno.h>
+#include <string>
+#include <algorithm>
+
+#define LOG_TAG "NativeCanBcm"
+#include "comm_log.h"
+#include "can_io.h"
+
+static std::string JStringToString(JNIEnv* env, jstring jstr) {
+    if (jstr == nullptr) return {};
+    const char* utf = env->GetStringUTFChars(jstr, nullptr);
+    if (utf == nullptr) return {};
+    std::string res(utf);
+    env->ReleaseStringUTFChars(jstr, utf);
+    return res;
+}
+
+/**
+ * 从 Java 数组取出 payload / 掩码。
+ *
+ * @return >=0: 长度；<0: -EINVAL
+ */
+static int CopyPayload(JNIEnv* env, jbyteArray jData, uint8_t* out) {
+    if (jData == nullptr) return 0;
+    jsize len = env->GetArrayLength(jData);
+    if (len > CANFD_MAX_DLEN) return -EINVAL;
+    env->GetByteArrayRegion(jData, 0, len, reinterpret_cast<jbyte*>(out));
+    return static_cast<int>(len);
+}
+
+extern "C" {
+
+/**
+ * long open(String ifName)
+ *
+ * @return >0: BCM socket 句柄（fd）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeCanBcm_open(
+        JNIEnv* env,
+        jclass,
+        jstring jIfName
+) {
+    std::string ifName = JStringToString(env, jIfName);
+    if (ifName.empty()) return -EINVAL;
+    return static_cast<jlong>(CanBcmOpen(ifName.c_str()));
+}
+
+/**
+ * int txStart(long handle, int frameId, int flags, byte[] data, long intervalUs)
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanBcm_txStart(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jint frameId,
+        jint flags,
+        jbyteArray jData,
+        jlong intervalUs
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+
+    uint8_t payload[CANFD_MAX_DLEN];
+    int len = CopyPayload(env, jData, payload);
+    if (len < 0) return len;
+    return CanBcmTxStart(fd, frameId, flags, payload, len, intervalUs);
+}
+
+/**
+ * int txUpdate(long handle, int frameId, int flags, byte[] data, boolean announce)
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanBcm_txUpdate(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jint frameId,
+        jint flags,
+        jbyteArray jData,
+        jboolean announce
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+
+    uint8_t payload[CANFD_MAX_DLEN];
+    int len = CopyPayload(env, jData, payload);
+    if (len < 0) return len;
+    return CanBcmTxUpdate(fd, frameId, flags, payload, len, announce == JNI_TRUE);
+}
+
+/**
+ * int txStop(long handle, int frameId, int flags)
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanBcm_txStop(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jint frameId,
+        jint flags
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    return CanBcmTxStop(fd, frameId, flags);
+}
+
+/**
+ * int rxWatch(long handle, int frameId, int flags, byte[] mask, long timeoutUs, long throttleUs, int options)
+ *
+ * @param mask null / 空数组表示每帧都上报
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanBcm_rxWatch(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jint frameId,
+        jint flags,
+        jbyteArray jMask,
+        jlong timeoutUs,
+        jlong throttleUs,
+        jint options
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+
+    uint8_t mask[CANFD_MAX_DLEN];
+    int len = CopyPayload(env, jMask, mask);
+    if (len < 0) return len;
+    return CanBcmRxWatch(fd, frameId, flags, mask, len, timeoutUs, throttleUs, options);
+}
+
+/**
+ * int rxUnwatch(long handle, int frameId, int flags)
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanBcm_rxUnwatch(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jint frameId,
+        jint flags
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    return CanBcmRxUnwatch(fd, frameId, flags);
+}
+
+/**
+ * int read(long handle, byte[] out, int maxEvents)
+ *
+ * 非阻塞地收走排队的 BCM 通知，按 CAN_RECORD_SIZE 定长记录写进 out（[7] 为事件类型）。
+ *
+ * @return >=0: 事件数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanBcm_read(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jbyteArray jOut,
+        jint maxEvents
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    if (jOut == nullptr || maxEvents <= 0) return -EINVAL;
+
+    int capacity = std::min<int>(maxEvents, env->GetArrayLength(jOut) / CAN_RECORD_SIZE);
+    capacity = std::min(capacity, CAN_MAX_BATCH);
+    if (capacity <= 0) return -EINVAL;
+
+    uint8_t packed[CAN_MAX_BATCH * CAN_RECORD_SIZE];
+    int count = CanBcmRead(fd, packed, capacity);
+    if (count > 0) {
+        env->SetByteArrayRegion(jOut, 0, count * CAN_RECORD_SIZE, reinterpret_cast<jbyte*>(packed));
+    }
+    return static_cast<jint>(count);
+}
+
+/**
+ * void close(long handle)
+ *
+ * 内核随 socket 一起删除其上所有的周期发送和接收监视。
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeCanBcm_close(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    CanClose(static_cast<int>(handle));
+}
+
+} // extern "C"
@@ -0,0 +1,782 @@
+/**
+ * sikcomm_bench：宿主机上的收发热路径基线。
+ *
+ * 直接调用 core 库（serial_io / can_io），不经过 JNI：
+ * - 串口：openpty 得到一对伪终端，master 端写、从端按 SerialOpen 打开后读；
+ * - 串口 + 接收环：读线程只把数据读进 RxRing（BLOCK 策略），另一个线程从环里取出并校验字节序列；
+ * - 串口轮询：SerialPoller 对 master 端模拟的若干 Modbus 从站循环执行读保持寄存器事务；
+ * - CAN：同一个 vcan 接口上开两个 CAN_RAW socket，一个发一个收（没有 vcan 时跳过）；
+ * - CAN 周期发送：CAN_BCM 由内核按 1ms 周期发帧，接收端按接收时间戳统计周期抖动（延迟列为 |实际间隔 - 周期|）；
+ * - CAN 网关：CanGateway 把 --can 接口上的帧改 ID 后转发到 --can-gw 接口，逐帧测往返，
+ *   用户态后端由一个线程模拟 reactor 调 Pump，内核后端（需要 CAP_NET_ADMIN）不可用时跳过。
+ *
+ * 每个用例输出吞吐、单条消息延迟分位数，以及按通道 metrics 统计的每条消息系统调用数
+ * （poll + read / write / recvmmsg / sendmmsg，收发两端合计）。
+ *
+ * 用法：sikcomm_bench [--messages N] [--size BYTES] [--can IFACE] [--can-gw IFACE] [--no-serial] [--no-can]
+ * 准备 vcan：ip link add dev vcan0 type vcan && ip link set vcan0 up（网关用例再加一个 vcan1）
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pty.h>
+#include <sched.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#define LOG_TAG "SikCommBench"
+#include "comm_log.h"
+#include "comm_metrics.h"
+#include "serial_io.h"
+#include "can_io.h"
+#include "can_gateway.h"
+#include "rx_ring.h"
+#include "serial_poller.h"
+#include "comm_crc.h"
+
+struct BenchOptions {
+    int messages = 20000;
+    int size = 32;
+    const char* canIf = "vcan0";
+    const char* gwIf = "vcan1";
+    bool serial = true;
+    bool can = true;
+};
+
+// 单次读等待的上限：超过就认为数据丢了，用例失败
+static const int BENCH_READ_TIMEOUT_MS = 1000;
+
+// 接收环用例的环大小：故意取小，让环反复回绕并触发 BLOCK
+static const size_t BENCH_RING_CAPACITY = 16 * 1024;
+
+// 轮询用例：模拟的从站数和帧间静默（pty 没有波特率，只保留很短的间隔）
+static const int BENCH_POLL_SLAVES = 8;
+static const int BENCH_POLL_GAP_US = 50;
+
+// 吞吐用例里 CAN 接收 socket 的接收缓冲区，尽量避免读线程跟不上时丢帧
+static const int BENCH_CAN_RCVBUF = 4 * 1024 * 1024;
+
+// 周期发送用例：周期和采样帧数（1000 帧约 1 秒）
+static const int64_t BENCH_CYCLIC_INTERVAL_US = 1000;
+static const int BENCH_CYCLIC_FRAMES = 1000;
+
+// 网关用例：转发后的 ID
+static const int32_t BENCH_GW_REWRITTEN_ID = 0x555;
+
+static uint64_t SyscallCount(int fd) {
+    ChannelMetrics* m = MetricsFor(fd);
+    if (m == nullptr) return 0;
+    return m->pollWait.count.load(std::memory_order_relaxed) +
+           m->pollTimeouts.load(std::memory_order_relaxed) +
+           m->syscall.count.load(std::memory_order_relaxed);
+}
+
+static void PrintHeader() {
+    printf("%-24s %9s %10s %11s %9s %9s %9s %9s %13s\n",
+           "case", "messages", "MB/s", "msg/s", "p50(us)", "p90(us)", "p99(us)", "max(us)", "syscalls/msg");
+}
+
+/**
+ * @param latency 为 nullptr 时不输出延迟列（纯吞吐用例）
+ */
+static void PrintResult(const char* name, uint64_t messages, uint64_t bytes, uint64_t elapsedNs,
+                        const LatencyHistogram* latency, uint64_t syscalls) {
+    double sec = static_cast<double>(elapsedNs) / 1e9;
+    double mbps = sec > 0 ? static_cast<double>(bytes) / sec / 1e6 : 0;
+    double rate = sec > 0 ? static_cast<double>(messages) / sec : 0;
+    double perMsg = messages > 0 ? static_cast<double>(syscalls) / static_cast<double>(messages) : 0;
+    if (latency != nullptr) {
+        printf("%-24s %9llu %10.2f %11.0f %9.1f %9.1f %9.1f %9.1f %13.2f\n",
+               name, static_cast<unsigned long long>(messages), mbps, rate,
+               static_cast<double>(latency->Percentile(0.50)) / 1e3,
+               static_cast<double>(latency->Percentile(0.90)) / 1e3,
+               static_cast<double>(latency->Percentile(0.99)) / 1e3,
+               static_cast<double>(latency->maxNs.load()) / 1e3, perMsg);
+    } else {
+        printf("%-24s %9llu %10.2f %11.0f %9s %9s %9s %9s %13.2f\n",
+               name, static_cast<unsigned long long>(messages), mbps, rate,
+               "-", "-", "-", "-", perMsg);
+    }
+    fflush(stdout);
+}
+
+/**
+ * 从 fd 读满 len 字节。
+ *
+ * @return 0: 成功；<0: -errno（超时为 -ETIMEDOUT）
+ */
+static int SerialReadExact(int fd, uint8_t* buf, size_t len) {
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = SerialRead(fd, buf + got, len - got, BENCH_READ_TIMEOUT_MS, nullptr);
+        if (n < 0) return static_cast<int>(n);
+        if (n == 0) return -ETIMEDOUT;
+        got += static_cast<size_t>(n);
+    }
+    return 0;
+}
+
+struct PtyPair {
+    int master = -1;
+    int slave = -1;       // openpty 给的从端，保持打开直到结束，避免 master 收到 hangup
+    int port = -1;        // 按串口方式重新打开的从端
+};
+
+static int OpenPtyPair(PtyPair* p) {
+    char name[128];
+    if (openpty(&p->master, &p->slave, name, nullptr, nullptr) != 0) return -errno;
+    SerialPortConfig config;
+    p->port = SerialOpen(name, config, nullptr);
+    if (p->port < 0) return p->port;
+    MetricsAttach(p->master);
+    return 0;
+}
+
+static void ClosePtyPair(PtyPair* p) {
+    if (p->port >= 0) SerialClose(p->port);
+    if (p->slave >= 0) ::close(p->slave);
+    if (p->master >= 0) ::close(p->master);
+}
+
+/**
+ * 串口单条往返：master 写一条消息，从端读满后才写下一条，测单条消息的端到端延迟。
+ */
+static int BenchSerialLatency(const BenchOptions& o) {
+    PtyPair p;
+    int ret = OpenPtyPair(&p);
+    if (ret < 0) {
+        LOGE("openpty failed: %s", strerror(-ret));
+        ClosePtyPair(&p);
+        return ret;
+    }
+
+    std::vector<uint8_t> tx(static_cast<size_t>(o.size));
+    std::vector<uint8_t> rx(static_cast<size_t>(o.size));
+    auto* latency = new LatencyHistogram();
+    latency->Reset();
+
+    uint64_t start = MetricsNowNs();
+    for (int i = 0; i < o.messages && ret == 0; ++i) {
+        tx[0] = static_cast<uint8_t>(i);
+        struct iovec iov{tx.data(), tx.size()};
+        int err = 0;
+        uint64_t t0 = MetricsNowNs();
+        size_t written = SerialWriteFully(p.master, &iov, 1, BENCH_READ_TIMEOUT_MS, MetricsFor(p.master), &err);
+        if (written != tx.size()) {
+            ret = -(err != 0 ? err : EIO);
+            break;
+        }
+        ret = SerialReadExact(p.port, rx.data(), rx.size());
+        latency->Record(MetricsNowNs() - t0);
+        if (ret == 0 && rx[0] != tx[0]) ret = -EBADMSG;
+    }
+    uint64_t elapsed = MetricsNowNs() - start;
+
+    if (ret == 0) {
+        PrintResult("serial.pingpong", static_cast<uint64_t>(o.messages),
+                    static_cast<uint64_t>(o.messages) * static_cast<uint64_t>(o.size), elapsed, latency,
+                    SyscallCount(p.master) + SyscallCount(p.port));
+    } else {
+        LOGE("serial.pingpong failed: %s", strerror(-ret));
+    }
+    delete latency;
+    ClosePtyPair(&p);
+    return ret;
+}
+
+/**
+ * 串口流式吞吐：写线程连续写，读线程按 4KB 缓冲读到收满为止。
+ */
+static int BenchSerialThroughput(const BenchOptions& o) {
+    PtyPair p;
+    int ret = OpenPtyPair(&p);
+    if (ret < 0) {
+        LOGE("openpty failed: %s", strerror(-ret));
+        ClosePtyPair(&p);
+        return ret;
+    }
+
+    const uint64_t total = static_cast<uint64_t>(o.messages) * static_cast<uint64_t>(o.size);
+    std::atomic<int> readerResult{0};
+    std::thread reader([&] {
+        uint8_t buf[4096];
+        uint64_t got = 0;
+        while (got < total) {
+            ssize_t n = SerialRead(p.port, buf, sizeof(buf), BENCH_READ_TIMEOUT_MS, nullptr);
+            if (n <= 0) {
+                readerResult = n < 0 ? static_cast<int>(n) : -ETIMEDOUT;
+                return;
+            }
+            got += static_cast<uint64_t>(n);
+        }
+    });
+
+    std::vector<uint8_t> tx(static_cast<size_t>(o.size), 0x55);
+    uint64_t start = MetricsNowNs();
+    for (int i = 0; i < o.messages; ++i) {
+        struct iovec iov{tx.data(), tx.size()};
+        int err = 0;
+        size_t written = SerialWriteFully(p.master, &iov, 1, BENCH_READ_TIMEOUT_MS, MetricsFor(p.master), &err);
+        if (written != tx.size()) {
+            ret = -(err != 0 ? err : EIO);
+            break;
+        }
+    }
+    reader.join();
+    uint64_t elapsed = MetricsNowNs() - start;
+    if (ret == 0) ret = readerResult.load();
+
+    if (ret == 0) {
+        PrintResult("serial.stream", static_cast<uint64_t>(o.messages), total, elapsed, nullptr,
+                    SyscallCount(p.master) + SyscallCount(p.port));
+    } else {
+        LOGE("serial.stream failed: %s", strerror(-ret));
+    }
+    ClosePtyPair(&p);
+    return ret;
+}
+
+/**
+ * 串口经接收环的吞吐：master 连续写递增字节序列，读线程用 RxRingFillSerial 读进环，
+ * 消费线程 Peek / Release 取出并逐字节校验，测环本身的开销和正确性。
+ */
+static int BenchSerialRing(const BenchOptions& o) {
+    PtyPair p;
+    int ret = OpenPtyPair(&p);
+    if (ret < 0) {
+        LOGE("openpty failed: %s", strerror(-ret));
+        ClosePtyPair(&p);
+        return ret;
+    }
+    RxRing* ring = RxRing::Create(BENCH_RING_CAPACITY, RX_RING_BLOCK);
+    if (ring == nullptr) {
+        ClosePtyPair(&p);
+        return -ENOMEM;
+    }
+
+    const uint64_t total = static_cast<uint64_t>(o.messages) * static_cast<uint64_t>(o.size);
+    std::atomic<bool> done{false};
+    std::atomic<int> producerResult{0};
+    std::thread producer([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            int ready = SerialWaitReadable(p.port, BENCH_READ_TIMEOUT_MS, MetricsFor(p.port));
+            if (ready < 0) {
+                producerResult = ready;
+                return;
+            }
+            for (;;) {
+                int n = RxRingFillSerial(ring, p.port);
+                if (n == -ENOBUFS) {
+                    // 真实通道里由消费者 Release 的返回值唤醒，这里简单让出 CPU
+                    sched_yield();
+                    continue;
+                }
+                if (n < 0) {
+                    producerResult = n;
+                    return;
+                }
+                if (n == 0) break;
+            }
+        }
+    });
+
+    std::atomic<int> consumerResult{0};
+    std::thread consumer([&] {
+        RxRingRecord records[64];
+        uint64_t got = 0;
+        uint64_t idleSince = MetricsNowNs();
+        while (got < total) {
+            int n = ring->Peek(records, 64);
+            for (int i = 0; i < n; ++i) {
+                const uint8_t* data = ring->Data() + records[i].offset;
+                for (uint32_t k = 0; k < records[i].length; ++k) {
+                    if (data[k] != static_cast<uint8_t>(got + k)) {
+                        consumerResult = -EBADMSG;
+                        return;
+                    }
+                }
+                got += records[i].length;
+            }
+            ring->Release();
+            if (n > 0) {
+                idleSince = MetricsNowNs();
+            } else if (MetricsNowNs() - idleSince > BENCH_READ_TIMEOUT_MS * 1000000ULL) {
+                consumerResult = -ETIMEDOUT;
+                return;
+            } else {
+                sched_yield();
+            }
+        }
+    });
+
+    std::vector<uint8_t> tx(static_cast<size_t>(o.size));
+    uint64_t seq = 0;
+    uint64_t start = MetricsNowNs();
+    for (int i = 0; i < o.messages; ++i) {
+        for (auto& b : tx) b = static_cast<uint8_t>(seq++);
+        struct iovec iov{tx.data(), tx.size()};
+        int err = 0;
+        size_t written = SerialWriteFully(p.master, &iov, 1, BENCH_READ_TIMEOUT_MS, MetricsFor(p.master), &err);
+        if (written != tx.size()) {
+            ret = -(err != 0 ? err : EIO);
+            break;
+        }
+    }
+    consumer.join();
+    uint64_t elapsed = MetricsNowNs() - start;
+    done = true;
+    producer.join();
+    if (ret == 0) ret = consumerResult.load();
+    if (ret == 0) ret = producerResult.load();
+
+    if (ret == 0) {
+        RxRingStats s{};
+        ring->Stats(&s);
+        PrintResult("serial.ring", static_cast<uint64_t>(o.messages), total, elapsed, nullptr,
+                    SyscallCount(p.master) + SyscallCount(p.port));
+        printf("%-24s records=%llu highWater=%llu/%llu blocked=%llu dropped=%llu\n", "",
+               static_cast<unsigned long long>(s.records),
+               static_cast<unsigned long long>(s.highWater),
+               static_cast<unsigned long long>(s.capacity),
+               static_cast<unsigned long long>(s.blocked),
+               static_cast<unsigned long long>(s.droppedRecords));
+        fflush(stdout);
+    } else {
+        LOGE("serial.ring failed: %s", strerror(-ret));
+    }
+    delete ring;
+    ClosePtyPair(&p);
+    return ret;
+}
+
+static void AppendModbusCrc(std::vector<uint8_t>* frame) {
+    uint16_t crc = Crc16Modbus(frame->data(), frame->size());
+    frame->push_back(static_cast<uint8_t>(crc));
+    frame->push_back(static_cast<uint8_t>(crc >> 8));
+}
+
+/**
+ * 串口轮询：SerialPoller 对 BENCH_POLL_SLAVES 个从站循环发 03 读保持寄存器（周期 0，线路空闲就发），
+ * master 端线程模拟从站按请求应答 size 字节寄存器数据。延迟为请求发完到应答收齐。
+ */
+static int BenchSerialPoll(const BenchOptions& o) {
+    PtyPair p;
+    int ret = OpenPtyPair(&p);
+    if (ret < 0) {
+        LOGE("openpty failed: %s", strerror(-ret));
+        ClosePtyPair(&p);
+        return ret;
+    }
+
+    // 应答数据区最多 250 字节（字节数字段 1 字节，整帧不超过 256）
+    const int registers = std::max(1, std::min(o.size, 250) / 2);
+    std::vector<PollRequestSpec> requests(BENCH_POLL_SLAVES);
+    for (int i = 0; i < BENCH_POLL_SLAVES; ++i) {
+        PollRequestSpec& r = requests[static_cast<size_t>(i)];
+        r.tag = i + 1;
+        r.periodMs = 0;
+        r.timeoutMs = BENCH_READ_TIMEOUT_MS;
+        r.frame = {static_cast<uint8_t>(i + 1), 0x03, 0x00, 0x00, 0x00, static_cast<uint8_t>(registers)};
+        AppendModbusCrc(&r.frame);
+    }
+    PollerParams params;
+    params.protocol = POLL_PROTOCOL_MODBUS_RTU;
+    params.gapUs = BENCH_POLL_GAP_US;
+    SerialPoller* poller = SerialPoller::Create(params, std::move(requests));
+    if (poller == nullptr) {
+        ClosePtyPair(&p);
+        return -EINVAL;
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> slaveResult{0};
+    std::thread slave([&] {
+        uint8_t req[8];
+        std::vector<uint8_t> resp;
+        while (!done.load(std::memory_order_relaxed)) {
+            int r = SerialReadExact(p.master, req, sizeof(req));
+            if (r == -ETIMEDOUT) continue;
+            if (r < 0) {
+                slaveResult = r;
+                return;
+            }
+            resp.assign({req[0], 0x03, static_cast<uint8_t>(req[5] * 2)});
+            for (int k = 0; k < req[5] * 2; ++k) resp.push_back(static_cast<uint8_t>(k));
+            AppendModbusCrc(&resp);
+            struct iovec iov{resp.data(), resp.size()};
+            int err = 0;
+            SerialWriteFully(p.master, &iov, 1, BENCH_READ_TIMEOUT_MS, MetricsFor(p.master), &err);
+        }
+    });
+
+    auto* latency = new LatencyHistogram();
+    latency->Reset();
+    std::vector<uint8_t> out(64 * static_cast<size_t>(POLL_RECORD_SIZE));
+    int completed = 0;
+    uint64_t start = MetricsNowNs();
+    while (completed < o.messages && ret == 0) {
+        int n = poller->Run(p.port, out.data(), 64, 100);
+        if (n < 0) {
+            ret = n;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const uint8_t* rec = out.data() + static_cast<size_t>(i) * POLL_RECORD_SIZE;
+            if (rec[4] != POLL_OK) {
+                ret = -EBADMSG;
+                break;
+            }
+            int64_t sent;
+            int64_t received;
+            memcpy(&sent, rec + 16, 8);
+            memcpy(&received, rec + 24, 8);
+            latency->Record(static_cast<uint64_t>(received - sent));
+        }
+        completed += n;
+    }
+    uint64_t elapsed = MetricsNowNs() - start;
+    done = true;
+    slave.join();
+    if (ret == 0) ret = slaveResult.load();
+
+    if (ret == 0) {
+        PollerStats s{};
+        poller->Stats(&s);
+        PrintResult("serial.poll", static_cast<uint64_t>(completed),
+                    static_cast<uint64_t>(completed) * static_cast<uint64_t>(registers * 2), elapsed, latency,
+                    SyscallCount(p.master) + SyscallCount(p.port));
+        printf("%-24s transactions=%llu timeouts=%llu stray=%llu\n", "",
+               static_cast<unsigned long long>(s.transactions),
+               static_cast<unsigned long long>(s.timeouts),
+               static_cast<unsigned long long>(s.strayBytes));
+        fflush(stdout);
+    } else {
+        LOGE("serial.poll failed: %s", strerror(-ret));
+    }
+    delete latency;
+    delete poller;
+    ClosePtyPair(&p);
+    return ret;
+}
+
+struct CanPair {
+    int tx = -1;
+    int rx = -1;
+};
+
+static int OpenCanPair(const char* ifName, CanPair* p) {
+    p->tx = CanOpen(ifName, false, nullptr, 0, 0);
+    if (p->tx < 0) return p->tx;
+    p->rx = CanOpen(ifName, false, nullptr, 0, 0);
+    if (p->rx < 0) return p->rx;
+    int rcvbuf = BENCH_CAN_RCVBUF;
+    setsockopt(p->rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    return 0;
+}
+
+static void CloseCanPair(CanPair* p) {
+    if (p->tx >= 0) CanClose(p->tx);
+    if (p->rx >= 0) CanClose(p->rx);
+}
+
+/**
+ * CAN 单帧往返：发一帧，另一个 socket 收到后再发下一帧。
+ */
+static int BenchCanLatency(const BenchOptions& o, const CanPair& p) {
+    auto* latency = new LatencyHistogram();
+    latency->Reset();
+
+    uint8_t data[CANFD_MAX_DLEN] = {};
+    uint8_t rx[CANFD_MAX_DLEN];
+    int ret = 0;
+    uint64_t start = MetricsNowNs();
+    for (int i = 0; i < o.messages; ++i) {
+        int32_t id = i & CAN_SFF_MASK;
+        uint64_t t0 = MetricsNowNs();
+        ret = CanWriteFrame(p.tx, id, 0, data, CAN_MAX_DLEN, BENCH_READ_TIMEOUT_MS);
+        if (ret <= 0) {
+            ret = ret < 0 ? ret : -ETIMEDOUT;
+            break;
+        }
+        int32_t rxId = -1;
+        int32_t rxFlags = 0;
+        ret = CanReadFrame(p.rx, &rxId, &rxFlags, rx, BENCH_READ_TIMEOUT_MS);
+        latency->Record(MetricsNowNs() - t0);
+        if (ret <= 0) {
+            ret = ret < 0 ? ret : -ETIMEDOUT;
+            break;
+        }
+        ret = rxId == id ? 0 : -EBADMSG;
+        if (ret < 0) break;
+    }
+    uint64_t elapsed = MetricsNowNs() - start;
+
+    if (ret == 0) {
+        PrintResult("can.pingpong", static_cast<uint64_t>(o.messages),
+                    static_cast<uint64_t>(o.messages) * CAN_MAX_DLEN, elapsed, latency,
+                    SyscallCount(p.tx) + SyscallCount(p.rx));
+    } else {
+        LOGE("can.pingpong failed: %s", strerror(-ret));
+    }
+    delete latency;
+    return ret;
+}
+
+/**
+ * CAN 批量吞吐：sendmmsg 连续发，读线程 recvmmsg 收。
+ *
+ * vcan 没有流控，读线程跟不上时接收 socket 会丢帧，丢帧数单独打印。
+ */
+static int BenchCanThroughput(const BenchOptions& o, const CanPair& p) {
+    const int count = o.messages;
+    std::vector<uint8_t> records(static_cast<size_t>(count) * CAN_RECORD_SIZE, 0);
+    for (int i = 0; i < count; ++i) {
+        uint8_t* rec = records.data() + static_cast<size_t>(i) * CAN_RECORD_SIZE;
+        uint32_t id = static_cast<uint32_t>(i) & CAN_SFF_MASK;
+        rec[0] = static_cast<uint8_t>(id);
+        rec[1] = static_cast<uint8_t>(id >> 8);
+        rec[5] = CAN_MAX_DLEN;
+    }
+
+    std::atomic<int> received{0};
+    std::thread reader([&] {
+        uint8_t buf[CAN_MAX_BATCH * CAN_RECORD_SIZE];
+        while (received.load(std::memory_order_relaxed) < count) {
+            int n = CanReadBatch(p.rx, buf, CAN_MAX_BATCH, BENCH_READ_TIMEOUT_MS / 4);
+            if (n <= 0) return;   // 超时：剩下的帧已经丢了
+            received.fetch_add(n, std::memory_order_relaxed);
+        }
+    });
+
+    uint64_t start = MetricsNowNs();
+    int sent = CanWriteBatch(p.tx, records.data(), count, CanMonotonicMs() + 10 * BENCH_READ_TIMEOUT_MS);
+    reader.join();
+    uint64_t elapsed = MetricsNowNs() - start;
+    if (sent < 0) {
+        LOGE("can.batch failed: %s", strerror(-sent));
+        return sent;
+    }
+
+    int got = received.load();
+    PrintResult("can.batch", static_cast<uint64_t>(got), static_cast<uint64_t>(got) * CAN_MAX_DLEN, elapsed,
+                nullptr, SyscallCount(p.tx) + SyscallCount(p.rx));
+    if (got < count) {
+        printf("%-24s sent %d, received %d (%d dropped by the receive socket)\n", "", sent, got, sent - got);
+    }
+    return 0;
+}
+
+/**
+ * CAN 周期发送抖动：CAN_BCM 周期发帧，用户态不参与发送，接收端用内核时间戳算相邻帧间隔。
+ */
+static int BenchCanCyclic(const BenchOptions& o, const CanPair& p) {
+    int bcm = CanBcmOpen(o.canIf);
+    if (bcm < 0) {
+        printf("%-24s skipped: CAN_BCM unavailable (%s)\n", "can.cyclic", strerror(-bcm));
+        return 0;
+    }
+
+    // 先把接收 socket 里前面用例剩下的帧收干净
+    uint8_t buf[CAN_MAX_BATCH * CAN_RECORD_SIZE];
+    while (CanReadBatch(p.rx, buf, CAN_MAX_BATCH, 0) > 0) {
+    }
+
+    const int32_t cyclicId = 0x7E0;
+    uint8_t data[CAN_MAX_DLEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    int ret = CanBcmTxStart(bcm, cyclicId, 0, data, CAN_MAX_DLEN, BENCH_CYCLIC_INTERVAL_US);
+    if (ret < 0) {
+        LOGE("can.cyclic setup failed: %s", strerror(-ret));
+        CanClose(bcm);
+        return ret;
+    }
+
+    auto* jitter = new LatencyHistogram();
+    jitter->Reset();
+    int frames = 0;
+    int64_t last = 0;
+    uint64_t syscallsBefore = SyscallCount(p.rx);
+    uint64_t start = MetricsNowNs();
+    while (frames < BENCH_CYCLIC_FRAMES) {
+        int n = CanReadBatch(p.rx, buf, CAN_MAX_BATCH, BENCH_READ_TIMEOUT_MS);
+        if (n <= 0) {
+            ret = n < 0 ? n : -ETIMEDOUT;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const uint8_t* rec = buf + i * CAN_RECORD_SIZE;
+            int64_t ts;
+            memcpy(&ts, rec + 8, sizeof(ts));
+            if (last != 0) {
+                int64_t delta = ts - last - BENCH_CYCLIC_INTERVAL_US * 1000;
+                jitter->Record(static_cast<uint64_t>(delta < 0 ? -delta : delta));
+            }
+            last = ts;
+            ++frames;
+        }
+    }
+    uint64_t elapsed = MetricsNowNs() - start;
+    CanBcmTxStop(bcm, cyclicId, 0);
+    CanClose(bcm);
+
+    if (ret == 0) {
+        PrintResult("can.cyclic", static_cast<uint64_t>(frames), static_cast<uint64_t>(frames) * CAN_MAX_DLEN,
+                    elapsed, jitter, SyscallCount(p.rx) - syscallsBefore);
+    } else {
+        LOGE("can.cyclic failed: %s", strerror(-ret));
+    }
+    delete jitter;
+    return ret;
+}
+
+/**
+ * CAN 网关往返：tx 在 --can 接口上发一帧，在 --can-gw 接口上收到改过 ID 的转发帧后再发下一帧。
+ */
+static int BenchCanGateway(const BenchOptions& o, const CanPair& p, int mode, const char* name) {
+    int dst = CanOpen(o.gwIf, false, nullptr, 0, 0);
+    if (dst < 0) {
+        printf("%-24s skipped: %s unavailable (%s)\n", name, o.gwIf, strerror(-dst));
+        return 0;
+    }
+
+    CanGwRoute route;
+    route.src = o.canIf;
+    route.dst = o.gwIf;
+    CanGwMod setId;
+    setId.op = CAN_GW_OP_SET;
+    setId.targets = CAN_GW_MOD_ID;
+    setId.value.can_id = BENCH_GW_REWRITTEN_ID;
+    route.mods.push_back(setId);
+
+    int err = 0;
+    CanGateway* gw = CanGateway::Create({route}, mode, &err);
+    if (gw == nullptr) {
+        printf("%-24s skipped: gateway unavailable (%s)\n", name, strerror(-err));
+        CanClose(dst);
+        return 0;
+    }
+
+    // 用户态后端：这个线程代替 reactor 等源 socket 就绪并调用 Pump
+    std::atomic<bool> stop{false};
+    std::thread pump([&] {
+        std::vector<struct pollfd> pfds;
+        for (int fd : gw->SourceFds()) pfds.push_back({fd, POLLIN, 0});
+        if (pfds.empty()) return;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (poll(pfds.data(), pfds.size(), 10) <= 0) continue;
+            for (const struct pollfd& pfd : pfds) {
+                if (pfd.revents & POLLIN) gw->Pump(pfd.fd);
+            }
+        }
+    });
+
+    auto* latency = new LatencyHistogram();
+    latency->Reset();
+    uint8_t data[CANFD_MAX_DLEN] = {};
+    uint8_t rx[CANFD_MAX_DLEN];
+    int ret = 0;
+    uint64_t syscallsBefore = SyscallCount(p.tx) + SyscallCount(dst);
+    uint64_t start = MetricsNowNs();
+    for (int i = 0; i < o.messages; ++i) {
+        data[0] = static_cast<uint8_t>(i);
+        uint64_t t0 = MetricsNowNs();
+        ret = CanWriteFrame(p.tx, i & CAN_SFF_MASK, 0, data, CAN_MAX_DLEN, BENCH_READ_TIMEOUT_MS);
+        if (ret <= 0) {
+            ret = ret < 0 ? ret : -ETIMEDOUT;
+            break;
+        }
+        int32_t rxId = -1;
+        int32_t rxFlags = 0;
+        ret = CanReadFrame(dst, &rxId, &rxFlags, rx, BENCH_READ_TIMEOUT_MS);
+        latency->Record(MetricsNowNs() - t0);
+        if (ret <= 0) {
+            ret = ret < 0 ? ret : -ETIMEDOUT;
+            break;
+        }
+        ret = rxId == BENCH_GW_REWRITTEN_ID && rx[0] == data[0] ? 0 : -EBADMSG;
+        if (ret < 0) break;
+    }
+    uint64_t elapsed = MetricsNowNs() - start;
+    stop.store(true);
+    pump.join();
+
+    if (ret == 0) {
+        // 系统调用只统计两端通道；网关自己的 recvmmsg / sendmmsg 不计入
+        PrintResult(name, static_cast<uint64_t>(o.messages), static_cast<uint64_t>(o.messages) * CAN_MAX_DLEN,
+                    elapsed, latency, SyscallCount(p.tx) + SyscallCount(dst) - syscallsBefore);
+    } else {
+        LOGE("%s failed: %s", name, strerror(-ret));
+    }
+    delete latency;
+    delete gw;
+    CanClose(dst);
+    return ret;
+}
+
+static int BenchCan(const BenchOptions& o) {
+    CanPair p;
+    int ret = OpenCanPair(o.canIf, &p);
+    if (ret < 0) {
+        printf("%-24s skipped: %s unavailable (%s)\n", "can.*", o.canIf, strerror(-ret));
+        CloseCanPair(&p);
+        return 0;
+    }
+    ret = BenchCanLatency(o, p);
+    if (ret == 0) ret = BenchCanThroughput(o, p);
+    if (ret == 0) ret = BenchCanCyclic(o, p);
+    if (ret == 0) ret = BenchCanGateway(o, p, CAN_GW_MODE_USERSPACE, "can.gateway");
+    if (ret == 0) ret = BenchCanGateway(o, p, CAN_GW_MODE_KERNEL, "can.gateway.kernel");
+    CloseCanPair(&p);
+    return ret;
+}
+
+static void Usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--messages N] [--size BYTES] [--can IFACE] [--can-gw IFACE] [--no-serial] [--no-can]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions o;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(a, "--messages") == 0 && hasValue) {
+            o.messages = atoi(argv[++i]);
+        } else if (strcmp(a, "--size") == 0 && hasValue) {
+            o.size = atoi(argv[++i]);
+        } else if (strcmp(a, "--can") == 0 && hasValue) {
+            o.canIf = argv[++i];
+        } else if (strcmp(a, "--can-gw") == 0 && hasValue) {
+            o.gwIf = argv[++i];
+        } else if (strcmp(a, "--no-serial") == 0) {
+            o.serial = false;
+        } else if (strcmp(a, "--no-can") == 0) {
+            o.can = false;
+        } else {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+    if (o.messages <= 0 || o.size <= 0) {
+        Usage(argv[0]);
+        return 2;
+    }
+
+    PrintHeader();
+    int ret = 0;
+    if (o.serial) {
+        if (ret == 0) ret = BenchSerialLatency(o);
+        if (ret == 0) ret = BenchSerialThroughput(o);
+        if (ret == 0) ret = BenchSerialRing(o);
+        if (ret == 0) ret = BenchSerialPoll(o);
+    }
+    if (o.can && ret == 0) {
+        ret = BenchCan(o);
+    }
+    return ret == 0 ? 0 : 1;
+}
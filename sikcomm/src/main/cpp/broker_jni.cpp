@@ -0,0 +1,86 @@
+#include <jni.h>
+#include <errno.h>
+#include <string>
+
+#define LOG_TAG "NativeBroker"
+#include "comm_log.h"
+#include "fd_broker.h"
+
+static std::string JStringToString(JNIEnv* env, jstring jstr) {
+    if (jstr == nullptr) return {};
+    const char* utf = env->GetStringUTFChars(jstr, nullptr);
+    if (utf == nullptr) return {};
+    std::string res(utf);
+    env->ReleaseStringUTFChars(jstr, utf);
+    return res;
+}
+
+extern "C" {
+
+/**
+ * int connect(String name, int timeoutMs)
+ *
+ * @return 0: 成功；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeBroker_connect(
+        JNIEnv* env,
+        jclass,
+        jstring jName,
+        jint timeoutMs
+) {
+    std::string name = JStringToString(env, jName);
+    if (name.empty()) return -EINVAL;
+    return BrokerConnect(name.c_str(), timeoutMs);
+}
+
+/**
+ * void disconnect()
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeBroker_disconnect(
+        JNIEnv*,
+        jclass
+) {
+    BrokerDisconnect();
+}
+
+/**
+ * boolean isConnected()
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_sik_comm_NativeBroker_isConnected(
+        JNIEnv*,
+        jclass
+) {
+    return BrokerConnected() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * int startLocal(String name)
+ *
+ * @return 0: 成功；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeBroker_startLocal(
+        JNIEnv* env,
+        jclass,
+        jstring jName
+) {
+    std::string name = JStringToString(env, jName);
+    if (name.empty()) return -EINVAL;
+    return BrokerStartLocal(name.c_str());
+}
+
+/**
+ * void stopLocal()
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeBroker_stopLocal(
+        JNIEnv*,
+        jclass
+) {
+    BrokerStopLocal();
+}
+
+} // extern "C"
@@ -0,0 +1,347 @@
+#include "can_gateway.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can/raw.h>
+#include <linux/can/gw.h>
+
+#define LOG_TAG "CanGateway"
+#include "comm_log.h"
+#include "can_io.h"
+#include "can_netlink.h"
+
+// 一次 Pump 最多收几批（每批至多 CAN_MAX_BATCH 帧），剩下的等 reactor 下一次就绪，避免饿死其它通道
+static const int CAN_GW_PUMP_BATCHES = 4;
+
+// 内核规则 UID：进程号 + 序号，避免和其它进程的规则冲突（0 表示不带 UID）
+static std::atomic<uint32_t> g_nextUidSeq{1};
+
+static uint32_t NextUid() {
+    uint32_t seq = g_nextUidSeq.fetch_add(1) & 0xFFFF;
+    return (static_cast<uint32_t>(getpid() & 0xFFFF) << 16) | (seq == 0 ? 1 : seq);
+}
+
+static bool IsFdLength(uint8_t len) {
+    static const uint8_t kFdLengths[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+    return std::find(std::begin(kFdLengths), std::end(kFdLengths), len) != std::end(kFdLengths);
+}
+
+/**
+ * 校验路由：接口名、修改操作（每种 op 至多一个，FLAGS 只对 FD 路由有效）。
+ */
+static bool ValidRoute(const CanGwRoute& r) {
+    if (r.src.empty() || r.dst.empty() || r.src == r.dst) return false;
+    if (r.maxHops < 0 || r.maxHops > 255) return false;
+    int seen = 0;
+    for (const CanGwMod& m : r.mods) {
+        if (m.op < 0 || m.op >= CAN_GW_OP_COUNT || (seen & (1 << m.op))) return false;
+        seen |= 1 << m.op;
+        int allowed = CAN_GW_MOD_ID | CAN_GW_MOD_LEN | CAN_GW_MOD_DATA | (r.fd ? CAN_GW_MOD_FLAGS : 0);
+        if (m.targets == 0 || (m.targets & ~allowed) != 0) return false;
+    }
+    return true;
+}
+
+CanGateway* CanGateway::Create(std::vector<CanGwRoute> routes, int mode, int* err) {
+    *err = 0;
+    if (routes.empty() || mode < CAN_GW_MODE_AUTO || mode > CAN_GW_MODE_USERSPACE) {
+        *err = -EINVAL;
+        return nullptr;
+    }
+    for (const CanGwRoute& r : routes) {
+        if (!ValidRoute(r)) {
+            LOGE("invalid route %s -> %s", r.src.c_str(), r.dst.c_str());
+            *err = -EINVAL;
+            return nullptr;
+        }
+    }
+
+    auto* gw = new CanGateway();
+    gw->routes_ = std::move(routes);
+    gw->counters_.reset(new Counters[gw->routes_.size()]);
+
+    if (mode != CAN_GW_MODE_USERSPACE) {
+        int failed = -1;
+        int ret = gw->StartKernel(&failed);
+        if (ret == 0) {
+            gw->mode_ = CAN_GW_MODE_KERNEL;
+            LOGI("gateway started in kernel (CAN_GW): %zu routes", gw->routes_.size());
+            return gw;
+        }
+        if (mode == CAN_GW_MODE_KERNEL) {
+            delete gw;
+            *err = ret;
+            return nullptr;
+        }
+        LOGW("CAN_GW unavailable (route %d: %s), falling back to userspace", failed, strerror(-ret));
+    }
+
+    int ret = gw->StartUserspace();
+    if (ret < 0) {
+        delete gw;
+        *err = ret;
+        return nullptr;
+    }
+    gw->mode_ = CAN_GW_MODE_USERSPACE;
+    LOGI("gateway started in userspace: %zu routes, %zu sockets", gw->routes_.size(), gw->ports_.size());
+    return gw;
+}
+
+CanGateway::~CanGateway() {
+    StopKernel(static_cast<int>(uids_.size()));
+    for (Port& p : ports_) {
+        if (p.fd >= 0) CanClose(p.fd);
+    }
+}
+
+/**
+ * 路由 -> 内核规则。
+ *
+ * @return 0: 成功；<0: -errno（接口不存在）
+ */
+static int BuildKernelRule(const CanGwRoute& r, uint32_t uid, CanGwKernelRule* out) {
+    out->srcIfindex = static_cast<int>(if_nametoindex(r.src.c_str()));
+    out->dstIfindex = static_cast<int>(if_nametoindex(r.dst.c_str()));
+    if (out->srcIfindex == 0 || out->dstIfindex == 0) return -ENODEV;
+    out->flags = r.fd ? CGW_FLAGS_CAN_FD : 0;
+    out->hasFilter = r.hasFilter;
+    if (r.hasFilter) out->filter = CanFilterFromSpec(r.filterSpec);
+    out->limitHops = static_cast<uint8_t>(r.maxHops);
+    out->uid = uid;
+    out->modCount = 0;
+    for (const CanGwMod& m : r.mods) {
+        CanGwKernelMod& km = out->mods[out->modCount++];
+        km.op = m.op;
+        km.modtype = static_cast<uint8_t>(m.targets);
+        km.frame = m.value;
+    }
+    return 0;
+}
+
+int CanGateway::StartKernel(int* failedRoute) {
+    for (size_t i = 0; i < routes_.size(); ++i) {
+        CanGwKernelRule rule;
+        uint32_t uid = NextUid();
+        int ret = BuildKernelRule(routes_[i], uid, &rule);
+        if (ret == 0) ret = CanGwKernelAdd(rule);
+        if (ret < 0) {
+            *failedRoute = static_cast<int>(i);
+            StopKernel(static_cast<int>(uids_.size()));
+            return ret;
+        }
+        uids_.push_back(uid);
+    }
+    return 0;
+}
+
+void CanGateway::StopKernel(int count) {
+    for (int i = 0; i < count; ++i) {
+        CanGwKernelRule rule;
+        if (BuildKernelRule(routes_[static_cast<size_t>(i)], uids_[static_cast<size_t>(i)], &rule) == 0) {
+            CanGwKernelDelete(rule);
+        }
+    }
+    uids_.clear();
+}
+
+int CanGateway::PortFor(const std::string& ifName, bool fdFrames) {
+    for (size_t i = 0; i < ports_.size(); ++i) {
+        if (ports_[i].ifName == ifName) {
+            ports_[i].fdFrames = ports_[i].fdFrames || fdFrames;
+            return static_cast<int>(i);
+        }
+    }
+    Port p;
+    p.ifName = ifName;
+    p.fdFrames = fdFrames;
+    ports_.push_back(p);
+    return static_cast<int>(ports_.size() - 1);
+}
+
+int CanGateway::StartUserspace() {
+    compiled_.clear();
+    for (const CanGwRoute& r : routes_) {
+        CompiledRoute c;
+        c.srcPort = PortFor(r.src, r.fd);
+        c.dstPort = PortFor(r.dst, r.fd);
+        c.hasFilter = r.hasFilter;
+        if (r.hasFilter) c.filter = CanFilterFromSpec(r.filterSpec);
+        c.fd = r.fd;
+        c.mods = r.mods;
+        std::sort(c.mods.begin(), c.mods.end(),
+                  [](const CanGwMod& a, const CanGwMod& b) { return a.op < b.op; });
+        compiled_.push_back(std::move(c));
+    }
+
+    for (size_t i = 0; i < ports_.size(); ++i) {
+        Port& p = ports_[i];
+
+        // 接收过滤器：以该接口为源的路由过滤器之并，有一条不带过滤器就全收；只做目标的接口什么都不收
+        std::vector<int32_t> spec;
+        bool all = false;
+        bool source = false;
+        for (size_t k = 0; k < routes_.size(); ++k) {
+            if (compiled_[k].srcPort != static_cast<int>(i)) continue;
+            source = true;
+            if (!routes_[k].hasFilter) {
+                all = true;
+                break;
+            }
+            spec.insert(spec.end(), routes_[k].filterSpec, routes_[k].filterSpec + 3);
+        }
+        if (all) spec.clear();
+
+        int fd = CanOpen(p.ifName.c_str(), p.fdFrames, spec.data(), static_cast<int>(spec.size() / 3), 0);
+        if (fd < 0) return fd;
+        p.fd = fd;
+
+        if (source) {
+            sourceFds_.push_back(fd);
+        } else {
+            if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0) < 0) {
+                int err = errno;
+                LOGE("setsockopt(CAN_RAW_FILTER, none) on %s failed: %s", p.ifName.c_str(), strerror(err));
+                return -err;
+            }
+            // 设置过滤器之前可能已经收进来几帧，丢掉
+            struct canfd_frame junk{};
+            while (recv(fd, &junk, sizeof(junk), MSG_DONTWAIT) > 0) {
+            }
+        }
+    }
+    return 0;
+}
+
+bool CanGateway::ApplyMods(const CompiledRoute& r, bool fdFrame, struct canfd_frame* f) {
+    size_t dataLen = fdFrame ? CANFD_MAX_DLEN : CAN_MAX_DLEN;
+    for (const CanGwMod& m : r.mods) {
+        const struct canfd_frame& v = m.value;
+        switch (m.op) {
+            case CAN_GW_OP_AND:
+                if (m.targets & CAN_GW_MOD_ID) f->can_id &= v.can_id;
+                if (m.targets & CAN_GW_MOD_LEN) f->len &= v.len;
+                if (m.targets & CAN_GW_MOD_DATA) for (size_t k = 0; k < dataLen; ++k) f->data[k] &= v.data[k];
+                if (m.targets & CAN_GW_MOD_FLAGS) f->flags &= v.flags;
+                break;
+            case CAN_GW_OP_OR:
+                if (m.targets & CAN_GW_MOD_ID) f->can_id |= v.can_id;
+                if (m.targets & CAN_GW_MOD_LEN) f->len |= v.len;
+                if (m.targets & CAN_GW_MOD_DATA) for (size_t k = 0; k < dataLen; ++k) f->data[k] |= v.data[k];
+                if (m.targets & CAN_GW_MOD_FLAGS) f->flags |= v.flags;
+                break;
+            case CAN_GW_OP_XOR:
+                if (m.targets & CAN_GW_MOD_ID) f->can_id ^= v.can_id;
+                if (m.targets & CAN_GW_MOD_LEN) f->len ^= v.len;
+                if (m.targets & CAN_GW_MOD_DATA) for (size_t k = 0; k < dataLen; ++k) f->data[k] ^= v.data[k];
+                if (m.targets & CAN_GW_MOD_FLAGS) f->flags ^= v.flags;
+                break;
+            default:
+                if (m.targets & CAN_GW_MOD_ID) f->can_id = v.can_id;
+                if (m.targets & CAN_GW_MOD_LEN) f->len = v.len;
+                if (m.targets & CAN_GW_MOD_DATA) memcpy(f->data, v.data, dataLen);
+                if (m.targets & CAN_GW_MOD_FLAGS) f->flags = v.flags;
+                break;
+        }
+    }
+    // 和内核一样：修改后长度不合法的帧丢弃
+    return fdFrame ? IsFdLength(f->len) : f->len <= CAN_MAX_DLEN;
+}
+
+int CanGateway::Pump(int fd) {
+    int port = -1;
+    for (size_t i = 0; i < ports_.size(); ++i) {
+        if (ports_[i].fd == fd) port = static_cast<int>(i);
+    }
+    if (port < 0) return -EBADF;
+
+    struct canfd_frame in[CAN_MAX_BATCH];
+    struct iovec inIov[CAN_MAX_BATCH];
+    struct mmsghdr inMsgs[CAN_MAX_BATCH];
+
+    struct canfd_frame out[CAN_MAX_BATCH];
+    struct iovec outIov[CAN_MAX_BATCH];
+    struct mmsghdr outMsgs[CAN_MAX_BATCH];
+
+    int forwarded = 0;
+    for (int batch = 0; batch < CAN_GW_PUMP_BATCHES; ++batch) {
+        memset(inMsgs, 0, sizeof(inMsgs));
+        for (int i = 0; i < CAN_MAX_BATCH; ++i) {
+            inIov[i].iov_base = &in[i];
+            inIov[i].iov_len = sizeof(struct canfd_frame);
+            inMsgs[i].msg_hdr.msg_iov = &inIov[i];
+            inMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(fd, inMsgs, CAN_MAX_BATCH, MSG_DONTWAIT, nullptr);
+        if (n < 0) {
+            int err = errno;
+            if (err == EAGAIN || err == EWOULDBLOCK) break;
+            LOGE("gateway recvmmsg on %s failed: %s", ports_[static_cast<size_t>(port)].ifName.c_str(), strerror(err));
+            return -err;
+        }
+
+        // 每条以此接口为源的路由各过一遍这批帧，匹配的帧改完后一次 sendmmsg 发到目标接口
+        for (size_t r = 0; r < compiled_.size(); ++r) {
+            const CompiledRoute& route = compiled_[r];
+            if (route.srcPort != port) continue;
+
+            int count = 0;
+            for (int i = 0; i < n; ++i) {
+                bool fdFrame = inMsgs[i].msg_len == CANFD_MTU;
+                if (!fdFrame && inMsgs[i].msg_len != CAN_MTU) continue;
+                if (fdFrame && !route.fd) continue;
+                const struct canfd_frame& f = in[i];
+                if (route.hasFilter) {
+                    bool match = ((f.can_id ^ route.filter.can_id) & route.filter.can_mask) == 0;
+                    if (route.filter.can_id & CAN_INV_FILTER) match = !match;
+                    if (!match) continue;
+                }
+                out[count] = f;
+                if (!ApplyMods(route, fdFrame, &out[count])) {
+                    counters_[r].dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                outIov[count].iov_base = &out[count];
+                outIov[count].iov_len = fdFrame ? CANFD_MTU : CAN_MTU;
+                ++count;
+            }
+            if (count == 0) continue;
+
+            memset(outMsgs, 0, sizeof(struct mmsghdr) * static_cast<size_t>(count));
+            for (int i = 0; i < count; ++i) {
+                outMsgs[i].msg_hdr.msg_iov = &outIov[i];
+                outMsgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            int dstFd = ports_[static_cast<size_t>(route.dstPort)].fd;
+            int sent = sendmmsg(dstFd, outMsgs, static_cast<unsigned int>(count), MSG_DONTWAIT);
+            if (sent < 0) sent = 0;  // 和内核网关一样：目标发不出去就丢，不阻塞 reactor
+            counters_[r].handled.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            counters_[r].dropped.fetch_add(static_cast<uint64_t>(count - sent), std::memory_order_relaxed);
+            forwarded += sent;
+        }
+
+        if (n < CAN_MAX_BATCH) break;
+    }
+    return forwarded;
+}
+
+int CanGateway::Stats(CanGwRouteStats* out) const {
+    if (mode_ == CAN_GW_MODE_KERNEL) {
+        std::vector<CanGwKernelCounters> c(uids_.size());
+        int ret = CanGwKernelCountersByUid(uids_.data(), static_cast<int>(uids_.size()), c.data());
+        if (ret < 0) return ret;
+        for (size_t i = 0; i < c.size(); ++i) {
+            out[i].handled = c[i].handled;
+            out[i].dropped = static_cast<uint64_t>(c[i].dropped) + c[i].deleted;
+        }
+        return 0;
+    }
+    for (size_t i = 0; i < routes_.size(); ++i) {
+        out[i].handled = counters_[i].handled.load(std::memory_order_relaxed);
+        out[i].dropped = counters_[i].dropped.load(std::memory_order_relaxed);
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <linux/can.h>
+#include "reactor_handler.h"
+
+/**
+ * CAN 网关：把一个接口上匹配的帧（可改 ID / 长度 / 数据 / FD flags）转发到另一个接口。
+ *
+ * 两种后端，规则模型相同（和内核 CAN_GW 一致）：
+ * - 内核：每条路由一条 CAN_GW 规则，转发完全在内核软中断里完成，需要 CAP_NET_ADMIN 和 can-gw 模块；
+ * - 用户态：每个接口一个 CAN_RAW socket（收发共用），登记到 native reactor 上，
+ *   就绪时在 reactor 线程里直接 recvmmsg -> 匹配 / 修改 -> sendmmsg，不经过 JNI 和 Kotlin。
+ *
+ * 用户态后端同一个接口的收发共用一个 socket，自己转发出去的帧不会再被自己收到
+ * （CAN_RAW_RECV_OWN_MSGS 默认关闭），双向桥接不会形成环路；多个网关实例之间的环路由调用方避免。
+ *
+ * 纯 C++，不依赖 JNI，gateway_jni.cpp 只做参数转换；宿主机上可以直接在两个 vcan 之间测试。
+ */
+
+// 后端选择（和 Kotlin CanGatewayMode 保持一致）
+static const int CAN_GW_MODE_AUTO      = 0;   // 先尝试内核，失败时退回用户态
+static const int CAN_GW_MODE_KERNEL    = 1;
+static const int CAN_GW_MODE_USERSPACE = 2;
+
+// 修改操作（和 Kotlin CanFrameMod.Op 保持一致，顺序同内核 CGW_MOD_AND / OR / XOR / SET）
+static const int CAN_GW_OP_AND = 0;
+static const int CAN_GW_OP_OR  = 1;
+static const int CAN_GW_OP_XOR = 2;
+static const int CAN_GW_OP_SET = 3;
+static const int CAN_GW_OP_COUNT = 4;
+
+// 修改目标 bit（同内核 CGW_MOD_ID / LEN / DATA / FLAGS）
+static const int CAN_GW_MOD_ID    = 0x01;
+static const int CAN_GW_MOD_LEN   = 0x02;
+static const int CAN_GW_MOD_DATA  = 0x04;
+static const int CAN_GW_MOD_FLAGS = 0x08;   // 只对 FD 路由有效
+
+/**
+ * 一个修改操作：对 targets 里的每个字段用 value 的对应字段做 op。
+ *
+ * value.can_id 为内核 can_id 原始值（扩展帧带 CAN_EFF_FLAG），value.len / data / flags 同 canfd_frame。
+ */
+struct CanGwMod {
+    int op = CAN_GW_OP_SET;
+    int targets = 0;
+    struct canfd_frame value{};
+};
+
+/**
+ * 一条路由。
+ */
+struct CanGwRoute {
+    std::string src;
+    std::string dst;
+    bool hasFilter = false;
+    int32_t filterSpec[3] = {0, 0, 0};  // [id, mask, flags]，同 CanSetFilters
+    bool fd = false;                    // 转发 CAN FD 帧（两端接口 MTU 需为 72）；否则只转发经典帧
+    int maxHops = 0;                    // 内核后端的跳数限制，0 使用内核默认
+    std::vector<CanGwMod> mods;         // 每种 op 至多一个
+};
+
+/**
+ * 单条路由的计数。
+ */
+struct CanGwRouteStats {
+    uint64_t handled = 0;   // 已转发
+    uint64_t dropped = 0;   // 发送失败（目标接口发送队列满 / 出错）或修改后长度非法
+};
+
+class CanGateway : public ReactorHandler {
+public:
+    /**
+     * 建立网关：按 mode 选择后端，AUTO 时内核规则有任何一条添加失败就整体退回用户态。
+     *
+     * @param err 失败时输出 -errno
+     * @return 成功返回网关，失败返回 nullptr
+     */
+    static CanGateway* Create(std::vector<CanGwRoute> routes, int mode, int* err);
+
+    /**
+     * 删除内核规则 / 关闭用户态 socket。用户态后端需先从 reactor 注销。
+     */
+    ~CanGateway() override;
+
+    CanGateway(const CanGateway&) = delete;
+    CanGateway& operator=(const CanGateway&) = delete;
+
+    /**
+     * 实际使用的后端：CAN_GW_MODE_KERNEL / CAN_GW_MODE_USERSPACE。
+     */
+    int Mode() const { return mode_; }
+
+    /**
+     * 用户态后端需要登记到 reactor 的 fd（只做目标的接口不在其中），内核后端为空。
+     */
+    const std::vector<int>& SourceFds() const { return sourceFds_; }
+
+    /**
+     * 用户态转发：把 fd 上已排队的帧收走并转发（至多若干批，剩下的等下一次就绪）。
+     *
+     * 只在 reactor 线程上调用，不阻塞。
+     *
+     * @return >=0: 本次转发的帧数；<0: -errno（接收出错）
+     */
+    int Pump(int fd);
+
+    const std::vector<int>& ReactorFds() const override { return sourceFds_; }
+    int OnReadable(int fd) override { return Pump(fd); }
+
+    /**
+     * 各路由计数，out 至少 RouteCount() 个。
+     *
+     * @return 0: 成功；<0: -errno（内核后端查询失败）
+     */
+    int Stats(CanGwRouteStats* out) const;
+
+    int RouteCount() const { return static_cast<int>(routes_.size()); }
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> handled{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    // 用户态：一个接口一个 socket
+    struct Port {
+        std::string ifName;
+        int fd = -1;
+        bool fdFrames = false;
+    };
+
+    // 用户态：路由编译后的形式
+    struct CompiledRoute {
+        int srcPort = -1;
+        int dstPort = -1;
+        struct can_filter filter{};   // hasFilter = false 时匹配所有帧
+        bool hasFilter = false;
+        bool fd = false;
+        std::vector<CanGwMod> mods;   // 已按 AND / OR / XOR / SET 排序
+    };
+
+    CanGateway() = default;
+
+    int StartKernel(int* failedRoute);
+    int StartUserspace();
+    void StopKernel(int count);
+    int PortFor(const std::string& ifName, bool fdFrames);
+
+    /**
+     * 按内核 CAN_GW 的规则修改一帧（FD 路由上的经典帧按经典帧处理）。
+     *
+     * @return false: 修改后长度非法，丢弃
+     */
+    static bool ApplyMods(const CompiledRoute& r, bool fdFrame, struct canfd_frame* frame);
+
+    int mode_ = CAN_GW_MODE_USERSPACE;
+    std::vector<CanGwRoute> routes_;
+
+    // 内核后端
+    std::vector<uint32_t> uids_;
+
+    // 用户态后端
+    std::vector<Port> ports_;
+    std::vector<int> sourceFds_;
+    std::vector<CompiledRoute> compiled_;
+    std::unique_ptr<Counters[]> counters_;
+};
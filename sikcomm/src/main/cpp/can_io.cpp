@@ -0,0 +1,865 @@
+#include "can_io.h"
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can/raw.h>
+#include <linux/can/bcm.h>
+#include <linux/net_tstamp.h>
+
+#define LOG_TAG "CanIo"
+#include "comm_log.h"
+#include "comm_capture.h"
+#include "comm_metrics.h"
+
+// SCM_TIMESTAMPING 控制消息内容：ts[0] 软件，ts[2] 原始硬件
+struct ScmTimestamping {
+    struct timespec ts[3];
+};
+
+// 每帧控制消息缓冲区：SCM_TIMESTAMPING 或 SCM_TIMESTAMPNS 二选一，按较大的留
+static const size_t CAN_CMSG_SPACE = CMSG_SPACE(sizeof(ScmTimestamping));
+
+int CanSetIfUp(const char* ifNameArg, bool up) {
+    const std::string ifName(ifNameArg);
+    int s = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) {
+        int err = errno;
+        LOGE("socket(AF_INET) failed: %s", strerror(err));
+        return -err;
+    }
+
+    struct ifreq ifr{};
+    std::strncpy(ifr.ifr_name, ifName.c_str(), IFNAMSIZ - 1);
+
+    if (ioctl(s, SIOCGIFFLAGS, &ifr) < 0) {
+        int err = errno;
+        LOGE("SIOCGIFFLAGS(%s) failed: %s", ifName.c_str(), strerror(err));
+        ::close(s);
+        return -err;
+    }
+
+    // 已经是目标状态就不再 SIOCSIFFLAGS（该 ioctl 需要 CAP_NET_ADMIN，接口已 up 时普通进程也能打开）
+    if (((ifr.ifr_flags & IFF_UP) != 0) == up) {
+        ::close(s);
+        return 0;
+    }
+    if (up) {
+        ifr.ifr_flags |= IFF_UP;
+    } else {
+        ifr.ifr_flags &= ~IFF_UP;
+    }
+
+    if (ioctl(s, SIOCSIFFLAGS, &ifr) < 0) {
+        int err = errno;
+        LOGE("SIOCSIFFLAGS(%s) failed: %s", ifName.c_str(), strerror(err));
+        ::close(s);
+        return -err;
+    }
+
+    ::close(s);
+    return 0;
+}
+
+/**
+ * 获取 ifindex。
+ */
+static int GetIfIndex(const std::string& ifName) {
+    int s = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) {
+        int err = errno;
+        LOGE("socket(AF_INET) failed: %s", strerror(err));
+        return -err;
+    }
+
+    struct ifreq ifr{};
+    std::strncpy(ifr.ifr_name, ifName.c_str(), IFNAMSIZ - 1);
+
+    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0) {
+        int err = errno;
+        LOGE("SIOCGIFINDEX(%s) failed: %s", ifName.c_str(), strerror(err));
+        ::close(s);
+        return -err;
+    }
+
+    ::close(s);
+    return ifr.ifr_ifindex;
+}
+
+/**
+ * CAN FD DLC -> payload 长度
+ */
+static const uint8_t kFdDlcToLen[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+/**
+ * payload 长度 -> 能装下它的最小 CAN FD 长度（8 字节以上按 DLC 档位向上取整）
+ */
+static uint8_t CanFdAlignLen(int len) {
+    for (uint8_t l : kFdDlcToLen) {
+        if (l >= len) return l;
+    }
+    return CANFD_MAX_DLEN;
+}
+
+/**
+ * can_id -> (frameId, flags)
+ */
+static void DecodeCanId(canid_t canId, int32_t* frameId, int32_t* flags) {
+    *flags = 0;
+    if (canId & CAN_ERR_FLAG) {
+        // 错误帧：frameId 为 CAN_ERR_* 错误类别位
+        *frameId = static_cast<int32_t>(canId & CAN_ERR_MASK);
+        *flags |= CAN_FLAG_ERROR;
+        return;
+    }
+    if (canId & CAN_EFF_FLAG) {
+        *frameId = static_cast<int32_t>(canId & CAN_EFF_MASK);
+        *flags |= CAN_FLAG_EXTENDED;
+    } else {
+        *frameId = static_cast<int32_t>(canId & CAN_SFF_MASK);
+    }
+    if (canId & CAN_RTR_FLAG) {
+        *flags |= CAN_FLAG_RTR;
+    }
+}
+
+/**
+ * 按 readBatch 记录格式写一帧。
+ *
+ * frame 按 canfd_frame 收取，mtu 为实际读到的长度（CAN_MTU / CANFD_MTU），
+ * 经典帧的 can_dlc 与 canfd_frame.len 位于同一位置。
+ */
+static void PackRecord(uint8_t* rec, const struct canfd_frame& frame, size_t mtu,
+                       int64_t timestampNs, int timestampSource) {
+    int32_t frameId = 0;
+    int32_t flags = 0;
+    DecodeCanId(frame.can_id, &frameId, &flags);
+
+    uint8_t maxLen = CAN_MAX_DLEN;
+    if (mtu == CANFD_MTU) {
+        flags |= CAN_FLAG_FD;
+        if (frame.flags & CANFD_BRS) flags |= CAN_FLAG_BRS;
+        if (frame.flags & CANFD_ESI) flags |= CAN_FLAG_ESI;
+        maxLen = CANFD_MAX_DLEN;
+    }
+
+    uint32_t id = static_cast<uint32_t>(frameId);
+    rec[0] = static_cast<uint8_t>(id);
+    rec[1] = static_cast<uint8_t>(id >> 8);
+    rec[2] = static_cast<uint8_t>(id >> 16);
+    rec[3] = static_cast<uint8_t>(id >> 24);
+    rec[4] = static_cast<uint8_t>(flags);
+    rec[5] = std::min<uint8_t>(frame.len, maxLen);
+    rec[6] = static_cast<uint8_t>(timestampSource);
+    rec[7] = 0;
+    uint64_t ts = static_cast<uint64_t>(timestampNs);
+    for (int i = 0; i < 8; ++i) rec[8 + i] = static_cast<uint8_t>(ts >> (8 * i));
+    memcpy(rec + CAN_RECORD_HEADER, frame.data, rec[5]);
+    memset(rec + CAN_RECORD_HEADER + rec[5], 0, CANFD_MAX_DLEN - rec[5]);
+}
+
+/**
+ * (frameId, flags) -> can_id（只取 EXTENDED，RTR 由调用方处理）
+ */
+static canid_t EncodeCanId(int32_t frameId, int flags) {
+    if (flags & CAN_FLAG_EXTENDED) {
+        return (static_cast<canid_t>(frameId) & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    }
+    return static_cast<canid_t>(frameId) & CAN_SFF_MASK;
+}
+
+/**
+ * (frameId, flags, payload) -> canfd_frame
+ *
+ * 经典帧只填 can_frame 部分，FD 帧 len 按 DLC 档位向上补齐（补 0）。
+ *
+ * @return >0: 需要写给内核的长度（CAN_MTU / CANFD_MTU）；<0: -EINVAL
+ */
+static int EncodeFrame(int32_t frameId, int flags, const uint8_t* data, int len,
+                       struct canfd_frame* frame) {
+    memset(frame, 0, sizeof(*frame));
+
+    canid_t cid = EncodeCanId(frameId, flags);
+
+    if (flags & CAN_FLAG_FD) {
+        // FD 没有远程帧
+        if ((flags & CAN_FLAG_RTR) || len > CANFD_MAX_DLEN) return -EINVAL;
+        frame->can_id = cid;
+        frame->len = CanFdAlignLen(len);
+        if (flags & CAN_FLAG_BRS) frame->flags |= CANFD_BRS;
+        memcpy(frame->data, data, static_cast<size_t>(len));
+        return CANFD_MTU;
+    }
+
+    if (flags & CAN_FLAG_BRS) return -EINVAL; // BRS 只对 FD 帧有意义
+    if (len > CAN_MAX_DLEN) return -EINVAL;
+    if (flags & CAN_FLAG_RTR) {
+        cid |= CAN_RTR_FLAG;
+    }
+    frame->can_id = cid;
+    frame->len = static_cast<__u8>(len);
+    memcpy(frame->data, data, static_cast<size_t>(len));
+    return CAN_MTU;
+}
+
+/**
+ * 按 writeBatch 记录格式解析一帧。
+ *
+ * @return >0: 需要写给内核的长度（CAN_MTU / CANFD_MTU）；<0: -EINVAL
+ */
+static int UnpackRecord(const uint8_t* rec, struct canfd_frame* frame) {
+    uint32_t id = static_cast<uint32_t>(rec[0]) |
+                  (static_cast<uint32_t>(rec[1]) << 8) |
+                  (static_cast<uint32_t>(rec[2]) << 16) |
+                  (static_cast<uint32_t>(rec[3]) << 24);
+    return EncodeFrame(static_cast<int32_t>(id), rec[4], rec + CAN_RECORD_HEADER, rec[5], frame);
+}
+
+/**
+ * 打开接收时间戳：优先 SO_TIMESTAMPING（软件 + 硬件），不支持时退回 SO_TIMESTAMPNS。
+ * 失败不影响收发，只是记录里没有时间戳。
+ */
+static void EnableRxTimestamps(int fd, const std::string& ifName) {
+    int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0) return;
+
+    int enable = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0) {
+        LOGW("rx timestamps unavailable on %s: %s", ifName.c_str(), strerror(errno));
+    }
+}
+
+/**
+ * CLOCK_REALTIME - CLOCK_MONOTONIC（纳秒），用于把内核软件时间戳换算到单调时钟。
+ */
+static int64_t RealtimeToMonotonicOffsetNs() {
+    struct timespec real{};
+    struct timespec mono{};
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    return (static_cast<int64_t>(real.tv_sec) - mono.tv_sec) * 1000000000LL +
+           (static_cast<int64_t>(real.tv_nsec) - mono.tv_nsec);
+}
+
+static int64_t TimespecNs(const struct timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * 从 recvmsg 控制消息里取接收时间戳：有硬件时间戳优先用硬件，否则用内核软件时间戳。
+ *
+ * @param realToMono 软件时间戳换算到 CLOCK_MONOTONIC 的偏移
+ * @param source     输出：CAN_TS_*
+ * @return 时间戳（纳秒），没有时为 0
+ */
+static int64_t ExtractRxTimestamp(struct msghdr* msg, int64_t realToMono, int* source) {
+    *source = CAN_TS_NONE;
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(msg); c != nullptr; c = CMSG_NXTHDR(msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET) continue;
+        if (c->cmsg_type == SO_TIMESTAMPING) {
+            ScmTimestamping stamps{};
+            memcpy(&stamps, CMSG_DATA(c), sizeof(stamps));
+            if (stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0) {
+                *source = CAN_TS_HARDWARE;
+                return TimespecNs(stamps.ts[2]);
+            }
+            if (stamps.ts[0].tv_sec != 0 || stamps.ts[0].tv_nsec != 0) {
+                *source = CAN_TS_KERNEL;
+                return TimespecNs(stamps.ts[0]) - realToMono;
+            }
+        } else if (c->cmsg_type == SO_TIMESTAMPNS) {
+            struct timespec ts{};
+            memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            *source = CAN_TS_KERNEL;
+            return TimespecNs(ts) - realToMono;
+        }
+    }
+    return 0;
+}
+
+int64_t CanMonotonicMs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * 发送队列满（ENOBUFS / EAGAIN）时等待一会儿再重试。
+ *
+ * CAN raw socket 在网卡 TX 队列满时直接返回 ENOBUFS，poll(POLLOUT) 往往仍然立即就绪，
+ * 所以 ENOBUFS 用短暂休眠退避，EAGAIN 才交给 poll 等待。
+ *
+ * @return true 还可以继续重试；false 已到截止时间
+ */
+static bool WaitTxRoom(int fd, int err, int64_t deadlineMs) {
+    int64_t remain = deadlineMs - CanMonotonicMs();
+    if (remain <= 0) return false;
+
+    if (err == ENOBUFS) {
+        // remain 以毫秒计且 > 0，200us 不会越过截止时间太多
+        struct timespec ts{};
+        ts.tv_nsec = 200 * 1000L;
+        nanosleep(&ts, nullptr);
+        return true;
+    }
+
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    return poll(&pfd, 1, static_cast<int>(remain)) > 0;
+}
+
+struct can_filter CanFilterFromSpec(const int32_t* spec) {
+    auto id = static_cast<canid_t>(spec[0]);
+    auto mask = static_cast<canid_t>(spec[1]);
+    int flags = spec[2];
+
+    // 扩展帧过滤器在 id / mask 上带 CAN_EFF_FLAG，标准帧过滤器只在 mask 上带，
+    // 这样标准/扩展帧之间不会误匹配
+    struct can_filter f{};
+    if (flags & CAN_FILTER_EXTENDED) {
+        f.can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+        f.can_mask = (mask & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    } else {
+        f.can_id = id & CAN_SFF_MASK;
+        f.can_mask = (mask & CAN_SFF_MASK) | CAN_EFF_FLAG;
+    }
+    if (flags & CAN_FILTER_INVERTED) {
+        f.can_id |= CAN_INV_FILTER;
+    }
+    return f;
+}
+
+/**
+ * 设置内核过滤器 + 错误帧掩码。
+ *
+ * spec 为 [id, mask, flags] 三元组依次排列，count 为过滤器个数。
+ * count == 0 表示不过滤（接收所有数据帧）。
+ */
+int CanSetFilters(int fd, const int32_t* spec, int count, int32_t errMask) {
+    std::vector<struct can_filter> filters;
+    if (count == 0) {
+        // 默认：全部接收
+        filters.push_back({0, 0});
+    } else {
+        filters.reserve(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            filters.push_back(CanFilterFromSpec(spec + i * 3));
+        }
+    }
+
+    if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                   static_cast<socklen_t>(filters.size() * sizeof(struct can_filter))) < 0) {
+        int err = errno;
+        LOGE("setsockopt(CAN_RAW_FILTER) failed: %s", strerror(err));
+        return -err;
+    }
+
+    can_err_mask_t errFilter = static_cast<can_err_mask_t>(errMask) & CAN_ERR_MASK;
+    if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errFilter, sizeof(errFilter)) < 0) {
+        int err = errno;
+        LOGE("setsockopt(CAN_RAW_ERR_FILTER) failed: %s", strerror(err));
+        return -err;
+    }
+    return 0;
+}
+
+int CanOpen(const char* ifNameArg, bool fdMode, const int32_t* filterSpec, int filterCount, int32_t errMask) {
+    if (ifNameArg == nullptr || ifNameArg[0] == '\0') {
+        LOGE("open: ifName is empty");
+        return -EINVAL;
+    }
+    const std::string ifName(ifNameArg);
+
+    // 尝试 up 一下接口（失败的话就直接返回错误）
+    int upRet = CanSetIfUp(ifName.c_str(), true);
+    if (upRet < 0) {
+        LOGE("open: CanSetIfUp(%s) failed: %d", ifName.c_str(), upRet);
+        return upRet;
+    }
+
+    int ifindex = GetIfIndex(ifName);
+    if (ifindex < 0) {
+        LOGE("open: GetIfIndex(%s) failed: %d", ifName.c_str(), ifindex);
+        return ifindex;
+    }
+
+    int fd = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        int err = errno;
+        LOGE("socket(PF_CAN) failed: %s", strerror(err));
+        return -err;
+    }
+
+    if (fdMode) {
+        int enable = 1;
+        if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) < 0) {
+            int err = errno;
+            LOGE("setsockopt(CAN_RAW_FD_FRAMES, %s) failed: %s", ifName.c_str(), strerror(err));
+            ::close(fd);
+            return -err;
+        }
+    }
+
+    int filterRet = CanSetFilters(fd, filterSpec, filterCount, errMask);
+    if (filterRet < 0) {
+        ::close(fd);
+        return filterRet;
+    }
+
+    struct sockaddr_can addr{};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifindex;
+
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        LOGE("bind(can, %s) failed: %s", ifName.c_str(), strerror(err));
+        ::close(fd);
+        return -err;
+    }
+
+    EnableRxTimestamps(fd, ifName);
+    MetricsAttach(fd);
+
+    LOGI("CAN open(%s) success, fd=%d", ifName.c_str(), fd);
+    return fd;
+}
+
+int CanWriteFrame(int fd, int32_t frameId, int flags, const uint8_t* data, int len, int timeoutMs) {
+    struct canfd_frame frame{};
+    int mtu = EncodeFrame(frameId, flags, data, len, &frame);
+    if (mtu < 0) return mtu;
+
+    ChannelMetrics* m = MetricsFor(fd);
+
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+
+    int pret = MetricsPoll(&pfd, timeoutMs, m);
+    if (pret < 0) {
+        int err = errno;
+        LOGE("CAN write poll failed: %s", strerror(err));
+        return -err;
+    } else if (pret == 0) {
+        return 0; // 超时
+    }
+
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    ssize_t n = ::write(fd, &frame, static_cast<size_t>(mtu));
+    int savedErr = errno;
+
+    if (n < 0) {
+        MetricsError(m, savedErr);
+        LOGE("CAN write failed: %s", strerror(savedErr));
+        return -savedErr;
+    }
+    if (m != nullptr) {
+        m->syscall.Record(MetricsNowNs() - start);
+        MetricsAdd(m->bytesOut, frame.len);
+        MetricsAdd(m->framesOut, 1);
+    }
+    CaptureCan(fd, CAPTURE_TX, frameId, flags, frame.data, frame.len);
+
+    return static_cast<int>(n);
+}
+
+int CanReadFrame(int fd, int32_t* frameId, int32_t* flags, uint8_t* data, int timeoutMs) {
+    ChannelMetrics* m = MetricsFor(fd);
+
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    int pret = MetricsPoll(&pfd, timeoutMs, m);
+    if (pret < 0) {
+        int err = errno;
+        LOGE("CAN read poll failed: %s", strerror(err));
+        return -err;
+    } else if (pret == 0) {
+        return 0; // 超时
+    }
+
+    // 按 canfd_frame 收，经典帧读到的是 CAN_MTU，FD 帧是 CANFD_MTU
+    struct canfd_frame frame{};
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    ssize_t n = ::read(fd, &frame, sizeof(frame));
+    int savedErr = errno;
+
+    if (n < 0) {
+        MetricsError(m, savedErr);
+        LOGE("CAN read failed: %s", strerror(savedErr));
+        return -savedErr;
+    }
+    if (m != nullptr) {
+        m->syscall.Record(MetricsNowNs() - start);
+        MetricsAdd(m->bytesIn, frame.len);
+        MetricsAdd(m->framesIn, 1);
+    }
+    if (n != CAN_MTU && n != CANFD_MTU) {
+        LOGW("CAN read: unexpected frame size %zd", n);
+        return -EIO;
+    }
+
+    DecodeCanId(frame.can_id, frameId, flags);
+    int frameLen = frame.len;
+    if (n == CANFD_MTU) {
+        *flags |= CAN_FLAG_FD;
+        if (frame.flags & CANFD_BRS) *flags |= CAN_FLAG_BRS;
+        if (frame.flags & CANFD_ESI) *flags |= CAN_FLAG_ESI;
+        frameLen = std::min<int>(frameLen, CANFD_MAX_DLEN);
+    } else {
+        frameLen = std::min<int>(frameLen, CAN_MAX_DLEN);
+    }
+    memcpy(data, frame.data, static_cast<size_t>(frameLen));
+    CaptureCan(fd, CAPTURE_RX, *frameId, *flags, data, static_cast<size_t>(frameLen));
+    return frameLen;
+}
+
+int CanReadBatch(int fd, uint8_t* out, int maxFrames, int timeoutMs) {
+    int capacity = std::min(maxFrames, CAN_MAX_BATCH);
+    if (out == nullptr || capacity <= 0) return -EINVAL;
+
+    ChannelMetrics* m = MetricsFor(fd);
+
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    int pret = MetricsPoll(&pfd, timeoutMs, m);
+    if (pret < 0) {
+        int err = errno;
+        LOGE("CAN readBatch poll failed: %s", strerror(err));
+        return -err;
+    } else if (pret == 0) {
+        return 0; // 超时
+    }
+
+    struct canfd_frame frames[CAN_MAX_BATCH];
+    struct iovec iov[CAN_MAX_BATCH];
+    struct mmsghdr msgs[CAN_MAX_BATCH];
+    alignas(struct cmsghdr) uint8_t control[CAN_MAX_BATCH][CAN_CMSG_SPACE];
+    memset(msgs, 0, sizeof(struct mmsghdr) * capacity);
+    for (int i = 0; i < capacity; ++i) {
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = sizeof(struct canfd_frame);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i];
+        msgs[i].msg_hdr.msg_controllen = CAN_CMSG_SPACE;
+    }
+
+    // poll 已确认可读，这里不阻塞，把队列里现有的帧一次性收走
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    int n = recvmmsg(fd, msgs, static_cast<unsigned int>(capacity), MSG_DONTWAIT, nullptr);
+    if (n < 0) {
+        int err = errno;
+        if (err == EAGAIN || err == EWOULDBLOCK) return 0;
+        MetricsError(m, err);
+        LOGE("CAN recvmmsg failed: %s", strerror(err));
+        return -err;
+    }
+    if (m != nullptr) m->syscall.Record(MetricsNowNs() - start);
+
+    int count = 0;
+    uint64_t bytes = 0;
+    int64_t realToMono = RealtimeToMonotonicOffsetNs();
+    for (int i = 0; i < n; ++i) {
+        // 只认 CAN_MTU / CANFD_MTU，其它长度丢弃
+        size_t mtu = msgs[i].msg_len;
+        if (mtu != CAN_MTU && mtu != CANFD_MTU) continue;
+        int tsSource = CAN_TS_NONE;
+        int64_t ts = ExtractRxTimestamp(&msgs[i].msg_hdr, realToMono, &tsSource);
+        uint8_t* rec = out + count * CAN_RECORD_SIZE;
+        PackRecord(rec, frames[i], mtu, ts, tsSource);
+        bytes += rec[5];
+        ++count;
+    }
+    if (m != nullptr) {
+        MetricsAdd(m->bytesIn, bytes);
+        MetricsAdd(m->framesIn, static_cast<uint64_t>(count));
+    }
+    CaptureCanRecords(fd, CAPTURE_RX, out, count);
+    return count;
+}
+
+int CanWriteBatch(int fd, const uint8_t* records, int count, int64_t deadlineMs) {
+    if (records == nullptr || count <= 0) return -EINVAL;
+    ChannelMetrics* m = MetricsFor(fd);
+
+    struct canfd_frame frames[CAN_MAX_BATCH];
+    struct iovec iov[CAN_MAX_BATCH];
+    struct mmsghdr msgs[CAN_MAX_BATCH];
+
+    int sent = 0;
+    while (sent < count) {
+        int chunk = std::min(count - sent, CAN_MAX_BATCH);
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * chunk);
+        for (int i = 0; i < chunk; ++i) {
+            int mtu = UnpackRecord(records + (sent + i) * CAN_RECORD_SIZE, &frames[i]);
+            if (mtu < 0) {
+                LOGE("CAN writeBatch: bad record #%d: %d", sent + i, mtu);
+                return sent > 0 ? sent : mtu;
+            }
+            iov[i].iov_base = &frames[i];
+            iov[i].iov_len = static_cast<size_t>(mtu);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int done = 0;
+        while (done < chunk) {
+            uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+            int n = sendmmsg(fd, msgs + done, static_cast<unsigned int>(chunk - done), MSG_DONTWAIT);
+            if (n > 0) {
+                if (m != nullptr) {
+                    m->syscall.Record(MetricsNowNs() - start);
+                    uint64_t bytes = 0;
+                    for (int k = done; k < done + n; ++k) bytes += frames[k].len;
+                    MetricsAdd(m->bytesOut, bytes);
+                    MetricsAdd(m->framesOut, static_cast<uint64_t>(n));
+                }
+                CaptureCanRecords(fd, CAPTURE_TX, records + (sent + done) * CAN_RECORD_SIZE, n);
+                done += n;
+                continue;
+            }
+
+            int err = (n < 0) ? errno : EAGAIN;
+            if (err == EINTR) continue;
+            if (err == ENOBUFS || err == EAGAIN || err == EWOULDBLOCK) {
+                if (WaitTxRoom(fd, err, deadlineMs)) continue;
+                // 超时：返回已经被接受的帧数
+                if (m != nullptr) MetricsAdd(m->pollTimeouts, 1);
+                return sent + done;
+            }
+
+            MetricsError(m, err);
+            LOGE("CAN sendmmsg failed: %s", strerror(err));
+            return (sent + done) > 0 ? sent + done : -err;
+        }
+        sent += chunk;
+    }
+    return sent;
+}
+
+void CanClose(int fd) {
+    if (fd >= 0) {
+        CaptureDetach(fd);
+        ::close(fd);
+        LOGI("CAN close fd=%d", fd);
+    }
+}
+
+// ---------------- CAN_BCM ----------------
+
+// BCM 消息缓冲区：bcm_msg_head 之后紧跟至多一帧（经典帧按 CAN_MTU，FD 帧按 CANFD_MTU）
+static const size_t BCM_MSG_SIZE = sizeof(struct bcm_msg_head) + sizeof(struct canfd_frame);
+
+struct alignas(8) BcmMessage {
+    uint8_t bytes[BCM_MSG_SIZE];
+
+    struct bcm_msg_head* head() { return reinterpret_cast<struct bcm_msg_head*>(bytes); }
+
+    struct canfd_frame* frame() {
+        return reinterpret_cast<struct canfd_frame*>(bytes + sizeof(struct bcm_msg_head));
+    }
+};
+
+static void SetBcmTimeval(struct bcm_timeval* tv, int64_t us) {
+    if (us < 0) us = 0;
+    tv->tv_sec = static_cast<long>(us / 1000000);
+    tv->tv_usec = static_cast<long>(us % 1000000);
+}
+
+/**
+ * 写一条 BCM 命令。frame 为 nullptr 时 nframes = 0。
+ *
+ * BCM 命令是同步处理的：write 返回时内核已经完成 setup / delete（或返回错误）。
+ */
+static int BcmCommand(int fd, uint32_t opcode, uint32_t bcmFlags, canid_t canId,
+                      const struct canfd_frame* frame, int64_t ival1Us, int64_t ival2Us) {
+    BcmMessage msg{};
+    struct bcm_msg_head* head = msg.head();
+    head->opcode = opcode;
+    head->flags = bcmFlags;
+    head->can_id = canId;
+    SetBcmTimeval(&head->ival1, ival1Us);
+    SetBcmTimeval(&head->ival2, ival2Us);
+
+    size_t size = sizeof(struct bcm_msg_head);
+    if (frame != nullptr) {
+        size_t frameSize = (bcmFlags & CAN_FD_FRAME) ? CANFD_MTU : CAN_MTU;
+        memcpy(msg.frame(), frame, frameSize);
+        head->nframes = 1;
+        size += frameSize;
+    }
+
+    ssize_t n = ::write(fd, msg.bytes, size);
+    if (n < 0) {
+        int err = errno;
+        LOGE("CAN_BCM opcode=%u can_id=0x%x failed: %s", opcode, canId, strerror(err));
+        return -err;
+    }
+    return 0;
+}
+
+int CanBcmOpen(const char* ifNameArg) {
+    if (ifNameArg == nullptr || ifNameArg[0] == '\0') {
+        LOGE("bcm open: ifName is empty");
+        return -EINVAL;
+    }
+    const std::string ifName(ifNameArg);
+
+    int ifindex = GetIfIndex(ifName);
+    if (ifindex < 0) return ifindex;
+
+    int fd = ::socket(PF_CAN, SOCK_DGRAM | SOCK_CLOEXEC, CAN_BCM);
+    if (fd < 0) {
+        int err = errno;
+        LOGE("socket(CAN_BCM) failed: %s", strerror(err));
+        return -err;
+    }
+
+    struct sockaddr_can addr{};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifindex;
+
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        int err = errno;
+        LOGE("connect(can_bcm, %s) failed: %s", ifName.c_str(), strerror(err));
+        ::close(fd);
+        return -err;
+    }
+
+    EnableRxTimestamps(fd, ifName);
+
+    LOGI("CAN_BCM open(%s) success, fd=%d", ifName.c_str(), fd);
+    return fd;
+}
+
+int CanBcmTxStart(int fd, int32_t frameId, int flags, const uint8_t* data, int len, int64_t intervalUs) {
+    if (intervalUs <= 0) return -EINVAL;
+    struct canfd_frame frame{};
+    int mtu = EncodeFrame(frameId, flags, data, len, &frame);
+    if (mtu < 0) return mtu;
+
+    uint32_t bcmFlags = SETTIMER | STARTTIMER | TX_ANNOUNCE;
+    if (mtu == CANFD_MTU) bcmFlags |= CAN_FD_FRAME;
+    // count = 0：只用 ival2 无限循环
+    return BcmCommand(fd, TX_SETUP, bcmFlags, frame.can_id, &frame, 0, intervalUs);
+}
+
+int CanBcmTxUpdate(int fd, int32_t frameId, int flags, const uint8_t* data, int len, bool announce) {
+    struct canfd_frame frame{};
+    int mtu = EncodeFrame(frameId, flags, data, len, &frame);
+    if (mtu < 0) return mtu;
+
+    // 不带 SETTIMER / STARTTIMER：内核只替换帧内容，正在运行的定时器不受影响
+    uint32_t bcmFlags = announce ? TX_ANNOUNCE : 0;
+    if (mtu == CANFD_MTU) bcmFlags |= CAN_FD_FRAME;
+    return BcmCommand(fd, TX_SETUP, bcmFlags, frame.can_id, &frame, 0, 0);
+}
+
+int CanBcmTxStop(int fd, int32_t frameId, int flags) {
+    uint32_t bcmFlags = (flags & CAN_FLAG_FD) ? CAN_FD_FRAME : 0;
+    return BcmCommand(fd, TX_DELETE, bcmFlags, EncodeCanId(frameId, flags), nullptr, 0, 0);
+}
+
+int CanBcmRxWatch(int fd, int32_t frameId, int flags, const uint8_t* mask, int maskLen,
+                  int64_t timeoutUs, int64_t throttleUs, int options) {
+    bool fdFrame = (flags & CAN_FLAG_FD) != 0;
+    if (maskLen < 0 || maskLen > (fdFrame ? CANFD_MAX_DLEN : CAN_MAX_DLEN)) return -EINVAL;
+    if (maskLen > 0 && mask == nullptr) return -EINVAL;
+
+    canid_t canId = EncodeCanId(frameId, flags);
+    // 每次都带 SETTIMER，替换已有监视时清掉旧的超时 / 限速设置
+    uint32_t bcmFlags = SETTIMER;
+    if (timeoutUs > 0) bcmFlags |= STARTTIMER;  // 一直收不到也要报超时，不等首帧
+    if (fdFrame) bcmFlags |= CAN_FD_FRAME;
+    if (options & CAN_BCM_WATCH_CHECK_DLC) bcmFlags |= RX_CHECK_DLC;
+    if (options & CAN_BCM_WATCH_ANNOUNCE_RESUME) bcmFlags |= RX_ANNOUNCE_RESUME;
+
+    if (maskLen == 0) {
+        return BcmCommand(fd, RX_SETUP, bcmFlags | RX_FILTER_ID, canId, nullptr, timeoutUs, throttleUs);
+    }
+
+    // 掩码帧：payload 为比较掩码，内核按 8 字节一组和上一帧做 (new ^ last) & mask
+    struct canfd_frame maskFrame{};
+    maskFrame.can_id = canId;
+    maskFrame.len = fdFrame ? CanFdAlignLen(maskLen) : static_cast<__u8>(maskLen);
+    memcpy(maskFrame.data, mask, static_cast<size_t>(maskLen));
+    return BcmCommand(fd, RX_SETUP, bcmFlags, canId, &maskFrame, timeoutUs, throttleUs);
+}
+
+int CanBcmRxUnwatch(int fd, int32_t frameId, int flags) {
+    uint32_t bcmFlags = (flags & CAN_FLAG_FD) ? CAN_FD_FRAME : 0;
+    return BcmCommand(fd, RX_DELETE, bcmFlags, EncodeCanId(frameId, flags), nullptr, 0, 0);
+}
+
+int CanBcmRead(int fd, uint8_t* out, int maxEvents) {
+    int capacity = std::min(maxEvents, CAN_MAX_BATCH);
+    if (out == nullptr || capacity <= 0) return -EINVAL;
+
+    BcmMessage msgsBuf[CAN_MAX_BATCH];
+    struct iovec iov[CAN_MAX_BATCH];
+    struct mmsghdr msgs[CAN_MAX_BATCH];
+    alignas(struct cmsghdr) uint8_t control[CAN_MAX_BATCH][CAN_CMSG_SPACE];
+    memset(msgs, 0, sizeof(struct mmsghdr) * capacity);
+    for (int i = 0; i < capacity; ++i) {
+        iov[i].iov_base = msgsBuf[i].bytes;
+        iov[i].iov_len = BCM_MSG_SIZE;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i];
+        msgs[i].msg_hdr.msg_controllen = CAN_CMSG_SPACE;
+    }
+
+    int n = recvmmsg(fd, msgs, static_cast<unsigned int>(capacity), MSG_DONTWAIT, nullptr);
+    if (n < 0) {
+        int err = errno;
+        if (err == EAGAIN || err == EWOULDBLOCK) return 0;
+        LOGE("CAN_BCM recvmmsg failed: %s", strerror(err));
+        return -err;
+    }
+
+    int count = 0;
+    int64_t realToMono = RealtimeToMonotonicOffsetNs();
+    for (int i = 0; i < n; ++i) {
+        if (msgs[i].msg_len < sizeof(struct bcm_msg_head)) continue;
+        BcmMessage& msg = msgsBuf[i];
+        const struct bcm_msg_head* head = msg.head();
+        size_t mtu = (head->flags & CAN_FD_FRAME) ? CANFD_MTU : CAN_MTU;
+        uint8_t* rec = out + count * CAN_RECORD_SIZE;
+
+        if (head->opcode == RX_CHANGED) {
+            if (head->nframes < 1 || msgs[i].msg_len < sizeof(struct bcm_msg_head) + mtu) continue;
+            int tsSource = CAN_TS_NONE;
+            int64_t ts = ExtractRxTimestamp(&msgs[i].msg_hdr, realToMono, &tsSource);
+            PackRecord(rec, *msg.frame(), mtu, ts, tsSource);
+            rec[7] = static_cast<uint8_t>(CAN_BCM_EVENT_CHANGED);
+        } else if (head->opcode == RX_TIMEOUT) {
+            struct canfd_frame frame{};
+            frame.can_id = head->can_id;
+            struct timespec now{};
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            PackRecord(rec, frame, mtu, TimespecNs(now), CAN_TS_MONOTONIC);
+            rec[7] = static_cast<uint8_t>(CAN_BCM_EVENT_TIMEOUT);
+        } else {
+            // TX_EXPIRED 等：这里不使用计数发送，忽略
+            continue;
+        }
+        ++count;
+    }
+    return count;
+}
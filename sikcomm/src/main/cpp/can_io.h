@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+#include <linux/can.h>
+
+/**
+ * SocketCAN I/O 核心：CAN_RAW socket 的打开 / 过滤器 / 单帧与批量收发，
+ * 以及 CAN_BCM（广播管理器）socket 上由内核定时的周期发送和接收变化检测 / 超时监视。
+ *
+ * 纯 C++，不依赖 JNI，socketcan_jni.cpp 只做参数转换；宿主机上可以直接对 vcan 调用（见 bench/）。
+ * 所有函数出错时返回 -errno。
+ */
+
+// flags bit 定义（和 Kotlin 那边保持一致）
+static const int CAN_FLAG_EXTENDED = 0x01;
+static const int CAN_FLAG_RTR      = 0x02;
+static const int CAN_FLAG_FD       = 0x04;
+static const int CAN_FLAG_BRS      = 0x08;
+static const int CAN_FLAG_ESI      = 0x10;
+static const int CAN_FLAG_ERROR    = 0x20;
+
+// 过滤器描述里的 flags（和 Kotlin CanFilter 保持一致）
+static const int CAN_FILTER_EXTENDED = 0x01;
+static const int CAN_FILTER_INVERTED = 0x02;
+
+// readBatch / writeBatch 打包记录格式（和 Kotlin CanFrames 保持一致，小端）：
+//  [0..3]   frameId
+//  [4]      flags
+//  [5]      payload 长度
+//  [6]      接收时间戳来源（CAN_TS_*，发送时忽略）
+//  [7]      保留
+//  [8..15]  接收时间戳（纳秒，int64）
+//  [16..79] payload（经典 CAN 只用前 8 字节，CAN FD 最多 64 字节）
+static const int CAN_RECORD_HEADER = 16;
+static const int CAN_RECORD_SIZE   = CAN_RECORD_HEADER + CANFD_MAX_DLEN;
+
+// 单次 recvmmsg / sendmmsg 最多处理多少帧
+static const int CAN_MAX_BATCH = 64;
+
+// 接收时间戳来源（和 Kotlin TimestampedReceiver.SOURCE_* 保持一致）
+static const int CAN_TS_NONE      = 0;
+static const int CAN_TS_MONOTONIC = 1;  // 用户态读取时的 CLOCK_MONOTONIC（BCM 超时事件）
+static const int CAN_TS_KERNEL    = 2;   // 内核软件时间戳，已换算到 CLOCK_MONOTONIC
+static const int CAN_TS_HARDWARE  = 3;   // 控制器硬件时间戳（设备时钟）
+
+/**
+ * 设置接口 up / down（SIOCSIFFLAGS，已经是目标状态时不做任何修改）。
+ */
+int CanSetIfUp(const char* ifName, bool up);
+
+/**
+ * up 接口并打开绑定在其上的 CAN_RAW socket。
+ *
+ * fdMode 时打开 CAN_RAW_FD_FRAMES（接口 MTU 需为 72，vcan 可用 `ip link set vcan0 mtu 72`）；
+ * 过滤器在 bind 之前设置，避免收到未过滤的帧。成功后挂上 metrics 并打开接收时间戳。
+ *
+ * @param filterSpec [id, mask, flags] 三元组依次排列，filterCount 为 0 表示接收所有数据帧
+ * @return >=0: fd；<0: -errno
+ */
+int CanOpen(const char* ifName, bool fdMode, const int32_t* filterSpec, int filterCount, int32_t errMask);
+
+/**
+ * [id, mask, flags] 三元组 -> 内核 can_filter（匹配规则和 CAN_RAW_FILTER 相同）。
+ */
+struct can_filter CanFilterFromSpec(const int32_t* spec);
+
+/**
+ * 设置内核过滤器 + 错误帧掩码，spec 格式同 CanOpen。
+ */
+int CanSetFilters(int fd, const int32_t* spec, int count, int32_t errMask);
+
+/**
+ * 发送一帧。flags 为 CAN_FLAG_*，FD 帧非 DLC 档位长度会补 0 对齐。
+ *
+ * @return >0: 写给内核的字节数；0: 超时；<0: -errno
+ */
+int CanWriteFrame(int fd, int32_t frameId, int flags, const uint8_t* data, int len, int timeoutMs);
+
+/**
+ * 接收一帧。
+ *
+ * @param data 至少 CANFD_MAX_DLEN 字节
+ * @return >0: payload 长度；0: 超时；<0: -errno
+ */
+int CanReadFrame(int fd, int32_t* frameId, int32_t* flags, uint8_t* data, int timeoutMs);
+
+/**
+ * 一次 poll + 一次 recvmmsg 收走已排队的帧，按 CAN_RECORD_SIZE 定长记录写进 out。
+ *
+ * @param maxFrames out 能容纳的记录数（单次至多 CAN_MAX_BATCH）
+ * @return >0: 收到的帧数；0: 超时；<0: -errno
+ */
+int CanReadBatch(int fd, uint8_t* out, int maxFrames, int timeoutMs);
+
+/**
+ * 按 CAN_MAX_BATCH 分片用 sendmmsg 发出 records 里的 count 条记录。
+ *
+ * TX 队列满（ENOBUFS）时退避后从第一个未被接受的帧继续，直到全部发出或到达 deadlineMs。
+ *
+ * @param deadlineMs CanMonotonicMs() 时间轴上的截止时间
+ * @return >=0: 被内核接受的帧数（小于 count 表示超时）；<0: 一帧都没发出时的 -errno
+ */
+int CanWriteBatch(int fd, const uint8_t* records, int count, int64_t deadlineMs);
+
+/**
+ * CLOCK_MONOTONIC 毫秒。
+ */
+int64_t CanMonotonicMs();
+
+void CanClose(int fd);
+
+// ---------------- CAN_BCM ----------------
+
+// BCM 事件记录：和 readBatch 记录格式相同，[7] 为事件类型（CAN_BCM_EVENT_*）
+static const int CAN_BCM_EVENT_CHANGED = 1;   // 收到的帧和上一帧（按掩码比较）不同，或首帧 / 超时后恢复
+static const int CAN_BCM_EVENT_TIMEOUT = 2;   // 超过 timeout 没有收到该 ID 的帧，payload 为空
+
+// CanBcmRxWatch 的 options bit（和 Kotlin NativeCanBcm 保持一致）
+static const int CAN_BCM_WATCH_CHECK_DLC      = 0x01;  // DLC 变化也算变化
+static const int CAN_BCM_WATCH_ANNOUNCE_RESUME = 0x02; // 超时后收到的第一帧总是上报
+
+/**
+ * 打开 CAN_BCM socket 并 connect 到接口（接口需已 up）。
+ *
+ * 周期发送和接收监视都由内核定时器完成，socket 关闭时内核删除其上所有的任务。
+ *
+ * @return >=0: fd；<0: -errno
+ */
+int CanBcmOpen(const char* ifName);
+
+/**
+ * 注册（或替换）周期发送任务：TX_SETUP + SETTIMER | STARTTIMER，立即发出第一帧，之后每 intervalUs 一帧。
+ *
+ * 任务以 (frameId, EXTENDED, FD) 区分，flags 同 CanWriteFrame。
+ */
+int CanBcmTxStart(int fd, int32_t frameId, int flags, const uint8_t* data, int len, int64_t intervalUs);
+
+/**
+ * 原地替换周期发送任务的 payload，不重置定时器：下一个周期发出的就是新内容。
+ *
+ * @param announce true 时额外立即发出一帧新内容（TX_ANNOUNCE）
+ */
+int CanBcmTxUpdate(int fd, int32_t frameId, int flags, const uint8_t* data, int len, bool announce);
+
+/**
+ * 删除周期发送任务（TX_DELETE）。
+ *
+ * @return 0: 成功；-EINVAL: 没有这个任务；其它 <0: -errno
+ */
+int CanBcmTxStop(int fd, int32_t frameId, int flags);
+
+/**
+ * 注册（或替换）接收监视：RX_SETUP。
+ *
+ * - mask 为空（maskLen == 0）时每收到一帧都上报（RX_FILTER_ID）
+ * - 否则只在 payload 按 mask 逐位比较发生变化时上报（RX_CHANGED），首帧总是上报
+ * - timeoutUs > 0 时超过该时间没收到帧上报一次超时（RX_TIMEOUT）
+ * - throttleUs > 0 时两次变化上报之间至少间隔该时间（内核合并期间的变化）
+ *
+ * @param options CAN_BCM_WATCH_* 组合
+ */
+int CanBcmRxWatch(int fd, int32_t frameId, int flags, const uint8_t* mask, int maskLen,
+                  int64_t timeoutUs, int64_t throttleUs, int options);
+
+/**
+ * 删除接收监视（RX_DELETE）。
+ *
+ * @return 0: 成功；-EINVAL: 没有这个监视；其它 <0: -errno
+ */
+int CanBcmRxUnwatch(int fd, int32_t frameId, int flags);
+
+/**
+ * 非阻塞地收走内核排队的 BCM 通知，按 BCM 事件记录写进 out（每条通知一条记录）。
+ *
+ * 变化事件带内核接收时间戳；超时事件的时间戳为读取时的 CLOCK_MONOTONIC。
+ *
+ * @param maxEvents out 能容纳的记录数（单次至多 CAN_MAX_BATCH）
+ * @return >=0: 事件数（0 表示没有）；<0: -errno
+ */
+int CanBcmRead(int fd, uint8_t* out, int maxEvents);
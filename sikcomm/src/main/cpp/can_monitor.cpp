@@ -0,0 +1,353 @@
+#include "can_monitor.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <linux/can/error.h>
+
+#define LOG_TAG "CanMonitor"
+#include "comm_log.h"
+#include "comm_metrics.h"
+#include "can_io.h"
+#include "can_netlink.h"
+
+// 老内核头文件里没有的错误帧位
+#ifndef CAN_ERR_CNT
+#define CAN_ERR_CNT 0x00000200U
+#endif
+#ifndef CAN_ERR_CRTL_ACTIVE
+#define CAN_ERR_CRTL_ACTIVE 0x40
+#endif
+
+// 一次 OnReadable 最多收几批，剩下的等 reactor 下一次就绪
+static const int CAN_MONITOR_BATCHES = 4;
+
+// 监视 socket 的接收缓冲区：reactor 线程被其它通道占住时尽量不丢帧
+static const int CAN_MONITOR_RCVBUF = 1024 * 1024;
+
+// CRC 界定符 + ACK 槽 + ACK 界定符 + EOF(7) + 帧间隔(3)，都按仲裁段波特率
+static const uint32_t CAN_FRAME_TRAILER_BITS = 13;
+
+// 负载的满量程（百万分比）
+static const uint64_t CAN_LOAD_FULL_PPM = 1000000;
+
+namespace {
+
+/**
+ * 按发送顺序逐位喂入，统计动态填充位（连续 5 个相同位后插入一个相反位，填充位计入下一段连续位），
+ * 打开 crc 时同时计算经典帧的 CRC-15。
+ */
+struct BitStuffer {
+    uint32_t bits = 0;
+    uint32_t stuffed = 0;
+    int last = -1;
+    int run = 0;
+    bool crc = false;
+    uint16_t crc15 = 0;
+
+    void Put(int bit) {
+        ++bits;
+        if (crc) {
+            int next = bit ^ ((crc15 >> 14) & 1);
+            crc15 = static_cast<uint16_t>((crc15 << 1) & 0x7FFF);
+            if (next) crc15 ^= 0x4599;
+        }
+        if (bit == last) {
+            if (++run == 5) {
+                ++stuffed;
+                last = bit ? 0 : 1;
+                run = 1;
+            }
+        } else {
+            last = bit;
+            run = 1;
+        }
+    }
+
+    void PutBits(uint32_t value, int count) {
+        for (int i = count - 1; i >= 0; --i) Put(static_cast<int>((value >> i) & 1));
+    }
+
+    uint32_t Total() const { return bits + stuffed; }
+};
+
+uint32_t ReadU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+int64_t ReadI64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return static_cast<int64_t>(v);
+}
+
+uint32_t FdDlc(uint8_t len) {
+    static const uint8_t kFdDlcToLen[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+    for (uint32_t dlc = 0; dlc < 16; ++dlc) {
+        if (kFdDlcToLen[dlc] >= len) return dlc;
+    }
+    return 15;
+}
+
+/**
+ * 仲裁段的 ID 位：标准帧 ID(11)；扩展帧 ID-A(11) SRR IDE ID-B(18)。
+ */
+void PutId(BitStuffer* s, uint32_t id, bool extended) {
+    if (extended) {
+        s->PutBits(id >> 18, 11);
+        s->Put(1);   // SRR
+        s->Put(1);   // IDE
+        s->PutBits(id & 0x3FFFF, 18);
+    } else {
+        s->PutBits(id, 11);
+    }
+}
+
+uint64_t LoadPpm(uint64_t busyPs, int64_t windowNs) {
+    if (windowNs <= 0) return 0;
+    return std::min(CAN_LOAD_FULL_PPM, busyPs * 1000 / static_cast<uint64_t>(windowNs));
+}
+
+} // namespace
+
+CanFrameBits CanRecordBits(const uint8_t* rec) {
+    CanFrameBits out;
+    int flags = rec[4];
+    if (flags & CAN_FLAG_ERROR) return out;
+
+    uint32_t id = ReadU32(rec);
+    bool extended = (flags & CAN_FLAG_EXTENDED) != 0;
+    uint8_t len = rec[5];
+    const uint8_t* data = rec + CAN_RECORD_HEADER;
+
+    BitStuffer s;
+    if (!(flags & CAN_FLAG_FD)) {
+        // 经典帧：SOF .. CRC 全部参与填充，CRC-15 覆盖 SOF .. 数据段
+        bool rtr = (flags & CAN_FLAG_RTR) != 0;
+        len = std::min<uint8_t>(len, CAN_MAX_DLEN);
+        s.crc = true;
+        s.Put(0);                       // SOF
+        PutId(&s, id, extended);
+        s.Put(rtr ? 1 : 0);             // RTR
+        if (!extended) s.Put(0);        // IDE
+        s.Put(0);                       // r0（扩展帧为 r1）
+        if (extended) s.Put(0);         // r0
+        s.PutBits(len, 4);              // DLC
+        if (!rtr) {
+            for (uint8_t i = 0; i < len; ++i) s.PutBits(data[i], 8);
+        }
+        s.crc = false;
+        s.PutBits(s.crc15, 15);
+        out.nominal = s.Total() + CAN_FRAME_TRAILER_BITS;
+        return out;
+    }
+
+    // FD 帧：SOF .. 数据段动态填充，之后填充计数 + CRC 用固定填充位
+    bool brs = (flags & CAN_FLAG_BRS) != 0;
+    len = std::min<uint8_t>(len, CANFD_MAX_DLEN);
+    s.Put(0);                           // SOF
+    PutId(&s, id, extended);
+    s.Put(0);                           // RRS
+    if (!extended) s.Put(0);            // IDE
+    s.Put(1);                           // FDF
+    s.Put(0);                           // res
+    s.Put(brs ? 1 : 0);                 // BRS
+    uint32_t arbitration = s.Total();
+    s.Put((flags & CAN_FLAG_ESI) ? 1 : 0);
+    s.PutBits(FdDlc(len), 4);
+    for (uint8_t i = 0; i < len; ++i) s.PutBits(data[i], 8);
+
+    // 填充计数 4 位 + CRC-17（<= 16 字节）/ CRC-21，固定填充位分别为 6 / 7 个
+    uint32_t crcField = len > 16 ? 4 + 21 + 7 : 4 + 17 + 6;
+    uint32_t total = s.Total() + crcField;
+    if (brs) {
+        out.nominal = arbitration + CAN_FRAME_TRAILER_BITS;
+        out.data = total - arbitration;
+    } else {
+        out.nominal = total + CAN_FRAME_TRAILER_BITS;
+    }
+    return out;
+}
+
+CanBusMonitor* CanBusMonitor::Create(const char* ifName, const CanBusMonitorConfig& config, int* err) {
+    *err = 0;
+    if (ifName == nullptr || ifName[0] == '\0' || config.windowMs <= 0) {
+        *err = -EINVAL;
+        return nullptr;
+    }
+
+    // 不带 ID 过滤器：总线上的每一帧都要计入负载；内核不支持 FD 时退回经典帧
+    int fd = CanOpen(ifName, true, nullptr, 0, static_cast<int32_t>(CAN_ERR_MASK));
+    if (fd < 0 && fd != -ENODEV && fd != -ENXIO) {
+        fd = CanOpen(ifName, false, nullptr, 0, static_cast<int32_t>(CAN_ERR_MASK));
+    }
+    if (fd < 0) {
+        *err = fd;
+        return nullptr;
+    }
+    int rcvbuf = CAN_MONITOR_RCVBUF;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    auto* m = new CanBusMonitor();
+    m->ifName_ = ifName;
+    m->fds_.push_back(fd);
+    m->windowNs_ = static_cast<int64_t>(config.windowMs) * 1000000;
+
+    CanLinkStatus link;
+    if (CanLinkQuery(ifName, &link) == 0 && link.isCan) {
+        m->linkIsCan_ = true;
+        m->state_.store(link.state);
+        m->txErrors_.store(link.txErrors);
+        m->rxErrors_.store(link.rxErrors);
+    }
+    m->bitrate_ = config.bitrate > 0 ? config.bitrate : link.bitrate;
+    m->dataBitrate_ = config.dataBitrate > 0 ? config.dataBitrate : link.dataBitrate;
+    if (m->dataBitrate_ == 0) m->dataBitrate_ = m->bitrate_;
+    if (m->bitrate_ > 0) {
+        m->nominalBitPs_ = 1000000000000ULL / m->bitrate_;
+        m->dataBitPs_ = 1000000000000ULL / m->dataBitrate_;
+    }
+
+    LOGI("bus monitor on %s: bitrate=%u dbitrate=%u window=%dms%s", ifName, m->bitrate_, m->dataBitrate_,
+         config.windowMs, m->bitrate_ == 0 ? " (bitrate unknown, load disabled)" : "");
+    return m;
+}
+
+CanBusMonitor::~CanBusMonitor() {
+    for (int fd : fds_) CanClose(fd);
+}
+
+int CanBusMonitor::OnReadable(int fd) {
+    uint8_t buf[CAN_MAX_BATCH * CAN_RECORD_SIZE];
+    int total = 0;
+    for (int batch = 0; batch < CAN_MONITOR_BATCHES; ++batch) {
+        int n = CanReadBatch(fd, buf, CAN_MAX_BATCH, 0);
+        if (n < 0) return n;
+        if (n == 0) break;
+        int64_t now = static_cast<int64_t>(MetricsNowNs());
+        for (int i = 0; i < n; ++i) Account(buf + i * CAN_RECORD_SIZE, now);
+        total += n;
+        if (n < CAN_MAX_BATCH) break;
+    }
+    return total;
+}
+
+void CanBusMonitor::Account(const uint8_t* rec, int64_t nowNs) {
+    // 硬件时间戳是设备时钟，不能和窗口比较，改用读取时间
+    int64_t ts = nowNs;
+    if (rec[6] == CAN_TS_KERNEL || rec[6] == CAN_TS_MONOTONIC) ts = ReadI64(rec + 8);
+
+    if (rec[4] & CAN_FLAG_ERROR) {
+        AccountError(rec, ts);
+        return;
+    }
+
+    CanFrameBits b = CanRecordBits(rec);
+    uint64_t ps = b.nominal * nominalBitPs_ + b.data * dataBitPs_;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    bits_.fetch_add(b.nominal + b.data, std::memory_order_relaxed);
+    busyPs_.fetch_add(ps, std::memory_order_relaxed);
+    if (nominalBitPs_ == 0) return;
+
+    CloseWindows(ts);
+    windowBusyPs_ += ps;
+}
+
+void CanBusMonitor::CloseWindows(int64_t ts) {
+    int64_t start = windowStartNs_.load(std::memory_order_relaxed);
+    if (start == 0) {
+        windowStartNs_.store(ts, std::memory_order_relaxed);
+        return;
+    }
+    if (ts < start + windowNs_) return;
+
+    // 帧按结束时间计入窗口；中间跨过的整窗口没有帧，最近一个完整窗口的负载为 0
+    int64_t elapsed = (ts - start) / windowNs_;
+    uint32_t ppm = static_cast<uint32_t>(LoadPpm(windowBusyPs_, windowNs_));
+    windowLoadPpm_.store(elapsed > 1 ? 0 : ppm, std::memory_order_relaxed);
+    if (ppm > peakLoadPpm_.load(std::memory_order_relaxed)) {
+        peakLoadPpm_.store(ppm, std::memory_order_relaxed);
+    }
+    windowBusyPs_ = 0;
+    windowStartNs_.store(start + elapsed * windowNs_, std::memory_order_relaxed);
+}
+
+void CanBusMonitor::AccountError(const uint8_t* rec, int64_t ts) {
+    uint32_t cls = ReadU32(rec);
+    const uint8_t* d = rec + CAN_RECORD_HEADER;
+    errorFrames_.fetch_add(1, std::memory_order_relaxed);
+    lastErrorNs_.store(ts, std::memory_order_relaxed);
+
+    if (cls & CAN_ERR_TX_TIMEOUT) txTimeouts_.fetch_add(1, std::memory_order_relaxed);
+    if (cls & CAN_ERR_LOSTARB) arbitrationLost_.fetch_add(1, std::memory_order_relaxed);
+    if (cls & (CAN_ERR_PROT | CAN_ERR_BUSERROR)) busErrors_.fetch_add(1, std::memory_order_relaxed);
+    if (cls & CAN_ERR_ACK) ackErrors_.fetch_add(1, std::memory_order_relaxed);
+    if (cls & CAN_ERR_CRTL) {
+        uint8_t c = d[1];
+        if (c & (CAN_ERR_CRTL_RX_OVERFLOW | CAN_ERR_CRTL_TX_OVERFLOW)) {
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (c & (CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE)) {
+            state_.store(CAN_BUS_STATE_ERROR_PASSIVE, std::memory_order_relaxed);
+        } else if (c & (CAN_ERR_CRTL_RX_WARNING | CAN_ERR_CRTL_TX_WARNING)) {
+            state_.store(CAN_BUS_STATE_ERROR_WARNING, std::memory_order_relaxed);
+        } else if (c & CAN_ERR_CRTL_ACTIVE) {
+            state_.store(CAN_BUS_STATE_ERROR_ACTIVE, std::memory_order_relaxed);
+        }
+    }
+    if (cls & CAN_ERR_BUSOFF) {
+        busOff_.fetch_add(1, std::memory_order_relaxed);
+        state_.store(CAN_BUS_STATE_BUS_OFF, std::memory_order_relaxed);
+    }
+    if (cls & CAN_ERR_RESTARTED) {
+        restarts_.fetch_add(1, std::memory_order_relaxed);
+        state_.store(CAN_BUS_STATE_ERROR_ACTIVE, std::memory_order_relaxed);
+    }
+    if (cls & CAN_ERR_CNT) {
+        txErrors_.store(d[6], std::memory_order_relaxed);
+        rxErrors_.store(d[7], std::memory_order_relaxed);
+    }
+}
+
+void CanBusMonitor::Snapshot(CanBusSnapshot* out) const {
+    *out = CanBusSnapshot{};
+    int64_t now = static_cast<int64_t>(MetricsNowNs());
+    out->timestampNs = now;
+    out->bitrate = bitrate_;
+    out->dataBitrate = dataBitrate_;
+    out->frames = frames_.load(std::memory_order_relaxed);
+    out->bits = bits_.load(std::memory_order_relaxed);
+    out->busyNs = busyPs_.load(std::memory_order_relaxed) / 1000;
+    out->peakLoadPpm = peakLoadPpm_.load(std::memory_order_relaxed);
+    // 总线空闲时没有帧来结束窗口：当前窗口之前的整窗口已经过去，负载为 0
+    int64_t start = windowStartNs_.load(std::memory_order_relaxed);
+    bool idle = start != 0 && now >= start + 2 * windowNs_;
+    out->windowLoadPpm = idle ? 0 : windowLoadPpm_.load(std::memory_order_relaxed);
+
+    out->state = state_.load(std::memory_order_relaxed);
+    out->txErrors = txErrors_.load(std::memory_order_relaxed);
+    out->rxErrors = rxErrors_.load(std::memory_order_relaxed);
+    out->errorFrames = errorFrames_.load(std::memory_order_relaxed);
+    out->busErrors = busErrors_.load(std::memory_order_relaxed);
+    out->ackErrors = ackErrors_.load(std::memory_order_relaxed);
+    out->arbitrationLost = arbitrationLost_.load(std::memory_order_relaxed);
+    out->overflows = overflows_.load(std::memory_order_relaxed);
+    out->txTimeouts = txTimeouts_.load(std::memory_order_relaxed);
+    out->busOff = busOff_.load(std::memory_order_relaxed);
+    out->restarts = restarts_.load(std::memory_order_relaxed);
+    out->lastErrorNs = lastErrorNs_.load(std::memory_order_relaxed);
+
+    // 真实控制器：状态和 TEC / REC 以驱动为准（不开 berr-reporting 时错误帧里没有计数器）
+    if (linkIsCan_) {
+        CanLinkStatus link;
+        if (CanLinkQuery(ifName_.c_str(), &link) == 0 && link.isCan) {
+            if (link.state >= 0) out->state = link.state;
+            if (link.txErrors >= 0) {
+                out->txErrors = link.txErrors;
+                out->rxErrors = link.rxErrors;
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <linux/can.h>
+#include "reactor_handler.h"
+
+/**
+ * CAN 总线负载 / 错误状态监视。
+ *
+ * 每个通道一个独立的 CAN_RAW socket（不带 ID 过滤器，订阅全部错误帧类别），登记到 native reactor，
+ * 就绪时在 reactor 线程里直接 recvmmsg 统计，不经过 JNI 和 Kotlin：
+ * - 负载：按每帧在总线上的精确位数（含位填充，FD 数据段按数据段波特率）累计总线占用时间，
+ *   另按固定窗口统计窗口负载和峰值；本机其它 socket 发出的帧通过回环同样计入
+ * - 错误：CAN_RAW_ERR_FILTER 收到的错误帧更新控制器状态、TEC / REC 和 bus-off / 重启等计数
+ *
+ * 快照（Snapshot）只读原子计数，真实控制器上再加一次 rtnetlink 查询取权威的状态和错误计数器。
+ */
+
+// 控制器状态（同内核 enum can_state，和 Kotlin CanBusState 保持一致），-1 表示未知
+static const int CAN_BUS_STATE_UNKNOWN       = -1;
+static const int CAN_BUS_STATE_ERROR_ACTIVE  = 0;
+static const int CAN_BUS_STATE_ERROR_WARNING = 1;
+static const int CAN_BUS_STATE_ERROR_PASSIVE = 2;
+static const int CAN_BUS_STATE_BUS_OFF       = 3;
+static const int CAN_BUS_STATE_STOPPED       = 4;
+
+/**
+ * 一帧在总线上占用的位数（SOF 到帧间隔结束）。
+ */
+struct CanFrameBits {
+    uint32_t nominal = 0;   // 按仲裁段波特率传输的位
+    uint32_t data = 0;      // 按数据段波特率传输的位（只有带 BRS 的 FD 帧不为 0）
+};
+
+/**
+ * 计算 readBatch 记录里一帧的精确位数。
+ *
+ * - 经典帧：按实际 ID / 数据算 CRC-15，统计 SOF..CRC 的动态填充位；
+ * - FD 帧：统计 SOF..数据段的动态填充位，填充计数 + CRC-17/21 用固定填充位；
+ *   带 BRS 时从 ESI 到 CRC 按数据段计，CRC 界定符起回到仲裁段；
+ * - 之后的 CRC 界定符、ACK、ACK 界定符、EOF、帧间隔共 13 位；错误帧记 0 位。
+ */
+CanFrameBits CanRecordBits(const uint8_t* rec);
+
+struct CanBusMonitorConfig {
+    uint32_t bitrate = 0;       // 仲裁段波特率，0 表示从接口查询，查不到时不计算负载
+    uint32_t dataBitrate = 0;   // FD 数据段波特率，0 表示从接口查询，查不到时按仲裁段
+    int windowMs = 100;         // 窗口负载 / 峰值的统计窗口
+};
+
+/**
+ * 快照（全部为 open 起累计值，状态 / 计数器除外）。
+ */
+struct CanBusSnapshot {
+    int64_t timestampNs = 0;        // 快照时间（CLOCK_MONOTONIC）
+    uint32_t bitrate = 0;
+    uint32_t dataBitrate = 0;
+    uint64_t frames = 0;            // 统计到的数据 / 远程帧
+    uint64_t bits = 0;              // 这些帧的总位数（含填充）
+    uint64_t busyNs = 0;            // 这些帧占用总线的时间，bitrate 未知时为 0
+    uint32_t windowLoadPpm = 0;     // 最近一个完整窗口的负载（百万分比）
+    uint32_t peakLoadPpm = 0;       // 窗口负载的最大值
+    int state = CAN_BUS_STATE_UNKNOWN;
+    int txErrors = -1;              // TEC，-1 表示未知
+    int rxErrors = -1;              // REC
+    uint64_t errorFrames = 0;       // 收到的错误帧
+    uint64_t busErrors = 0;         // 协议错误（CAN_ERR_PROT / CAN_ERR_BUSERROR）
+    uint64_t ackErrors = 0;         // 无应答（CAN_ERR_ACK）
+    uint64_t arbitrationLost = 0;   // 仲裁失败（CAN_ERR_LOSTARB）
+    uint64_t overflows = 0;         // 控制器收 / 发缓冲区溢出（CAN_ERR_CRTL_*_OVERFLOW）
+    uint64_t txTimeouts = 0;        // 发送超时（CAN_ERR_TX_TIMEOUT）
+    uint64_t busOff = 0;            // 进入 bus-off 的次数
+    uint64_t restarts = 0;          // 控制器重启次数（CAN_ERR_RESTARTED）
+    int64_t lastErrorNs = 0;        // 最近一个错误帧的时间，0 表示没有
+};
+
+class CanBusMonitor : public ReactorHandler {
+public:
+    /**
+     * 打开监视 socket（FD 帧 + 全部错误帧类别），bitrate 为 0 时从接口查询。
+     *
+     * @param err 失败时输出 -errno
+     * @return 成功返回监视，失败返回 nullptr
+     */
+    static CanBusMonitor* Create(const char* ifName, const CanBusMonitorConfig& config, int* err);
+
+    /**
+     * 关闭 socket。需先从 reactor 注销。
+     */
+    ~CanBusMonitor() override;
+
+    CanBusMonitor(const CanBusMonitor&) = delete;
+    CanBusMonitor& operator=(const CanBusMonitor&) = delete;
+
+    const std::vector<int>& ReactorFds() const override { return fds_; }
+
+    /**
+     * 收走已排队的帧并统计（至多若干批，剩下的等下一次就绪），只在 reactor 线程上调用。
+     *
+     * @return >=0: 本次统计的帧数；<0: -errno
+     */
+    int OnReadable(int fd) override;
+
+    /**
+     * 读取快照，任意线程可调用；真实 CAN 控制器上会做一次 rtnetlink 查询。
+     */
+    void Snapshot(CanBusSnapshot* out) const;
+
+private:
+    CanBusMonitor() = default;
+
+    void Account(const uint8_t* rec, int64_t nowNs);
+    void AccountError(const uint8_t* rec, int64_t ts);
+    void CloseWindows(int64_t ts);
+
+    std::string ifName_;
+    std::vector<int> fds_;
+    bool linkIsCan_ = false;
+
+    uint32_t bitrate_ = 0;
+    uint32_t dataBitrate_ = 0;
+    uint64_t nominalBitPs_ = 0;   // 一位的时长（皮秒），0 表示未知
+    uint64_t dataBitPs_ = 0;
+    int64_t windowNs_ = 0;
+
+    // 只在 reactor 线程上修改
+    uint64_t windowBusyPs_ = 0;
+
+    std::atomic<int64_t> windowStartNs_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> bits_{0};
+    std::atomic<uint64_t> busyPs_{0};
+    std::atomic<uint32_t> windowLoadPpm_{0};
+    std::atomic<uint32_t> peakLoadPpm_{0};
+
+    std::atomic<int> state_{CAN_BUS_STATE_UNKNOWN};
+    std::atomic<int> txErrors_{-1};
+    std::atomic<int> rxErrors_{-1};
+    std::atomic<uint64_t> errorFrames_{0};
+    std::atomic<uint64_t> busErrors_{0};
+    std::atomic<uint64_t> ackErrors_{0};
+    std::atomic<uint64_t> arbitrationLost_{0};
+    std::atomic<uint64_t> overflows_{0};
+    std::atomic<uint64_t> txTimeouts_{0};
+    std::atomic<uint64_t> busOff_{0};
+    std::atomic<uint64_t> restarts_{0};
+    std::atomic<int64_t> lastErrorNs_{0};
+};
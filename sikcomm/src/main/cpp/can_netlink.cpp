@@ -0,0 +1,552 @@
+#include "can_netlink.h"
+
+#include <errno.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/can/netlink.h>
+#include <linux/can/gw.h>
+
+#define LOG_TAG "CanNetlink"
+#include "comm_log.h"
+#include "comm_metrics.h"
+
+// 一次请求最多携带的 RTM_NEWLINK 条数
+static const int NL_MAX_MESSAGES = 2;
+
+// 单条请求的缓冲区（两组位时序 + 几个 u32 属性，或者 4 个 CAN FD 网关修改帧，都小于该值）
+static const size_t NL_MESSAGE_SIZE = 512;
+
+// 等待内核 ACK 的超时
+static const int NL_ACK_TIMEOUT_MS = 1000;
+
+struct NlMessage {
+    struct nlmsghdr nh;
+    union {
+        struct ifinfomsg ifi;   // RTM_NEWLINK
+        struct rtcanmsg rtc;    // RTM_NEWROUTE / RTM_DELROUTE（CAN_GW）
+    };
+    char attrs[NL_MESSAGE_SIZE];
+};
+
+// 属性都按整条消息（而不是 nlmsghdr）寻址，编译器才知道后面还有 attrs 缓冲区
+static struct rtattr* NlTail(NlMessage* msg) {
+    return reinterpret_cast<struct rtattr*>(reinterpret_cast<char*>(msg) + NLMSG_ALIGN(msg->nh.nlmsg_len));
+}
+
+static bool NlAddAttr(NlMessage* msg, int type, const void* data, size_t len) {
+    size_t attrLen = RTA_LENGTH(len);
+    if (NLMSG_ALIGN(msg->nh.nlmsg_len) + RTA_ALIGN(attrLen) > sizeof(NlMessage)) return false;
+    struct rtattr* rta = NlTail(msg);
+    rta->rta_type = static_cast<unsigned short>(type);
+    rta->rta_len = static_cast<unsigned short>(attrLen);
+    if (len > 0) memcpy(RTA_DATA(rta), data, len);
+    msg->nh.nlmsg_len = static_cast<__u32>(NLMSG_ALIGN(msg->nh.nlmsg_len) + RTA_ALIGN(attrLen));
+    return true;
+}
+
+static bool NlAddU32(NlMessage* msg, int type, uint32_t value) {
+    return NlAddAttr(msg, type, &value, sizeof(value));
+}
+
+static bool NlAddU8(NlMessage* msg, int type, uint8_t value) {
+    return NlAddAttr(msg, type, &value, sizeof(value));
+}
+
+static struct rtattr* NlNestBegin(NlMessage* msg, int type) {
+    struct rtattr* nest = NlTail(msg);
+    return NlAddAttr(msg, type, nullptr, 0) ? nest : nullptr;
+}
+
+static void NlNestEnd(NlMessage* msg, struct rtattr* nest) {
+    nest->rta_len = static_cast<unsigned short>(reinterpret_cast<char*>(NlTail(msg)) -
+                                                reinterpret_cast<char*>(nest));
+}
+
+static void NlInit(NlMessage* msg, int ifindex, uint32_t seq, unsigned int flags, unsigned int change) {
+    memset(msg, 0, sizeof(*msg));
+    msg->nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    msg->nh.nlmsg_type = RTM_NEWLINK;
+    msg->nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    msg->nh.nlmsg_seq = seq;
+    msg->ifi.ifi_family = AF_UNSPEC;
+    msg->ifi.ifi_index = ifindex;
+    msg->ifi.ifi_flags = flags;
+    msg->ifi.ifi_change = change;
+}
+
+/**
+ * 在 msg 里追加 IFLA_LINKINFO { kind = "can", data = {...} }。
+ */
+static bool NlAddCanInfo(NlMessage* msg, const CanLinkConfig& c, bool restart) {
+    struct rtattr* linkInfo = NlNestBegin(msg, IFLA_LINKINFO);
+    if (linkInfo == nullptr || !NlAddAttr(msg, IFLA_INFO_KIND, "can", 3)) return false;
+    struct rtattr* data = NlNestBegin(msg, IFLA_INFO_DATA);
+    if (data == nullptr) return false;
+
+    bool ok = true;
+    if (c.bitrate > 0) {
+        struct can_bittiming bt{};
+        bt.bitrate = c.bitrate;
+        bt.sample_point = c.samplePoint;
+        ok = ok && NlAddAttr(msg, IFLA_CAN_BITTIMING, &bt, sizeof(bt));
+    }
+    if (c.dataBitrate > 0) {
+        struct can_bittiming dbt{};
+        dbt.bitrate = c.dataBitrate;
+        dbt.sample_point = c.dataSamplePoint;
+        ok = ok && NlAddAttr(msg, IFLA_CAN_DATA_BITTIMING, &dbt, sizeof(dbt));
+    }
+    if (c.fd >= 0) {
+        struct can_ctrlmode cm{};
+        cm.mask = CAN_CTRLMODE_FD;
+        cm.flags = c.fd ? CAN_CTRLMODE_FD : 0;
+        ok = ok && NlAddAttr(msg, IFLA_CAN_CTRLMODE, &cm, sizeof(cm));
+    }
+    if (c.restartMs >= 0) {
+        ok = ok && NlAddU32(msg, IFLA_CAN_RESTART_MS, static_cast<uint32_t>(c.restartMs));
+    }
+    if (restart) {
+        ok = ok && NlAddU32(msg, IFLA_CAN_RESTART, 1);
+    }
+    if (!ok) return false;
+
+    NlNestEnd(msg, data);
+    NlNestEnd(msg, linkInfo);
+    return true;
+}
+
+/**
+ * CAN_GW 路由请求：rtcanmsg 头 + 规则属性。
+ */
+static void NlInitRoute(NlMessage* msg, int type, uint32_t seq, uint16_t gwFlags) {
+    memset(msg, 0, sizeof(*msg));
+    msg->nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtcanmsg));
+    msg->nh.nlmsg_type = static_cast<__u16>(type);
+    msg->nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+    msg->nh.nlmsg_seq = seq;
+    msg->rtc.can_family = AF_CAN;
+    msg->rtc.gwtype = CGW_TYPE_CAN_CAN;
+    msg->rtc.flags = gwFlags;
+}
+
+/**
+ * 一次 sendmsg 发出 count 条请求，收齐它们的 ACK。
+ *
+ * 内核对同一个缓冲区里的多条消息逐条处理，某条失败不影响后面的执行，返回第一个错误。
+ *
+ * @return 0: 全部成功；<0: 第一条失败请求的 -errno
+ */
+static int NlTransact(NlMessage* msgs, int count) {
+    int s = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (s < 0) return -errno;
+
+    struct sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+
+    struct iovec iov[NL_MAX_MESSAGES];
+    for (int i = 0; i < count; ++i) {
+        iov[i].iov_base = &msgs[i];
+        iov[i].iov_len = NLMSG_ALIGN(msgs[i].nh.nlmsg_len);
+    }
+    struct msghdr mh{};
+    mh.msg_name = &kernel;
+    mh.msg_namelen = sizeof(kernel);
+    mh.msg_iov = iov;
+    mh.msg_iovlen = static_cast<size_t>(count);
+
+    if (sendmsg(s, &mh, 0) < 0) {
+        int err = errno;
+        ::close(s);
+        return -err;
+    }
+
+    int firstError = 0;
+    int acked = 0;
+    char buf[4096];
+    while (acked < count) {
+        struct pollfd pfd{};
+        pfd.fd = s;
+        pfd.events = POLLIN;
+        int pr = poll(&pfd, 1, NL_ACK_TIMEOUT_MS);
+        if (pr <= 0) {
+            if (pr < 0 && errno == EINTR) continue;
+            firstError = firstError ? firstError : (pr == 0 ? -ETIMEDOUT : -errno);
+            break;
+        }
+        ssize_t n = recv(s, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            firstError = firstError ? firstError : -errno;
+            break;
+        }
+        size_t len = static_cast<size_t>(n);
+        for (auto* nh = reinterpret_cast<struct nlmsghdr*>(buf); NLMSG_OK(nh, len);
+             nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type != NLMSG_ERROR) continue;
+            auto* e = static_cast<struct nlmsgerr*>(NLMSG_DATA(nh));
+            if (e->error != 0 && firstError == 0) firstError = e->error;
+            ++acked;
+        }
+    }
+    ::close(s);
+    return firstError;
+}
+
+/**
+ * 发出一条查询请求，把回复逐条交给 onMessage，直到 NLMSG_DONE / NLMSG_ERROR；
+ * 不是 dump 的请求收到第一条回复就结束。
+ *
+ * @return 0: 成功；<0: -errno
+ */
+template <typename F>
+static int NlQuery(NlMessage* req, F&& onMessage) {
+    int s = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (s < 0) return -errno;
+
+    struct sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(s, req, req->nh.nlmsg_len, 0, reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+        int err = errno;
+        ::close(s);
+        return -err;
+    }
+
+    bool dump = (req->nh.nlmsg_flags & NLM_F_DUMP) != 0;
+    int ret = 0;
+    bool done = false;
+    alignas(struct nlmsghdr) char buf[8192];
+    while (!done) {
+        struct pollfd pfd{};
+        pfd.fd = s;
+        pfd.events = POLLIN;
+        int pr = poll(&pfd, 1, NL_ACK_TIMEOUT_MS);
+        if (pr <= 0) {
+            if (pr < 0 && errno == EINTR) continue;
+            ret = pr == 0 ? -ETIMEDOUT : -errno;
+            break;
+        }
+        ssize_t n = recv(s, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ret = -errno;
+            break;
+        }
+        size_t len = static_cast<size_t>(n);
+        for (auto* nh = reinterpret_cast<struct nlmsghdr*>(buf); NLMSG_OK(nh, len); nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type == NLMSG_DONE) {
+                done = true;
+                break;
+            }
+            if (nh->nlmsg_type == NLMSG_ERROR) {
+                ret = static_cast<struct nlmsgerr*>(NLMSG_DATA(nh))->error;
+                done = true;
+                break;
+            }
+            onMessage(nh);
+            if (!dump) {
+                done = true;
+                break;
+            }
+        }
+    }
+    ::close(s);
+    return ret;
+}
+
+/**
+ * 驱动按时钟算出的实际波特率 / 采样点和请求值可能差一点，在容差内视为一致。
+ */
+static bool NearlyEqual(uint32_t actual, uint32_t wanted, uint32_t tolerancePerMille) {
+    uint64_t diff = actual > wanted ? actual - wanted : wanted - actual;
+    return diff * 1000 <= static_cast<uint64_t>(wanted) * tolerancePerMille;
+}
+
+/**
+ * 当前链路的 CAN 参数是否已经满足 c（只比较 c 里要修改的字段）。
+ */
+static bool CanParamsMatch(const CanLinkStatus& s, const CanLinkConfig& c) {
+    if (c.bitrate > 0 && !NearlyEqual(s.bitrate, c.bitrate, 5)) return false;
+    if (c.bitrate > 0 && c.samplePoint > 0 && !NearlyEqual(s.samplePoint, c.samplePoint, 25)) return false;
+    if (c.dataBitrate > 0 && !NearlyEqual(s.dataBitrate, c.dataBitrate, 5)) return false;
+    if (c.dataBitrate > 0 && c.dataSamplePoint > 0 &&
+        !NearlyEqual(s.dataSamplePoint, c.dataSamplePoint, 25)) {
+        return false;
+    }
+    if (c.fd >= 0 && s.fd != c.fd) return false;
+    if (c.restartMs >= 0 && s.restartMs != c.restartMs) return false;
+    return true;
+}
+
+int CanLinkConfigure(const char* ifName, const CanLinkConfig& c) {
+    int ifindex = static_cast<int>(if_nametoindex(ifName));
+    if (ifindex == 0) {
+        int err = errno;
+        LOGE("if_nametoindex(%s) failed: %s", ifName, strerror(err));
+        return -err;
+    }
+
+    bool canParams = c.bitrate > 0 || c.dataBitrate > 0 || c.fd >= 0 || c.restartMs >= 0;
+    bool txQueueLen = c.txQueueLen >= 0;
+    uint64_t start = MetricsNowNs();
+
+    CanLinkStatus cur;
+    if (CanLinkQuery(ifName, &cur) == 0) {
+        if (canParams && !cur.isCan) {
+            LOGW("configure(%s): not a CAN controller, CAN parameters ignored", ifName);
+            canParams = false;
+        } else if (canParams && CanParamsMatch(cur, c)) {
+            canParams = false;
+        }
+        if (txQueueLen && cur.txQueueLen == c.txQueueLen) txQueueLen = false;
+        if (!canParams && !txQueueLen && cur.up) {
+            LOGI("configure(%s): already up with the requested parameters", ifName);
+            return 0;
+        }
+    }
+
+    NlMessage msgs[NL_MAX_MESSAGES];
+    int count = 0;
+    if (canParams) {
+        // 位时序 / restart-ms 只能在 down 时修改
+        NlInit(&msgs[count++], ifindex, 1, 0, IFF_UP);
+    }
+    NlMessage* cfg = &msgs[count++];
+    NlInit(cfg, ifindex, 2, IFF_UP, IFF_UP);
+    bool ok = true;
+    if (txQueueLen) ok = NlAddU32(cfg, IFLA_TXQLEN, static_cast<uint32_t>(c.txQueueLen));
+    if (canParams) ok = ok && NlAddCanInfo(cfg, c, false);
+    if (!ok) return -EMSGSIZE;
+
+    int ret = NlTransact(msgs, count);
+    double ms = static_cast<double>(MetricsNowNs() - start) / 1e6;
+    if (ret < 0) {
+        LOGE("configure(%s) bitrate=%u dbitrate=%u fd=%d restart-ms=%d txqlen=%d failed: %s",
+             ifName, c.bitrate, c.dataBitrate, c.fd, c.restartMs, c.txQueueLen, strerror(-ret));
+        return ret;
+    }
+    LOGI("configure(%s) bitrate=%u sp=%u dbitrate=%u dsp=%u fd=%d restart-ms=%d txqlen=%d, %.2f ms",
+         ifName, c.bitrate, c.samplePoint, c.dataBitrate, c.dataSamplePoint, c.fd, c.restartMs,
+         c.txQueueLen, ms);
+    return 0;
+}
+
+int CanLinkRestart(const char* ifName) {
+    int ifindex = static_cast<int>(if_nametoindex(ifName));
+    if (ifindex == 0) return -errno;
+
+    NlMessage msg;
+    NlInit(&msg, ifindex, 1, 0, 0);
+    CanLinkConfig none;
+    if (!NlAddCanInfo(&msg, none, true)) return -EMSGSIZE;
+
+    int ret = NlTransact(&msg, 1);
+    if (ret < 0) {
+        LOGW("restart(%s) failed: %s", ifName, strerror(-ret));
+    } else {
+        LOGI("restart(%s) done", ifName);
+    }
+    return ret;
+}
+
+/**
+ * 解析 IFLA_INFO_DATA（IFLA_CAN_*）。
+ */
+static void ParseCanInfoData(struct rtattr* data, CanLinkStatus* out) {
+    int len = static_cast<int>(RTA_PAYLOAD(data));
+    for (auto* rta = static_cast<struct rtattr*>(RTA_DATA(data)); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        size_t size = RTA_PAYLOAD(rta);
+        switch (rta->rta_type) {
+            case IFLA_CAN_BITTIMING:
+                if (size >= sizeof(struct can_bittiming)) {
+                    auto* bt = static_cast<const struct can_bittiming*>(RTA_DATA(rta));
+                    out->bitrate = bt->bitrate;
+                    out->samplePoint = bt->sample_point;
+                }
+                break;
+            case IFLA_CAN_DATA_BITTIMING:
+                if (size >= sizeof(struct can_bittiming)) {
+                    auto* dbt = static_cast<const struct can_bittiming*>(RTA_DATA(rta));
+                    out->dataBitrate = dbt->bitrate;
+                    out->dataSamplePoint = dbt->sample_point;
+                }
+                break;
+            case IFLA_CAN_CTRLMODE:
+                if (size >= sizeof(struct can_ctrlmode)) {
+                    auto* cm = static_cast<const struct can_ctrlmode*>(RTA_DATA(rta));
+                    out->fd = (cm->flags & CAN_CTRLMODE_FD) != 0 ? 1 : 0;
+                }
+                break;
+            case IFLA_CAN_RESTART_MS:
+                if (size >= sizeof(uint32_t)) {
+                    uint32_t v;
+                    memcpy(&v, RTA_DATA(rta), sizeof(v));
+                    out->restartMs = static_cast<int>(v);
+                }
+                break;
+            case IFLA_CAN_STATE:
+                if (size >= sizeof(uint32_t)) {
+                    uint32_t v;
+                    memcpy(&v, RTA_DATA(rta), sizeof(v));
+                    out->state = static_cast<int>(v);
+                }
+                break;
+            case IFLA_CAN_BERR_COUNTER:
+                if (size >= sizeof(struct can_berr_counter)) {
+                    auto* bec = static_cast<const struct can_berr_counter*>(RTA_DATA(rta));
+                    out->txErrors = bec->txerr;
+                    out->rxErrors = bec->rxerr;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * 从 RTM_NEWLINK 里取出 IFF_UP、IFLA_TXQLEN 和 IFLA_LINKINFO { IFLA_INFO_DATA, IFLA_INFO_XSTATS }。
+ */
+static void ParseLinkStatus(struct nlmsghdr* nh, CanLinkStatus* out) {
+    auto* ifi = static_cast<struct ifinfomsg*>(NLMSG_DATA(nh));
+    out->up = (ifi->ifi_flags & IFF_UP) != 0;
+    auto* rta = reinterpret_cast<struct rtattr*>(
+            reinterpret_cast<char*>(NLMSG_DATA(nh)) + NLMSG_ALIGN(sizeof(struct ifinfomsg)));
+    int len = static_cast<int>(nh->nlmsg_len) - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == IFLA_TXQLEN && RTA_PAYLOAD(rta) >= sizeof(uint32_t)) {
+            uint32_t v;
+            memcpy(&v, RTA_DATA(rta), sizeof(v));
+            out->txQueueLen = static_cast<int>(v);
+            continue;
+        }
+        if (rta->rta_type != IFLA_LINKINFO) continue;
+        int infoLen = static_cast<int>(RTA_PAYLOAD(rta));
+        for (auto* info = static_cast<struct rtattr*>(RTA_DATA(rta)); RTA_OK(info, infoLen);
+             info = RTA_NEXT(info, infoLen)) {
+            if (info->rta_type == IFLA_INFO_DATA) {
+                out->isCan = true;
+                ParseCanInfoData(info, out);
+            } else if (info->rta_type == IFLA_INFO_XSTATS && RTA_PAYLOAD(info) >= sizeof(struct can_device_stats)) {
+                auto* st = static_cast<const struct can_device_stats*>(RTA_DATA(info));
+                out->hasDeviceStats = true;
+                out->busErrors = st->bus_error;
+                out->errorWarning = st->error_warning;
+                out->errorPassive = st->error_passive;
+                out->busOff = st->bus_off;
+                out->arbitrationLost = st->arbitration_lost;
+                out->restarts = st->restarts;
+            }
+        }
+    }
+}
+
+int CanLinkQuery(const char* ifName, CanLinkStatus* out) {
+    *out = CanLinkStatus{};
+    int ifindex = static_cast<int>(if_nametoindex(ifName));
+    if (ifindex == 0) return -errno;
+
+    NlMessage req;
+    NlInit(&req, ifindex, 1, 0, 0);
+    req.nh.nlmsg_type = RTM_GETLINK;
+    req.nh.nlmsg_flags = NLM_F_REQUEST;
+    return NlQuery(&req, [&](struct nlmsghdr* nh) {
+        if (nh->nlmsg_type == RTM_NEWLINK) ParseLinkStatus(nh, out);
+    });
+}
+
+/**
+ * 按规则填 RTM_NEWROUTE / RTM_DELROUTE：删除时内核按同样的属性（带 UID 时不比较修改帧）找到规则。
+ */
+static bool NlAddGwRule(NlMessage* msg, const CanGwKernelRule& r) {
+    bool fd = (r.flags & CGW_FLAGS_CAN_FD) != 0;
+    bool ok = true;
+    for (int i = 0; i < r.modCount && ok; ++i) {
+        const CanGwKernelMod& m = r.mods[i];
+        if (fd) {
+            struct cgw_fdframe_mod mod{};
+            mod.cf = m.frame;
+            mod.modtype = m.modtype;
+            ok = NlAddAttr(msg, CGW_FDMOD_AND + m.op, &mod, sizeof(mod));
+        } else {
+            struct cgw_frame_mod mod{};
+            memcpy(&mod.cf, &m.frame, CAN_MTU);
+            mod.modtype = m.modtype;
+            ok = NlAddAttr(msg, CGW_MOD_AND + m.op, &mod, sizeof(mod));
+        }
+    }
+    ok = ok && NlAddU32(msg, CGW_MOD_UID, r.uid);
+    if (r.limitHops > 0) ok = ok && NlAddU8(msg, CGW_LIM_HOPS, r.limitHops);
+    ok = ok && NlAddU32(msg, CGW_SRC_IF, static_cast<uint32_t>(r.srcIfindex));
+    ok = ok && NlAddU32(msg, CGW_DST_IF, static_cast<uint32_t>(r.dstIfindex));
+    if (r.hasFilter) ok = ok && NlAddAttr(msg, CGW_FILTER, &r.filter, sizeof(r.filter));
+    return ok;
+}
+
+int CanGwKernelAdd(const CanGwKernelRule& rule) {
+    NlMessage msg;
+    NlInitRoute(&msg, RTM_NEWROUTE, 1, rule.flags);
+    if (!NlAddGwRule(&msg, rule)) return -EMSGSIZE;
+    int ret = NlTransact(&msg, 1);
+    if (ret < 0) {
+        LOGW("CAN_GW add %d -> %d failed: %s", rule.srcIfindex, rule.dstIfindex, strerror(-ret));
+    }
+    return ret;
+}
+
+int CanGwKernelDelete(const CanGwKernelRule& rule) {
+    NlMessage msg;
+    NlInitRoute(&msg, RTM_DELROUTE, 1, rule.flags);
+    if (!NlAddGwRule(&msg, rule)) return -EMSGSIZE;
+    int ret = NlTransact(&msg, 1);
+    if (ret < 0) {
+        LOGW("CAN_GW delete %d -> %d failed: %s", rule.srcIfindex, rule.dstIfindex, strerror(-ret));
+    }
+    return ret;
+}
+
+/**
+ * 从一条 RTM_NEWROUTE 里取出 UID 和计数。
+ */
+static void ParseGwCounters(struct nlmsghdr* nh, const uint32_t* uids, int count, CanGwKernelCounters* out) {
+    auto* rta = reinterpret_cast<struct rtattr*>(
+            reinterpret_cast<char*>(NLMSG_DATA(nh)) + NLMSG_ALIGN(sizeof(struct rtcanmsg)));
+    int len = static_cast<int>(nh->nlmsg_len) - NLMSG_LENGTH(sizeof(struct rtcanmsg));
+
+    uint32_t uid = 0;
+    CanGwKernelCounters c{};
+    for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (RTA_PAYLOAD(rta) < sizeof(uint32_t)) continue;
+        uint32_t v;
+        memcpy(&v, RTA_DATA(rta), sizeof(v));
+        switch (rta->rta_type) {
+            case CGW_MOD_UID: uid = v; break;
+            case CGW_HANDLED: c.handled = v; break;
+            case CGW_DROPPED: c.dropped = v; break;
+            case CGW_DELETED: c.deleted = v; break;
+            default: break;
+        }
+    }
+    if (uid == 0) return;
+    for (int i = 0; i < count; ++i) {
+        if (uids[i] == uid) {
+            out[i] = c;
+            out[i].found = true;
+        }
+    }
+}
+
+int CanGwKernelCountersByUid(const uint32_t* uids, int count, CanGwKernelCounters* out) {
+    for (int i = 0; i < count; ++i) out[i] = CanGwKernelCounters{};
+
+    NlMessage req;
+    NlInitRoute(&req, RTM_GETROUTE, 1, 0);
+    req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    return NlQuery(&req, [&](struct nlmsghdr* nh) {
+        if (nh->nlmsg_type == RTM_NEWROUTE) ParseGwCounters(nh, uids, count, out);
+    });
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+#include <linux/can.h>
+
+/**
+ * 通过 rtnetlink 配置 SocketCAN 接口（相当于 `ip link set canX type can ...`，但不用起进程），
+ * 以及增删内核 CAN 网关规则（相当于 `cangw -A / -D`）。
+ *
+ * 纯 C++，不依赖 JNI，由 socketcan_jni.cpp 调用。需要 CAP_NET_ADMIN。
+ */
+
+struct CanLinkConfig {
+    uint32_t bitrate = 0;            // 仲裁段波特率，0 表示不修改位时序
+    uint32_t samplePoint = 0;        // 采样点（千分比，875 = 87.5%），0 由驱动决定
+    uint32_t dataBitrate = 0;        // FD 数据段波特率，0 表示不修改
+    uint32_t dataSamplePoint = 0;    // 数据段采样点（千分比）
+    int fd = -1;                     // -1 不修改，0 关闭 CAN FD，1 打开
+    int restartMs = -1;              // bus-off 自动恢复延时（毫秒），-1 不修改，0 关闭自动恢复
+    int txQueueLen = -1;             // 发送队列长度（txqueuelen），-1 不修改
+};
+
+/**
+ * 配置接口并 up。
+ *
+ * 先用 CanLinkQuery 读出当前配置，只有 CAN 参数确实不同时才 down / 配置 / up：
+ * “down” 和 “配置 + up” 两条 RTM_NEWLINK 放进同一次 sendmsg，内核按顺序处理，一次往返拿回两个 ACK
+ * （CAN 位时序只能在接口 down 时修改）。参数都已一致时不打断接口上其它 socket 的收发，
+ * 接口已 up 时什么都不发。不是 CAN 控制器（例如 vcan）时忽略 CAN 参数，只设置 txqueuelen 并 up。
+ *
+ * @return 0: 成功；<0: -errno（EPERM: 需要修改但没有 CAP_NET_ADMIN）
+ */
+int CanLinkConfigure(const char* ifName, const CanLinkConfig& config);
+
+/**
+ * bus-off 后立即重启控制器（IFLA_CAN_RESTART），不必 down / up 整个接口。
+ *
+ * 内核只在 restart-ms 为 0（未开自动恢复）且控制器处于 bus-off 时允许手动重启。
+ *
+ * @return 0: 成功；-EBUSY: 控制器不在 bus-off；-EINVAL: 已开启自动恢复；其它 <0: -errno
+ */
+int CanLinkRestart(const char* ifName);
+
+/**
+ * 接口当前的 CAN 链路状态（RTM_GETLINK），没有的字段保持默认值。
+ */
+struct CanLinkStatus {
+    bool isCan = false;              // 是 CAN 控制器（有 IFLA_INFO_DATA），vcan 为 false
+    bool up = false;                 // 接口已 up（IFF_UP）
+    int txQueueLen = -1;             // txqueuelen，-1 表示未知
+    uint32_t bitrate = 0;            // 仲裁段波特率，0 表示未知
+    uint32_t samplePoint = 0;        // 采样点（千分比）
+    uint32_t dataBitrate = 0;        // FD 数据段波特率，0 表示未知 / 未开 FD
+    uint32_t dataSamplePoint = 0;
+    int fd = -1;                     // CAN FD 是否打开（CAN_CTRLMODE_FD），-1 表示未知
+    int restartMs = -1;              // bus-off 自动恢复延时，-1 表示未知
+    int state = -1;                  // CAN_STATE_*（linux/can/netlink.h），-1 表示未知
+    int txErrors = -1;               // 发送错误计数器（TEC），-1 表示驱动不提供
+    int rxErrors = -1;               // 接收错误计数器（REC）
+    bool hasDeviceStats = false;     // 以下为 can_device_stats，从接口 up 开始累计
+    uint32_t busErrors = 0;
+    uint32_t errorWarning = 0;
+    uint32_t errorPassive = 0;
+    uint32_t busOff = 0;
+    uint32_t arbitrationLost = 0;
+    uint32_t restarts = 0;
+};
+
+/**
+ * 查询接口的 CAN 链路状态：位时序、控制器状态、错误计数器和设备统计，一次往返。
+ *
+ * 不需要特权。
+ *
+ * @return 0: 成功（不是 CAN 控制器时 isCan = false）；<0: -errno
+ */
+int CanLinkQuery(const char* ifName, CanLinkStatus* out);
+
+/**
+ * 一个内核网关修改操作：op 为 0..3（AND / OR / XOR / SET，对应 CGW_MOD_AND 起的顺序），
+ * modtype 为 CGW_MOD_ID / LEN / DATA / FLAGS 组合，frame 为操作数（经典帧只用 can_frame 部分）。
+ */
+struct CanGwKernelMod {
+    int op = 0;
+    uint8_t modtype = 0;
+    struct canfd_frame frame{};
+};
+
+/**
+ * 一条内核 CAN_GW 规则（CGW_TYPE_CAN_CAN）。
+ */
+struct CanGwKernelRule {
+    int srcIfindex = 0;
+    int dstIfindex = 0;
+    uint16_t flags = 0;              // CGW_FLAGS_CAN_*
+    bool hasFilter = false;
+    struct can_filter filter{};
+    uint8_t limitHops = 0;           // 0 使用内核默认（模块参数 max_hops）
+    uint32_t uid = 0;                // CGW_MOD_UID，查询计数和删除时用来定位规则
+    CanGwKernelMod mods[4];
+    int modCount = 0;
+};
+
+/**
+ * 内核规则计数（CGW_HANDLED / DROPPED / DELETED）。
+ */
+struct CanGwKernelCounters {
+    bool found = false;
+    uint32_t handled = 0;
+    uint32_t dropped = 0;
+    uint32_t deleted = 0;
+};
+
+/**
+ * 添加规则（RTM_NEWROUTE）。需要 CAP_NET_ADMIN 和 can-gw 内核模块。
+ *
+ * @return 0: 成功；<0: -errno（EPERM: 没有权限；EOPNOTSUPP / EPROTONOSUPPORT: 内核没有 CAN_GW）
+ */
+int CanGwKernelAdd(const CanGwKernelRule& rule);
+
+/**
+ * 删除规则（RTM_DELROUTE），rule 需和添加时相同。
+ */
+int CanGwKernelDelete(const CanGwKernelRule& rule);
+
+/**
+ * dump 全部网关规则，按 UID 取出 count 条规则的计数（没找到的 found = false）。
+ *
+ * @return 0: 成功；<0: -errno
+ */
+int CanGwKernelCountersByUid(const uint32_t* uids, int count, CanGwKernelCounters* out);
@@ -0,0 +1,189 @@
+#include <jni.h>
+#include <errno.h>
+#include <string>
+#include <vector>
+
+#define LOG_TAG "NativeCapture"
+#include "comm_log.h"
+#include "comm_capture.h"
+#include "can_io.h"
+#include "serial_io.h"
+
+static std::string JStringToString(JNIEnv* env, jstring jstr) {
+    if (jstr == nullptr) return {};
+    const char* utf = env->GetStringUTFChars(jstr, nullptr);
+    if (utf == nullptr) return {};
+    std::string res(utf);
+    env->ReleaseStringUTFChars(jstr, utf);
+    return res;
+}
+
+static bool ToPaths(JNIEnv* env, jobjectArray jPaths, std::vector<std::string>* out) {
+    if (jPaths == nullptr) return false;
+    jsize n = env->GetArrayLength(jPaths);
+    for (jsize i = 0; i < n; i++) {
+        auto js = static_cast<jstring>(env->GetObjectArrayElement(jPaths, i));
+        std::string path = JStringToString(env, js);
+        env->DeleteLocalRef(js);
+        if (path.empty()) return false;
+        out->push_back(std::move(path));
+    }
+    return !out->empty();
+}
+
+static CaptureReplayer* FromHandle(jlong handle) {
+    return reinterpret_cast<CaptureReplayer*>(static_cast<intptr_t>(handle));
+}
+
+static jlong OpenReplayer(const std::vector<std::string>& paths, int fd, int kind, jdouble speed, jboolean includeSent) {
+    int err = 0;
+    CaptureReplayer* r = CaptureReplayer::Open(paths, fd, kind, speed, includeSent == JNI_TRUE, &err);
+    if (r == nullptr) return err;
+    LOGI("replay opened: %zu files -> fd=%d, speed=%.2f", paths.size(), fd, speed);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(r));
+}
+
+extern "C" {
+
+/**
+ * int start(long handle, String pathPrefix, long segmentBytes, int maxSegments)
+ *
+ * 开始记录 handle（串口 / CAN fd）上的收发，段文件为 <pathPrefix>.<段号>.sikcap。
+ * 关闭 fd 时自动停止。
+ *
+ * @return 0: 成功；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCapture_start(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jstring jPrefix,
+        jlong segmentBytes,
+        jint maxSegments
+) {
+    if (handle <= 0) return -EBADF;
+    if (segmentBytes <= 0) return -EINVAL;
+    std::string prefix = JStringToString(env, jPrefix);
+    int err = 0;
+    CaptureWriter* w = CaptureWriter::Open(prefix.c_str(), static_cast<size_t>(segmentBytes), maxSegments, &err);
+    if (w == nullptr) return err;
+    CaptureAttach(static_cast<int>(handle), w);
+    return 0;
+}
+
+/**
+ * void stop(long handle)
+ *
+ * 停止记录，当前段截断到实际长度。
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeCapture_stop(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    if (handle <= 0) return;
+    CaptureDetach(static_cast<int>(handle));
+}
+
+/**
+ * long replayOpenCan(String[] paths, String ifName, boolean fdMode, double speed, boolean includeSent)
+ *
+ * 打开目标 CAN 接口（不设过滤）并准备按顺序回放 paths。
+ *
+ * @return >0: 回放句柄；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeCapture_replayOpenCan(
+        JNIEnv* env,
+        jclass,
+        jobjectArray jPaths,
+        jstring jIfName,
+        jboolean fdMode,
+        jdouble speed,
+        jboolean includeSent
+) {
+    std::vector<std::string> paths;
+    if (!ToPaths(env, jPaths, &paths)) return -EINVAL;
+    std::string ifName = JStringToString(env, jIfName);
+    int fd = CanOpen(ifName.c_str(), fdMode == JNI_TRUE, nullptr, 0, 0);
+    if (fd < 0) return fd;
+    return OpenReplayer(paths, fd, CAPTURE_KIND_CAN, speed, includeSent);
+}
+
+/**
+ * long replayOpenSerial(String[] paths, String devicePath, int baudRate, double speed, boolean includeSent)
+ *
+ * 打开目标串口 / pty（8N1）并准备按顺序回放 paths。
+ *
+ * @return >0: 回放句柄；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeCapture_replayOpenSerial(
+        JNIEnv* env,
+        jclass,
+        jobjectArray jPaths,
+        jstring jDevicePath,
+        jint baudRate,
+        jdouble speed,
+        jboolean includeSent
+) {
+    std::vector<std::string> paths;
+    if (!ToPaths(env, jPaths, &paths)) return -EINVAL;
+    std::string devicePath = JStringToString(env, jDevicePath);
+    if (devicePath.empty()) return -EINVAL;
+    SerialPortConfig config;
+    config.baudRate = baudRate;
+    int fd = SerialOpen(devicePath.c_str(), config, nullptr);
+    if (fd < 0) return fd;
+    return OpenReplayer(paths, fd, CAPTURE_KIND_SERIAL, speed, includeSent);
+}
+
+/**
+ * int replayStep(long replay, int budgetMs)
+ *
+ * 回放至多 budgetMs 毫秒（包括按原始节奏等待的时间），便于调用方在两次之间检查取消。
+ *
+ * @return 0: 还有记录；1: 已全部回放；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCapture_replayStep(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jint budgetMs
+) {
+    CaptureReplayer* r = FromHandle(handle);
+    if (r == nullptr) return -EBADF;
+    return r->Step(budgetMs);
+}
+
+/**
+ * long replaySent(long replay)
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeCapture_replaySent(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    CaptureReplayer* r = FromHandle(handle);
+    return r == nullptr ? 0 : static_cast<jlong>(r->Sent());
+}
+
+/**
+ * void replayClose(long replay)
+ *
+ * 释放回放器并关闭目标 fd。
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeCapture_replayClose(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    delete FromHandle(handle);
+}
+
+} // extern "C"
@@ -0,0 +1,486 @@
+#include "comm_capture.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <new>
+
+#define LOG_TAG "CommCapture"
+#include "comm_log.h"
+#include "comm_metrics.h"
+#include "can_io.h"
+#include "serial_io.h"
+
+static const char CAPTURE_MAGIC[8] = {'S', 'I', 'K', 'C', 'A', 'P', 0, 1};
+static const uint32_t CAPTURE_VERSION = 1;
+
+// 回放时单帧写入的超时：目标一直写不进去就放弃本次回放
+static const int REPLAY_WRITE_TIMEOUT_MS = 1000;
+
+static inline size_t AlignRecord(size_t n) {
+    return (n + 7) & ~static_cast<size_t>(7);
+}
+
+static int64_t RealtimeNs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static void PutU32(uint8_t* p, uint32_t v) {
+    memcpy(p, &v, 4);
+}
+
+static uint32_t GetU32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static int64_t GetI64(const uint8_t* p) {
+    int64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// CaptureWriter
+// ---------------------------------------------------------------------------
+
+CaptureWriter* CaptureWriter::Open(const char* pathPrefix, size_t segmentBytes, int maxSegments, int* err) {
+    if (pathPrefix == nullptr || pathPrefix[0] == '\0' ||
+        segmentBytes < static_cast<size_t>(CAPTURE_FILE_HEADER) * 2) {
+        *err = -EINVAL;
+        return nullptr;
+    }
+    CaptureWriter* w = new (std::nothrow) CaptureWriter(pathPrefix, segmentBytes, maxSegments);
+    if (w == nullptr) {
+        *err = -ENOMEM;
+        return nullptr;
+    }
+    int ret = w->MapSegment(0, &w->current_);
+    if (ret < 0) {
+        *err = ret;
+        delete w;
+        return nullptr;
+    }
+    w->nextIndex_ = 1;
+    w->thread_ = std::thread(&CaptureWriter::Run, w);
+    LOGI("capture started: %s.*.sikcap, segment=%zu bytes, keep=%d", pathPrefix, segmentBytes, maxSegments);
+    *err = 0;
+    return w;
+}
+
+CaptureWriter::CaptureWriter(const char* pathPrefix, size_t segmentBytes, int maxSegments)
+        : prefix_(pathPrefix), segmentBytes_(segmentBytes), maxSegments_(maxSegments) {
+    retired_.reserve(4);
+}
+
+CaptureWriter::~CaptureWriter() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+
+    for (auto& seg : retired_) FinishSegment(&seg);
+    FinishSegment(&current_);
+    if (next_.fd >= 0) {
+        // 预先建好但没用上的空段
+        next_.used = 0;
+        FinishSegment(&next_);
+        unlink(SegmentPath(next_.index).c_str());
+    }
+    if (dropped_.load() > 0) {
+        LOGW("capture %s stopped, %llu records, %llu dropped", prefix_.c_str(),
+             static_cast<unsigned long long>(records_.load()),
+             static_cast<unsigned long long>(dropped_.load()));
+    }
+}
+
+std::string CaptureWriter::SegmentPath(int index) const {
+    return prefix_ + "." + std::to_string(index) + ".sikcap";
+}
+
+int CaptureWriter::MapSegment(int index, Segment* out) {
+    std::string path = SegmentPath(index);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        int err = errno;
+        LOGE("capture: open(%s) failed: %s", path.c_str(), strerror(err));
+        return -err;
+    }
+    if (ftruncate(fd, static_cast<off_t>(segmentBytes_)) != 0) {
+        int err = errno;
+        LOGE("capture: ftruncate(%s) failed: %s", path.c_str(), strerror(err));
+        ::close(fd);
+        unlink(path.c_str());
+        return -err;
+    }
+    // MAP_POPULATE 预先建好页表，写入时不在热路径上缺页
+    void* mem = mmap(nullptr, segmentBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (mem == MAP_FAILED) {
+        int err = errno;
+        LOGE("capture: mmap(%s) failed: %s", path.c_str(), strerror(err));
+        ::close(fd);
+        unlink(path.c_str());
+        return -err;
+    }
+
+    auto* base = static_cast<uint8_t*>(mem);
+    int64_t realtime = RealtimeNs();
+    int64_t monotonic = static_cast<int64_t>(MetricsNowNs());
+    memcpy(base, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    PutU32(base + 8, CAPTURE_VERSION);
+    PutU32(base + 12, CAPTURE_FILE_HEADER);
+    PutU32(base + 16, static_cast<uint32_t>(index));
+    memcpy(base + 24, &realtime, 8);
+    memcpy(base + 32, &monotonic, 8);
+
+    out->fd = fd;
+    out->base = base;
+    out->used = CAPTURE_FILE_HEADER;
+    out->index = index;
+    return 0;
+}
+
+void CaptureWriter::FinishSegment(Segment* seg) {
+    if (seg->fd < 0) return;
+    munmap(seg->base, segmentBytes_);
+    // 截断到实际写入的长度，文件结尾即本段结束
+    if (ftruncate(seg->fd, static_cast<off_t>(seg->used)) != 0) {
+        LOGW("capture: truncate segment %d failed: %s", seg->index, strerror(errno));
+    }
+    ::close(seg->fd);
+    seg->fd = -1;
+    seg->base = nullptr;
+}
+
+void CaptureWriter::Run() {
+    std::unique_lock<std::mutex> lk(mu_);
+    for (;;) {
+        cv_.wait(lk, [this] { return stop_ || next_.fd < 0 || !retired_.empty(); });
+
+        std::vector<Segment> retired;
+        retired.swap(retired_);
+        retired_.reserve(4);
+        bool needNext = !stop_ && next_.fd < 0;
+        int index = nextIndex_;
+        lk.unlock();
+
+        for (auto& seg : retired) {
+            FinishSegment(&seg);
+            // seg 之后的一段已经在写，连同它一共保留 maxSegments_ 段
+            int expired = seg.index + 1 - maxSegments_;
+            if (maxSegments_ > 0 && expired >= 0) unlink(SegmentPath(expired).c_str());
+        }
+
+        int ret = 0;
+        Segment seg;
+        if (needNext) ret = MapSegment(index, &seg);
+
+        lk.lock();
+        if (needNext) {
+            if (ret == 0) {
+                next_ = seg;
+                nextIndex_ = index + 1;
+            } else {
+                // 磁盘满等情况：隔一会儿再试，期间写满的记录按丢弃计数
+                cv_.wait_for(lk, std::chrono::seconds(1), [this] { return stop_; });
+            }
+        }
+        if (stop_ && retired_.empty()) break;
+    }
+}
+
+void CaptureWriter::Append(int kind, int direction, uint32_t frameId, uint32_t flags, int64_t timestampNs,
+                           const struct iovec* iov, int iovcnt, size_t len) {
+    const size_t need = AlignRecord(CAPTURE_RECORD_HEADER + len);
+
+    std::lock_guard<std::mutex> lk(mu_);
+    if (current_.base == nullptr) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (current_.used + need > segmentBytes_) {
+        if (need + CAPTURE_FILE_HEADER > segmentBytes_ || next_.fd < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        retired_.push_back(current_);
+        current_ = next_;
+        next_ = Segment{};
+        cv_.notify_one();
+    }
+
+    uint8_t* p = current_.base + current_.used;
+    PutU32(p, static_cast<uint32_t>(len));
+    p[5] = static_cast<uint8_t>(direction);
+    p[6] = 0;
+    p[7] = 0;
+    PutU32(p + 8, frameId);
+    PutU32(p + 12, flags);
+    memcpy(p + 16, &timestampNs, 8);
+    size_t off = CAPTURE_RECORD_HEADER;
+    for (int i = 0; i < iovcnt && off < CAPTURE_RECORD_HEADER + len; ++i) {
+        size_t n = iov[i].iov_len;
+        if (n > CAPTURE_RECORD_HEADER + len - off) n = CAPTURE_RECORD_HEADER + len - off;
+        memcpy(p + off, iov[i].iov_base, n);
+        off += n;
+    }
+    // 类型最后写：读端看到非 0 类型时记录已经完整
+    p[4] = static_cast<uint8_t>(kind);
+    current_.used += need;
+    records_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// 按 fd 挂载
+// ---------------------------------------------------------------------------
+
+static std::atomic<CaptureWriter*> g_writers[COMM_METRICS_MAX_FDS];
+// 正在使用该 fd 槽位的调用数，Detach 等它归零后才释放 writer
+static std::atomic<int> g_users[COMM_METRICS_MAX_FDS];
+
+static CaptureWriter* Acquire(int fd) {
+    if (fd < 0 || fd >= COMM_METRICS_MAX_FDS) return nullptr;
+    if (g_writers[fd].load(std::memory_order_relaxed) == nullptr) return nullptr;
+    g_users[fd].fetch_add(1, std::memory_order_seq_cst);
+    CaptureWriter* w = g_writers[fd].load(std::memory_order_seq_cst);
+    if (w == nullptr) g_users[fd].fetch_sub(1, std::memory_order_release);
+    return w;
+}
+
+static void Release(int fd) {
+    g_users[fd].fetch_sub(1, std::memory_order_release);
+}
+
+static void Retire(int fd, CaptureWriter* old) {
+    if (old == nullptr) return;
+    while (g_users[fd].load(std::memory_order_acquire) != 0) sched_yield();
+    delete old;
+}
+
+void CaptureAttach(int fd, CaptureWriter* writer) {
+    if (fd < 0 || fd >= COMM_METRICS_MAX_FDS) {
+        delete writer;
+        return;
+    }
+    Retire(fd, g_writers[fd].exchange(writer, std::memory_order_seq_cst));
+}
+
+void CaptureDetach(int fd) {
+    if (fd < 0 || fd >= COMM_METRICS_MAX_FDS) return;
+    Retire(fd, g_writers[fd].exchange(nullptr, std::memory_order_seq_cst));
+}
+
+void CaptureSerial(int fd, int direction, const uint8_t* data, size_t len) {
+    struct iovec iov{const_cast<uint8_t*>(data), len};
+    CaptureSerialv(fd, direction, &iov, 1, len);
+}
+
+void CaptureSerialv(int fd, int direction, const struct iovec* iov, int iovcnt, size_t len) {
+    CaptureWriter* w = Acquire(fd);
+    if (w == nullptr) return;
+    w->Append(CAPTURE_KIND_SERIAL, direction, 0, 0, static_cast<int64_t>(MetricsNowNs()), iov, iovcnt, len);
+    Release(fd);
+}
+
+void CaptureCan(int fd, int direction, int32_t frameId, int32_t flags, const uint8_t* data, size_t len) {
+    CaptureWriter* w = Acquire(fd);
+    if (w == nullptr) return;
+    struct iovec iov{const_cast<uint8_t*>(data), len};
+    w->Append(CAPTURE_KIND_CAN, direction, static_cast<uint32_t>(frameId), static_cast<uint32_t>(flags),
+              static_cast<int64_t>(MetricsNowNs()), &iov, 1, len);
+    Release(fd);
+}
+
+void CaptureCanRecords(int fd, int direction, const uint8_t* records, int count) {
+    CaptureWriter* w = Acquire(fd);
+    if (w == nullptr) return;
+    int64_t now = static_cast<int64_t>(MetricsNowNs());
+    for (int i = 0; i < count; ++i) {
+        const uint8_t* rec = records + i * CAN_RECORD_SIZE;
+        int64_t ts = (direction == CAPTURE_RX && rec[6] == CAN_TS_KERNEL) ? GetI64(rec + 8) : now;
+        struct iovec iov{const_cast<uint8_t*>(rec + CAN_RECORD_HEADER), rec[5]};
+        w->Append(CAPTURE_KIND_CAN, direction, GetU32(rec), rec[4], ts, &iov, 1, rec[5]);
+    }
+    Release(fd);
+}
+
+// ---------------------------------------------------------------------------
+// CaptureReplayer
+// ---------------------------------------------------------------------------
+
+static void SleepUntil(int64_t deadlineNs) {
+    struct timespec ts{};
+    ts.tv_sec = static_cast<time_t>(deadlineNs / 1000000000LL);
+    ts.tv_nsec = static_cast<long>(deadlineNs % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+CaptureReplayer* CaptureReplayer::Open(const std::vector<std::string>& paths, int targetFd, int kind,
+                                       double speed, bool includeSent, int* err) {
+    if (paths.empty() || targetFd < 0 || (kind != CAPTURE_KIND_SERIAL && kind != CAPTURE_KIND_CAN)) {
+        if (targetFd >= 0) ::close(targetFd);
+        *err = -EINVAL;
+        return nullptr;
+    }
+    CaptureReplayer* r = new (std::nothrow) CaptureReplayer(paths, targetFd, kind, speed, includeSent);
+    if (r == nullptr) {
+        ::close(targetFd);
+        *err = -ENOMEM;
+        return nullptr;
+    }
+    // 先打开第一个文件，格式不对时立即报错
+    int ret = r->OpenFile(0);
+    if (ret < 0) {
+        *err = ret;
+        delete r;
+        return nullptr;
+    }
+    *err = 0;
+    return r;
+}
+
+CaptureReplayer::CaptureReplayer(const std::vector<std::string>& paths, int targetFd, int kind,
+                                 double speed, bool includeSent)
+        : paths_(paths), fd_(targetFd), kind_(kind), speed_(speed), includeSent_(includeSent) {
+}
+
+CaptureReplayer::~CaptureReplayer() {
+    CloseFile();
+    ::close(fd_);
+}
+
+int CaptureReplayer::OpenFile(size_t i) {
+    const std::string& path = paths_[i];
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        int err = errno;
+        LOGE("replay: open(%s) failed: %s", path.c_str(), strerror(err));
+        return -err;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < CAPTURE_FILE_HEADER) {
+        LOGE("replay: %s is not a capture file", path.c_str());
+        ::close(fd);
+        return -EINVAL;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        int err = errno;
+        LOGE("replay: mmap(%s) failed: %s", path.c_str(), strerror(err));
+        return -err;
+    }
+    auto* base = static_cast<const uint8_t*>(mem);
+    uint32_t headerSize = GetU32(base + 12);
+    if (memcmp(base, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 || GetU32(base + 8) != CAPTURE_VERSION ||
+        headerSize < static_cast<uint32_t>(CAPTURE_FILE_HEADER) || headerSize > size) {
+        LOGE("replay: %s has a bad header", path.c_str());
+        munmap(mem, size);
+        return -EINVAL;
+    }
+    madvise(mem, size, MADV_SEQUENTIAL);
+
+    map_ = base;
+    mapSize_ = size;
+    pos_ = headerSize;
+    fileIndex_ = i;
+    return 0;
+}
+
+void CaptureReplayer::CloseFile() {
+    if (map_ != nullptr) {
+        munmap(const_cast<uint8_t*>(map_), mapSize_);
+        map_ = nullptr;
+        mapSize_ = 0;
+    }
+}
+
+int CaptureReplayer::Send(const uint8_t* rec, uint32_t len) {
+    const uint8_t* data = rec + CAPTURE_RECORD_HEADER;
+    if (kind_ == CAPTURE_KIND_CAN) {
+        int ret = CanWriteFrame(fd_, static_cast<int32_t>(GetU32(rec + 8)), static_cast<int>(GetU32(rec + 12)),
+                                data, static_cast<int>(len), REPLAY_WRITE_TIMEOUT_MS);
+        if (ret == 0) return -ETIMEDOUT;
+        return ret < 0 ? ret : 0;
+    }
+    struct iovec iov{const_cast<uint8_t*>(data), len};
+    int err = 0;
+    size_t written = SerialWriteFully(fd_, &iov, 1, REPLAY_WRITE_TIMEOUT_MS, MetricsFor(fd_), &err);
+    if (written != len) return -(err != 0 ? err : EIO);
+    return 0;
+}
+
+int CaptureReplayer::Step(int budgetMs) {
+    const int64_t deadline = static_cast<int64_t>(MetricsNowNs()) + static_cast<int64_t>(budgetMs) * 1000000LL;
+    for (;;) {
+        if (map_ == nullptr) {
+            if (fileIndex_ + 1 >= paths_.size()) return 1;
+            int ret = OpenFile(fileIndex_ + 1);
+            if (ret < 0) return ret;
+        }
+
+        const uint8_t* rec = map_ + pos_;
+        if (pos_ + CAPTURE_RECORD_HEADER > mapSize_ || rec[4] == 0) {
+            CloseFile();
+            continue;
+        }
+        uint32_t len = GetU32(rec);
+        if (pos_ + CAPTURE_RECORD_HEADER + len > mapSize_) {
+            LOGW("replay: %s ends with a truncated record", paths_[fileIndex_].c_str());
+            CloseFile();
+            continue;
+        }
+        int kind = rec[4];
+        int direction = rec[5];
+        uint32_t flags = GetU32(rec + 12);
+        size_t size = AlignRecord(CAPTURE_RECORD_HEADER + len);
+
+        bool skip = kind != kind_ || (direction == CAPTURE_TX && !includeSent_) ||
+                    (kind == CAPTURE_KIND_CAN && (flags & CAN_FLAG_ERROR));
+        if (skip) {
+            pos_ += size;
+            continue;
+        }
+
+        int64_t ts = GetI64(rec + 16);
+        int64_t now = static_cast<int64_t>(MetricsNowNs());
+        if (!started_) {
+            started_ = true;
+            firstTs_ = ts;
+            startNs_ = now;
+        }
+        if (speed_ > 0) {
+            int64_t due = startNs_ + static_cast<int64_t>(static_cast<double>(ts - firstTs_) / speed_);
+            if (due > now) {
+                if (due > deadline) {
+                    SleepUntil(deadline);
+                    return 0;
+                }
+                SleepUntil(due);
+            }
+        }
+
+        int ret = Send(rec, len);
+        if (ret < 0) {
+            LOGE("replay: write failed after %llu records: %s",
+                 static_cast<unsigned long long>(sent_), strerror(-ret));
+            return ret;
+        }
+        pos_ += size;
+        ++sent_;
+        if (static_cast<int64_t>(MetricsNowNs()) >= deadline) return 0;
+    }
+}
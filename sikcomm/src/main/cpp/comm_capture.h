@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 收发抓包与回放。
+ *
+ * 抓包文件格式（小端，按段轮转：<prefix>.<段号>.sikcap）：
+ * - 文件头 64 字节：[0..7] 魔数 "SIKCAP\0\1"，[8..11] 版本，[12..15] 文件头长度，[16..19] 段号，
+ *   [24..31] 建段时的 CLOCK_REALTIME（纳秒），[32..39] 同一时刻的 CLOCK_MONOTONIC（纳秒），其余保留；
+ * - 之后是首尾相接的记录，每条 8 字节对齐：
+ *   [0..3] 数据长度，[4] 类型（CAPTURE_KIND_*），[5] 方向（CAPTURE_RX / TX），[6..7] 保留，
+ *   [8..11] CAN ID（串口为 0），[12..15] CAN flags（CAN_FLAG_*，串口为 0），[16..23] CLOCK_MONOTONIC 时间戳（纳秒），
+ *   [24..] 数据（串口为一次 read / writev 的字节，CAN 为 payload）；
+ * - 类型为 0 的记录（或文件结尾）表示本段结束。
+ *
+ * 写入：段文件预先 ftruncate + mmap（MAP_POPULATE），热路径只是加锁后 memcpy 进映射内存；
+ * 建下一段、收尾旧段（munmap / 截断到实际长度 / 删除超出保留数的旧段）都在后台线程里完成。
+ * 下一段还没准备好时新记录直接丢弃并计数，不阻塞收发。
+ *
+ * 抓包按 fd 挂载（和 metrics 一样），serial_io / can_io 的收发函数在成功后调用 Capture*()，
+ * 没有挂载时只多一次 relaxed load。
+ */
+
+enum {
+    CAPTURE_RX = 0,
+    CAPTURE_TX = 1
+};
+
+enum {
+    CAPTURE_KIND_SERIAL = 1,
+    CAPTURE_KIND_CAN = 2
+};
+
+static const int CAPTURE_FILE_HEADER = 64;
+static const int CAPTURE_RECORD_HEADER = 24;
+
+class CaptureWriter {
+public:
+    /**
+     * 创建第一段并启动后台线程。
+     *
+     * @param segmentBytes 单段文件大小（含文件头）
+     * @param maxSegments  最多保留的段数，超出时删除最旧的段；<=0 表示不删除
+     * @return nullptr 时 *err 为 -errno
+     */
+    static CaptureWriter* Open(const char* pathPrefix, size_t segmentBytes, int maxSegments, int* err);
+
+    /**
+     * 停止后台线程，当前段截断到实际长度后关闭。
+     */
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * 追加一条记录，数据由 iov 拼接而成（总长 len）。
+     */
+    void Append(int kind, int direction, uint32_t frameId, uint32_t flags, int64_t timestampNs,
+                const struct iovec* iov, int iovcnt, size_t len);
+
+    uint64_t Records() const { return records_.load(std::memory_order_relaxed); }
+
+    uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Segment {
+        int fd = -1;
+        uint8_t* base = nullptr;
+        size_t used = 0;
+        int index = 0;
+    };
+
+    CaptureWriter(const char* pathPrefix, size_t segmentBytes, int maxSegments);
+
+    int MapSegment(int index, Segment* out);
+    void FinishSegment(Segment* seg);
+    std::string SegmentPath(int index) const;
+    void Run();
+
+    const std::string prefix_;
+    const size_t segmentBytes_;
+    const int maxSegments_;
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    Segment current_;
+    Segment next_;                     // 后台线程准备好的下一段，fd < 0 表示还没有
+    std::vector<Segment> retired_;     // 写满等待后台收尾的段
+    bool stop_ = false;
+    int nextIndex_ = 0;                // 下一个要准备的段号
+
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::thread thread_;
+};
+
+/**
+ * 把 writer 挂到 fd 上，之后该 fd 上的收发都会被记录。fd 上已有的 writer 会被替换并释放。
+ */
+void CaptureAttach(int fd, CaptureWriter* writer);
+
+/**
+ * 摘下并释放 fd 上的 writer（等正在写入的调用结束），必须在 close(fd) 之前调用。
+ */
+void CaptureDetach(int fd);
+
+// 收发函数成功后调用；fd 没有挂 writer 时立即返回
+void CaptureSerial(int fd, int direction, const uint8_t* data, size_t len);
+void CaptureSerialv(int fd, int direction, const struct iovec* iov, int iovcnt, size_t len);
+void CaptureCan(int fd, int direction, int32_t frameId, int32_t flags, const uint8_t* data, size_t len);
+
+/**
+ * 按 CAN_RECORD_SIZE 定长记录批量记录（readBatch / writeBatch 的格式），
+ * 接收方向带内核时间戳（CAN_TS_KERNEL）的帧沿用该时间戳。
+ */
+void CaptureCanRecords(int fd, int direction, const uint8_t* records, int count);
+
+/**
+ * 回放器：按原始时间间隔（或 speed 倍速）把抓包文件里的记录写到目标 fd。
+ *
+ * 只回放 kind 与目标一致的记录；CAN 目标用 CanWriteFrame 发出，串口目标用完整写入。
+ * 所有文件的时间戳都是同一个 CLOCK_MONOTONIC，多段按顺序连续回放即可保持原始节奏。
+ * 同一个实例只能在一个线程里使用。
+ */
+class CaptureReplayer {
+public:
+    /**
+     * @param speed       回放倍速，<=0 表示不等待、尽快发送
+     * @param targetFd    回放目标，归回放器所有（析构时关闭，打开失败时也会关闭）
+     * @param includeSent 是否连发送方向的记录一起回放（默认只回放接收到的）
+     * @return nullptr 时 *err 为 -errno
+     */
+    static CaptureReplayer* Open(const std::vector<std::string>& paths, int targetFd, int kind,
+                                 double speed, bool includeSent, int* err);
+
+    ~CaptureReplayer();
+
+    /**
+     * 回放一段时间（至多 budgetMs 毫秒，包括等待）。
+     *
+     * @return 0: 还有记录；1: 已全部回放；<0: -errno
+     */
+    int Step(int budgetMs);
+
+    uint64_t Sent() const { return sent_; }
+
+private:
+    CaptureReplayer(const std::vector<std::string>& paths, int targetFd, int kind, double speed, bool includeSent);
+
+    int OpenFile(size_t i);
+    void CloseFile();
+    int Send(const uint8_t* rec, uint32_t len);
+
+    const std::vector<std::string> paths_;
+    const int fd_;
+    const int kind_;
+    const double speed_;
+    const bool includeSent_;
+
+    size_t fileIndex_ = 0;
+    const uint8_t* map_ = nullptr;
+    size_t mapSize_ = 0;
+    size_t pos_ = 0;
+
+    bool started_ = false;
+    int64_t firstTs_ = 0;       // 第一条回放记录的原始时间戳
+    int64_t startNs_ = 0;       // 开始回放时的 CLOCK_MONOTONIC
+    uint64_t sent_ = 0;
+};
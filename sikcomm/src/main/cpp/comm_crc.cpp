@@ -0,0 +1,313 @@
+#include "comm_crc.h"
+
+#include <string.h>
+
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * slicing-by-8 查表：t[0] 为标准单字节表，t[k][b] 表示字节 b 之后再跟 k 个 0 字节的效果。
+ */
+struct SliceTable {
+    uint32_t t[8][256];
+};
+
+SliceTable MakeReflected(uint32_t poly) {
+    SliceTable tab{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ poly : (c >> 1);
+        tab.t[0][i] = c;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            uint32_t prev = tab.t[k - 1][i];
+            tab.t[k][i] = (prev >> 8) ^ tab.t[0][prev & 0xFF];
+        }
+    }
+    return tab;
+}
+
+SliceTable MakeNormal16(uint16_t poly) {
+    SliceTable tab{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i << 8;
+        for (int k = 0; k < 8; ++k) c = (c & 0x8000) ? ((c << 1) ^ poly) : (c << 1);
+        tab.t[0][i] = c & 0xFFFF;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (int i = 0; i < 256; ++i) {
+            uint32_t prev = tab.t[k - 1][i];
+            tab.t[k][i] = ((prev << 8) & 0xFFFF) ^ tab.t[0][prev >> 8];
+        }
+    }
+    return tab;
+}
+
+// 函数内 static 保证首次使用时线程安全地初始化
+const SliceTable& Modbus16Table() {
+    static const SliceTable tab = MakeReflected(0xA001);
+    return tab;
+}
+
+const SliceTable& Ccitt16Table() {
+    static const SliceTable tab = MakeNormal16(0x1021);
+    return tab;
+}
+
+const SliceTable& Crc32Table() {
+    static const SliceTable tab = MakeReflected(0xEDB88320u);
+    return tab;
+}
+
+/**
+ * 反射型 CRC（低位先行），宽度 <= 32 位通用。
+ */
+uint32_t SliceReflected(const SliceTable& tab, uint32_t crc, const uint8_t* p, size_t n) {
+    const uint32_t (*t)[256] = tab.t;
+    while (n >= 8) {
+        uint32_t lo = (static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                       (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24)) ^ crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+/**
+ * 非反射 16 位 CRC（高位先行）。
+ */
+uint32_t SliceNormal16(const SliceTable& tab, uint32_t crc, const uint8_t* p, size_t n) {
+    const uint32_t (*t)[256] = tab.t;
+    while (n >= 8) {
+        crc = t[7][p[0] ^ (crc >> 8)] ^ t[6][p[1] ^ (crc & 0xFF)] ^
+              t[5][p[2]] ^ t[4][p[3]] ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = ((crc << 8) & 0xFFFF) ^ t[0][(crc >> 8) ^ *p++];
+    return crc;
+}
+
+uint32_t Crc32Slice8(uint32_t crc, const uint8_t* p, size_t n) {
+    return ~SliceReflected(Crc32Table(), ~crc, p, n);
+}
+
+#if defined(__aarch64__)
+
+#if defined(__clang__)
+#define SIKCOMM_TARGET_CRC __attribute__((target("crc")))
+#else
+#define SIKCOMM_TARGET_CRC __attribute__((target("+crc")))
+#endif
+
+/**
+ * ARMv8 CRC32 指令（crc32x / crc32b），多项式和 zlib CRC-32 相同。
+ */
+SIKCOMM_TARGET_CRC
+uint32_t Crc32Armv8(uint32_t crc, const uint8_t* p, size_t n) {
+    crc = ~crc;
+    while (n > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc = __crc32b(crc, *p++);
+        --n;
+    }
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        crc = __crc32d(crc, v);
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = __crc32b(crc, *p++);
+    return ~crc;
+}
+
+#endif // __aarch64__
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * PCLMULQDQ 折叠实现（Intel "Fast CRC Computation Using PCLMULQDQ" 白皮书，
+ * 常量为反射域下的 CRC-32 折叠常量，和 zlib / Linux crc32-pclmul 相同）。
+ *
+ * 要求 n >= 64 且为 16 的整数倍；crc 为未取反的内部状态。
+ */
+__attribute__((target("pclmul,sse4.1")))
+uint32_t Crc32PclmulBlocks(uint32_t crc, const uint8_t* buf, size_t n) {
+    alignas(16) static const uint64_t k1k2[] = {0x0154442bd4ULL, 0x01c6e41596ULL};
+    alignas(16) static const uint64_t k3k4[] = {0x01751997d0ULL, 0x00ccaa009eULL};
+    alignas(16) static const uint64_t k5k0[] = {0x0163cd6124ULL, 0x0000000000ULL};
+    alignas(16) static const uint64_t poly[] = {0x01db710641ULL, 0x01f7011641ULL};
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    buf += 64;
+    n -= 64;
+
+    // 4 路并行，每次折叠 64 字节
+    while (n >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30)));
+        buf += 64;
+        n -= 64;
+    }
+
+    // 4 路合并成 128 位
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // 剩余的 16 字节块逐块折叠
+    while (n >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        buf += 16;
+        n -= 16;
+    }
+
+    // 128 -> 64 位
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett 约减到 32 位
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t Crc32Pclmul(uint32_t crc, const uint8_t* p, size_t n) {
+    // 折叠有固定开销，短数据直接查表
+    if (n < 64) return Crc32Slice8(crc, p, n);
+    size_t blocks = n & ~static_cast<size_t>(15);
+    crc = ~Crc32PclmulBlocks(~crc, p, blocks);
+    return Crc32Slice8(crc, p + blocks, n - blocks);
+}
+
+#endif // x86
+
+using Crc32Fn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+struct Crc32Impl {
+    Crc32Fn fn;
+    const char* name;
+};
+
+Crc32Impl DetectCrc32() {
+#if defined(__aarch64__)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) return {Crc32Armv8, "armv8-crc32"};
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+        return {Crc32Pclmul, "pclmul"};
+    }
+#endif
+    return {Crc32Slice8, "slice8"};
+}
+
+const Crc32Impl& SelectedCrc32() {
+    static const Crc32Impl impl = DetectCrc32();
+    return impl;
+}
+
+} // namespace
+
+uint16_t Crc16Modbus(const uint8_t* data, size_t len, uint16_t crc) {
+    return static_cast<uint16_t>(SliceReflected(Modbus16Table(), crc, data, len));
+}
+
+uint16_t Crc16Ccitt(const uint8_t* data, size_t len, uint16_t crc) {
+    return static_cast<uint16_t>(SliceNormal16(Ccitt16Table(), crc, data, len));
+}
+
+uint32_t Crc32(const uint8_t* data, size_t len, uint32_t crc) {
+    return SelectedCrc32().fn(crc, data, len);
+}
+
+uint32_t CrcCompute(int algorithm, const uint8_t* data, size_t len) {
+    switch (algorithm) {
+        case CRC_ALGO_16_MODBUS: return Crc16Modbus(data, len);
+        case CRC_ALGO_16_CCITT:  return Crc16Ccitt(data, len);
+        case CRC_ALGO_32:        return Crc32(data, len);
+        default:                 return 0;
+    }
+}
+
+uint32_t CrcUpdate(int algorithm, uint32_t crc, const uint8_t* data, size_t len) {
+    switch (algorithm) {
+        case CRC_ALGO_16_MODBUS: return Crc16Modbus(data, len, static_cast<uint16_t>(crc));
+        case CRC_ALGO_16_CCITT:  return Crc16Ccitt(data, len, static_cast<uint16_t>(crc));
+        case CRC_ALGO_32:        return Crc32(data, len, crc);
+        default:                 return 0;
+    }
+}
+
+int CrcWidth(int algorithm) {
+    switch (algorithm) {
+        case CRC_ALGO_16_MODBUS:
+        case CRC_ALGO_16_CCITT:
+            return 2;
+        case CRC_ALGO_32:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+const char* CrcBackend() {
+    return SelectedCrc32().name;
+}
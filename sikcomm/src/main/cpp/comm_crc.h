@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * 常用校验算法（纯 C++，不依赖 JNI）。
+ *
+ * - 通用实现：slicing-by-8 查表，每次处理 8 字节
+ * - CRC-32：运行时检测到 ARMv8 CRC32 指令或 x86 PCLMULQDQ 时自动切到硬件实现
+ */
+
+// 算法编号（和 Kotlin CrcAlgorithm.id 保持一致）
+static const int CRC_ALGO_NONE         = 0;
+static const int CRC_ALGO_16_MODBUS    = 1;   // poly 0x8005 反射，init 0xFFFF
+static const int CRC_ALGO_16_CCITT     = 2;   // poly 0x1021 不反射，init 0xFFFF（CCITT-FALSE）
+static const int CRC_ALGO_32           = 3;   // IEEE 802.3 / zlib
+
+/**
+ * CRC-16/MODBUS。
+ *
+ * @param crc 初值（分段计算时传入上一段的结果）
+ */
+uint16_t Crc16Modbus(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * CRC-16/CCITT-FALSE；init 传 0 即为 XMODEM。
+ */
+uint16_t Crc16Ccitt(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * CRC-32（zlib 语义：初值 0，分段计算时传入上一段的结果）。
+ */
+uint32_t Crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+/**
+ * 按算法编号计算（使用各算法默认初值）。
+ */
+uint32_t CrcCompute(int algorithm, const uint8_t* data, size_t len);
+
+/**
+ * 按算法编号分段计算：crc 为初值或上一段的结果。
+ */
+uint32_t CrcUpdate(int algorithm, uint32_t crc, const uint8_t* data, size_t len);
+
+/**
+ * 算法校验值的字节数，未知算法返回 0。
+ */
+int CrcWidth(int algorithm);
+
+/**
+ * 当前 CRC-32 使用的实现："armv8-crc32" / "pclmul" / "slice8"。
+ */
+const char* CrcBackend();
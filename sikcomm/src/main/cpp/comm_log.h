@@ -0,0 +1,39 @@
+#pragma once
+
+// 使用前先定义 LOG_TAG：
+//   #define LOG_TAG "NativeSerial"
+//   #include "comm_log.h"
+#ifndef LOG_TAG
+#error "define LOG_TAG before including comm_log.h"
+#endif
+
+#ifdef __ANDROID__
+
+#include <android/log.h>
+
+#define COMM_LOG(prio, ...) __android_log_print(ANDROID_LOG_##prio, LOG_TAG, __VA_ARGS__)
+
+#else
+
+// 宿主机构建（core 库 / benchmark）：没有 logcat，打到 stderr
+#include <stdio.h>
+
+#define COMM_LOG(prio, ...) \
+    do { \
+        fprintf(stderr, #prio "/" LOG_TAG ": " __VA_ARGS__); \
+        fputc('\n', stderr); \
+    } while (0)
+
+#endif
+
+#define LOGE(...) COMM_LOG(ERROR, __VA_ARGS__)
+#define LOGW(...) COMM_LOG(WARN,  __VA_ARGS__)
+#define LOGI(...) COMM_LOG(INFO,  __VA_ARGS__)
+
+// 热路径（每次 read / write / poll）的详细日志，默认编译掉，
+// 需要排查时用 -DSIKCOMM_VERBOSE_LOG=ON 重新编译（gradle: -Psikcomm.verboseLog=true）。
+#ifdef SIKCOMM_VERBOSE_LOG
+#define LOGV(...) COMM_LOG(VERBOSE, __VA_ARGS__)
+#else
+#define LOGV(...) ((void) 0)
+#endif
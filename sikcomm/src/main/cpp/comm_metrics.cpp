@@ -0,0 +1,89 @@
+#include <errno.h>
+#include <string.h>
+#include "comm_metrics.h"
+
+// 槽位按需分配，之后一直复用（同一个 fd 号重新 open 时清零），不释放
+static std::atomic<ChannelMetrics*> g_slots[COMM_METRICS_MAX_FDS];
+
+static int BucketIndex(uint64_t v) {
+    const uint64_t subCount = 1ULL << COMM_HIST_SUB_BITS;
+    if (v < subCount) return static_cast<int>(v);
+    int exp = 63 - __builtin_clzll(v);
+    int shift = exp - COMM_HIST_SUB_BITS;
+    int idx = ((shift + 1) << COMM_HIST_SUB_BITS) + static_cast<int>((v >> shift) & (subCount - 1));
+    return idx < COMM_HIST_BUCKETS ? idx : COMM_HIST_BUCKETS - 1;
+}
+
+static uint64_t BucketUpperBound(int idx) {
+    const int subCount = 1 << COMM_HIST_SUB_BITS;
+    if (idx < subCount) return static_cast<uint64_t>(idx);
+    int shift = (idx >> COMM_HIST_SUB_BITS) - 1;
+    uint64_t sub = static_cast<uint64_t>(idx & (subCount - 1)) | static_cast<uint64_t>(subCount);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+    buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = maxNs.load(std::memory_order_relaxed);
+    while (ns > prev && !maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::Percentile(double p) const {
+    uint64_t total = count.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    auto target = static_cast<uint64_t>(p * static_cast<double>(total));
+    if (target >= total) target = total - 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < COMM_HIST_BUCKETS; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > target) {
+            uint64_t upper = BucketUpperBound(i);
+            uint64_t max = maxNs.load(std::memory_order_relaxed);
+            return upper < max ? upper : max;
+        }
+    }
+    return maxNs.load(std::memory_order_relaxed);
+}
+
+void ChannelMetrics::Reset() {
+    bytesIn.store(0, std::memory_order_relaxed);
+    bytesOut.store(0, std::memory_order_relaxed);
+    framesIn.store(0, std::memory_order_relaxed);
+    framesOut.store(0, std::memory_order_relaxed);
+    pollTimeouts.store(0, std::memory_order_relaxed);
+    errors.store(0, std::memory_order_relaxed);
+    for (auto& e : errorsByErrno) e.store(0, std::memory_order_relaxed);
+    pollWait.Reset();
+    syscall.Reset();
+}
+
+void MetricsAttach(int fd) {
+    if (fd < 0 || fd >= COMM_METRICS_MAX_FDS) return;
+    ChannelMetrics* m = g_slots[fd].load(std::memory_order_acquire);
+    if (m == nullptr) {
+        m = new ChannelMetrics();
+        m->Reset();
+        ChannelMetrics* expected = nullptr;
+        if (!g_slots[fd].compare_exchange_strong(expected, m, std::memory_order_acq_rel)) {
+            delete m;
+            m = expected;
+        }
+    }
+    m->Reset();
+}
+
+ChannelMetrics* MetricsFor(int fd) {
+    if (fd < 0 || fd >= COMM_METRICS_MAX_FDS) return nullptr;
+    return g_slots[fd].load(std::memory_order_acquire);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+/**
+ * 通道级统计。
+ *
+ * 按 fd 索引保存在一张定长表里，open 成功时 MetricsAttach(fd) 清零，
+ * 之后热路径只做 relaxed 原子加，没有锁，也没有日志。
+ */
+
+// 只统计 fd < COMM_METRICS_MAX_FDS 的通道
+static const int COMM_METRICS_MAX_FDS = 1024;
+
+// 按 errno 计数的上限（超出的都记在最后一格）
+static const int COMM_METRICS_MAX_ERRNO = 134;
+
+// 对数-线性直方图：每个 2 的幂区间再分 8 档（约 12.5% 精度），覆盖到约 2^40 ns
+static const int COMM_HIST_SUB_BITS = 3;
+static const int COMM_HIST_BUCKETS = (40 - COMM_HIST_SUB_BITS + 1) << COMM_HIST_SUB_BITS;
+
+struct LatencyHistogram {
+    std::atomic<uint64_t> buckets[COMM_HIST_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sumNs;
+    std::atomic<uint64_t> maxNs;
+
+    void Reset();
+    void Record(uint64_t ns);
+
+    /**
+     * 估算分位数（返回所在桶的上界，ns），没有样本返回 0。
+     */
+    uint64_t Percentile(double p) const;
+};
+
+struct ChannelMetrics {
+    std::atomic<uint64_t> bytesIn;
+    std::atomic<uint64_t> bytesOut;
+    std::atomic<uint64_t> framesIn;
+    std::atomic<uint64_t> framesOut;
+    std::atomic<uint64_t> pollTimeouts;
+    std::atomic<uint64_t> errors;
+    std::atomic<uint64_t> errorsByErrno[COMM_METRICS_MAX_ERRNO + 1];
+
+    // poll 从进入到返回就绪的等待时间
+    LatencyHistogram pollWait;
+    // read / write / recvmmsg / sendmmsg 本身的耗时
+    LatencyHistogram syscall;
+
+    void Reset();
+};
+
+/**
+ * 通道打开成功后调用：为 fd 分配（或复用）统计槽并清零。
+ */
+void MetricsAttach(int fd);
+
+/**
+ * 取 fd 对应的统计槽，未 attach 或超出范围返回 nullptr。
+ */
+ChannelMetrics* MetricsFor(int fd);
+
+static inline uint64_t MetricsNowNs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static inline void MetricsAdd(std::atomic<uint64_t>& counter, uint64_t v) {
+    counter.fetch_add(v, std::memory_order_relaxed);
+}
+
+static inline void MetricsError(ChannelMetrics* m, int err) {
+    if (m == nullptr) return;
+    MetricsAdd(m->errors, 1);
+    int idx = (err > 0 && err < COMM_METRICS_MAX_ERRNO) ? err : COMM_METRICS_MAX_ERRNO;
+    MetricsAdd(m->errorsByErrno[idx], 1);
+}
+
+/**
+ * poll 一次并记录统计：就绪时记等待时间，真正等过（timeoutMs > 0）还没就绪才算超时。
+ * 返回值和 errno 与 poll 相同。
+ */
+static inline int MetricsPoll(struct pollfd* pfd, int timeoutMs, ChannelMetrics* m) {
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    int ret = poll(pfd, 1, timeoutMs);
+    if (m != nullptr) {
+        int savedErr = errno;
+        if (ret > 0) {
+            m->pollWait.Record(MetricsNowNs() - start);
+        } else if (ret == 0 && timeoutMs > 0) {
+            MetricsAdd(m->pollTimeouts, 1);
+        } else if (ret < 0) {
+            MetricsError(m, savedErr);
+        }
+        errno = savedErr;
+    }
+    return ret;
+}
+
+/**
+ * ::read 并记录耗时 / 字节数 / 错误（每次读到数据记一帧）。
+ *
+ * @return >=0: 读到的字节数；<0: -errno
+ */
+static inline ssize_t MetricsRead(int fd, void* buf, size_t len, ChannelMetrics* m) {
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    ssize_t n = ::read(fd, buf, len);
+    if (n < 0) {
+        int err = errno;
+        MetricsError(m, err);
+        return -err;
+    }
+    if (m != nullptr) {
+        m->syscall.Record(MetricsNowNs() - start);
+        MetricsAdd(m->bytesIn, static_cast<uint64_t>(n));
+        if (n > 0) MetricsAdd(m->framesIn, 1);
+    }
+    return n;
+}
+
+/**
+ * ::writev 并记录耗时 / 字节数 / 错误（每次调用记一帧）。
+ *
+ * @return >=0: 写入的字节数；<0: -errno
+ */
+static inline ssize_t MetricsWritev(int fd, const struct iovec* iov, int iovcnt, ChannelMetrics* m) {
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    ssize_t n = ::writev(fd, iov, iovcnt);
+    if (n < 0) {
+        int err = errno;
+        MetricsError(m, err);
+        return -err;
+    }
+    if (m != nullptr) {
+        m->syscall.Record(MetricsNowNs() - start);
+        MetricsAdd(m->bytesOut, static_cast<uint64_t>(n));
+        MetricsAdd(m->framesOut, 1);
+    }
+    return n;
+}
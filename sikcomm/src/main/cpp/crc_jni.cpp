@@ -0,0 +1,77 @@
+#include <jni.h>
+#include <errno.h>
+
+#define LOG_TAG "NativeCrc"
+#include "comm_log.h"
+#include "comm_crc.h"
+
+extern "C" {
+
+/**
+ * int update(int algorithm, int crc, byte[] data, int offset, int length)
+ *
+ * 临界区只有一次查表循环，用 GetPrimitiveArrayCritical 直接在 Java 数组上计算，不拷贝。
+ *
+ * @return 新的校验值（16 位算法只有低 16 位有效）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCrc_update(
+        JNIEnv* env,
+        jclass,
+        jint algorithm,
+        jint crc,
+        jbyteArray jData,
+        jint offset,
+        jint length
+) {
+    if (length <= 0) return crc;
+    void* data = env->GetPrimitiveArrayCritical(jData, nullptr);
+    if (data == nullptr) {
+        LOGE("update: GetPrimitiveArrayCritical failed");
+        return crc;
+    }
+    uint32_t ret = CrcUpdate(algorithm, static_cast<uint32_t>(crc),
+                             static_cast<const uint8_t*>(data) + offset,
+                             static_cast<size_t>(length));
+    env->ReleasePrimitiveArrayCritical(jData, data, JNI_ABORT);
+    return static_cast<jint>(ret);
+}
+
+/**
+ * int updateDirect(int algorithm, int crc, ByteBuffer buffer, int offset, int length)
+ *
+ * @return 新的校验值
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCrc_updateDirect(
+        JNIEnv* env,
+        jclass,
+        jint algorithm,
+        jint crc,
+        jobject buffer,
+        jint offset,
+        jint length
+) {
+    if (length <= 0) return crc;
+    auto* base = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+    jlong cap = env->GetDirectBufferCapacity(buffer);
+    if (base == nullptr || offset < 0 || static_cast<jlong>(offset) + length > cap) {
+        LOGE("updateDirect: invalid direct buffer, offset=%d, length=%d", offset, length);
+        return crc;
+    }
+    return static_cast<jint>(CrcUpdate(algorithm, static_cast<uint32_t>(crc),
+                                       base + offset, static_cast<size_t>(length)));
+}
+
+/**
+ * String backend()
+ */
+JNIEXPORT jstring JNICALL
+Java_com_sik_comm_NativeCrc_backend(
+        JNIEnv* env,
+        jclass
+) {
+    return env->NewStringUTF(CrcBackend());
+}
+
+} // extern "C"
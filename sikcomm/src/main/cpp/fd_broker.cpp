@@ -0,0 +1,400 @@
+#include "fd_broker.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_TAG "FdBroker"
+#include "comm_log.h"
+
+// 请求头魔数（"SKFD"），也用来区分协议版本
+static const uint32_t BROKER_MAGIC = 0x534B4644;
+
+// 请求头：magic + flags
+static const size_t BROKER_HEADER = 8;
+
+// helper 同时服务的最大连接数
+static const int BROKER_MAX_CLIENTS = 32;
+
+// 只允许打开串口设备节点（按解析掉符号链接后的真实路径匹配）。
+// 不包含 /dev/tty 和 /dev/tty[0-9]*（控制终端 / 虚拟控制台）
+static const char* const BROKER_PATH_PATTERNS[] = {
+    "/dev/ttyS*",
+    "/dev/ttyUSB*",
+    "/dev/ttyACM*",
+    "/dev/ttyAMA*",
+    "/dev/ttyHS*",
+    "/dev/ttyMSM*",
+    "/dev/ttyMT*",
+    "/dev/ttySAC*",
+    "/dev/ttymxc*",
+    "/dev/ttyO*",
+    "/dev/ttyGS*",
+    "/dev/ttyWCH*",
+    "/dev/ttyCH*",
+};
+
+// 进程内的客户端连接
+static std::mutex gClientLock;
+static int gClientFd = -1;
+static std::string gClientName;
+static int gClientTimeoutMs = 1000;
+
+// 进程内 stand-in helper
+static std::mutex gLocalLock;
+static int gLocalStopPipe[2] = {-1, -1};
+static std::thread gLocalThread;
+
+static socklen_t MakeAddress(const char* name, struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    size_t len = strlen(name);
+    if (len == 0 || len >= sizeof(addr->sun_path) - 1) return 0;
+    if (name[0] == '/') {
+        memcpy(addr->sun_path, name, len);
+        return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + len + 1);
+    }
+    // abstract namespace：sun_path[0] = 0，不在文件系统里留下节点
+    memcpy(addr->sun_path + 1, name, len);
+    return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + 1 + len);
+}
+
+/**
+ * 解析符号链接 / .. 后按白名单匹配（/dev/serial/by-id/... 之类的链接解析到真实的 ttyUSBx 后放行）。
+ *
+ * @param resolved 输出真实路径，之后按它以 O_NOFOLLOW 打开
+ */
+static bool PathAllowed(const std::string& path, std::string* resolved) {
+    char real[PATH_MAX];
+    if (realpath(path.c_str(), real) == nullptr) return false;
+    for (const char* pattern : BROKER_PATH_PATTERNS) {
+        if (fnmatch(pattern, real, FNM_PATHNAME) == 0) {
+            resolved->assign(real);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 客户端 flags 只保留访问方式（O_RDONLY / O_RDWR）和 O_NONBLOCK。
+ *
+ * @return <0: 不支持的访问方式
+ */
+static int SanitizeFlags(int32_t flags) {
+    int access = flags & O_ACCMODE;
+    if (access != O_RDONLY && access != O_RDWR) return -1;
+    return access | (flags & O_NONBLOCK);
+}
+
+static int SendReply(int conn, int status, int fd) {
+    int32_t value = status;
+    struct iovec iov{&value, sizeof(value)};
+    struct msghdr mh{};
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0) {
+        memset(control, 0, sizeof(control));
+        mh.msg_control = control;
+        mh.msg_controllen = sizeof(control);
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&mh);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cm), &fd, sizeof(int));
+    }
+    return sendmsg(conn, &mh, MSG_NOSIGNAL) < 0 ? -errno : 0;
+}
+
+/**
+ * 处理一条请求。
+ *
+ * @return false 表示连接已断开，应关闭
+ */
+static bool HandleRequest(int conn) {
+    char buf[BROKER_HEADER + PATH_MAX];
+    ssize_t n = recv(conn, buf, sizeof(buf), 0);
+    if (n <= 0) return n < 0 && errno == EINTR;
+
+    uint32_t magic;
+    int32_t flags;
+    memcpy(&magic, buf, sizeof(magic));
+    memcpy(&flags, buf + 4, sizeof(flags));
+    if (static_cast<size_t>(n) <= BROKER_HEADER || magic != BROKER_MAGIC) {
+        SendReply(conn, -EPROTO, -1);
+        return true;
+    }
+
+    std::string path(buf + BROKER_HEADER, static_cast<size_t>(n) - BROKER_HEADER);
+    std::string real;
+    int openFlags = SanitizeFlags(flags);
+    if (openFlags < 0 || !PathAllowed(path, &real)) {
+        LOGW("refused to open %s (flags=0x%x)", path.c_str(), flags);
+        SendReply(conn, -EPERM, -1);
+        return true;
+    }
+
+    // 不允许对端借此拿到控制终端，也不让传过去的 fd 在 helper 里泄漏给子进程；
+    // realpath 之后节点被换成符号链接时 O_NOFOLLOW 直接失败
+    int fd = ::open(real.c_str(), openFlags | O_NOCTTY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        int err = errno;
+        LOGW("open(%s) failed: %s", real.c_str(), strerror(err));
+        SendReply(conn, -err, -1);
+        return true;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || !S_ISCHR(st.st_mode)) {
+        LOGW("refused to open %s: not a character device", real.c_str());
+        ::close(fd);
+        SendReply(conn, -EPERM, -1);
+        return true;
+    }
+    int ret = SendReply(conn, 0, fd);
+    ::close(fd);   // 对端已经持有副本
+    if (ret < 0) LOGW("reply for %s failed: %s", path.c_str(), strerror(-ret));
+    return ret == 0;
+}
+
+static bool PeerAllowed(int conn, int allowedUid) {
+    struct ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) return false;
+    return static_cast<int>(cred.uid) == allowedUid;
+}
+
+int BrokerListen(const char* name) {
+    struct sockaddr_un addr;
+    socklen_t len = MakeAddress(name, &addr);
+    if (len == 0) return -EINVAL;
+
+    int s = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (s < 0) return -errno;
+    if (name[0] == '/') unlink(name);
+    if (bind(s, reinterpret_cast<struct sockaddr*>(&addr), len) < 0 || listen(s, 8) < 0) {
+        int err = errno;
+        LOGE("listen(%s) failed: %s", name, strerror(err));
+        ::close(s);
+        return -err;
+    }
+    LOGI("fd broker listening on %s%s", name[0] == '/' ? "" : "@", name);
+    return s;
+}
+
+int BrokerServe(int listenFd, int stopFd, int allowedUid) {
+    if (allowedUid < 0) return -EINVAL;
+
+    // [0] 监听 socket，[1] 停止通知，其余为客户端连接
+    std::vector<struct pollfd> fds(2);
+    fds[0].fd = listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = stopFd;
+    fds[1].events = POLLIN;
+
+    int ret = 0;
+    while (true) {
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            ret = -errno;
+            break;
+        }
+        if (fds[1].revents) break;
+
+        for (size_t i = fds.size() - 1; i >= 2; --i) {
+            if (fds[i].revents == 0) continue;
+            if ((fds[i].revents & POLLIN) && HandleRequest(fds[i].fd)) continue;
+            ::close(fds[i].fd);
+            fds.erase(fds.begin() + static_cast<long>(i));
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int conn = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (conn < 0) continue;
+            if (!PeerAllowed(conn, allowedUid) || fds.size() - 2 >= BROKER_MAX_CLIENTS) {
+                LOGW("connection rejected");
+                ::close(conn);
+                continue;
+            }
+            struct pollfd pfd{};
+            pfd.fd = conn;
+            pfd.events = POLLIN;
+            fds.push_back(pfd);
+        }
+    }
+
+    for (size_t i = 2; i < fds.size(); ++i) ::close(fds[i].fd);
+    return ret;
+}
+
+static int ConnectLocked() {
+    struct sockaddr_un addr;
+    socklen_t len = MakeAddress(gClientName.c_str(), &addr);
+    if (len == 0) return -EINVAL;
+
+    int s = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (s < 0) return -errno;
+    // helper 卡住时请求不能无限期挂住调用方
+    struct timeval tv{};
+    tv.tv_sec = gClientTimeoutMs / 1000;
+    tv.tv_usec = static_cast<long>(gClientTimeoutMs % 1000) * 1000L;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    if (connect(s, reinterpret_cast<struct sockaddr*>(&addr), len) < 0) {
+        int err = errno;
+        ::close(s);
+        return -err;
+    }
+    if (gClientFd >= 0) ::close(gClientFd);
+    gClientFd = s;
+    return 0;
+}
+
+int BrokerConnect(const char* name, int timeoutMs) {
+    std::lock_guard<std::mutex> guard(gClientLock);
+    gClientName = name;
+    gClientTimeoutMs = timeoutMs > 0 ? timeoutMs : 1000;
+    int ret = ConnectLocked();
+    if (ret < 0) {
+        LOGW("connect(%s) failed: %s", name, strerror(-ret));
+    } else {
+        LOGI("connected to fd broker %s", name);
+    }
+    return ret;
+}
+
+void BrokerDisconnect() {
+    std::lock_guard<std::mutex> guard(gClientLock);
+    if (gClientFd >= 0) ::close(gClientFd);
+    gClientFd = -1;
+    gClientName.clear();
+}
+
+bool BrokerConnected() {
+    std::lock_guard<std::mutex> guard(gClientLock);
+    return gClientFd >= 0;
+}
+
+/**
+ * 发一次请求并等应答。
+ *
+ * @return >=0: fd；<0: -errno；*transport 标记是否为连接本身的错误（可重连重试）
+ */
+static int RequestLocked(const char* path, int flags, bool* transport) {
+    *transport = true;
+    size_t pathLen = strlen(path);
+    if (pathLen == 0 || pathLen >= PATH_MAX) {
+        *transport = false;
+        return -EINVAL;
+    }
+
+    char req[BROKER_HEADER + PATH_MAX];
+    uint32_t magic = BROKER_MAGIC;
+    int32_t f = flags;
+    memcpy(req, &magic, sizeof(magic));
+    memcpy(req + 4, &f, sizeof(f));
+    memcpy(req + BROKER_HEADER, path, pathLen);
+    if (send(gClientFd, req, BROKER_HEADER + pathLen, MSG_NOSIGNAL) < 0) return -errno;
+
+    int32_t status = 0;
+    struct iovec iov{&status, sizeof(status)};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr mh{};
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = control;
+    mh.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = recvmsg(gClientFd, &mh, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) return -errno;
+    if (n == 0) return -ECONNRESET;
+    if (static_cast<size_t>(n) < sizeof(status)) return -EPROTO;
+
+    int fd = -1;
+    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&mh); cm != nullptr; cm = CMSG_NXTHDR(&mh, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+            memcpy(&fd, CMSG_DATA(cm), sizeof(int));
+        }
+    }
+    *transport = false;
+    if (status < 0) {
+        if (fd >= 0) ::close(fd);
+        return status;
+    }
+    return fd >= 0 ? fd : -EPROTO;
+}
+
+int BrokerOpen(const char* path, int flags) {
+    std::lock_guard<std::mutex> guard(gClientLock);
+    if (gClientFd < 0) return -ENOTCONN;
+
+    bool transport = false;
+    int ret = RequestLocked(path, flags, &transport);
+    if (ret < 0 && transport && ret != -EAGAIN) {
+        // helper 重启过：重连一次再试
+        LOGW("fd broker request failed (%s), reconnecting", strerror(-ret));
+        int c = ConnectLocked();
+        if (c < 0) {
+            ::close(gClientFd);
+            gClientFd = -1;
+            return c;
+        }
+        ret = RequestLocked(path, flags, &transport);
+    }
+    if (ret < 0 && transport) {
+        // 超时 / 连接坏掉：丢掉这条连接，避免后续应答错位
+        ::close(gClientFd);
+        gClientFd = -1;
+    }
+    return ret;
+}
+
+int BrokerStartLocal(const char* name) {
+    std::lock_guard<std::mutex> guard(gLocalLock);
+    if (gLocalThread.joinable()) return -EALREADY;
+
+    int listenFd = BrokerListen(name);
+    if (listenFd < 0) return listenFd;
+    if (pipe2(gLocalStopPipe, O_CLOEXEC) < 0) {
+        int err = errno;
+        ::close(listenFd);
+        return -err;
+    }
+    int stopFd = gLocalStopPipe[0];
+    gLocalThread = std::thread([listenFd, stopFd] {
+        BrokerServe(listenFd, stopFd, static_cast<int>(getuid()));
+        ::close(listenFd);
+    });
+    return 0;
+}
+
+void BrokerStopLocal() {
+    std::lock_guard<std::mutex> guard(gLocalLock);
+    if (!gLocalThread.joinable()) return;
+    char c = 1;
+    ssize_t ignored = write(gLocalStopPipe[1], &c, 1);
+    (void) ignored;
+    gLocalThread.join();
+    ::close(gLocalStopPipe[0]);
+    ::close(gLocalStopPipe[1]);
+    gLocalStopPipe[0] = gLocalStopPipe[1] = -1;
+}
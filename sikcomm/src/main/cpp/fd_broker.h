@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * 特权 fd 代理（fd broker）。
+ *
+ * 常驻的 helper 进程（通常以 root 身份由 `su -c` 启动一次）监听一个 Unix socket，
+ * 替应用 open 设备节点，再通过 SCM_RIGHTS 把 fd 传回来。
+ * 应用进程只需连接一次，之后每次打开串口都是一次本地 IPC，不再为每个端口起 su。
+ *
+ * 协议（SOCK_SEQPACKET，一个请求 / 应答一条消息）：
+ * - 请求：[u32 BROKER_MAGIC][i32 open flags][路径，不含结尾 0]
+ * - 应答：[i32 结果：0 成功 / -errno]，成功时附带 SCM_RIGHTS fd
+ *
+ * 出于安全考虑，helper 只接受指定 uid 的连接，只打开解析符号链接后匹配串口白名单（/dev/ttyS*、
+ * /dev/ttyUSB* 等）的字符设备，open flags 只保留 O_RDONLY / O_RDWR 和 O_NONBLOCK。
+ */
+
+// 默认的 socket 名（abstract namespace）；以 '/' 开头的名字按文件系统路径处理
+#define BROKER_DEFAULT_NAME "sikcomm_fdbroker"
+
+/**
+ * 创建监听 socket。
+ *
+ * @return >=0: 监听 fd；<0: -errno
+ */
+int BrokerListen(const char* name);
+
+/**
+ * 处理请求，直到 stopFd 可读（stopFd < 0 表示一直运行）。
+ *
+ * @param allowedUid 只接受该 uid 的连接，必须显式指定
+ * @return 0: 正常退出；<0: -errno（EINVAL: allowedUid < 0）
+ */
+int BrokerServe(int listenFd, int stopFd, int allowedUid);
+
+/**
+ * 连接 helper（进程内全局只保留一条连接，重复调用会替换）。
+ *
+ * @param timeoutMs 之后每次请求等待应答的超时时间
+ * @return 0: 成功；<0: -errno
+ */
+int BrokerConnect(const char* name, int timeoutMs);
+
+void BrokerDisconnect();
+
+bool BrokerConnected();
+
+/**
+ * 通过 helper 打开设备节点。连接断开时自动重连一次。
+ *
+ * @return >=0: fd；<0: -errno（ENOTCONN: 没有连接 helper）
+ */
+int BrokerOpen(const char* path, int flags);
+
+/**
+ * 在本进程内起一个 helper 线程（没有特权，只接受本进程 uid，仅用于测试 / 开发机上替代真正的 helper）。
+ *
+ * @return 0: 成功；<0: -errno
+ */
+int BrokerStartLocal(const char* name);
+
+void BrokerStopLocal();
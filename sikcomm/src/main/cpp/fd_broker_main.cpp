@@ -0,0 +1,41 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fd_broker.h"
+
+/**
+ * fd broker helper 进程。
+ *
+ * 用法（root 下常驻，只需启动一次）：
+ *   su -c "/data/local/tmp/sikcomm_fdbroker <socket 名> <允许的 uid>" &
+ *
+ * 必须指定允许连接的 uid（应用 uid），否则拒绝启动：helper 以 root 打开设备节点，不能对所有进程开放。
+ */
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <socket name, e.g. %s> <allowed uid>\n",
+                argv[0], BROKER_DEFAULT_NAME);
+        return 2;
+    }
+    const char* name = argv[1];
+
+    char* end = nullptr;
+    errno = 0;
+    long uid = strtol(argv[2], &end, 10);
+    if (errno != 0 || end == argv[2] || *end != '\0' || uid < 0 || uid > 0x7FFFFFFFL) {
+        fprintf(stderr, "sikcomm_fdbroker: invalid uid '%s'\n", argv[2]);
+        return 2;
+    }
+
+    int listenFd = BrokerListen(name);
+    if (listenFd < 0) {
+        fprintf(stderr, "sikcomm_fdbroker: listen(%s) failed: %s\n", name, strerror(-listenFd));
+        return 1;
+    }
+    int ret = BrokerServe(listenFd, -1, static_cast<int>(uid));
+    close(listenFd);
+    return ret < 0 ? 1 : 0;
+}
@@ -0,0 +1,131 @@
+#include <jni.h>
+#include <errno.h>
+#include <new>
+
+#define LOG_TAG "NativeFramer"
+#include "comm_log.h"
+#include "serial_io.h"
+
+// create() 参数数组下标（和 Kotlin NativeFramer.P_* 保持一致）
+static const int P_MAX_FRAME_SIZE     = 0;
+static const int P_DELIMITER          = 1;
+static const int P_ESCAPE             = 2;
+static const int P_ESCAPED_DELIMITER  = 3;
+static const int P_ESCAPED_ESCAPE     = 4;
+static const int P_LENGTH_OFFSET      = 5;
+static const int P_LENGTH_SIZE        = 6;
+static const int P_LENGTH_BIG_ENDIAN  = 7;
+static const int P_LENGTH_ADJUST      = 8;
+static const int P_FIXED_SIZE         = 9;
+static const int P_SILENCE_GAP_US     = 10;
+static const int P_CHECK_ALGORITHM    = 11;
+static const int P_CHECK_BIG_ENDIAN   = 12;
+static const int P_CHECK_STRIP        = 13;
+static const int P_COUNT              = 14;
+
+static SerialFramer* FromHandle(jlong handle) {
+    return reinterpret_cast<SerialFramer*>(static_cast<intptr_t>(handle));
+}
+
+extern "C" {
+
+/**
+ * long create(int mode, int[] params)
+ *
+ * @return >0: 分帧器句柄（native 指针）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeFramer_create(
+        JNIEnv* env,
+        jclass,
+        jint mode,
+        jintArray params
+) {
+    if (params == nullptr || env->GetArrayLength(params) < P_COUNT) return -EINVAL;
+    jint p[P_COUNT];
+    env->GetIntArrayRegion(params, 0, P_COUNT, p);
+
+    FramerConfig config;
+    config.mode = mode;
+    config.maxFrameSize = p[P_MAX_FRAME_SIZE];
+    config.delimiter = p[P_DELIMITER];
+    config.escape = p[P_ESCAPE];
+    config.escapedDelimiter = p[P_ESCAPED_DELIMITER];
+    config.escapedEscape = p[P_ESCAPED_ESCAPE];
+    config.lengthOffset = p[P_LENGTH_OFFSET];
+    config.lengthSize = p[P_LENGTH_SIZE];
+    config.lengthBigEndian = p[P_LENGTH_BIG_ENDIAN] != 0;
+    config.lengthAdjust = p[P_LENGTH_ADJUST];
+    config.fixedSize = p[P_FIXED_SIZE];
+    config.silenceGapUs = p[P_SILENCE_GAP_US];
+    config.checkAlgorithm = p[P_CHECK_ALGORITHM];
+    config.checkBigEndian = p[P_CHECK_BIG_ENDIAN] != 0;
+    config.checkStrip = p[P_CHECK_STRIP] != 0;
+
+    int ret = SerialFramer::Validate(config);
+    if (ret < 0) {
+        LOGE("invalid framer config, mode=%d", mode);
+        return ret;
+    }
+
+    SerialFramer* framer = new (std::nothrow) SerialFramer(config);
+    if (framer == nullptr) return -ENOMEM;
+    LOGI("framer created, mode=%d, maxFrameSize=%d", mode, config.maxFrameSize);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(framer));
+}
+
+/**
+ * void destroy(long framer)
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeFramer_destroy(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    SerialFramer* framer = FromHandle(handle);
+    if (framer == nullptr) return;
+    if (framer->DroppedBytes() > 0 || framer->CheckFailures() > 0) {
+        LOGW("framer destroyed, %llu bytes dropped while resyncing, %llu frames failed check",
+             static_cast<unsigned long long>(framer->DroppedBytes()),
+             static_cast<unsigned long long>(framer->CheckFailures()));
+    }
+    delete framer;
+}
+
+/**
+ * int readFrames(long framer, long fd, ByteBuffer out, int capacity, int timeoutMs)
+ *
+ * 读取串口数据并分帧，完整帧按 [int32 长度][int64 时间戳][数据]（小端）连续写进 direct buffer out。
+ * 时间戳为包含帧最后一个字节的那次 read 之前 poll 返回时的 CLOCK_MONOTONIC。
+ * - 先交付上次放不下的帧；
+ * - 再把 fd 里已有的数据非阻塞读干净（第一次等待至多 timeoutMs）；
+ * - SILENCE 模式下有半帧时紧贴着 read 用 ppoll 等静默间隔，到期即提交该帧。
+ * - 配置了帧尾校验时只交付校验通过的帧，失败的记为 EBADMSG 错误。
+ *
+ * @return >=0: 写进 out 的帧数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeFramer_readFrames(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlong fd,
+        jobject out,
+        jint capacity,
+        jint timeoutMs
+) {
+    SerialFramer* framer = FromHandle(handle);
+    if (framer == nullptr || fd <= 0) return -EBADF;
+
+    auto* base = static_cast<uint8_t*>(env->GetDirectBufferAddress(out));
+    jlong bufCap = env->GetDirectBufferCapacity(out);
+    if (base == nullptr || bufCap < 0 || capacity < 0 || capacity > bufCap) {
+        LOGE("readFrames: invalid direct buffer, capacity=%d", capacity);
+        return -EINVAL;
+    }
+
+    return SerialReadFrames(framer, static_cast<int>(fd), base, static_cast<size_t>(capacity), timeoutMs);
+}
+
+} // extern "C"
@@ -0,0 +1,185 @@
+#include <jni.h>
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define LOG_TAG "NativeCanGateway"
+#include "comm_log.h"
+#include "can_io.h"
+#include "can_gateway.h"
+
+// create() 每条路由的描述（和 Kotlin NativeCanGateway.R_* 保持一致），
+// 接口名按 [源, 目标] 成对放在 interfaces 里
+static const int R_HAS_FILTER   = 0;
+static const int R_FILTER_ID    = 1;
+static const int R_FILTER_MASK  = 2;
+static const int R_FILTER_FLAGS = 3;
+static const int R_FD           = 4;
+static const int R_MAX_HOPS     = 5;
+static const int R_COUNT        = 6;
+
+// create() 每个修改操作的描述（和 Kotlin NativeCanGateway.M_* 保持一致），
+// 数据按顺序每个操作占 CANFD_MAX_DLEN 字节放在 modData 里
+static const int M_ROUTE   = 0;
+static const int M_OP      = 1;
+static const int M_TARGETS = 2;
+static const int M_ID      = 3;
+static const int M_LENGTH  = 4;
+static const int M_FLAGS   = 5;   // CAN_FLAG_BRS / CAN_FLAG_ESI
+static const int M_COUNT   = 6;
+
+static std::string JStringToString(JNIEnv* env, jstring jstr) {
+    if (jstr == nullptr) return {};
+    const char* utf = env->GetStringUTFChars(jstr, nullptr);
+    if (utf == nullptr) return {};
+    std::string res(utf);
+    env->ReleaseStringUTFChars(jstr, utf);
+    return res;
+}
+
+static CanGateway* FromHandle(jlong handle) {
+    return reinterpret_cast<CanGateway*>(static_cast<intptr_t>(handle));
+}
+
+extern "C" {
+
+/**
+ * long create(String[] interfaces, int[] routes, int[] mods, byte[] modData, int mode)
+ *
+ * @param routes 每条路由 R_COUNT 个 int
+ * @param mods   每个修改操作 M_COUNT 个 int
+ * @return >0: 网关句柄（native 指针）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeCanGateway_create(
+        JNIEnv* env,
+        jclass,
+        jobjectArray jInterfaces,
+        jintArray jRoutes,
+        jintArray jMods,
+        jbyteArray jModData,
+        jint mode
+) {
+    if (jInterfaces == nullptr || jRoutes == nullptr || jMods == nullptr || jModData == nullptr) return -EINVAL;
+    jsize descLen = env->GetArrayLength(jRoutes);
+    if (descLen == 0 || descLen % R_COUNT != 0) return -EINVAL;
+    size_t routeCount = static_cast<size_t>(descLen / R_COUNT);
+    if (static_cast<size_t>(env->GetArrayLength(jInterfaces)) != routeCount * 2) return -EINVAL;
+    jsize modLen = env->GetArrayLength(jMods);
+    if (modLen % M_COUNT != 0) return -EINVAL;
+    size_t modCount = static_cast<size_t>(modLen / M_COUNT);
+    if (static_cast<size_t>(env->GetArrayLength(jModData)) != modCount * CANFD_MAX_DLEN) return -EINVAL;
+
+    std::vector<jint> desc(static_cast<size_t>(descLen));
+    env->GetIntArrayRegion(jRoutes, 0, descLen, desc.data());
+    std::vector<jint> modDesc(static_cast<size_t>(modLen));
+    if (modLen > 0) env->GetIntArrayRegion(jMods, 0, modLen, modDesc.data());
+    std::vector<uint8_t> modData(modCount * CANFD_MAX_DLEN);
+    if (!modData.empty()) {
+        env->GetByteArrayRegion(jModData, 0, static_cast<jsize>(modData.size()),
+                                reinterpret_cast<jbyte*>(modData.data()));
+    }
+
+    std::vector<CanGwRoute> routes(routeCount);
+    for (size_t i = 0; i < routeCount; ++i) {
+        const jint* d = desc.data() + i * R_COUNT;
+        CanGwRoute& r = routes[i];
+        auto jSrc = static_cast<jstring>(env->GetObjectArrayElement(jInterfaces, static_cast<jsize>(i * 2)));
+        auto jDst = static_cast<jstring>(env->GetObjectArrayElement(jInterfaces, static_cast<jsize>(i * 2 + 1)));
+        r.src = JStringToString(env, jSrc);
+        r.dst = JStringToString(env, jDst);
+        env->DeleteLocalRef(jSrc);
+        env->DeleteLocalRef(jDst);
+        r.hasFilter = d[R_HAS_FILTER] != 0;
+        r.filterSpec[0] = d[R_FILTER_ID];
+        r.filterSpec[1] = d[R_FILTER_MASK];
+        r.filterSpec[2] = d[R_FILTER_FLAGS];
+        r.fd = d[R_FD] != 0;
+        r.maxHops = d[R_MAX_HOPS];
+    }
+
+    for (size_t i = 0; i < modCount; ++i) {
+        const jint* d = modDesc.data() + i * M_COUNT;
+        if (d[M_ROUTE] < 0 || static_cast<size_t>(d[M_ROUTE]) >= routeCount) return -EINVAL;
+        if (d[M_LENGTH] < 0 || d[M_LENGTH] > CANFD_MAX_DLEN) return -EINVAL;
+        CanGwMod m;
+        m.op = d[M_OP];
+        m.targets = d[M_TARGETS];
+        m.value.can_id = static_cast<canid_t>(d[M_ID]);
+        m.value.len = static_cast<uint8_t>(d[M_LENGTH]);
+        if (d[M_FLAGS] & CAN_FLAG_BRS) m.value.flags |= CANFD_BRS;
+        if (d[M_FLAGS] & CAN_FLAG_ESI) m.value.flags |= CANFD_ESI;
+        memcpy(m.value.data, modData.data() + i * CANFD_MAX_DLEN, CANFD_MAX_DLEN);
+        routes[static_cast<size_t>(d[M_ROUTE])].mods.push_back(m);
+    }
+
+    int err = 0;
+    CanGateway* gw = CanGateway::Create(std::move(routes), mode, &err);
+    if (gw == nullptr) return err;
+    LOGI("gateway created: %zu routes, mode=%d", routeCount, gw->Mode());
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(gw));
+}
+
+/**
+ * int mode(long gateway)
+ *
+ * @return 实际使用的后端（CAN_GW_MODE_KERNEL / CAN_GW_MODE_USERSPACE）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanGateway_mode(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    CanGateway* gw = FromHandle(handle);
+    if (gw == nullptr) return -EINVAL;
+    return gw->Mode();
+}
+
+/**
+ * int stats(long gateway, long[] out)
+ *
+ * 每条路由 [handled, dropped] 两项。
+ *
+ * @return 写入的项数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanGateway_stats(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlongArray jOut
+) {
+    CanGateway* gw = FromHandle(handle);
+    if (gw == nullptr || jOut == nullptr) return -EINVAL;
+    int count = gw->RouteCount();
+    if (env->GetArrayLength(jOut) < count * 2) return -EINVAL;
+
+    std::vector<CanGwRouteStats> stats(static_cast<size_t>(count));
+    int ret = gw->Stats(stats.data());
+    if (ret < 0) return ret;
+    std::vector<jlong> out(static_cast<size_t>(count) * 2);
+    for (size_t i = 0; i < stats.size(); ++i) {
+        out[i * 2] = static_cast<jlong>(stats[i].handled);
+        out[i * 2 + 1] = static_cast<jlong>(stats[i].dropped);
+    }
+    env->SetLongArrayRegion(jOut, 0, count * 2, out.data());
+    return count * 2;
+}
+
+/**
+ * void destroy(long gateway)
+ *
+ * 用户态后端必须先从 reactor 注销（NativeReactor.removeGateway）。
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeCanGateway_destroy(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    delete FromHandle(handle);
+}
+
+} // extern "C"
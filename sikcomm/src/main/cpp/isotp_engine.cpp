@@ -0,0 +1,409 @@
+#include "isotp_engine.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <utility>
+#include <sys/socket.h>
+
+// 协议控制信息（PCI）类型，首字节高 4 位
+static const int PCI_SF = 0;
+static const int PCI_FF = 1;
+static const int PCI_CF = 2;
+static const int PCI_FC = 3;
+
+// 连续收到 WAIT 的上限（N_WFTmax），超过视为对端放弃
+static const int ISOTP_MAX_WAIT_FRAMES = 10;
+
+// STmin 为 0 时一次 sendmmsg 推给内核的最大 CF 数
+static const int ISOTP_TX_BATCH = 64;
+
+// FD 帧填充（ISO 15765-2 要求 CAN FD 帧对齐 DLC 时填 0xCC）
+static const uint8_t ISOTP_FD_PAD = 0xCC;
+
+static const uint8_t kFdLens[] = {8, 12, 16, 20, 24, 32, 48, 64};
+
+static int64_t NowNs() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static uint8_t FdAlignLen(size_t len) {
+    if (len <= 8) return static_cast<uint8_t>(len);
+    for (uint8_t l : kFdLens) {
+        if (l >= len) return l;
+    }
+    return CANFD_MAX_DLEN;
+}
+
+/**
+ * STmin 原始编码换算成纳秒：0x00~0x7F 毫秒，0xF1~0xF9 为 100~900 微秒，其余保留值按 127ms 处理。
+ */
+static int64_t StMinNs(int stMin) {
+    if (stMin <= 0x7F) return static_cast<int64_t>(stMin) * 1000000LL;
+    if (stMin >= 0xF1 && stMin <= 0xF9) return static_cast<int64_t>(stMin - 0xF0) * 100000LL;
+    return 127 * 1000000LL;
+}
+
+IsoTpEngine::IsoTpEngine(int fd, const IsoTpOptions& options)
+        : fd_(fd), opt_(options), mtu_(options.fd ? CANFD_MTU : CAN_MTU) {
+    rxBuf_.reserve(std::min<size_t>(opt_.maxMessageSize, ISOTP_MAX_CLASSIC_MESSAGE));
+}
+
+int IsoTpEngine::Validate(const IsoTpOptions& o) {
+    if (o.fd) {
+        if (std::find(std::begin(kFdLens), std::end(kFdLens), o.txDl) == std::end(kFdLens)) {
+            return -EINVAL;
+        }
+    } else if (o.txDl != 8 || o.brs) {
+        return -EINVAL;
+    }
+    if (o.padding > 0xFF) return -EINVAL;
+    if (o.blockSize < 0 || o.blockSize > 0xFF) return -EINVAL;
+    if (o.stMin < 0 || (o.stMin > 0x7F && (o.stMin < 0xF1 || o.stMin > 0xF9))) return -EINVAL;
+    if (o.maxMessageSize == 0) return -EINVAL;
+    if (o.timeoutMs <= 0) return -EINVAL;
+    return 0;
+}
+
+void IsoTpEngine::Pop() {
+    if (ready_.empty()) return;
+    if (spare_.size() < 4) spare_.push_back(std::move(ready_.front()));
+    ready_.pop_front();
+}
+
+size_t IsoTpEngine::BuildFrame(struct canfd_frame* frame, const uint8_t* pdu, size_t len) const {
+    memset(frame, 0, sizeof(*frame));
+    frame->can_id = opt_.txId;
+    memcpy(frame->data, pdu, len);
+
+    size_t dlc = len;
+    uint8_t pad = ISOTP_FD_PAD;
+    if (opt_.padding >= 0) {
+        pad = static_cast<uint8_t>(opt_.padding);
+        dlc = std::max<size_t>(len, 8);
+    }
+    if (opt_.fd) {
+        dlc = FdAlignLen(dlc);
+        if (opt_.brs) frame->flags |= CANFD_BRS;
+    }
+    if (dlc > len) memset(frame->data + len, pad, dlc - len);
+    frame->len = static_cast<uint8_t>(dlc);
+    return mtu_;
+}
+
+int IsoTpEngine::ReadFrame(struct canfd_frame* frame, int timeoutMs) {
+    while (true) {
+        if (timeoutMs != 0) {
+            struct pollfd pfd{};
+            pfd.fd = fd_;
+            pfd.events = POLLIN;
+            int ret = poll(&pfd, 1, timeoutMs);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                return -errno;
+            }
+            if (ret == 0) return 0;
+        }
+
+        ssize_t n = recv(fd_, frame, sizeof(*frame), MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -errno;
+        }
+        if (static_cast<size_t>(n) != CAN_MTU && static_cast<size_t>(n) != CANFD_MTU) continue;
+        // 内核过滤器已经只放行 rxId，这里兜底排除远程帧 / 错误帧
+        if (frame->can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) continue;
+        if (frame->can_id != opt_.rxId) continue;
+        return 1;
+    }
+}
+
+void IsoTpEngine::AbortRx() {
+    if (rxActive_) ++rxAborts_;
+    rxActive_ = false;
+    rxBuf_.clear();
+}
+
+void IsoTpEngine::ExpireRx(int64_t nowNs) {
+    if (rxActive_ && nowNs - rxLastNs_ > static_cast<int64_t>(opt_.timeoutMs) * 1000000LL) {
+        AbortRx();   // N_Cr 超时
+    }
+}
+
+void IsoTpEngine::Deliver(const uint8_t* data, size_t len) {
+    std::vector<uint8_t> message;
+    if (!spare_.empty()) {
+        message = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    message.assign(data, data + len);
+    ready_.push_back(std::move(message));
+}
+
+void IsoTpEngine::Process(const struct canfd_frame& frame, int64_t nowNs) {
+    if (frame.len < 1) return;
+    const uint8_t* d = frame.data;
+    size_t flen = frame.len;
+
+    switch (d[0] >> 4) {
+        case PCI_SF: {
+            size_t dl = d[0] & 0x0F;
+            size_t off = 1;
+            if (dl == 0) {
+                // FD 单帧转义：长度在第二个字节
+                if (flen <= 8) return;
+                dl = d[1];
+                off = 2;
+            }
+            if (dl == 0 || off + dl > flen) return;
+            AbortRx();   // 新报文打断未完成的接收
+            Deliver(d + off, dl);
+            break;
+        }
+
+        case PCI_FF: {
+            if (flen < 8) return;
+            size_t total = (static_cast<size_t>(d[0] & 0x0F) << 8) | d[1];
+            size_t off = 2;
+            if (total == 0) {
+                // FF 转义：32 位长度
+                total = (static_cast<size_t>(d[2]) << 24) | (static_cast<size_t>(d[3]) << 16) |
+                        (static_cast<size_t>(d[4]) << 8) | d[5];
+                off = 6;
+            }
+            if (total <= flen - off) return;
+            AbortRx();
+            if (total > opt_.maxMessageSize) {
+                SendFc(ISOTP_FC_OVFLW);
+                return;
+            }
+            rxBuf_.assign(d + off, d + flen);
+            rxTotal_ = total;
+            rxSn_ = 1;
+            rxBsLeft_ = opt_.blockSize;
+            rxLastNs_ = nowNs;
+            rxActive_ = true;
+            SendFc(ISOTP_FC_CTS);
+            break;
+        }
+
+        case PCI_CF: {
+            if (!rxActive_) return;
+            if ((d[0] & 0x0F) != rxSn_) {
+                AbortRx();
+                return;
+            }
+            size_t n = std::min(rxTotal_ - rxBuf_.size(), flen - 1);
+            rxBuf_.insert(rxBuf_.end(), d + 1, d + 1 + n);
+            rxSn_ = static_cast<uint8_t>((rxSn_ + 1) & 0x0F);
+            rxLastNs_ = nowNs;
+            if (rxBuf_.size() == rxTotal_) {
+                rxActive_ = false;
+                Deliver(rxBuf_.data(), rxBuf_.size());
+                rxBuf_.clear();
+            } else if (opt_.blockSize > 0 && --rxBsLeft_ == 0) {
+                rxBsLeft_ = opt_.blockSize;
+                SendFc(ISOTP_FC_CTS);
+            }
+            break;
+        }
+
+        case PCI_FC:
+            if (!txWaitingFc_ || flen < 3) return;
+            fcStatus_ = d[0] & 0x0F;
+            fcBs_ = d[1];
+            fcStMin_ = d[2];
+            fcReceived_ = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+int IsoTpEngine::SendFc(int status) {
+    uint8_t pdu[3] = {
+            static_cast<uint8_t>((PCI_FC << 4) | status),
+            static_cast<uint8_t>(opt_.blockSize),
+            static_cast<uint8_t>(opt_.stMin)
+    };
+    struct canfd_frame frame;
+    size_t mtu = BuildFrame(&frame, pdu, sizeof(pdu));
+    ssize_t n = send(fd_, &frame, mtu, MSG_DONTWAIT);
+    return (n < 0) ? -errno : 0;
+}
+
+int IsoTpEngine::WriteFrames(struct canfd_frame* frames, int count, int64_t deadlineNs) {
+    struct iovec iov[ISOTP_TX_BATCH];
+    struct mmsghdr msgs[ISOTP_TX_BATCH];
+    memset(msgs, 0, sizeof(struct mmsghdr) * count);
+    for (int i = 0; i < count; ++i) {
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = mtu_;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int done = 0;
+    while (done < count) {
+        int n = sendmmsg(fd_, msgs + done, static_cast<unsigned int>(count - done), MSG_DONTWAIT);
+        if (n > 0) {
+            done += n;
+            continue;
+        }
+        int err = (n < 0) ? errno : EAGAIN;
+        if (err == EINTR) continue;
+        if (err != ENOBUFS && err != EAGAIN && err != EWOULDBLOCK) return -err;
+
+        int64_t remain = deadlineNs - NowNs();
+        if (remain <= 0) return -ETIMEDOUT;
+        if (err == ENOBUFS) {
+            // 发送队列（txqueuelen）满，poll 等不到，短暂退避
+            struct timespec ts{};
+            ts.tv_nsec = std::min<int64_t>(remain, 200 * 1000LL);
+            nanosleep(&ts, nullptr);
+        } else {
+            struct pollfd pfd{};
+            pfd.fd = fd_;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, static_cast<int>(remain / 1000000LL) + 1);
+        }
+    }
+    return 0;
+}
+
+int IsoTpEngine::WaitFc(int64_t deadlineNs) {
+    txWaitingFc_ = true;
+    fcReceived_ = false;
+    struct canfd_frame frame;
+    int ret = 0;
+    while (!fcReceived_) {
+        int64_t remain = deadlineNs - NowNs();
+        if (remain <= 0) {
+            ret = -ETIMEDOUT;   // N_Bs 超时
+            break;
+        }
+        int r = ReadFrame(&frame, static_cast<int>(remain / 1000000LL) + 1);
+        if (r < 0) {
+            ret = r;
+            break;
+        }
+        if (r > 0) Process(frame, NowNs());
+    }
+    txWaitingFc_ = false;
+    return ret;
+}
+
+int IsoTpEngine::Send(const uint8_t* data, size_t len, int timeoutMs) {
+    if (len == 0) return -EINVAL;
+    if (len > UINT32_MAX) return -EMSGSIZE;
+
+    size_t dl = static_cast<size_t>(opt_.txDl);
+    int64_t deadline = NowNs() + static_cast<int64_t>(std::max(timeoutMs, 0)) * 1000000LL;
+    uint8_t pdu[CANFD_MAX_DLEN];
+    struct canfd_frame frames[ISOTP_TX_BATCH];
+
+    // 单帧：<= 7 字节用 4 位长度，FD 下更长的单帧用转义格式
+    size_t sfMax = (dl == 8) ? 7 : dl - 2;
+    if (len <= sfMax) {
+        size_t off;
+        if (len <= 7) {
+            pdu[0] = static_cast<uint8_t>((PCI_SF << 4) | len);
+            off = 1;
+        } else {
+            pdu[0] = PCI_SF << 4;
+            pdu[1] = static_cast<uint8_t>(len);
+            off = 2;
+        }
+        memcpy(pdu + off, data, len);
+        BuildFrame(&frames[0], pdu, off + len);
+        int ret = WriteFrames(frames, 1, deadline);
+        return ret < 0 ? ret : static_cast<int>(len);
+    }
+
+    // 首帧
+    size_t off;
+    if (len <= ISOTP_MAX_CLASSIC_MESSAGE) {
+        pdu[0] = static_cast<uint8_t>((PCI_FF << 4) | (len >> 8));
+        pdu[1] = static_cast<uint8_t>(len);
+        off = 2;
+    } else {
+        pdu[0] = PCI_FF << 4;
+        pdu[1] = 0;
+        pdu[2] = static_cast<uint8_t>(len >> 24);
+        pdu[3] = static_cast<uint8_t>(len >> 16);
+        pdu[4] = static_cast<uint8_t>(len >> 8);
+        pdu[5] = static_cast<uint8_t>(len);
+        off = 6;
+    }
+    size_t pos = dl - off;
+    memcpy(pdu + off, data, pos);
+    BuildFrame(&frames[0], pdu, dl);
+    int ret = WriteFrames(frames, 1, deadline);
+    if (ret < 0) return ret;
+
+    uint8_t sn = 1;
+    int waits = 0;
+    while (pos < len) {
+        ret = WaitFc(NowNs() + static_cast<int64_t>(opt_.timeoutMs) * 1000000LL);
+        if (ret < 0) return ret;
+        if (fcStatus_ == ISOTP_FC_WAIT) {
+            if (++waits > ISOTP_MAX_WAIT_FRAMES) return -ETIMEDOUT;
+            continue;
+        }
+        if (fcStatus_ == ISOTP_FC_OVFLW) return -EMSGSIZE;
+        if (fcStatus_ != ISOTP_FC_CTS) return -EPROTO;
+        waits = 0;
+
+        size_t blockLeft = (fcBs_ == 0) ? SIZE_MAX : static_cast<size_t>(fcBs_);
+        int64_t gapNs = StMinNs(fcStMin_);
+        int64_t next = NowNs();
+
+        while (pos < len && blockLeft > 0) {
+            // STmin = 0 时整批推给内核；否则逐帧按 STmin 间隔绝对定时发送
+            int batch = (gapNs == 0)
+                        ? static_cast<int>(std::min<size_t>(blockLeft, ISOTP_TX_BATCH)) : 1;
+            int count = 0;
+            while (count < batch && pos < len) {
+                size_t n = std::min(dl - 1, len - pos);
+                pdu[0] = static_cast<uint8_t>((PCI_CF << 4) | sn);
+                memcpy(pdu + 1, data + pos, n);
+                BuildFrame(&frames[count++], pdu, n + 1);
+                pos += n;
+                sn = static_cast<uint8_t>((sn + 1) & 0x0F);
+            }
+            if (gapNs > 0) {
+                struct timespec ts{};
+                ts.tv_sec = next / 1000000000LL;
+                ts.tv_nsec = next % 1000000000LL;
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+            }
+            ret = WriteFrames(frames, count, deadline);
+            if (ret < 0) return ret;
+            next = NowNs() + gapNs;
+            blockLeft -= static_cast<size_t>(count);
+        }
+    }
+    return static_cast<int>(len);
+}
+
+int IsoTpEngine::Poll(int timeoutMs) {
+    struct canfd_frame frame;
+    int wait = ready_.empty() ? timeoutMs : 0;
+    while (true) {
+        int r = ReadFrame(&frame, wait);
+        if (r < 0) return r;
+        int64_t now = NowNs();
+        ExpireRx(now);
+        if (r == 0) break;
+        Process(frame, now);
+        wait = 0;
+    }
+    return static_cast<int>(ready_.size());
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <linux/can.h>
+
+/**
+ * 用户态 ISO-TP（ISO 15765-2）引擎：在 CAN_RAW socket 上做分段 / 重组、流控（FC）、BS / STmin。
+ *
+ * 只在内核没有 CAN_ISOTP（< 5.10 或未编译该模块）时使用，由 isotp_jni.cpp 包装给 Kotlin。
+ * 纯 C++，不依赖 JNI；同一个实例同一时刻只允许一个线程调用（JNI 层加锁）。
+ *
+ * 只支持普通寻址（normal addressing），收发各一个 CAN ID。
+ */
+
+// FC 帧状态（FlowStatus）
+static const int ISOTP_FC_CTS   = 0;
+static const int ISOTP_FC_WAIT  = 1;
+static const int ISOTP_FC_OVFLW = 2;
+
+// 经典 FF 能表达的最大报文长度，再长需要 FF 转义（32 位长度）
+static const size_t ISOTP_MAX_CLASSIC_MESSAGE = 4095;
+
+struct IsoTpOptions {
+    canid_t txId = 0;            // 已按需带 CAN_EFF_FLAG
+    canid_t rxId = 0;
+    bool fd = false;             // 以 CAN FD 帧收发
+    bool brs = false;            // FD 帧是否带 BRS
+    int txDl = 8;                // 发送帧数据长度：8 / 12 / 16 / 20 / 24 / 32 / 48 / 64
+    int padding = 0xCC;          // 发送帧填充字节，<0 表示经典帧不填充（FD 帧总要对齐 DLC，用 0xCC）
+    int blockSize = 0;           // 接收时在 FC 里告诉对端的 BS，0 表示不分块
+    int stMin = 0;               // 接收时在 FC 里告诉对端的 STmin（原始编码）
+    size_t maxMessageSize = ISOTP_MAX_CLASSIC_MESSAGE;
+    int timeoutMs = 1000;        // N_Bs（等 FC）/ N_Cr（等 CF）
+};
+
+class IsoTpEngine {
+public:
+    IsoTpEngine(int fd, const IsoTpOptions& options);
+
+    /**
+     * 检查配置是否合法。
+     *
+     * @return 0: 合法；-EINVAL: 不合法
+     */
+    static int Validate(const IsoTpOptions& options);
+
+    /**
+     * 发送一条完整报文，阻塞到最后一帧交给内核（或出错）。
+     *
+     * 等 FC 期间收到的其它帧照常进入接收状态机，不会丢。
+     * 对端 STmin 为 0 时，整块 CF 用 sendmmsg 一次推给内核，让总线保持满载。
+     *
+     * @param timeoutMs 发送队列满（ENOBUFS）时整次发送最多等待的时间（毫秒）
+     * @return >=0: 发送的字节数；<0: -errno（ETIMEDOUT: 等 FC 超时；EMSGSIZE: 对端溢出）
+     */
+    int Send(const uint8_t* data, size_t len, int timeoutMs);
+
+    /**
+     * 把 socket 里已有的帧读完并送进接收状态机（第一次等待至多 timeoutMs）。
+     *
+     * @return >=0: 当前可取的完整报文数；<0: -errno
+     */
+    int Poll(int timeoutMs);
+
+    bool HasMessage() const { return !ready_.empty(); }
+    size_t PendingMessages() const { return ready_.size(); }
+    const std::vector<uint8_t>& Front() const { return ready_.front(); }
+    void Pop();
+
+    /** 因序号错 / 超时 / 被新报文打断而放弃的接收次数 */
+    uint64_t RxAborts() const { return rxAborts_; }
+
+private:
+    int ReadFrame(struct canfd_frame* frame, int timeoutMs);
+    void Process(const struct canfd_frame& frame, int64_t nowNs);
+    void ExpireRx(int64_t nowNs);
+    void AbortRx();
+    void Deliver(const uint8_t* data, size_t len);
+
+    size_t BuildFrame(struct canfd_frame* frame, const uint8_t* pdu, size_t len) const;
+    int SendFc(int status);
+    int WriteFrames(struct canfd_frame* frames, int count, int64_t deadlineNs);
+    int WaitFc(int64_t deadlineNs);
+
+    int fd_;
+    IsoTpOptions opt_;
+    size_t mtu_;
+
+    // 接收状态机
+    bool rxActive_ = false;
+    size_t rxTotal_ = 0;
+    uint8_t rxSn_ = 0;
+    int rxBsLeft_ = 0;
+    int64_t rxLastNs_ = 0;
+    std::vector<uint8_t> rxBuf_;
+    std::deque<std::vector<uint8_t>> ready_;
+    std::vector<std::vector<uint8_t>> spare_;
+    uint64_t rxAborts_ = 0;
+
+    // 发送等 FC
+    bool txWaitingFc_ = false;
+    bool fcReceived_ = false;
+    int fcStatus_ = 0;
+    int fcBs_ = 0;
+    int fcStMin_ = 0;
+};
@@ -0,0 +1,495 @@
+#include <jni.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#if __has_include(<linux/can/isotp.h>)
+#include <linux/can/isotp.h>
+#endif
+
+#define LOG_TAG "NativeIsoTp"
+#include "comm_log.h"
+#include "comm_metrics.h"
+#include "isotp_engine.h"
+
+// 旧版 NDK 的 uapi 头文件里没有 CAN_ISOTP（内核 5.10 合入），按内核定义补齐
+#ifndef CAN_ISOTP
+#define CAN_ISOTP 6
+#endif
+#ifndef SOL_CAN_ISOTP
+#define SOL_CAN_ISOTP (SOL_CAN_BASE + CAN_ISOTP)
+#define CAN_ISOTP_OPTS          1
+#define CAN_ISOTP_RECV_FC       2
+#define CAN_ISOTP_LL_OPTS       5
+#define CAN_ISOTP_TX_PADDING    0x0004
+#define CAN_ISOTP_WAIT_TX_DONE  0x0400
+struct can_isotp_options {
+    __u32 flags;
+    __u32 frame_txtime;
+    __u8 ext_address;
+    __u8 txpad_content;
+    __u8 rxpad_content;
+    __u8 rx_ext_address;
+};
+struct can_isotp_fc_options {
+    __u8 bs;
+    __u8 stmin;
+    __u8 wftmax;
+};
+struct can_isotp_ll_options {
+    __u8 mtu;
+    __u8 tx_dl;
+    __u8 tx_flags;
+};
+#endif
+#ifndef CAN_ISOTP_FRAME_TXTIME_ZERO
+#define CAN_ISOTP_FRAME_TXTIME_ZERO 0xFFFFFFFF
+#endif
+
+// open() flags（和 Kotlin NativeIsoTp.FLAG_* 保持一致）
+static const int ISOTP_FLAG_EXTENDED = 0x01;
+static const int ISOTP_FLAG_FD       = 0x02;
+static const int ISOTP_FLAG_BRS      = 0x04;
+static const int ISOTP_FLAG_KERNEL   = 0x08;
+
+// open() 参数数组下标（和 Kotlin NativeIsoTp.P_* 保持一致）
+static const int P_TX_DL            = 0;
+static const int P_PADDING          = 1;
+static const int P_BLOCK_SIZE       = 2;
+static const int P_ST_MIN           = 3;
+static const int P_MAX_MESSAGE_SIZE = 4;
+static const int P_TIMEOUT_MS       = 5;
+static const int P_COUNT            = 6;
+
+/**
+ * ISO-TP 句柄：内核 CAN_ISOTP socket，或 CAN_RAW socket + 用户态引擎。
+ */
+struct IsoTpHandle {
+    int fd = -1;
+    bool kernel = false;
+    IsoTpEngine* engine = nullptr;
+    // 用户态引擎的发送要在同一个 socket 上等 FC，和读循环互斥
+    std::mutex lock;
+    // 内核模式下的接收缓冲区（只有读循环使用）
+    std::vector<uint8_t> rxBuf;
+};
+
+static IsoTpHandle* FromHandle(jlong handle) {
+    return reinterpret_cast<IsoTpHandle*>(static_cast<intptr_t>(handle));
+}
+
+static canid_t MakeId(jint id, bool extended) {
+    return extended ? ((static_cast<canid_t>(id) & CAN_EFF_MASK) | CAN_EFF_FLAG)
+                    : (static_cast<canid_t>(id) & CAN_SFF_MASK);
+}
+
+/**
+ * 打开内核 ISO-TP socket。
+ *
+ * - frame_txtime 置零：CF 之间不额外插 50us 间隔，由对端 FC 的 STmin 决定节奏
+ * - WAIT_TX_DONE：write 阻塞到整条报文发完，返回值即发送结果
+ * - FD 时通过 LL_OPTS 设置 mtu / tx_dl / BRS
+ *
+ * @return >=0: fd；<0: -errno（EPROTONOSUPPORT 表示内核没有 CAN_ISOTP）
+ */
+static int OpenKernel(int ifindex, const IsoTpOptions& o) {
+    int fd = ::socket(PF_CAN, SOCK_DGRAM | SOCK_CLOEXEC, CAN_ISOTP);
+    if (fd < 0) return -errno;
+
+    struct can_isotp_options opts{};
+    opts.flags = CAN_ISOTP_WAIT_TX_DONE;
+    opts.frame_txtime = CAN_ISOTP_FRAME_TXTIME_ZERO;
+    if (o.padding >= 0) {
+        opts.flags |= CAN_ISOTP_TX_PADDING;
+        opts.txpad_content = static_cast<__u8>(o.padding);
+    }
+
+    struct can_isotp_fc_options fc{};
+    fc.bs = static_cast<__u8>(o.blockSize);
+    fc.stmin = static_cast<__u8>(o.stMin);
+
+    int ret = 0;
+    if (setsockopt(fd, SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &opts, sizeof(opts)) < 0 ||
+        setsockopt(fd, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC, &fc, sizeof(fc)) < 0) {
+        ret = -errno;
+    }
+    if (ret == 0 && o.fd) {
+        struct can_isotp_ll_options ll{};
+        ll.mtu = CANFD_MTU;
+        ll.tx_dl = static_cast<__u8>(o.txDl);
+        ll.tx_flags = o.brs ? CANFD_BRS : 0;
+        if (setsockopt(fd, SOL_CAN_ISOTP, CAN_ISOTP_LL_OPTS, &ll, sizeof(ll)) < 0) ret = -errno;
+    }
+    if (ret == 0) {
+        struct sockaddr_can addr{};
+        addr.can_family = AF_CAN;
+        addr.can_ifindex = ifindex;
+        addr.can_addr.tp.rx_id = o.rxId;
+        addr.can_addr.tp.tx_id = o.txId;
+        if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) ret = -errno;
+    }
+    if (ret < 0) {
+        ::close(fd);
+        return ret;
+    }
+    return fd;
+}
+
+/**
+ * 打开用户态引擎使用的 CAN_RAW socket，内核过滤器只放行 rxId。
+ *
+ * @return >=0: fd；<0: -errno
+ */
+static int OpenRaw(int ifindex, const IsoTpOptions& o) {
+    int fd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) return -errno;
+
+    struct can_filter filter{};
+    filter.can_id = o.rxId;
+    filter.can_mask = (o.rxId & CAN_EFF_FLAG) ? (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK)
+                                              : (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_SFF_MASK);
+    int enable = 1;
+    int ret = 0;
+    if (o.fd && setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) < 0) {
+        ret = -errno;
+    }
+    if (ret == 0 && setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter)) < 0) {
+        ret = -errno;
+    }
+    if (ret == 0) {
+        struct sockaddr_can addr{};
+        addr.can_family = AF_CAN;
+        addr.can_ifindex = ifindex;
+        if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) ret = -errno;
+    }
+    if (ret < 0) {
+        ::close(fd);
+        return ret;
+    }
+    return fd;
+}
+
+/**
+ * 用户态引擎：取出一条完整报文写进 out。
+ *
+ * @return >0: 报文长度；0: 没有报文；<0: -errno（EMSGSIZE: out 放不下，报文已丢弃）
+ */
+static jint TakeMessage(JNIEnv* env, IsoTpEngine* engine, jbyteArray out, ChannelMetrics* m) {
+    if (!engine->HasMessage()) return 0;
+    const std::vector<uint8_t>& msg = engine->Front();
+    jsize cap = env->GetArrayLength(out);
+    jint ret;
+    if (msg.size() > static_cast<size_t>(cap)) {
+        LOGW("receive: message of %zu bytes exceeds buffer (%d), dropped", msg.size(), cap);
+        MetricsError(m, EMSGSIZE);
+        ret = -EMSGSIZE;
+    } else {
+        env->SetByteArrayRegion(out, 0, static_cast<jsize>(msg.size()),
+                                reinterpret_cast<const jbyte*>(msg.data()));
+        if (m != nullptr) {
+            MetricsAdd(m->bytesIn, msg.size());
+            MetricsAdd(m->framesIn, 1);
+        }
+        ret = static_cast<jint>(msg.size());
+    }
+    engine->Pop();
+    return ret;
+}
+
+extern "C" {
+
+/**
+ * long open(String ifName, int txId, int rxId, int flags, int[] params)
+ *
+ * flags 带 ISOTP_FLAG_KERNEL 时优先使用内核 CAN_ISOTP，打不开（内核不支持）再退回用户态引擎。
+ *
+ * @return >0: 句柄（native 指针）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeIsoTp_open(
+        JNIEnv* env,
+        jclass,
+        jstring jIfName,
+        jint txId,
+        jint rxId,
+        jint flags,
+        jintArray params
+) {
+    if (jIfName == nullptr || params == nullptr || env->GetArrayLength(params) < P_COUNT) {
+        return -EINVAL;
+    }
+    jint p[P_COUNT];
+    env->GetIntArrayRegion(params, 0, P_COUNT, p);
+
+    const char* chars = env->GetStringUTFChars(jIfName, nullptr);
+    if (chars == nullptr) return -ENOMEM;
+    std::string ifName(chars);
+    env->ReleaseStringUTFChars(jIfName, chars);
+
+    bool extended = (flags & ISOTP_FLAG_EXTENDED) != 0;
+    IsoTpOptions o;
+    o.txId = MakeId(txId, extended);
+    o.rxId = MakeId(rxId, extended);
+    o.fd = (flags & ISOTP_FLAG_FD) != 0;
+    o.brs = (flags & ISOTP_FLAG_BRS) != 0;
+    o.txDl = p[P_TX_DL];
+    o.padding = p[P_PADDING];
+    o.blockSize = p[P_BLOCK_SIZE];
+    o.stMin = p[P_ST_MIN];
+    o.maxMessageSize = static_cast<size_t>(p[P_MAX_MESSAGE_SIZE] > 0 ? p[P_MAX_MESSAGE_SIZE] : 0);
+    o.timeoutMs = p[P_TIMEOUT_MS];
+    if (IsoTpEngine::Validate(o) < 0) {
+        LOGE("open: invalid ISO-TP options, txDl=%d, bs=%d, stMin=0x%x",
+             o.txDl, o.blockSize, o.stMin);
+        return -EINVAL;
+    }
+
+    int ifindex = static_cast<int>(if_nametoindex(ifName.c_str()));
+    if (ifindex == 0) {
+        int err = errno;
+        LOGE("open: if_nametoindex(%s) failed: %s", ifName.c_str(), strerror(err));
+        return -err;
+    }
+
+    auto* h = new (std::nothrow) IsoTpHandle();
+    if (h == nullptr) return -ENOMEM;
+
+    int fd = -1;
+    if (flags & ISOTP_FLAG_KERNEL) {
+        fd = OpenKernel(ifindex, o);
+        if (fd >= 0) {
+            h->kernel = true;
+            h->rxBuf.resize(o.maxMessageSize);
+        } else {
+            LOGW("open: kernel CAN_ISOTP on %s unavailable (%s), using user-space engine",
+                 ifName.c_str(), strerror(-fd));
+        }
+    }
+    if (fd < 0) {
+        fd = OpenRaw(ifindex, o);
+        if (fd < 0) {
+            LOGE("open: CAN_RAW socket on %s failed: %s", ifName.c_str(), strerror(-fd));
+            delete h;
+            return fd;
+        }
+        h->engine = new (std::nothrow) IsoTpEngine(fd, o);
+        if (h->engine == nullptr) {
+            ::close(fd);
+            delete h;
+            return -ENOMEM;
+        }
+    }
+    h->fd = fd;
+    MetricsAttach(fd);
+
+    LOGI("ISO-TP open(%s) tx=0x%x rx=0x%x, %s, fd=%d", ifName.c_str(), o.txId, o.rxId,
+         h->kernel ? "kernel" : "user-space", fd);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(h));
+}
+
+/**
+ * long fd(long handle)
+ *
+ * 底层 socket 的 fd，用于注册 reactor 和读取统计。
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeIsoTp_fd(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    IsoTpHandle* h = FromHandle(handle);
+    return h != nullptr ? static_cast<jlong>(h->fd) : -EBADF;
+}
+
+/**
+ * boolean isKernel(long handle)
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_sik_comm_NativeIsoTp_isKernel(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    IsoTpHandle* h = FromHandle(handle);
+    return (h != nullptr && h->kernel) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * int send(long handle, byte[] data, int offset, int length, int timeoutMs)
+ *
+ * 阻塞到整条报文发完（内核模式 WAIT_TX_DONE；用户态引擎发完最后一个 CF）。
+ *
+ * @return >=0: 发送的字节数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeIsoTp_send(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jbyteArray jData,
+        jint offset,
+        jint length,
+        jint timeoutMs
+) {
+    IsoTpHandle* h = FromHandle(handle);
+    if (h == nullptr || h->fd < 0) return -EBADF;
+    if (jData == nullptr || offset < 0 || length <= 0 ||
+        offset > env->GetArrayLength(jData) - length) {
+        return -EINVAL;
+    }
+
+    // 报文要在阻塞发送期间一直可用，不能用临界区，拷一份
+    std::vector<uint8_t> data(static_cast<size_t>(length));
+    env->GetByteArrayRegion(jData, offset, length, reinterpret_cast<jbyte*>(data.data()));
+
+    ChannelMetrics* m = MetricsFor(h->fd);
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    int ret;
+    if (h->kernel) {
+        struct pollfd pfd{};
+        pfd.fd = h->fd;
+        pfd.events = POLLOUT;
+        int pr;
+        do {
+            pr = MetricsPoll(&pfd, timeoutMs, m);
+        } while (pr < 0 && errno == EINTR);
+        if (pr <= 0) return (pr == 0) ? 0 : -errno;
+
+        ssize_t n;
+        do {
+            n = ::write(h->fd, data.data(), data.size());
+        } while (n < 0 && errno == EINTR);
+        ret = (n < 0) ? -errno : static_cast<int>(n);
+    } else {
+        std::lock_guard<std::mutex> guard(h->lock);
+        ret = h->engine->Send(data.data(), data.size(), timeoutMs);
+    }
+
+    if (ret < 0) {
+        MetricsError(m, -ret);
+        LOGE("send: %d bytes failed: %s", length, strerror(-ret));
+        return ret;
+    }
+    if (m != nullptr) {
+        m->syscall.Record(MetricsNowNs() - start);
+        MetricsAdd(m->bytesOut, static_cast<uint64_t>(ret));
+        MetricsAdd(m->framesOut, 1);
+    }
+    LOGV("send: %d bytes", ret);
+    return ret;
+}
+
+/**
+ * int receive(long handle, byte[] out, int timeoutMs)
+ *
+ * 取一条完整报文写进 out（从下标 0 开始）。
+ *
+ * @return >0: 报文长度；0: 超时无报文；<0: -errno（EMSGSIZE: out 放不下，报文已丢弃）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeIsoTp_receive(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jbyteArray out,
+        jint timeoutMs
+) {
+    IsoTpHandle* h = FromHandle(handle);
+    if (h == nullptr || h->fd < 0) return -EBADF;
+    if (out == nullptr) return -EINVAL;
+
+    ChannelMetrics* m = MetricsFor(h->fd);
+
+    if (!h->kernel) {
+        std::lock_guard<std::mutex> guard(h->lock);
+        if (!h->engine->HasMessage()) {
+            int ret = h->engine->Poll(timeoutMs);
+            if (ret < 0 && ret != -EINTR) {
+                MetricsError(m, -ret);
+                LOGE("receive: poll failed: %s", strerror(-ret));
+                return ret;
+            }
+        }
+        return TakeMessage(env, h->engine, out, m);
+    }
+
+    struct pollfd pfd{};
+    pfd.fd = h->fd;
+    pfd.events = POLLIN;
+    int pr = MetricsPoll(&pfd, timeoutMs, m);
+    if (pr < 0) return (errno == EINTR) ? 0 : -errno;
+    if (pr == 0) return 0;
+
+    // MSG_TRUNC 让 recv 返回报文真实长度，用来发现缓冲区不够
+    ssize_t n = recv(h->fd, h->rxBuf.data(), h->rxBuf.size(), MSG_DONTWAIT | MSG_TRUNC);
+    if (n < 0) {
+        int err = errno;
+        if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) return 0;
+        // 内核在 N_Cr 超时 / 序号错等协议错误时通过 socket 错误上报，报文已丢弃
+        MetricsError(m, err);
+        LOGW("receive: recv failed: %s", strerror(err));
+        return (err == ECOMM || err == EILSEQ || err == ETIMEDOUT || err == EBADMSG) ? 0 : -err;
+    }
+    jsize cap = env->GetArrayLength(out);
+    if (static_cast<size_t>(n) > h->rxBuf.size() || n > cap) {
+        LOGW("receive: message of %zd bytes exceeds buffer, dropped", n);
+        MetricsError(m, EMSGSIZE);
+        return -EMSGSIZE;
+    }
+    env->SetByteArrayRegion(out, 0, static_cast<jsize>(n),
+                            reinterpret_cast<const jbyte*>(h->rxBuf.data()));
+    if (m != nullptr) {
+        MetricsAdd(m->bytesIn, static_cast<uint64_t>(n));
+        MetricsAdd(m->framesIn, 1);
+    }
+    return static_cast<jint>(n);
+}
+
+/**
+ * int pending(long handle)
+ *
+ * 用户态引擎在发送等 FC 期间顺带收完、还没取走的报文数（内核模式总是 0）。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeIsoTp_pending(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    IsoTpHandle* h = FromHandle(handle);
+    if (h == nullptr || h->kernel) return 0;
+    std::lock_guard<std::mutex> guard(h->lock);
+    return static_cast<jint>(h->engine->PendingMessages());
+}
+
+/**
+ * void close(long handle)
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeIsoTp_close(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    IsoTpHandle* h = FromHandle(handle);
+    if (h == nullptr) return;
+    if (h->engine != nullptr && h->engine->RxAborts() > 0) {
+        LOGW("ISO-TP closed, %llu receptions aborted",
+             static_cast<unsigned long long>(h->engine->RxAborts()));
+    }
+    if (h->fd >= 0) ::close(h->fd);
+    delete h->engine;
+    delete h;
+    LOGI("ISO-TP close()");
+}
+
+} // extern "C"
@@ -0,0 +1,90 @@
+#include <jni.h>
+#include <errno.h>
+#include "comm_metrics.h"
+
+// snapshot 输出布局（和 Kotlin NativeMetrics.IDX_* 保持一致）
+enum SnapshotIndex {
+    SNAP_BYTES_IN = 0,
+    SNAP_BYTES_OUT,
+    SNAP_FRAMES_IN,
+    SNAP_FRAMES_OUT,
+    SNAP_POLL_TIMEOUTS,
+    SNAP_ERRORS,
+    SNAP_POLL_WAIT,                  // 之后 6 项：count / mean / p50 / p90 / p99 / max
+    SNAP_SYSCALL = SNAP_POLL_WAIT + 6, // 同上
+    SNAP_SIZE = SNAP_SYSCALL + 6
+};
+
+static void FillHistogram(jlong* out, const LatencyHistogram& h) {
+    uint64_t count = h.count.load(std::memory_order_relaxed);
+    out[0] = static_cast<jlong>(count);
+    out[1] = count == 0 ? 0 : static_cast<jlong>(h.sumNs.load(std::memory_order_relaxed) / count);
+    out[2] = static_cast<jlong>(h.Percentile(0.50));
+    out[3] = static_cast<jlong>(h.Percentile(0.90));
+    out[4] = static_cast<jlong>(h.Percentile(0.99));
+    out[5] = static_cast<jlong>(h.maxNs.load(std::memory_order_relaxed));
+}
+
+extern "C" {
+
+/**
+ * int snapshot(long handle, long[] out)
+ *
+ * 把 handle 对应通道的计数器和直方图摘要写到 out（布局见 SnapshotIndex）。
+ *
+ * @return 写入的项数；<0: 错误（-ENOENT 表示该通道没有统计）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeMetrics_snapshot(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlongArray jOut
+) {
+    if (jOut == nullptr || env->GetArrayLength(jOut) < SNAP_SIZE) return -EINVAL;
+    ChannelMetrics* m = MetricsFor(static_cast<int>(handle));
+    if (m == nullptr) return -ENOENT;
+
+    jlong out[SNAP_SIZE];
+    out[SNAP_BYTES_IN] = static_cast<jlong>(m->bytesIn.load(std::memory_order_relaxed));
+    out[SNAP_BYTES_OUT] = static_cast<jlong>(m->bytesOut.load(std::memory_order_relaxed));
+    out[SNAP_FRAMES_IN] = static_cast<jlong>(m->framesIn.load(std::memory_order_relaxed));
+    out[SNAP_FRAMES_OUT] = static_cast<jlong>(m->framesOut.load(std::memory_order_relaxed));
+    out[SNAP_POLL_TIMEOUTS] = static_cast<jlong>(m->pollTimeouts.load(std::memory_order_relaxed));
+    out[SNAP_ERRORS] = static_cast<jlong>(m->errors.load(std::memory_order_relaxed));
+    FillHistogram(out + SNAP_POLL_WAIT, m->pollWait);
+    FillHistogram(out + SNAP_SYSCALL, m->syscall);
+
+    env->SetLongArrayRegion(jOut, 0, SNAP_SIZE, out);
+    return SNAP_SIZE;
+}
+
+/**
+ * int errorCounts(long handle, long[] out)
+ *
+ * out[errno] = 该 errno 出现的次数，最后一格汇总超出范围的 errno。
+ *
+ * @return 写入的项数；<0: 错误
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeMetrics_errorCounts(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlongArray jOut
+) {
+    if (jOut == nullptr) return -EINVAL;
+    ChannelMetrics* m = MetricsFor(static_cast<int>(handle));
+    if (m == nullptr) return -ENOENT;
+
+    jsize len = env->GetArrayLength(jOut);
+    int n = len < COMM_METRICS_MAX_ERRNO + 1 ? len : COMM_METRICS_MAX_ERRNO + 1;
+    jlong out[COMM_METRICS_MAX_ERRNO + 1];
+    for (int i = 0; i < n; ++i) {
+        out[i] = static_cast<jlong>(m->errorsByErrno[i].load(std::memory_order_relaxed));
+    }
+    env->SetLongArrayRegion(jOut, 0, n, out);
+    return n;
+}
+
+} // extern "C"
@@ -0,0 +1,143 @@
+#include <jni.h>
+#include <errno.h>
+#include <string>
+
+#define LOG_TAG "NativeCanMonitor"
+#include "comm_log.h"
+#include "can_monitor.h"
+
+// create() 参数数组下标（和 Kotlin NativeCanMonitor.P_* 保持一致）
+static const int P_BITRATE      = 0;
+static const int P_DATA_BITRATE = 1;
+static const int P_WINDOW_MS    = 2;
+static const int P_COUNT        = 3;
+
+// snapshot() 输出布局（和 Kotlin NativeCanMonitor.IDX_* 保持一致）
+enum BusStatsIndex {
+    BUS_TIMESTAMP_NS = 0,
+    BUS_BITRATE,
+    BUS_DATA_BITRATE,
+    BUS_FRAMES,
+    BUS_BITS,
+    BUS_BUSY_NS,
+    BUS_WINDOW_LOAD_PPM,
+    BUS_PEAK_LOAD_PPM,
+    BUS_STATE,
+    BUS_TX_ERRORS,
+    BUS_RX_ERRORS,
+    BUS_ERROR_FRAMES,
+    BUS_BUS_ERRORS,
+    BUS_ACK_ERRORS,
+    BUS_ARBITRATION_LOST,
+    BUS_OVERFLOWS,
+    BUS_TX_TIMEOUTS,
+    BUS_BUS_OFF,
+    BUS_RESTARTS,
+    BUS_LAST_ERROR_NS,
+    BUS_STATS_SIZE
+};
+
+static std::string JStringToString(JNIEnv* env, jstring jstr) {
+    if (jstr == nullptr) return {};
+    const char* utf = env->GetStringUTFChars(jstr, nullptr);
+    if (utf == nullptr) return {};
+    std::string res(utf);
+    env->ReleaseStringUTFChars(jstr, utf);
+    return res;
+}
+
+static CanBusMonitor* FromHandle(jlong handle) {
+    return reinterpret_cast<CanBusMonitor*>(static_cast<intptr_t>(handle));
+}
+
+extern "C" {
+
+/**
+ * long create(String ifName, int[] params)
+ *
+ * @return >0: 监视句柄（native 指针）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeCanMonitor_create(
+        JNIEnv* env,
+        jclass,
+        jstring jIfName,
+        jintArray jParams
+) {
+    std::string ifName = JStringToString(env, jIfName);
+    if (ifName.empty() || jParams == nullptr) return -EINVAL;
+    if (env->GetArrayLength(jParams) < P_COUNT) return -EINVAL;
+
+    jint p[P_COUNT];
+    env->GetIntArrayRegion(jParams, 0, P_COUNT, p);
+    if (p[P_BITRATE] < 0 || p[P_DATA_BITRATE] < 0) return -EINVAL;
+    CanBusMonitorConfig config;
+    config.bitrate = static_cast<uint32_t>(p[P_BITRATE]);
+    config.dataBitrate = static_cast<uint32_t>(p[P_DATA_BITRATE]);
+    config.windowMs = p[P_WINDOW_MS];
+
+    int err = 0;
+    CanBusMonitor* m = CanBusMonitor::Create(ifName.c_str(), config, &err);
+    if (m == nullptr) return err;
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(m));
+}
+
+/**
+ * int snapshot(long monitor, long[] out)
+ *
+ * @return 写入的项数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCanMonitor_snapshot(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlongArray jOut
+) {
+    CanBusMonitor* m = FromHandle(handle);
+    if (m == nullptr || jOut == nullptr) return -EINVAL;
+    if (env->GetArrayLength(jOut) < BUS_STATS_SIZE) return -EINVAL;
+
+    CanBusSnapshot s;
+    m->Snapshot(&s);
+
+    jlong out[BUS_STATS_SIZE];
+    out[BUS_TIMESTAMP_NS] = s.timestampNs;
+    out[BUS_BITRATE] = s.bitrate;
+    out[BUS_DATA_BITRATE] = s.dataBitrate;
+    out[BUS_FRAMES] = static_cast<jlong>(s.frames);
+    out[BUS_BITS] = static_cast<jlong>(s.bits);
+    out[BUS_BUSY_NS] = static_cast<jlong>(s.busyNs);
+    out[BUS_WINDOW_LOAD_PPM] = s.windowLoadPpm;
+    out[BUS_PEAK_LOAD_PPM] = s.peakLoadPpm;
+    out[BUS_STATE] = s.state;
+    out[BUS_TX_ERRORS] = s.txErrors;
+    out[BUS_RX_ERRORS] = s.rxErrors;
+    out[BUS_ERROR_FRAMES] = static_cast<jlong>(s.errorFrames);
+    out[BUS_BUS_ERRORS] = static_cast<jlong>(s.busErrors);
+    out[BUS_ACK_ERRORS] = static_cast<jlong>(s.ackErrors);
+    out[BUS_ARBITRATION_LOST] = static_cast<jlong>(s.arbitrationLost);
+    out[BUS_OVERFLOWS] = static_cast<jlong>(s.overflows);
+    out[BUS_TX_TIMEOUTS] = static_cast<jlong>(s.txTimeouts);
+    out[BUS_BUS_OFF] = static_cast<jlong>(s.busOff);
+    out[BUS_RESTARTS] = static_cast<jlong>(s.restarts);
+    out[BUS_LAST_ERROR_NS] = s.lastErrorNs;
+    env->SetLongArrayRegion(jOut, 0, BUS_STATS_SIZE, out);
+    return BUS_STATS_SIZE;
+}
+
+/**
+ * void destroy(long monitor)
+ *
+ * 必须先从 reactor 注销（NativeReactor.removeBusMonitor）。
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeCanMonitor_destroy(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    delete FromHandle(handle);
+}
+
+} // extern "C"
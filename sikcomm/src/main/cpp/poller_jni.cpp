@@ -0,0 +1,193 @@
+#include <jni.h>
+#include <errno.h>
+#include <vector>
+
+#define LOG_TAG "NativePoller"
+#include "comm_log.h"
+#include "serial_poller.h"
+
+// create() 参数数组下标（和 Kotlin NativePoller.P_* 保持一致）
+static const int P_PROTOCOL = 0;
+static const int P_GAP_US   = 1;
+static const int P_CHAR_NS  = 2;
+static const int P_RETRIES  = 3;
+static const int P_COUNT    = 4;
+
+// create() 每条请求的描述（和 Kotlin NativePoller.R_* 保持一致），帧数据按顺序首尾相接放在 frames 里
+static const int R_TAG             = 0;
+static const int R_PERIOD_MS       = 1;
+static const int R_TIMEOUT_MS      = 2;
+static const int R_RESPONSE_LENGTH = 3;
+static const int R_FRAME_LENGTH    = 4;
+static const int R_COUNT           = 5;
+
+// stats() 输出布局（和 Kotlin NativePoller.IDX_* 保持一致）
+enum PollStatsIndex {
+    POLL_TRANSACTIONS = 0,
+    POLL_TIMEOUTS,
+    POLL_BAD_CRCS,
+    POLL_MISMATCHES,
+    POLL_EXCEPTIONS,
+    POLL_RETRIES,
+    POLL_STRAY_BYTES,
+    POLL_OVERRUNS,
+    POLL_MAX_LATENESS_NS,
+    POLL_STATS_SIZE
+};
+
+/**
+ * 轮询器 + 结果暂存区：Run() 会阻塞等待线路，不能在持有 Java 数组 critical 区时调用，
+ * 结果先写进这里，返回后再一次性拷进 Java 数组。
+ */
+struct PollerHandle {
+    SerialPoller* poller;
+    std::vector<uint8_t> out;
+};
+
+static PollerHandle* FromHandle(jlong handle) {
+    return reinterpret_cast<PollerHandle*>(static_cast<intptr_t>(handle));
+}
+
+extern "C" {
+
+/**
+ * long create(int[] params, int[] requests, byte[] frames)
+ *
+ * @param requests 每条请求 R_COUNT 个 int
+ * @return >0: 轮询器句柄（native 指针）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativePoller_create(
+        JNIEnv* env,
+        jclass,
+        jintArray jParams,
+        jintArray jRequests,
+        jbyteArray jFrames
+) {
+    if (jParams == nullptr || jRequests == nullptr || jFrames == nullptr) return -EINVAL;
+    if (env->GetArrayLength(jParams) < P_COUNT) return -EINVAL;
+    jsize descLen = env->GetArrayLength(jRequests);
+    if (descLen == 0 || descLen % R_COUNT != 0) return -EINVAL;
+
+    jint p[P_COUNT];
+    env->GetIntArrayRegion(jParams, 0, P_COUNT, p);
+    PollerParams params;
+    params.protocol = p[P_PROTOCOL];
+    params.gapUs = p[P_GAP_US];
+    params.charNs = p[P_CHAR_NS];
+    params.retries = p[P_RETRIES];
+
+    std::vector<jint> desc(static_cast<size_t>(descLen));
+    env->GetIntArrayRegion(jRequests, 0, descLen, desc.data());
+    jsize framesLen = env->GetArrayLength(jFrames);
+    std::vector<uint8_t> frames(static_cast<size_t>(framesLen));
+    env->GetByteArrayRegion(jFrames, 0, framesLen, reinterpret_cast<jbyte*>(frames.data()));
+
+    std::vector<PollRequestSpec> requests(static_cast<size_t>(descLen / R_COUNT));
+    size_t pos = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        const jint* d = desc.data() + i * R_COUNT;
+        PollRequestSpec& r = requests[i];
+        r.tag = d[R_TAG];
+        r.periodMs = d[R_PERIOD_MS];
+        r.timeoutMs = d[R_TIMEOUT_MS];
+        r.responseLength = d[R_RESPONSE_LENGTH];
+        size_t len = static_cast<size_t>(d[R_FRAME_LENGTH] > 0 ? d[R_FRAME_LENGTH] : 0);
+        if (pos + len > frames.size()) return -EINVAL;
+        r.frame.assign(frames.begin() + static_cast<long>(pos), frames.begin() + static_cast<long>(pos + len));
+        pos += len;
+    }
+
+    size_t count = requests.size();
+    SerialPoller* poller = SerialPoller::Create(params, std::move(requests));
+    if (poller == nullptr) {
+        LOGE("create: invalid poll requests");
+        return -EINVAL;
+    }
+    auto* h = new PollerHandle{poller, {}};
+    LOGI("poller created: %zu requests, protocol=%d, gap=%dus", count, params.protocol, params.gapUs);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(h));
+}
+
+/**
+ * void destroy(long poller)
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativePoller_destroy(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    PollerHandle* h = FromHandle(handle);
+    if (h == nullptr) return;
+    delete h->poller;
+    delete h;
+}
+
+/**
+ * int run(long poller, long fd, byte[] out, int maxRecords, int budgetMs)
+ *
+ * 执行到期的事务，结果按 POLL_RECORD_SIZE 定长记录写进 out。
+ *
+ * @return >=0: 结果数；<0: -errno（fd 出错）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativePoller_run(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlong fd,
+        jbyteArray jOut,
+        jint maxRecords,
+        jint budgetMs
+) {
+    PollerHandle* h = FromHandle(handle);
+    if (h == nullptr || fd <= 0) return -EBADF;
+    if (jOut == nullptr || maxRecords <= 0) return -EINVAL;
+    jsize cap = env->GetArrayLength(jOut) / POLL_RECORD_SIZE;
+    if (maxRecords > cap) maxRecords = cap;
+    if (maxRecords <= 0) return -EINVAL;
+
+    size_t need = static_cast<size_t>(maxRecords) * POLL_RECORD_SIZE;
+    if (h->out.size() < need) h->out.resize(need);
+
+    int n = h->poller->Run(static_cast<int>(fd), h->out.data(), maxRecords, budgetMs);
+    if (n > 0) {
+        env->SetByteArrayRegion(jOut, 0, n * POLL_RECORD_SIZE, reinterpret_cast<const jbyte*>(h->out.data()));
+    }
+    return n;
+}
+
+/**
+ * int stats(long poller, long[] out)
+ *
+ * @return 写入的项数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativePoller_stats(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlongArray jOut
+) {
+    PollerHandle* h = FromHandle(handle);
+    if (h == nullptr) return -EBADF;
+    if (jOut == nullptr || env->GetArrayLength(jOut) < POLL_STATS_SIZE) return -EINVAL;
+
+    PollerStats s{};
+    h->poller->Stats(&s);
+    jlong out[POLL_STATS_SIZE];
+    out[POLL_TRANSACTIONS] = static_cast<jlong>(s.transactions);
+    out[POLL_TIMEOUTS] = static_cast<jlong>(s.timeouts);
+    out[POLL_BAD_CRCS] = static_cast<jlong>(s.badCrc);
+    out[POLL_MISMATCHES] = static_cast<jlong>(s.mismatches);
+    out[POLL_EXCEPTIONS] = static_cast<jlong>(s.exceptions);
+    out[POLL_RETRIES] = static_cast<jlong>(s.retries);
+    out[POLL_STRAY_BYTES] = static_cast<jlong>(s.strayBytes);
+    out[POLL_OVERRUNS] = static_cast<jlong>(s.overruns);
+    out[POLL_MAX_LATENESS_NS] = static_cast<jlong>(s.maxLatenessNs);
+    env->SetLongArrayRegion(jOut, 0, POLL_STATS_SIZE, out);
+    return POLL_STATS_SIZE;
+}
+
+} // extern "C"
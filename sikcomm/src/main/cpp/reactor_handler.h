@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * 直接在 reactor 线程上由 native 处理的 fd 集合（CAN 网关 / 总线监视）。
+ *
+ * 登记后这些 fd 按电平触发挂在 reactor 的 epoll 上，就绪时 await 在 native 里调用 [OnReadable]，
+ * 事件不返回 Kotlin；登记 / 注销见 reactor_jni.cpp。
+ */
+class ReactorHandler {
+public:
+    virtual ~ReactorHandler() = default;
+
+    /**
+     * 需要登记到 reactor 的 fd，登记期间不能变化；为空表示不需要 reactor。
+     */
+    virtual const std::vector<int>& ReactorFds() const = 0;
+
+    /**
+     * fd 可读：非阻塞地处理已排队的数据，只在 reactor 线程上调用。
+     *
+     * @return >=0: 成功；<0: -errno，reactor 会把该 fd 摘掉
+     */
+    virtual int OnReadable(int fd) = 0;
+};
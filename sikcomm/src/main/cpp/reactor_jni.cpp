@@ -0,0 +1,328 @@
+#include <jni.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <mutex>
+
+#define LOG_TAG "NativeReactor"
+#include "comm_log.h"
+#include "can_gateway.h"
+#include "can_monitor.h"
+
+// 单次 epoll_wait 最多取回多少个事件
+static const int REACTOR_MAX_EVENTS = 64;
+
+// 就绪事件 bit 定义（和 Kotlin NativeReactor.EVENT_* 保持一致）
+static const int REACTOR_EVENT_READABLE = 0x01;
+static const int REACTOR_EVENT_ERROR    = 0x02;
+
+/**
+ * 直接在 reactor 线程上由 native 处理的 fd（ReactorHandler：用户态 CAN 网关 / 总线监视）：
+ * epoll data 最高位置 1，[32..62] 为处理者槽位，低 32 位为 fd；
+ * 这类事件在 await 里就地处理，不返回 Kotlin，每帧都不跨 JNI。
+ *
+ * 这类 fd 按电平触发注册（不 ONESHOT），OnReadable 没取完的数据下一次 epoll_wait 会再次就绪。
+ */
+static const int REACTOR_MAX_NATIVE = 16;
+static const uint64_t REACTOR_NATIVE_BIT = 1ULL << 63;
+
+// 槽位表；await 持锁调用 OnReadable，RemoveHandler 持锁清槽位，清完之后不会再有调用进行中
+static std::mutex g_nativeLock;
+static ReactorHandler* g_native[REACTOR_MAX_NATIVE];
+
+static uint64_t NativeData(int slot, int fd) {
+    return REACTOR_NATIVE_BIT | (static_cast<uint64_t>(slot) << 32) | static_cast<uint32_t>(fd);
+}
+
+/**
+ * 处理一个 native 事件。
+ *
+ * 处理出错（接口 down 等）时把该 fd 摘掉，否则电平触发会让 reactor 线程空转。
+ */
+static void DispatchNative(int epfd, uint64_t data) {
+    int slot = static_cast<int>((data >> 32) & 0x7FFFFFFF);
+    int fd = static_cast<int>(static_cast<uint32_t>(data));
+    if (slot >= REACTOR_MAX_NATIVE) return;
+
+    std::lock_guard<std::mutex> lock(g_nativeLock);
+    ReactorHandler* h = g_native[slot];
+    if (h == nullptr) return;
+    int ret = h->OnReadable(fd);
+    if (ret < 0 && ret != -EBADF) {
+        LOGE("native fd=%d failed (%d), detached from reactor", fd, ret);
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+/**
+ * fd 统一按 EPOLLIN | EPOLLONESHOT 注册：
+ * 一次就绪只通知一次，通道把数据读干净之后再 rearm，
+ * 这样 reactor 线程不会在通道还没来得及读的时候反复被同一个 fd 唤醒。
+ */
+static int CtlOneShot(int epfd, int op, int fd, jint token) {
+    struct epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = static_cast<uint32_t>(token);
+    if (epoll_ctl(epfd, op, fd, &ev) < 0) {
+        int err = errno;
+        LOGE("epoll_ctl(op=%d, fd=%d) failed: %s", op, fd, strerror(err));
+        return -err;
+    }
+    return 0;
+}
+
+/**
+ * 把处理者的 fd 按电平触发登记到 reactor，占用一个槽位。
+ */
+static int AddHandler(jlong reactor, ReactorHandler* h) {
+    if (reactor <= 0) return -EBADF;
+    if (h == nullptr) return -EINVAL;
+    const std::vector<int>& fds = h->ReactorFds();
+    if (fds.empty()) return 0;
+
+    int epfd = static_cast<int>(reactor);
+    std::lock_guard<std::mutex> lock(g_nativeLock);
+    int slot = -1;
+    for (int i = 0; i < REACTOR_MAX_NATIVE; ++i) {
+        if (g_native[i] == h) return -EEXIST;
+        if (slot < 0 && g_native[i] == nullptr) slot = i;
+    }
+    if (slot < 0) return -ENOSPC;
+
+    for (size_t i = 0; i < fds.size(); ++i) {
+        struct epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = NativeData(slot, fds[i]);
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, fds[i], &ev) < 0) {
+            int err = errno;
+            LOGE("epoll_ctl(add native fd=%d) failed: %s", fds[i], strerror(err));
+            for (size_t k = 0; k < i; ++k) epoll_ctl(epfd, EPOLL_CTL_DEL, fds[k], nullptr);
+            return -err;
+        }
+    }
+    g_native[slot] = h;
+    return 0;
+}
+
+/**
+ * 注销处理者的 fd 并清槽位；返回后 reactor 线程不会再调用它。
+ */
+static int RemoveHandler(jlong reactor, ReactorHandler* h) {
+    if (reactor <= 0) return -EBADF;
+    if (h == nullptr) return -EINVAL;
+
+    for (int fd : h->ReactorFds()) {
+        epoll_ctl(static_cast<int>(reactor), EPOLL_CTL_DEL, fd, nullptr);
+    }
+    std::lock_guard<std::mutex> lock(g_nativeLock);
+    for (int i = 0; i < REACTOR_MAX_NATIVE; ++i) {
+        if (g_native[i] == h) g_native[i] = nullptr;
+    }
+    return 0;
+}
+
+extern "C" {
+
+/**
+ * long create()
+ *
+ * @return >0: reactor 句柄（epoll fd）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeReactor_create(
+        JNIEnv*,
+        jclass
+) {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        int err = errno;
+        LOGE("epoll_create1 failed: %s", strerror(err));
+        return -err;
+    }
+    LOGI("reactor created, epfd=%d", epfd);
+    return static_cast<jlong>(epfd);
+}
+
+/**
+ * int add(long reactor, long fd, int token)
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_add(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong fd,
+        jint token
+) {
+    if (reactor <= 0 || fd < 0) return -EBADF;
+    return CtlOneShot(static_cast<int>(reactor), EPOLL_CTL_ADD, static_cast<int>(fd), token);
+}
+
+/**
+ * int rearm(long reactor, long fd, int token)
+ *
+ * 通道处理完一次就绪事件后调用，重新等待下一次可读。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_rearm(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong fd,
+        jint token
+) {
+    if (reactor <= 0 || fd < 0) return -EBADF;
+    return CtlOneShot(static_cast<int>(reactor), EPOLL_CTL_MOD, static_cast<int>(fd), token);
+}
+
+/**
+ * int remove(long reactor, long fd)
+ *
+ * 必须在 close(fd) 之前调用，避免 fd 号被复用后收到错误的事件。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_remove(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong fd
+) {
+    if (reactor <= 0 || fd < 0) return -EBADF;
+    if (epoll_ctl(static_cast<int>(reactor), EPOLL_CTL_DEL, static_cast<int>(fd), nullptr) < 0) {
+        int err = errno;
+        return -err;
+    }
+    return 0;
+}
+
+/**
+ * int addGateway(long reactor, long gateway)
+ *
+ * 把用户态网关的源 socket 登记到 reactor，之后转发都在 reactor 线程的 await 里完成。
+ * 内核后端没有需要登记的 fd，直接返回 0。
+ *
+ * @return 0: 成功；<0: -errno（-ENOSPC: native 处理者数超过上限）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_addGateway(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong gateway
+) {
+    return AddHandler(reactor, reinterpret_cast<CanGateway*>(static_cast<intptr_t>(gateway)));
+}
+
+/**
+ * int removeGateway(long reactor, long gateway)
+ *
+ * 返回之后 reactor 线程不会再调用该网关，可以安全销毁。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_removeGateway(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong gateway
+) {
+    return RemoveHandler(reactor, reinterpret_cast<CanGateway*>(static_cast<intptr_t>(gateway)));
+}
+
+/**
+ * int addBusMonitor(long reactor, long monitor)
+ *
+ * 把总线监视 socket 登记到 reactor，帧和错误帧都在 reactor 线程的 await 里统计。
+ *
+ * @return 0: 成功；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_addBusMonitor(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong monitor
+) {
+    return AddHandler(reactor, reinterpret_cast<CanBusMonitor*>(static_cast<intptr_t>(monitor)));
+}
+
+/**
+ * int removeBusMonitor(long reactor, long monitor)
+ *
+ * 返回之后 reactor 线程不会再访问该监视，可以安全销毁。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_removeBusMonitor(
+        JNIEnv*,
+        jclass,
+        jlong reactor,
+        jlong monitor
+) {
+    return RemoveHandler(reactor, reinterpret_cast<CanBusMonitor*>(static_cast<intptr_t>(monitor)));
+}
+
+/**
+ * int await(long reactor, int[] outTokens, int[] outEvents, int timeoutMs)
+ *
+ * 阻塞在 epoll_wait 上，没有任何通道就绪时不会醒来（timeoutMs = -1）。
+ * native 处理的事件（网关转发）就地处理；timeoutMs = -1 时只有这类事件就继续等待。
+ *
+ * 返回值：
+ *  >0: 就绪事件数，outTokens / outEvents 依次写入
+ *  0: 超时或被信号打断
+ *  <0: 错误
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeReactor_await(
+        JNIEnv* env,
+        jclass,
+        jlong reactor,
+        jintArray jOutTokens,
+        jintArray jOutEvents,
+        jint timeoutMs
+) {
+    if (reactor <= 0) return -EBADF;
+    if (jOutTokens == nullptr || jOutEvents == nullptr) return -EINVAL;
+
+    jsize cap = env->GetArrayLength(jOutTokens);
+    if (env->GetArrayLength(jOutEvents) < cap) cap = env->GetArrayLength(jOutEvents);
+    if (cap > REACTOR_MAX_EVENTS) cap = REACTOR_MAX_EVENTS;
+    if (cap <= 0) return -EINVAL;
+
+    int epfd = static_cast<int>(reactor);
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    jint tokens[REACTOR_MAX_EVENTS];
+    jint flags[REACTOR_MAX_EVENTS];
+    while (true) {
+        int n = epoll_wait(epfd, events, cap, timeoutMs);
+        if (n < 0) {
+            int err = errno;
+            if (err == EINTR) return 0;
+            LOGE("epoll_wait failed: %s", strerror(err));
+            return -err;
+        }
+        if (n == 0) return 0;
+
+        int count = 0;
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 & REACTOR_NATIVE_BIT) {
+                DispatchNative(epfd, events[i].data.u64);
+                continue;
+            }
+            tokens[count] = static_cast<jint>(events[i].data.u64);
+            flags[count] = 0;
+            if (events[i].events & EPOLLIN) flags[count] |= REACTOR_EVENT_READABLE;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) flags[count] |= REACTOR_EVENT_ERROR;
+            ++count;
+        }
+        if (count == 0) {
+            if (timeoutMs < 0) continue;
+            return 0;
+        }
+        env->SetIntArrayRegion(jOutTokens, 0, count, tokens);
+        env->SetIntArrayRegion(jOutEvents, 0, count, flags);
+        return static_cast<jint>(count);
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,286 @@
+#include "rx_ring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <new>
+
+#define LOG_TAG "RxRing"
+#include "comm_log.h"
+#include "can_io.h"
+#include "serial_io.h"
+
+// 记录类型
+static const uint32_t RECORD_DATA = 1;
+static const uint32_t RECORD_PAD = 2;
+
+// 串口原始字节单次读取的上限
+static const size_t SERIAL_CHUNK = 4096;
+
+// 分帧模式下单条记录最多容纳的分帧输出
+static const size_t FRAMES_CHUNK = 16 * 1024;
+
+// 数据区上限：记录偏移要能放进 jint
+static const size_t MAX_CAPACITY = 1u << 30;
+
+static inline uint64_t AlignRecord(uint64_t n) {
+    return (n + RX_RING_RECORD_HEADER - 1) & ~static_cast<uint64_t>(RX_RING_RECORD_HEADER - 1);
+}
+
+RxRing* RxRing::Create(size_t capacity, int policy) {
+    if (capacity < RX_RING_MIN_CAPACITY || capacity > MAX_CAPACITY ||
+        (capacity & (capacity - 1)) != 0) {
+        LOGE("invalid ring capacity %zu (power of two in [%zu, %zu])",
+             capacity, RX_RING_MIN_CAPACITY, MAX_CAPACITY);
+        return nullptr;
+    }
+    if (policy != RX_RING_DROP_NEWEST && policy != RX_RING_DROP_OLDEST && policy != RX_RING_BLOCK) {
+        LOGE("invalid ring overflow policy %d", policy);
+        return nullptr;
+    }
+
+    void* mem = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        LOGE("mmap ring failed, capacity=%zu, errno=%d (%s)", capacity, errno, strerror(errno));
+        return nullptr;
+    }
+    RxRing* ring = new (std::nothrow) RxRing(static_cast<uint8_t*>(mem), capacity, policy);
+    if (ring == nullptr) munmap(mem, capacity);
+    return ring;
+}
+
+RxRing::RxRing(uint8_t* data, size_t capacity, int policy)
+        : data_(data), capacity_(capacity), mask_(capacity - 1), policy_(policy) {
+}
+
+RxRing::~RxRing() {
+    munmap(data_, capacity_);
+}
+
+void RxRing::WriteHeader(uint64_t pos, uint32_t len, uint32_t type, int64_t timestampNs) {
+    uint8_t* p = data_ + (pos & mask_);
+    memcpy(p, &len, 4);
+    memcpy(p + 4, &type, 4);
+    memcpy(p + 8, &timestampNs, 8);
+}
+
+void RxRing::ReadHeader(uint64_t pos, uint32_t* len, uint32_t* type) const {
+    const uint8_t* p = data_ + (pos & mask_);
+    memcpy(len, p, 4);
+    memcpy(type, p + 4, 4);
+}
+
+bool RxRing::DropOldest() {
+    uint64_t r = readIdx_.load(std::memory_order_acquire);
+    if (r == head_.load(std::memory_order_relaxed)) return false;
+    // 消费者还占着 [tail, r)：丢掉 r 之后的记录也腾不出连续空间，退化为丢弃新数据
+    if (tail_.load(std::memory_order_acquire) != r) return false;
+
+    uint32_t len = 0;
+    uint32_t type = 0;
+    ReadHeader(r, &len, &type);
+    uint64_t next = r + AlignRecord(RX_RING_RECORD_HEADER + len);
+    if (!readIdx_.compare_exchange_strong(r, next, std::memory_order_acq_rel)) {
+        // 消费者刚好认领走了，重新计算空间
+        return true;
+    }
+    // tail == r 说明没有未归还的认领，这段空间立即归生产者
+    uint64_t expected = r;
+    tail_.compare_exchange_strong(expected, next, std::memory_order_acq_rel);
+    if (type == RECORD_DATA) {
+        droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+        droppedBytes_.fetch_add(len, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+uint8_t* RxRing::Reserve(size_t minLen, size_t maxLen, size_t* granted) {
+    const uint64_t need = AlignRecord(RX_RING_RECORD_HEADER + minLen);
+    if (need > capacity_ / 2) return nullptr;
+
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        uint64_t free = capacity_ - (head - tail);
+        uint64_t pos = head & mask_;
+        uint64_t toEnd = capacity_ - pos;
+
+        if (toEnd < need) {
+            if (free >= toEnd) {
+                // 尾部放不下：补一条 PAD 记录，从头开始
+                WriteHeader(head, static_cast<uint32_t>(toEnd - RX_RING_RECORD_HEADER), RECORD_PAD, 0);
+                head += toEnd;
+                head_.store(head, std::memory_order_release);
+                continue;
+            }
+        } else if (free >= need) {
+            uint64_t room = (free < toEnd ? free : toEnd) - RX_RING_RECORD_HEADER;
+            *granted = room < maxLen ? static_cast<size_t>(room) : maxLen;
+            reserved_ = head;
+            return data_ + pos + RX_RING_RECORD_HEADER;
+        }
+
+        if (policy_ == RX_RING_DROP_OLDEST) {
+            if (DropOldest()) continue;
+        } else if (policy_ == RX_RING_BLOCK) {
+            producerWaiting_.store(true, std::memory_order_seq_cst);
+            // 置位之后再看一次 tail，避免和消费者的 Release 互相错过
+            if (tail_.load(std::memory_order_seq_cst) != tail) {
+                producerWaiting_.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            blocked_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return nullptr;
+    }
+}
+
+void RxRing::Commit(size_t len, int64_t timestampNs) {
+    if (len == 0) return;
+    WriteHeader(reserved_, static_cast<uint32_t>(len), RECORD_DATA, timestampNs);
+    uint64_t head = reserved_ + AlignRecord(RX_RING_RECORD_HEADER + len);
+    head_.store(head, std::memory_order_release);
+    records_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t used = head - tail_.load(std::memory_order_relaxed);
+    if (used > highWater_.load(std::memory_order_relaxed)) {
+        highWater_.store(used, std::memory_order_relaxed);
+    }
+}
+
+uint8_t* RxRing::Scratch(size_t len) {
+    if (scratch_.size() < len) scratch_.resize(len);
+    return scratch_.data();
+}
+
+void RxRing::CountDropped(size_t bytes) {
+    droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+    droppedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+int RxRing::Peek(RxRingRecord* out, int max) {
+    for (;;) {
+        uint64_t r = readIdx_.load(std::memory_order_acquire);
+        uint64_t h = head_.load(std::memory_order_acquire);
+        uint64_t pos = r;
+        int n = 0;
+        while (pos < h && n < max) {
+            uint32_t len = 0;
+            uint32_t type = 0;
+            ReadHeader(pos, &len, &type);
+            uint64_t size = AlignRecord(RX_RING_RECORD_HEADER + len);
+            // 读到了被 DROP_OLDEST 回收后正在改写的位置，下面的 CAS 必然失败
+            if (size > h - pos) break;
+            if (type == RECORD_DATA) {
+                uint64_t at = pos & mask_;
+                out[n].offset = static_cast<uint32_t>(at + RX_RING_RECORD_HEADER);
+                out[n].length = len;
+                memcpy(&out[n].timestampNs, data_ + at + 8, 8);
+                n++;
+            }
+            pos += size;
+        }
+        if (pos == r) return 0;
+        if (readIdx_.compare_exchange_strong(r, pos, std::memory_order_acq_rel)) return n;
+    }
+}
+
+bool RxRing::Release() {
+    uint64_t r = readIdx_.load(std::memory_order_acquire);
+    uint64_t t = tail_.load(std::memory_order_relaxed);
+    while (t < r && !tail_.compare_exchange_weak(t, r, std::memory_order_seq_cst)) {
+    }
+    return producerWaiting_.exchange(false, std::memory_order_seq_cst);
+}
+
+void RxRing::Stats(RxRingStats* out) const {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    out->capacity = capacity_;
+    out->used = head > tail ? head - tail : 0;
+    out->highWater = highWater_.load(std::memory_order_relaxed);
+    out->records = records_.load(std::memory_order_relaxed);
+    out->droppedRecords = droppedRecords_.load(std::memory_order_relaxed);
+    out->droppedBytes = droppedBytes_.load(std::memory_order_relaxed);
+    out->blocked = blocked_.load(std::memory_order_relaxed);
+}
+
+int RxRingFillSerial(RxRing* ring, int fd) {
+    size_t granted = 0;
+    uint8_t* p = ring->Reserve(1, SERIAL_CHUNK, &granted);
+    bool dropping = p == nullptr;
+    if (dropping) {
+        if (ring->Policy() == RX_RING_BLOCK) return -ENOBUFS;
+        // 放不下也要把 fd 读干净，否则 reactor 会一直报可读
+        p = ring->Scratch(SERIAL_CHUNK);
+        granted = SERIAL_CHUNK;
+    }
+
+    int64_t readyNs = 0;
+    ssize_t n = SerialRead(fd, p, granted, 0, &readyNs);
+    if (n <= 0) return static_cast<int>(n);
+    if (dropping) {
+        ring->CountDropped(static_cast<size_t>(n));
+    } else {
+        ring->Commit(static_cast<size_t>(n), readyNs);
+    }
+    return static_cast<int>(n);
+}
+
+int RxRingFillFrames(RxRing* ring, SerialFramer* framer, int fd) {
+    const size_t minLen = SERIAL_FRAME_RECORD_HEADER + static_cast<size_t>(framer->MaxFrameSize());
+    if (AlignRecord(RX_RING_RECORD_HEADER + minLen) > ring->Capacity() / 2) return -EMSGSIZE;
+    const size_t maxLen = minLen > FRAMES_CHUNK ? minLen : FRAMES_CHUNK;
+
+    size_t granted = 0;
+    uint8_t* p = ring->Reserve(minLen, maxLen, &granted);
+    bool dropping = p == nullptr;
+    if (dropping) {
+        if (ring->Policy() == RX_RING_BLOCK) return -ENOBUFS;
+        p = ring->Scratch(maxLen);
+        granted = maxLen;
+    }
+
+    int n = SerialReadFrames(framer, fd, p, granted, 0);
+    if (n <= 0) return n;
+
+    // 每帧自带时间戳，记录头里的时间戳不用
+    size_t bytes = 0;
+    for (int i = 0; i < n; i++) {
+        int32_t len = 0;
+        memcpy(&len, p + bytes, 4);
+        bytes += SERIAL_FRAME_RECORD_HEADER + static_cast<size_t>(len);
+    }
+    if (dropping) {
+        ring->CountDropped(bytes);
+    } else {
+        ring->Commit(bytes, 0);
+    }
+    return n;
+}
+
+int RxRingFillCan(RxRing* ring, int fd, int maxFrames) {
+    if (maxFrames < 1) maxFrames = 1;
+    if (maxFrames > CAN_MAX_BATCH) maxFrames = CAN_MAX_BATCH;
+    const size_t maxLen = static_cast<size_t>(maxFrames) * CAN_RECORD_SIZE;
+
+    size_t granted = 0;
+    uint8_t* p = ring->Reserve(CAN_RECORD_SIZE, maxLen, &granted);
+    bool dropping = p == nullptr;
+    if (dropping) {
+        if (ring->Policy() == RX_RING_BLOCK) return -ENOBUFS;
+        p = ring->Scratch(maxLen);
+        granted = maxLen;
+    }
+
+    int n = CanReadBatch(fd, p, static_cast<int>(granted / CAN_RECORD_SIZE), 0);
+    if (n <= 0) return n;
+    size_t bytes = static_cast<size_t>(n) * CAN_RECORD_SIZE;
+    // 每帧自带内核时间戳，记录头里的时间戳不用
+    if (dropping) {
+        ring->CountDropped(bytes);
+    } else {
+        ring->Commit(bytes, 0);
+    }
+    return n;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include "serial_framer.h"
+
+/**
+ * 接收环形缓冲区：单生产者（通道 IO 协程，reactor 唤醒后把 fd 里的数据直接读进环里）/
+ * 单消费者（通道自己的接收线程，通过 direct ByteBuffer 原地读取）的无锁队列。
+ *
+ * 数据区是一块 mmap 出来的连续内存，Kotlin 侧用 NewDirectByteBuffer 包一层即可直接访问。
+ * 环里存的是“记录”：16 字节对齐，记录头 [u32 长度][u32 类型][i64 接收时间戳]，后跟数据；
+ * 记录不跨越环尾，放不下时在尾部补一条 PAD 记录后从头开始。
+ * 一条记录就是一次读取的结果（串口原始字节 / 一批分帧记录 / 一批 CAN 定长记录），由消费者按通道类型解析。
+ *
+ * 三个单调递增的 64 位位置：head（生产者已发布）、readIdx（消费者已认领）、tail（消费者已归还），
+ * 满足 tail <= readIdx <= head，[tail, head) 之外的空间归生产者。
+ * DROP_OLDEST 时生产者用 CAS 抢在消费者之前推进 readIdx，丢弃最旧的未认领记录；
+ * 消费者已认领、还没归还的记录不会被覆盖。
+ */
+
+// 溢出策略（和 Kotlin RxOverflow 的顺序保持一致）
+enum {
+    RX_RING_DROP_NEWEST = 0,   // 环满时新读到的数据直接丢弃（fd 照常读干净）
+    RX_RING_DROP_OLDEST = 1,   // 环满时丢弃最旧的未被认领的记录
+    RX_RING_BLOCK = 2          // 环满时停止读 fd，数据留在内核缓冲区，消费者腾出空间后再继续
+};
+
+static const int RX_RING_RECORD_HEADER = 16;
+static const size_t RX_RING_MIN_CAPACITY = 4096;
+
+struct RxRingRecord {
+    uint32_t offset;      // 数据（不含记录头）在数据区内的偏移
+    uint32_t length;
+    int64_t timestampNs;
+};
+
+struct RxRingStats {
+    uint64_t capacity;
+    uint64_t used;             // 当前占用（含已认领未归还）的字节数
+    uint64_t highWater;        // 占用的历史最大值
+    uint64_t records;          // 写入的记录数
+    uint64_t droppedRecords;   // 因溢出丢弃的记录数（DROP_NEWEST 为丢弃的读取次数）
+    uint64_t droppedBytes;     // 因溢出丢弃的数据字节数
+    uint64_t blocked;          // BLOCK 策略下因环满暂停读取的次数
+};
+
+class RxRing {
+public:
+    /**
+     * @param capacity 数据区大小，必须是 2 的幂且不小于 RX_RING_MIN_CAPACITY
+     * @return nullptr: 参数非法或内存不足
+     */
+    static RxRing* Create(size_t capacity, int policy);
+
+    ~RxRing();
+
+    RxRing(const RxRing&) = delete;
+    RxRing& operator=(const RxRing&) = delete;
+
+    uint8_t* Data() const { return data_; }
+
+    size_t Capacity() const { return capacity_; }
+
+    int Policy() const { return policy_; }
+
+    // ---- 生产者（只能在一个线程里调用） ----
+
+    /**
+     * 预留一段连续空间，至少 minLen、至多 maxLen 字节。
+     *
+     * 空间不足时按策略处理：DROP_OLDEST 丢弃旧记录腾空间；
+     * DROP_NEWEST / BLOCK 返回 nullptr（BLOCK 同时记下生产者在等待，消费者归还时会得到通知）。
+     *
+     * @param granted 输出实际可用的长度
+     */
+    uint8_t* Reserve(size_t minLen, size_t maxLen, size_t* granted);
+
+    /**
+     * 发布上一次 Reserve 得到的空间中的前 len 字节，len 为 0 时什么也不做。
+     */
+    void Commit(size_t len, int64_t timestampNs);
+
+    /**
+     * 生产者自己的临时缓冲区（DROP_NEWEST 时把放不下的数据读到这里丢掉）。
+     */
+    uint8_t* Scratch(size_t len);
+
+    /**
+     * 记一次 DROP_NEWEST 丢弃。
+     */
+    void CountDropped(size_t bytes);
+
+    // ---- 消费者（只能在一个线程里调用） ----
+
+    /**
+     * 认领至多 max 条已发布的记录，认领期间它们不会被生产者覆盖 / 丢弃。
+     *
+     * @return 认领的记录数，0 表示环为空
+     */
+    int Peek(RxRingRecord* out, int max);
+
+    /**
+     * 归还已认领的全部记录。
+     *
+     * @return true: 生产者之前因环满（BLOCK）暂停了读取，调用方应唤醒它
+     */
+    bool Release();
+
+    void Stats(RxRingStats* out) const;
+
+private:
+    RxRing(uint8_t* data, size_t capacity, int policy);
+
+    bool DropOldest();
+    void WriteHeader(uint64_t pos, uint32_t len, uint32_t type, int64_t timestampNs);
+    void ReadHeader(uint64_t pos, uint32_t* len, uint32_t* type) const;
+
+    uint8_t* const data_;
+    const size_t capacity_;
+    const uint64_t mask_;
+    const int policy_;
+
+    // 生产者写、消费者读
+    alignas(64) std::atomic<uint64_t> head_{0};
+    // 消费者认领；DROP_OLDEST 时生产者也会推进
+    alignas(64) std::atomic<uint64_t> readIdx_{0};
+    std::atomic<uint64_t> tail_{0};
+    std::atomic<bool> producerWaiting_{false};
+
+    // 生产者私有
+    alignas(64) uint64_t reserved_ = 0;   // Reserve 返回的记录起点
+    std::vector<uint8_t> scratch_;
+
+    std::atomic<uint64_t> highWater_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> droppedRecords_{0};
+    std::atomic<uint64_t> droppedBytes_{0};
+    std::atomic<uint64_t> blocked_{0};
+};
+
+/**
+ * 串口原始字节：一次非阻塞 read 直接读进环里，一次读取成为一条记录（时间戳为 poll 返回时间）。
+ *
+ * @return >0: 读到的字节数（含被丢弃的）；0: 没有数据；-ENOBUFS: BLOCK 策略下环已满；其它 <0: -errno
+ */
+int RxRingFillSerial(RxRing* ring, int fd);
+
+/**
+ * 串口分帧：SerialReadFrames 的输出（[int32 长度][int64 时间戳][数据] 连续排列）作为一条记录。
+ *
+ * @return >0: 帧数（含被丢弃的）；0: 没有完整帧；-ENOBUFS / <0: 同 RxRingFillSerial
+ */
+int RxRingFillFrames(RxRing* ring, SerialFramer* framer, int fd);
+
+/**
+ * CAN：一次 recvmmsg 收到的 CAN_RECORD_SIZE 定长记录作为一条记录。
+ *
+ * @return >0: 帧数（含被丢弃的）；0: 没有数据；-ENOBUFS / <0: 同 RxRingFillSerial
+ */
+int RxRingFillCan(RxRing* ring, int fd, int maxFrames);
@@ -0,0 +1,238 @@
+#include <jni.h>
+#include <errno.h>
+
+#define LOG_TAG "NativeRxRing"
+#include "comm_log.h"
+#include "rx_ring.h"
+
+// stats() 输出布局（和 Kotlin NativeRxRing.IDX_* 保持一致）
+enum RingStatsIndex {
+    RING_CAPACITY = 0,
+    RING_USED,
+    RING_HIGH_WATER,
+    RING_RECORDS,
+    RING_DROPPED_RECORDS,
+    RING_DROPPED_BYTES,
+    RING_BLOCKED,
+    RING_STATS_SIZE
+};
+
+// peek() 单次最多认领的记录数
+static const int PEEK_MAX = 64;
+
+static RxRing* FromHandle(jlong handle) {
+    return reinterpret_cast<RxRing*>(static_cast<intptr_t>(handle));
+}
+
+extern "C" {
+
+/**
+ * long create(int capacity, int policy)
+ *
+ * @return >0: 环句柄（native 指针）；<0: -errno
+ */
+JNIEXPORT jlong JNICALL
+Java_com_sik_comm_NativeRxRing_create(
+        JNIEnv*,
+        jclass,
+        jint capacity,
+        jint policy
+) {
+    if (capacity <= 0) return -EINVAL;
+    RxRing* ring = RxRing::Create(static_cast<size_t>(capacity), policy);
+    if (ring == nullptr) return -EINVAL;
+    LOGI("rx ring created, capacity=%d, policy=%d", capacity, policy);
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(ring));
+}
+
+/**
+ * void destroy(long ring)
+ */
+JNIEXPORT void JNICALL
+Java_com_sik_comm_NativeRxRing_destroy(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr) return;
+    RxRingStats s{};
+    ring->Stats(&s);
+    if (s.droppedRecords > 0 || s.blocked > 0) {
+        LOGW("rx ring destroyed, %llu records (%llu bytes) dropped, blocked %llu times, high water %llu/%llu",
+             static_cast<unsigned long long>(s.droppedRecords),
+             static_cast<unsigned long long>(s.droppedBytes),
+             static_cast<unsigned long long>(s.blocked),
+             static_cast<unsigned long long>(s.highWater),
+             static_cast<unsigned long long>(s.capacity));
+    }
+    delete ring;
+}
+
+/**
+ * ByteBuffer buffer(long ring)
+ *
+ * 包住整个数据区的 direct ByteBuffer，peek() 返回的偏移都相对于它。
+ */
+JNIEXPORT jobject JNICALL
+Java_com_sik_comm_NativeRxRing_buffer(
+        JNIEnv* env,
+        jclass,
+        jlong handle
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr) return nullptr;
+    return env->NewDirectByteBuffer(ring->Data(), static_cast<jlong>(ring->Capacity()));
+}
+
+/**
+ * int fillSerial(long ring, long fd)
+ *
+ * 非阻塞地读一次串口，数据直接落进环里。
+ *
+ * @return >0: 字节数；0: 没有数据；-ENOBUFS: 环已满（BLOCK）；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeRxRing_fillSerial(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jlong fd
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr || fd <= 0) return -EBADF;
+    return RxRingFillSerial(ring, static_cast<int>(fd));
+}
+
+/**
+ * int fillFrames(long ring, long framer, long fd)
+ *
+ * 通过分帧器读一次串口，本次得到的整帧作为一条记录落进环里。
+ *
+ * @return >0: 帧数；0: 没有完整帧；-ENOBUFS: 环已满（BLOCK）；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeRxRing_fillFrames(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jlong framerHandle,
+        jlong fd
+) {
+    RxRing* ring = FromHandle(handle);
+    auto* framer = reinterpret_cast<SerialFramer*>(static_cast<intptr_t>(framerHandle));
+    if (ring == nullptr || framer == nullptr || fd <= 0) return -EBADF;
+    return RxRingFillFrames(ring, framer, static_cast<int>(fd));
+}
+
+/**
+ * int fillCan(long ring, long fd, int maxFrames)
+ *
+ * 一次 recvmmsg 收走已排队的 CAN 帧，定长记录直接落进环里。
+ *
+ * @return >0: 帧数；0: 没有数据；-ENOBUFS: 环已满（BLOCK）；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeRxRing_fillCan(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jlong fd,
+        jint maxFrames
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr || fd <= 0) return -EBADF;
+    return RxRingFillCan(ring, static_cast<int>(fd), maxFrames);
+}
+
+/**
+ * int peek(long ring, int[] offsets, int[] lengths, long[] stamps)
+ *
+ * 认领已发布的记录（至多 offsets.length 条，单次不超过 64），每条记录的数据偏移 / 长度 / 时间戳写进对应数组。
+ * 认领的记录在 release() 之前不会被覆盖。
+ *
+ * @return 认领的记录数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeRxRing_peek(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jintArray jOffsets,
+        jintArray jLengths,
+        jlongArray jStamps
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr) return -EBADF;
+    if (jOffsets == nullptr || jLengths == nullptr || jStamps == nullptr) return -EINVAL;
+    jint max = env->GetArrayLength(jOffsets);
+    if (env->GetArrayLength(jLengths) < max || env->GetArrayLength(jStamps) < max) return -EINVAL;
+    if (max > PEEK_MAX) max = PEEK_MAX;
+
+    RxRingRecord records[PEEK_MAX];
+    int n = ring->Peek(records, max);
+    if (n <= 0) return n;
+
+    jint offsets[PEEK_MAX];
+    jint lengths[PEEK_MAX];
+    jlong stamps[PEEK_MAX];
+    for (int i = 0; i < n; i++) {
+        offsets[i] = static_cast<jint>(records[i].offset);
+        lengths[i] = static_cast<jint>(records[i].length);
+        stamps[i] = static_cast<jlong>(records[i].timestampNs);
+    }
+    env->SetIntArrayRegion(jOffsets, 0, n, offsets);
+    env->SetIntArrayRegion(jLengths, 0, n, lengths);
+    env->SetLongArrayRegion(jStamps, 0, n, stamps);
+    return n;
+}
+
+/**
+ * boolean release(long ring)
+ *
+ * 归还 peek() 认领的全部记录，每次 peek() 之后都要调用（包括返回 0 时）。
+ *
+ * @return true: 生产者因环满暂停了读取，需要唤醒它
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_sik_comm_NativeRxRing_release(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr) return JNI_FALSE;
+    return ring->Release() ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * int stats(long ring, long[] out)
+ *
+ * @return 写入的项数；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeRxRing_stats(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jlongArray jOut
+) {
+    RxRing* ring = FromHandle(handle);
+    if (ring == nullptr) return -EBADF;
+    if (jOut == nullptr || env->GetArrayLength(jOut) < RING_STATS_SIZE) return -EINVAL;
+
+    RxRingStats s{};
+    ring->Stats(&s);
+    jlong out[RING_STATS_SIZE];
+    out[RING_CAPACITY] = static_cast<jlong>(s.capacity);
+    out[RING_USED] = static_cast<jlong>(s.used);
+    out[RING_HIGH_WATER] = static_cast<jlong>(s.highWater);
+    out[RING_RECORDS] = static_cast<jlong>(s.records);
+    out[RING_DROPPED_RECORDS] = static_cast<jlong>(s.droppedRecords);
+    out[RING_DROPPED_BYTES] = static_cast<jlong>(s.droppedBytes);
+    out[RING_BLOCKED] = static_cast<jlong>(s.blocked);
+    env->SetLongArrayRegion(jOut, 0, RING_STATS_SIZE, out);
+    return RING_STATS_SIZE;
+}
+
+} // extern "C"
@@ -0,0 +1,200 @@
+#include "serial_framer.h"
+#include "comm_crc.h"
+
+#include <errno.h>
+#include <utility>
+
+SerialFramer::SerialFramer(const FramerConfig& config) : config_(config) {
+    partial_.reserve(static_cast<size_t>(config_.maxFrameSize));
+}
+
+int SerialFramer::Validate(const FramerConfig& c) {
+    if (c.maxFrameSize <= 0) return -EINVAL;
+    if (c.checkAlgorithm != CRC_ALGO_NONE && CrcWidth(c.checkAlgorithm) == 0) return -EINVAL;
+    switch (c.mode) {
+        case FRAMER_MODE_DELIMITER:
+            if (c.delimiter < 0 || c.delimiter > 0xFF) return -EINVAL;
+            if (c.escape >= 0) {
+                if (c.escape > 0xFF || c.escape == c.delimiter) return -EINVAL;
+                if (c.escapedDelimiter < 0 || c.escapedDelimiter > 0xFF) return -EINVAL;
+                if (c.escapedEscape < 0 || c.escapedEscape > 0xFF) return -EINVAL;
+            }
+            return 0;
+        case FRAMER_MODE_LENGTH_FIELD:
+            if (c.lengthSize != 1 && c.lengthSize != 2 && c.lengthSize != 4) return -EINVAL;
+            if (c.lengthOffset < 0) return -EINVAL;
+            if (c.lengthOffset + c.lengthSize > c.maxFrameSize) return -EINVAL;
+            return 0;
+        case FRAMER_MODE_FIXED:
+            if (c.fixedSize <= 0 || c.fixedSize > c.maxFrameSize) return -EINVAL;
+            return 0;
+        case FRAMER_MODE_SILENCE:
+            if (c.silenceGapUs <= 0) return -EINVAL;
+            return 0;
+        default:
+            return -EINVAL;
+    }
+}
+
+void SerialFramer::Feed(const uint8_t* data, size_t len, int64_t timestampNs) {
+    if (len == 0) return;
+    feedTimestampNs_ = timestampNs;
+    switch (config_.mode) {
+        case FRAMER_MODE_DELIMITER:
+            FeedDelimiter(data, len);
+            return;
+        case FRAMER_MODE_SILENCE:
+            if (overflow_) {
+                dropped_ += len;
+                return;
+            }
+            if (partial_.size() + len > static_cast<size_t>(config_.maxFrameSize)) {
+                // 超长：整帧作废，直到下一次静默再重新开始
+                dropped_ += partial_.size() + len;
+                partial_.clear();
+                overflow_ = true;
+                return;
+            }
+            partial_.insert(partial_.end(), data, data + len);
+            return;
+        case FRAMER_MODE_LENGTH_FIELD:
+            partial_.insert(partial_.end(), data, data + len);
+            FeedLengthField();
+            Compact();
+            return;
+        case FRAMER_MODE_FIXED:
+            partial_.insert(partial_.end(), data, data + len);
+            FeedFixed();
+            Compact();
+            return;
+        default:
+            return;
+    }
+}
+
+void SerialFramer::FeedDelimiter(const uint8_t* data, size_t len) {
+    const int delim = config_.delimiter;
+    const int esc = config_.escape;
+    const size_t max = static_cast<size_t>(config_.maxFrameSize);
+
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t b = data[i];
+        if (b == delim) {
+            // 分隔符总是结束当前帧（包括转义中途被截断的情况），空帧忽略
+            if (!overflow_ && !escaping_ && !partial_.empty()) {
+                Emit(partial_.data(), partial_.size());
+            } else if (escaping_ || overflow_) {
+                dropped_ += partial_.size();
+            }
+            partial_.clear();
+            escaping_ = false;
+            overflow_ = false;
+            continue;
+        }
+        if (overflow_) {
+            ++dropped_;
+            continue;
+        }
+        if (escaping_) {
+            escaping_ = false;
+            if (b == config_.escapedDelimiter) {
+                b = static_cast<uint8_t>(delim);
+            } else if (b == config_.escapedEscape) {
+                b = static_cast<uint8_t>(esc);
+            }
+            // 非法转义序列按原样保留（和 Linux slip 驱动的容错行为一致）
+        } else if (esc >= 0 && b == esc) {
+            escaping_ = true;
+            continue;
+        }
+        if (partial_.size() >= max) {
+            // 超长，丢弃到下一个分隔符
+            dropped_ += partial_.size() + 1;
+            partial_.clear();
+            overflow_ = true;
+            continue;
+        }
+        partial_.push_back(b);
+    }
+}
+
+void SerialFramer::FeedLengthField() {
+    const size_t headerEnd = static_cast<size_t>(config_.lengthOffset + config_.lengthSize);
+    while (partial_.size() - consumed_ >= headerEnd) {
+        const uint8_t* p = partial_.data() + consumed_ + config_.lengthOffset;
+        uint32_t value = 0;
+        for (int i = 0; i < config_.lengthSize; ++i) {
+            int shift = config_.lengthBigEndian ? (config_.lengthSize - 1 - i) * 8 : i * 8;
+            value |= static_cast<uint32_t>(p[i]) << shift;
+        }
+        int64_t total = static_cast<int64_t>(value) + config_.lengthAdjust;
+        if (total < static_cast<int64_t>(headerEnd) || total > config_.maxFrameSize) {
+            // 长度字段不可信：丢一个字节，向后滑动重新同步
+            ++consumed_;
+            ++dropped_;
+            continue;
+        }
+        size_t frameLen = static_cast<size_t>(total);
+        if (partial_.size() - consumed_ < frameLen) return;
+        Emit(partial_.data() + consumed_, frameLen);
+        consumed_ += frameLen;
+    }
+}
+
+void SerialFramer::FeedFixed() {
+    const size_t size = static_cast<size_t>(config_.fixedSize);
+    while (partial_.size() - consumed_ >= size) {
+        Emit(partial_.data() + consumed_, size);
+        consumed_ += size;
+    }
+}
+
+void SerialFramer::EndOfSilence() {
+    if (!overflow_ && !partial_.empty()) {
+        Emit(partial_.data(), partial_.size());
+    }
+    partial_.clear();
+    overflow_ = false;
+}
+
+bool SerialFramer::Verify(const uint8_t* data, size_t* len) {
+    const int width = CrcWidth(config_.checkAlgorithm);
+    if (*len < static_cast<size_t>(width)) return false;
+    const size_t body = *len - width;
+    const uint8_t* tail = data + body;
+    uint32_t expected = 0;
+    for (int i = 0; i < width; ++i) {
+        int shift = config_.checkBigEndian ? (width - 1 - i) * 8 : i * 8;
+        expected |= static_cast<uint32_t>(tail[i]) << shift;
+    }
+    if (CrcCompute(config_.checkAlgorithm, data, body) != expected) return false;
+    if (config_.checkStrip) *len = body;
+    return true;
+}
+
+void SerialFramer::Emit(const uint8_t* data, size_t len) {
+    if (config_.checkAlgorithm != CRC_ALGO_NONE && !Verify(data, &len)) {
+        ++checkFailures_;
+        return;
+    }
+    FramerFrame frame;
+    if (!spare_.empty()) {
+        frame.data = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    frame.data.assign(data, data + len);
+    frame.timestampNs = feedTimestampNs_;
+    ready_.push_back(std::move(frame));
+}
+
+void SerialFramer::Pop() {
+    if (ready_.empty()) return;
+    if (spare_.size() < 16) spare_.push_back(std::move(ready_.front().data));
+    ready_.pop_front();
+}
+
+void SerialFramer::Compact() {
+    if (consumed_ == 0) return;
+    partial_.erase(partial_.begin(), partial_.begin() + static_cast<std::ptrdiff_t>(consumed_));
+    consumed_ = 0;
+}
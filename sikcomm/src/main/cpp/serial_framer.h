@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+/**
+ * 串口分帧器：把串口读到的零散字节流重组成完整帧（“粘包 / 半包”处理）。
+ *
+ * 纯 C++，不依赖 JNI，由 framer_jni.cpp 包装给 Kotlin 使用。
+ * 同一个实例只允许在一个线程里使用（对应通道的 IO 协程）。
+ */
+
+// 分帧模式（和 Kotlin NativeFramer.MODE_* 保持一致）
+static const int FRAMER_MODE_DELIMITER    = 1;   // 分隔符 + 可选转义（SLIP 类）
+static const int FRAMER_MODE_LENGTH_FIELD = 2;   // 帧内固定偏移处的长度字段
+static const int FRAMER_MODE_FIXED        = 3;   // 固定长度
+static const int FRAMER_MODE_SILENCE      = 4;   // 线路静默（Modbus RTU 3.5 字符间隔）
+
+struct FramerConfig {
+    int mode = 0;
+    // 单帧最大长度，超过即丢弃当前帧并重新同步
+    int maxFrameSize = 4096;
+
+    // DELIMITER：escape < 0 表示不转义
+    int delimiter = -1;
+    int escape = -1;
+    int escapedDelimiter = -1;   // escape 后跟该字节表示 delimiter
+    int escapedEscape = -1;      // escape 后跟该字节表示 escape 本身
+
+    // LENGTH_FIELD：帧总长 = 长度字段值 + lengthAdjust
+    int lengthOffset = 0;
+    int lengthSize = 1;          // 1 / 2 / 4
+    bool lengthBigEndian = false;
+    int lengthAdjust = 0;
+
+    // FIXED
+    int fixedSize = 0;
+
+    // SILENCE：静默多少微秒视为一帧结束
+    int silenceGapUs = 0;
+
+    // 帧尾校验（CRC_ALGO_*），校验失败的帧直接丢弃
+    int checkAlgorithm = 0;
+    bool checkBigEndian = false;   // 帧尾校验值的字节序
+    bool checkStrip = false;       // 交付前去掉帧尾校验值
+};
+
+/**
+ * 一个完整帧及其时间戳（包含帧最后一个字节的那次 read 之前 poll 返回的 CLOCK_MONOTONIC 时间）。
+ */
+struct FramerFrame {
+    std::vector<uint8_t> data;
+    int64_t timestampNs = 0;
+};
+
+class SerialFramer {
+public:
+    explicit SerialFramer(const FramerConfig& config);
+
+    /**
+     * 校验配置是否合法。
+     *
+     * @return 0: 合法；<0: -EINVAL
+     */
+    static int Validate(const FramerConfig& config);
+
+    /**
+     * 喂入一段原始字节，凑齐的完整帧进入就绪队列。
+     *
+     * @param timestampNs 这段数据的接收时间，由此完成的帧带上该时间戳
+     */
+    void Feed(const uint8_t* data, size_t len, int64_t timestampNs = 0);
+
+    /**
+     * SILENCE 模式下线路已静默足够久：把当前累积的字节作为一帧提交。
+     */
+    void EndOfSilence();
+
+    /**
+     * 当前是否有未完成的半帧。
+     */
+    bool HasPartial() const { return !partial_.empty() || escaping_ || overflow_; }
+
+    bool IsSilenceMode() const { return config_.mode == FRAMER_MODE_SILENCE; }
+
+    int SilenceGapUs() const { return config_.silenceGapUs; }
+
+    int MaxFrameSize() const { return config_.maxFrameSize; }
+
+    bool HasReady() const { return !ready_.empty(); }
+
+    const FramerFrame& Front() const { return ready_.front(); }
+
+    void Pop();
+
+    /**
+     * 因超长 / 长度字段非法被丢弃的字节数（累计）。
+     */
+    uint64_t DroppedBytes() const { return dropped_; }
+
+    /**
+     * 帧尾校验失败被丢弃的帧数（累计）。
+     */
+    uint64_t CheckFailures() const { return checkFailures_; }
+
+private:
+    void FeedDelimiter(const uint8_t* data, size_t len);
+    void FeedLengthField();
+    void FeedFixed();
+    void Emit(const uint8_t* data, size_t len);
+    bool Verify(const uint8_t* data, size_t* len);
+    void Compact();
+
+    FramerConfig config_;
+    // 当前半帧（DELIMITER / SILENCE 为去掉转义后的内容，其余模式为原始字节）
+    std::vector<uint8_t> partial_;
+    // LENGTH_FIELD / FIXED 模式下 partial_ 中已消费的前缀长度
+    size_t consumed_ = 0;
+    bool escaping_ = false;
+    bool overflow_ = false;
+    uint64_t dropped_ = 0;
+    uint64_t checkFailures_ = 0;
+    // 最近一次 Feed 的时间戳
+    int64_t feedTimestampNs_ = 0;
+    std::deque<FramerFrame> ready_;
+    // 回收已出队帧的内存，避免稳态下反复分配
+    std::vector<std::vector<uint8_t>> spare_;
+};
@@ -0,0 +1,743 @@
+#include "serial_io.h"
+
+#include <atomic>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <time.h>
+#include <cstdio>
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <linux/serial.h>
+
+#define LOG_TAG "SerialIo"
+#include "comm_log.h"
+#include "comm_capture.h"
+#include "fd_broker.h"
+
+// SerialReadFrames 单次 read 的栈上缓冲区
+static const int SERIAL_READ_CHUNK = 4096;
+
+// SerialOpen 时按 VMIN 记下 read 可能阻塞的 fd，更大的 fd 每次查 termios
+static const int SERIAL_MAX_FDS = 1024;
+static std::atomic<bool> g_readMayBlock[SERIAL_MAX_FDS];
+
+// bionic 的 <termios.h> 已经带了 struct termios2 / BOTHER；glibc 没有，又不能和 <asm/termbits.h> 同时包含，
+// 这里按内核 uapi（asm-generic）补齐，TCGETS2 / TCSETS2 由 <sys/ioctl.h> 提供
+#ifndef BOTHER
+#define BOTHER 0010000
+struct termios2 {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+#endif
+#ifndef IBSHIFT
+#define IBSHIFT 16
+#endif
+
+/**
+ * 使用 su（交互式，无 -c）执行 chmod
+ * su 必须是无交互授权 / 已默认允许的那种，否则会卡住。
+ */
+static bool chmod_with_su(const std::string& path, mode_t mode) {
+    // 起一个 su shell，往 stdin 写命令
+    FILE* fp = popen("su", "w");
+    if (!fp) {
+        LOGE("popen(\"su\") failed");
+        return false;
+    }
+
+    // 写 chmod 命令
+    // 注意末尾一定要有换行，不然 shell 不执行
+    fprintf(fp, "chmod %o \"%s\"\n", mode, path.c_str());
+    // 不放心可以顺带再 ls 一下：
+    // fprintf(fp, "ls -l \"%s\"\n", path.c_str());
+    // 退出 su
+    fprintf(fp, "exit\n");
+    fflush(fp);
+
+    int status = pclose(fp);
+    if (status == -1) {
+        LOGE("pclose(su) failed");
+        return false;
+    }
+
+    if (WIFEXITED(status)) {
+        int code = WEXITSTATUS(status);
+        LOGI("su chmod exit code = %d", code);
+        return code == 0;
+    } else {
+        LOGW("su terminated abnormally");
+        return false;
+    }
+}
+
+
+// 波特率映射
+static speed_t GetBaudrate(int baudRate) {
+    switch (baudRate) {
+        case 0: return B0;
+        case 50: return B50;
+        case 75: return B75;
+        case 110: return B110;
+        case 134: return B134;
+        case 150: return B150;
+        case 200: return B200;
+        case 300: return B300;
+        case 600: return B600;
+        case 1200: return B1200;
+        case 1800: return B1800;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B460800
+        case 460800: return B460800;
+#endif
+#ifdef B921600
+        case 921600: return B921600;
+#endif
+        default:
+            return B0;
+    }
+}
+
+/**
+ * 用 termios2 + BOTHER 设置任意整数波特率（1.5M / 2M / 3M、DMX 250000 等非标准值）。
+ *
+ * 驱动按自己的分频能力取整，实际生效的值通过 TCGETS2 读回。
+ *
+ * @return 0: 成功；<0: -errno（ENOTTY / EINVAL: 驱动不支持任意波特率）
+ */
+static int SetCustomBaudrate(int fd, int baudRate) {
+    struct termios2 tio{};
+    if (ioctl(fd, TCGETS2, &tio) != 0) return -errno;
+    tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = static_cast<speed_t>(baudRate);
+    tio.c_ospeed = static_cast<speed_t>(baudRate);
+    if (ioctl(fd, TCSETS2, &tio) != 0) return -errno;
+    return 0;
+}
+
+/**
+ * 读回驱动实际生效的输出波特率。
+ *
+ * @return >0: 波特率；<0: -errno
+ */
+int SerialGetBaudrate(int fd) {
+    struct termios2 tio{};
+    if (ioctl(fd, TCGETS2, &tio) != 0) return -errno;
+    return static_cast<int>(tio.c_ospeed);
+}
+
+// 串口参数配置
+static int ConfigurePort(int fd, const SerialPortConfig& config, const SerialLatencyParams& lat) {
+    const int baudRate = config.baudRate;
+    const int dataBits = config.dataBits;
+    const int stopBits = config.stopBits;
+    const int parity = config.parity;
+
+    struct termios options{};
+    if (tcgetattr(fd, &options) != 0) {
+        LOGE("tcgetattr failed: %s", strerror(errno));
+        return -errno;
+    }
+
+    cfmakeraw(&options);
+
+    if (baudRate <= 0) {
+        LOGE("Unsupported baudrate: %d", baudRate);
+        return -EINVAL;
+    }
+    // 标准波特率走 Bxxx 常量；其它值先保留当前速率，参数设置完后再用 termios2 / BOTHER 单独设置
+    speed_t speed = GetBaudrate(baudRate);
+    if (speed != B0) {
+        cfsetispeed(&options, speed);
+        cfsetospeed(&options, speed);
+    }
+
+    // 数据位
+    options.c_cflag &= ~CSIZE;
+    switch (dataBits) {
+        case 5: options.c_cflag |= CS5; break;
+        case 6: options.c_cflag |= CS6; break;
+        case 7: options.c_cflag |= CS7; break;
+        case 8:
+        default: options.c_cflag |= CS8; break;
+    }
+
+    // 停止位
+    if (stopBits == 2) {
+        options.c_cflag |= CSTOPB;
+    } else {
+        options.c_cflag &= ~CSTOPB;
+    }
+
+    // 校验位：0 无，1 奇，2 偶
+    options.c_cflag &= ~(PARENB | PARODD);
+    if (parity == 1) {            // 奇
+        options.c_cflag |= (PARENB | PARODD);
+    } else if (parity == 2) {     // 偶
+        options.c_cflag |= PARENB;
+        options.c_cflag &= ~PARODD;
+    }
+
+    // 允许接收，忽略 modem 线
+    options.c_cflag |= (CLOCAL | CREAD);
+
+    // 不用软件流控
+    options.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+    // 原样输出
+    options.c_oflag &= ~OPOST;
+
+    // 默认 0 / 0：poll 就绪后读到多少算多少；块状协议可以让驱动攒够 VMIN 字节再唤醒
+    options.c_cc[VMIN]  = static_cast<cc_t>(lat.vmin);
+    options.c_cc[VTIME] = static_cast<cc_t>(lat.vtime);
+
+    if (tcsetattr(fd, TCSANOW, &options) != 0) {
+        LOGE("tcsetattr failed: %s", strerror(errno));
+        return -errno;
+    }
+
+    if (speed == B0) {
+        int ret = SetCustomBaudrate(fd, baudRate);
+        if (ret < 0) {
+            LOGE("termios2 BOTHER baudrate %d failed: %s", baudRate, strerror(-ret));
+            return ret;
+        }
+    }
+
+    int actual = SerialGetBaudrate(fd);
+    if (actual > 0 && actual != baudRate) {
+        LOGW("baudrate %d requested, driver applied %d", baudRate, actual);
+    }
+
+    return 0;
+}
+
+/**
+ * 写 USB 转串口驱动的 latency_timer（ftdi_sio 等提供，默认 16ms）。
+ *
+ * 设备路径可能是 /dev/ttyUSB0，也可能是 by-id 下的软链接，先 realpath 拿到 tty 名。
+ */
+static int SetUsbLatencyTimer(const std::string& path, int ms) {
+    char real[PATH_MAX];
+    if (realpath(path.c_str(), real) == nullptr) return -errno;
+    const char* slash = strrchr(real, '/');
+    const char* tty = slash != nullptr ? slash + 1 : real;
+
+    const char* patterns[] = {
+            "/sys/bus/usb-serial/devices/%s/latency_timer",
+            "/sys/class/tty/%s/device/latency_timer",
+    };
+    int err = ENOENT;
+    for (const char* pattern : patterns) {
+        char sysPath[PATH_MAX];
+        snprintf(sysPath, sizeof(sysPath), pattern, tty);
+        int f = ::open(sysPath, O_WRONLY | O_CLOEXEC);
+        if (f < 0) {
+            if (errno != ENOENT) err = errno;
+            continue;
+        }
+        char value[16];
+        int len = snprintf(value, sizeof(value), "%d", ms);
+        ssize_t n = ::write(f, value, static_cast<size_t>(len));
+        err = n == len ? 0 : (n < 0 ? errno : EIO);
+        ::close(f);
+        if (err == 0) return 0;
+    }
+    return -err;
+}
+
+/**
+ * 应用延迟档位中 termios 以外的部分：ASYNC_LOW_LATENCY、USB latency_timer、open 时清空缓冲。
+ *
+ * 都是尽力而为：驱动不支持（cdc-acm 没有 TIOCSSERIAL、没有 root 写不了 sysfs）只打日志。
+ */
+static void ApplyLatency(int fd, const std::string& path, const SerialLatencyParams& lat) {
+    if (lat.lowLatency) {
+        struct serial_struct ss{};
+        if (ioctl(fd, TIOCGSERIAL, &ss) != 0) {
+            LOGW("TIOCGSERIAL on %s failed: %s", path.c_str(), strerror(errno));
+        } else if ((ss.flags & ASYNC_LOW_LATENCY) == 0) {
+            ss.flags |= ASYNC_LOW_LATENCY;
+            if (ioctl(fd, TIOCSSERIAL, &ss) != 0) {
+                LOGW("ASYNC_LOW_LATENCY on %s failed: %s", path.c_str(), strerror(errno));
+            } else {
+                LOGI("ASYNC_LOW_LATENCY enabled on %s", path.c_str());
+            }
+        }
+    }
+
+    if (lat.usbTimerMs > 0) {
+        int ret = SetUsbLatencyTimer(path, lat.usbTimerMs);
+        if (ret == 0) {
+            LOGI("latency_timer of %s set to %d ms", path.c_str(), lat.usbTimerMs);
+        } else if (ret != -ENOENT) {
+            // ENOENT：不是 FTDI 类 USB 转串口，没有这个属性，正常情况
+            LOGW("latency_timer of %s: %s", path.c_str(), strerror(-ret));
+        }
+    }
+
+    if (lat.flushOnOpen && tcflush(fd, TCIOFLUSH) != 0) {
+        LOGW("tcflush on %s failed: %s", path.c_str(), strerror(errno));
+    }
+}
+
+/**
+ * 等待 fd 可写。
+ *
+ * @return >0: 就绪；0: 超时；<0: -errno
+ */
+static int WaitWritable(int fd, int timeoutMs, ChannelMetrics* m) {
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+
+    int ret = MetricsPoll(&pfd, timeoutMs, m);
+    if (ret < 0) {
+        int err = errno;
+        LOGE("write poll failed: %s", strerror(err));
+        return -err;
+    }
+    return ret;
+}
+
+/**
+ * 等待 fd 可读。
+ *
+ * @return >0: 有数据可读；0: 超时 / 无数据；<0: -errno
+ */
+int SerialWaitReadable(int fd, int timeoutMs, ChannelMetrics* m) {
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    int ret = MetricsPoll(&pfd, timeoutMs, m);
+    if (ret < 0) {
+        int err = errno;
+        LOGE("read: poll failed: %s", strerror(err));
+        return -err;
+    } else if (ret == 0) {
+        LOGV("read: poll timeout, no data");
+        return 0; // 超时无数据
+    }
+
+    LOGV("read: poll ret=%d, revents=0x%x", ret, pfd.revents);
+
+    // 这里必须判断下是不是 POLLIN，不然 POLLERR/POLLHUP 也会进来
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        LOGE("read: poll error revents=0x%x", pfd.revents);
+        MetricsError(m, EIO);
+        return -EIO;
+    }
+    if (!(pfd.revents & POLLIN)) {
+        LOGV("read: revents=0x%x but no POLLIN, skip", pfd.revents);
+        return 0;
+    }
+    return ret;
+}
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/**
+ * 完整写入 iov 描述的全部数据：poll(POLLOUT) + writev 循环，直到写完或超时。
+ *
+ * iov 会被原地推进（调用方传入可修改的副本）。
+ *
+ * @param timeoutMs 整体截止时间（毫秒），<0 表示不限时
+ * @param err       0: 全部写完；ETIMEDOUT: 超时；其它: 出错时的 errno
+ * @return          实际写入的字节数
+ */
+size_t SerialWriteFully(int fd, struct iovec* iov, int iovcnt, int timeoutMs,
+                        ChannelMetrics* m, int* err) {
+    const uint64_t deadline = MetricsNowNs() + static_cast<uint64_t>(timeoutMs) * 1000000ULL;
+    size_t total = 0;
+    *err = 0;
+
+    // 跳过空段
+    while (iovcnt > 0 && iov->iov_len == 0) {
+        ++iov;
+        --iovcnt;
+    }
+
+    while (iovcnt > 0) {
+        int waitMs = -1;
+        if (timeoutMs >= 0) {
+            uint64_t now = MetricsNowNs();
+            waitMs = now >= deadline ? 0 : static_cast<int>((deadline - now + 999999ULL) / 1000000ULL);
+        }
+        int ret = WaitWritable(fd, waitMs, m);
+        if (ret < 0) {
+            if (ret == -EINTR) continue;
+            *err = -ret;
+            return total;
+        }
+        if (ret == 0) {
+            *err = ETIMEDOUT;
+            return total;
+        }
+
+        ssize_t n = MetricsWritev(fd, iov, iovcnt < IOV_MAX ? iovcnt : IOV_MAX, m);
+        if (n < 0) {
+            if (n == -EINTR || n == -EAGAIN) continue;
+            LOGE("writev failed: %s", strerror(static_cast<int>(-n)));
+            *err = static_cast<int>(-n);
+            return total;
+        }
+        LOGV("writev: %zd bytes", n);
+        total += static_cast<size_t>(n);
+        CaptureSerialv(fd, CAPTURE_TX, iov, iovcnt, static_cast<size_t>(n));
+
+        // 按本次写入量推进 iov
+        size_t left = static_cast<size_t>(n);
+        while (iovcnt > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+    return total;
+}
+
+
+int SerialWriteResult(size_t written, int err) {
+    if (written > 0 || err == 0 || err == ETIMEDOUT) return static_cast<int>(written);
+    return -err;
+}
+
+int SerialOpen(const char* pathArg, const SerialPortConfig& config, const SerialLatencyParams* latency) {
+    if (pathArg == nullptr || pathArg[0] == '\0') {
+        LOGE("open: path is empty");
+        return -EINVAL;
+    }
+    if (latency != nullptr &&
+        (latency->vmin < 0 || latency->vmin > 255 || latency->vtime < 0 || latency->vtime > 255)) {
+        LOGE("open: invalid vmin=%d vtime=%d", latency->vmin, latency->vtime);
+        return -EINVAL;
+    }
+    const std::string path(pathArg);
+    const SerialLatencyParams lat = latency != nullptr ? *latency : SerialLatencyParams();
+
+    const int openFlags = O_RDWR | O_NOCTTY | O_NONBLOCK;
+    auto do_open = [&](const char* tag) -> int {
+        int fd = ::open(path.c_str(), openFlags);
+        if (fd < 0) {
+            int err = errno;
+            LOGE("%s open(%s) failed: %s", tag, path.c_str(), strerror(err));
+            return -err;   // 约定：负 errno
+        }
+        LOGI("%s open(%s) success, fd=%d", tag, path.c_str(), fd);
+        return fd;
+    };
+
+    // 1️⃣ 先尝试直接 open
+    int fd = do_open("first");
+    if (fd < 0) {
+        int err = -fd;
+
+        // 如果不是权限错误，没必要改权限，直接返回
+        if (err != EACCES && err != EPERM) {
+            return fd; // 负 errno
+        }
+
+        // 2️⃣ 连着 fd broker 时让常驻的特权 helper 代为 open，SCM_RIGHTS 传回 fd，不用起 su
+        if (BrokerConnected()) {
+            int bfd = BrokerOpen(path.c_str(), openFlags);
+            if (bfd >= 0) {
+                LOGI("broker open(%s) success, fd=%d", path.c_str(), bfd);
+                fd = bfd;
+            } else {
+                LOGW("broker open(%s) failed: %s", path.c_str(), strerror(-bfd));
+                // helper 明确拒绝（连接仍然正常），su 也帮不上
+                if (BrokerConnected()) return bfd;
+            }
+        }
+    }
+
+    if (fd < 0) {
+        int err = -fd;
+        LOGW("open failed with permission error (%d: %s), try chmod_with_su...",
+             err, strerror(err));
+
+        // 3️⃣ 没有 broker：用 su 去把权限改成 0666
+        if (!chmod_with_su(path, 0666)) {
+            LOGE("chmod_with_su(%s) failed", path.c_str());
+            return fd;    // 还是原来的权限错误
+        }
+
+        // 4️⃣ 权限改完再试一次 open
+        fd = do_open("after_chmod");
+        if (fd < 0) {
+            // 改完权限还不行，那就真没辙了
+            return fd;
+        }
+    }
+
+    // 走到这里，fd > 0，说明 open 已经成功了
+
+    // 清掉非阻塞
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags != -1) {
+        fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    }
+
+    int cfg = ConfigurePort(fd, config, lat);
+    if (cfg != 0) {
+        int err = -cfg;
+        LOGE("ConfigurePort failed: %d (%s)", cfg, strerror(err));
+        ::close(fd);
+        return cfg;  // 按你原来的约定：cfg 已经是负 errno
+    }
+
+    if (latency != nullptr) {
+        ApplyLatency(fd, path, *latency);
+    }
+
+    MetricsAttach(fd);
+    if (fd < SERIAL_MAX_FDS) g_readMayBlock[fd].store(lat.vmin > 0, std::memory_order_relaxed);
+
+    LOGI("ConfigurePort success on %s, fd=%d", path.c_str(), fd);
+    return fd;
+}
+
+bool SerialReadMayBlock(int fd) {
+    if (fd >= 0 && fd < SERIAL_MAX_FDS) return g_readMayBlock[fd].load(std::memory_order_relaxed);
+    struct termios options{};
+    return tcgetattr(fd, &options) == 0 && options.c_cc[VMIN] > 0;
+}
+
+ssize_t SerialRead(int fd, uint8_t* buf, size_t len, int timeoutMs, int64_t* readyNs) {
+    ChannelMetrics* m = MetricsFor(fd);
+    int ret = SerialWaitReadable(fd, timeoutMs, m);
+    if (ret <= 0) {
+        return ret; // 0 超时无数据，<0 错误
+    }
+    // poll 一返回就取时间戳，尽量贴近数据到达的时刻
+    if (readyNs != nullptr) *readyNs = static_cast<int64_t>(MetricsNowNs());
+
+    // 默认 VMIN = VTIME = 0，poll 已确认可读时 ::read 立即返回；VMIN > 0 且 VTIME > 0 时 read 会阻塞到
+    // 凑够 VMIN 字节或字节间隔超时（见 SerialReadMayBlock），buf 是 native 内存，阻塞在这里没有问题
+    ssize_t n = MetricsRead(fd, buf, len, m);
+    if (n < 0) {
+        LOGE("read: ::read failed: %s", strerror(static_cast<int>(-n)));
+    } else if (n > 0) {
+        CaptureSerial(fd, CAPTURE_RX, buf, static_cast<size_t>(n));
+    }
+    return n;
+}
+
+int SerialWaitIdle(int fd, int micros) {
+    if (micros <= 0) return 0;
+
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    struct timespec ts{};
+    ts.tv_sec = micros / 1000000;
+    ts.tv_nsec = static_cast<long>(micros % 1000000) * 1000L;
+
+    int ret;
+    do {
+        ret = ppoll(&pfd, 1, &ts, nullptr);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        int err = errno;
+        LOGE("waitIdle: ppoll failed: %s", strerror(err));
+        MetricsError(MetricsFor(fd), err);
+        return -err;
+    }
+    if (ret > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+        LOGE("waitIdle: poll revents error: 0x%x", pfd.revents);
+        return -EIO;
+    }
+    return ret > 0 ? 1 : 0;
+}
+
+int SerialDrain(int fd) {
+    int ret;
+    do {
+        ret = tcdrain(fd);
+    } while (ret != 0 && errno == EINTR);
+    if (ret != 0) {
+        int err = errno;
+        LOGE("drain: tcdrain failed: %s", strerror(err));
+        MetricsError(MetricsFor(fd), err);
+        return -err;
+    }
+    return 0;
+}
+
+int SerialFlush(int fd, int queue) {
+    int which;
+    switch (queue) {
+        case SERIAL_FLUSH_INPUT: which = TCIFLUSH; break;
+        case SERIAL_FLUSH_OUTPUT: which = TCOFLUSH; break;
+        case SERIAL_FLUSH_BOTH: which = TCIOFLUSH; break;
+        default: return -EINVAL;
+    }
+    if (tcflush(fd, which) != 0) {
+        int err = errno;
+        LOGE("flush: tcflush failed: %s", strerror(err));
+        return -err;
+    }
+    return 0;
+}
+
+void SerialClose(int fd) {
+    if (fd >= 0) {
+        if (fd < SERIAL_MAX_FDS) g_readMayBlock[fd].store(false, std::memory_order_relaxed);
+        CaptureDetach(fd);
+        ::close(fd);
+        LOGI("close fd=%d", fd);
+    }
+}
+
+/**
+ * 把就绪队列里的帧按 [int32 长度][int64 时间戳][数据] 依次写进 out，放不下为止。
+ *
+ * 比整个 out 还大的帧无法交付，直接丢弃并记为 EMSGSIZE 错误。
+ */
+static int EmitReady(SerialFramer* framer, uint8_t* out, size_t cap, size_t* pos,
+                     ChannelMetrics* m) {
+    int count = 0;
+    while (framer->HasReady()) {
+        const FramerFrame& entry = framer->Front();
+        const std::vector<uint8_t>& frame = entry.data;
+        size_t need = SERIAL_FRAME_RECORD_HEADER + frame.size();
+        if (need > cap) {
+            LOGW("frame of %zu bytes exceeds output buffer (%zu), dropped", frame.size(), cap);
+            MetricsError(m, EMSGSIZE);
+            framer->Pop();
+            continue;
+        }
+        if (*pos + need > cap) break;
+
+        uint8_t* rec = out + *pos;
+        uint32_t len = static_cast<uint32_t>(frame.size());
+        rec[0] = static_cast<uint8_t>(len);
+        rec[1] = static_cast<uint8_t>(len >> 8);
+        rec[2] = static_cast<uint8_t>(len >> 16);
+        rec[3] = static_cast<uint8_t>(len >> 24);
+        uint64_t ts = static_cast<uint64_t>(entry.timestampNs);
+        for (int i = 0; i < 8; ++i) rec[4 + i] = static_cast<uint8_t>(ts >> (8 * i));
+        memcpy(rec + SERIAL_FRAME_RECORD_HEADER, frame.data(), frame.size());
+        *pos += need;
+        ++count;
+        framer->Pop();
+    }
+    return count;
+}
+
+/**
+ * 等待 fd 可读，至多 gapUs 微秒（静默检测用，ppoll 精确到微秒）。
+ *
+ * 静默到期是 SILENCE 模式下的正常结束方式，不计入 pollTimeouts。
+ *
+ * @return >0: 可读；0: 静默到期；<0: -errno
+ */
+static int WaitGap(struct pollfd* pfd, int gapUs, ChannelMetrics* m) {
+    struct timespec ts{};
+    ts.tv_sec = gapUs / 1000000;
+    ts.tv_nsec = static_cast<long>(gapUs % 1000000) * 1000L;
+    uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+    int ret = ppoll(pfd, 1, &ts, nullptr);
+    if (ret < 0) {
+        int err = errno;
+        MetricsError(m, err);
+        return -err;
+    }
+    if (ret > 0 && m != nullptr) m->pollWait.Record(MetricsNowNs() - start);
+    return ret;
+}
+
+int SerialReadFrames(SerialFramer* framer, int fd, uint8_t* out, size_t cap, int timeoutMs) {
+    ChannelMetrics* m = MetricsFor(fd);
+    uint64_t failuresBefore = framer->CheckFailures();
+    size_t pos = 0;
+
+    int count = EmitReady(framer, out, cap, &pos, m);
+    if (framer->HasReady()) return count;   // out 已满
+
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    uint8_t chunk[SERIAL_READ_CHUNK];
+    int wait = (count > 0) ? 0 : timeoutMs;
+
+    while (true) {
+        bool gap = framer->IsSilenceMode() && framer->HasPartial();
+        int ret = gap ? WaitGap(&pfd, framer->SilenceGapUs(), m)
+                      : MetricsPoll(&pfd, wait, m);
+        if (ret < 0) {
+            int err = gap ? -ret : errno;
+            if (err == EINTR) continue;
+            LOGE("readFrames: poll failed: %s", strerror(err));
+            if (count > 0) break;
+            return -err;
+        }
+        if (ret == 0) {
+            if (gap) framer->EndOfSilence();
+            break;
+        }
+        int64_t readyNs = static_cast<int64_t>(MetricsNowNs());
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            LOGE("readFrames: poll revents error: 0x%x", pfd.revents);
+            if (count > 0) break;
+            return -EIO;
+        }
+
+        ssize_t n = MetricsRead(fd, chunk, sizeof(chunk), m);
+        if (n < 0) {
+            if (n == -EINTR) continue;
+            if (n == -EAGAIN) break;
+            LOGE("readFrames: read failed: %s", strerror(static_cast<int>(-n)));
+            if (count > 0) break;
+            return static_cast<int>(n);
+        }
+        if (n == 0) {
+            if (gap) framer->EndOfSilence();
+            break;
+        }
+        LOGV("readFrames: read %zd bytes", n);
+        CaptureSerial(fd, CAPTURE_RX, chunk, static_cast<size_t>(n));
+
+        framer->Feed(chunk, static_cast<size_t>(n), readyNs);
+        wait = 0;
+    }
+
+    for (uint64_t i = failuresBefore; i < framer->CheckFailures(); ++i) {
+        MetricsError(m, EBADMSG);
+    }
+
+    count += EmitReady(framer, out, cap, &pos, m);
+    return count;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "comm_metrics.h"
+#include "serial_framer.h"
+
+/**
+ * 串口 I/O 核心：open / termios 配置 / poll + read / 完整写入 / 分帧读取。
+ *
+ * 纯 C++，不依赖 JNI，serialport_jni.cpp / framer_jni.cpp 只做参数转换；
+ * 宿主机上可以直接对 openpty 得到的伪终端调用（见 bench/）。
+ * 所有函数出错时返回 -errno。
+ */
+
+struct SerialPortConfig {
+    int baudRate = 115200;
+    int dataBits = 8;
+    int stopBits = 1;
+    int parity = 0;              // 0 无，1 奇，2 偶
+};
+
+// 延迟档位（见 Kotlin SerialLatency）
+struct SerialLatencyParams {
+    bool lowLatency = false;
+    int usbTimerMs = 0;          // 0 表示不修改
+    int vmin = 0;
+    int vtime = 0;
+    bool flushOnOpen = false;
+};
+
+// SerialFlush() 的 queue 参数（和 Kotlin NativeSerial.FLUSH_* 保持一致）
+enum {
+    SERIAL_FLUSH_INPUT = 0,
+    SERIAL_FLUSH_OUTPUT = 1,
+    SERIAL_FLUSH_BOTH = 2
+};
+
+// SerialReadFrames 输出记录头（小端）：[0..3] int32 长度，[4..11] int64 接收时间戳（CLOCK_MONOTONIC 纳秒）
+static const int SERIAL_FRAME_RECORD_HEADER = 12;
+
+/**
+ * 打开并配置串口，成功后挂上 metrics。
+ *
+ * 权限不足（EACCES / EPERM）时先请 fd broker 代为 open，没有 broker 再用 su chmod 0666 后重试。
+ *
+ * @param latency 为 nullptr 时保持驱动默认（VMIN = VTIME = 0，不改驱动延迟）
+ * @return >=0: fd；<0: -errno
+ */
+int SerialOpen(const char* path, const SerialPortConfig& config, const SerialLatencyParams* latency);
+
+/**
+ * 读回驱动实际生效的输出波特率（TCGETS2）。
+ *
+ * @return >0: 波特率；<0: -errno
+ */
+int SerialGetBaudrate(int fd);
+
+/**
+ * 等待 fd 可读。
+ *
+ * @return >0: 有数据可读；0: 超时 / 无数据；<0: -errno
+ */
+int SerialWaitReadable(int fd, int timeoutMs, ChannelMetrics* m);
+
+/**
+ * poll 报告可读之后 ::read 是否仍可能阻塞（SerialOpen 时 VMIN > 0：VTIME > 0 时 poll 在第一个字节就绪，
+ * read 要等凑够 VMIN 字节或字节间隔超时）。这种 fd 不能在 JNI 临界区里读。
+ */
+bool SerialReadMayBlock(int fd);
+
+/**
+ * poll + read：等待至多 timeoutMs，读到多少算多少。
+ *
+ * @param readyNs 不为 nullptr 时写入 poll 返回时的 CLOCK_MONOTONIC（纳秒）
+ * @return >0: 读到的字节数；0: 超时；<0: -errno
+ */
+ssize_t SerialRead(int fd, uint8_t* buf, size_t len, int timeoutMs, int64_t* readyNs);
+
+/**
+ * 完整写入 iov 描述的全部数据：poll(POLLOUT) + writev 循环，直到写完或超时。
+ *
+ * iov 会被原地推进（调用方传入可修改的副本）。
+ *
+ * @param timeoutMs 整体截止时间（毫秒），<0 表示不限时
+ * @param err       0: 全部写完；ETIMEDOUT: 超时；其它: 出错时的 errno
+ * @return          实际写入的字节数
+ */
+size_t SerialWriteFully(int fd, struct iovec* iov, int iovcnt, int timeoutMs,
+                        ChannelMetrics* m, int* err);
+
+/**
+ * SerialWriteFully 的结果换算成返回值：写入了数据就返回字节数，否则超时为 0、出错为 -errno。
+ */
+int SerialWriteResult(size_t written, int err);
+
+/**
+ * 半双工 turnaround：用 ppoll 等待线路静默 micros 微秒，只等待不读取。
+ *
+ * @return 0: 线路静默；1: 有数据到达；<0: -errno
+ */
+int SerialWaitIdle(int fd, int micros);
+
+/**
+ * tcdrain：阻塞到输出队列里的数据全部从 UART 发出。
+ */
+int SerialDrain(int fd);
+
+/**
+ * tcflush，queue 为 SERIAL_FLUSH_*。
+ */
+int SerialFlush(int fd, int queue);
+
+void SerialClose(int fd);
+
+/**
+ * 读取串口数据并分帧，完整帧按 [int32 长度][int64 时间戳][数据] 连续写进 out。
+ *
+ * - 先交付上次放不下的帧；
+ * - 再把 fd 里已有的数据非阻塞读干净（第一次等待至多 timeoutMs）；
+ * - SILENCE 模式下有半帧时紧贴着 read 用 ppoll 等静默间隔，到期即提交该帧；
+ * - 配置了帧尾校验时只交付校验通过的帧，失败的记为 EBADMSG 错误。
+ *
+ * @return >=0: 写进 out 的帧数；<0: -errno
+ */
+int SerialReadFrames(SerialFramer* framer, int fd, uint8_t* out, size_t cap, int timeoutMs);
@@ -0,0 +1,359 @@
+#include "serial_poller.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <new>
+
+#define LOG_TAG "SerialPoller"
+#include "comm_log.h"
+#include "comm_capture.h"
+#include "comm_crc.h"
+#include "comm_metrics.h"
+#include "serial_io.h"
+
+static inline int64_t NowNs() {
+    return static_cast<int64_t>(MetricsNowNs());
+}
+
+static void PutU16(uint8_t* p, uint16_t v) {
+    memcpy(p, &v, 2);
+}
+
+static void PutI32(uint8_t* p, int32_t v) {
+    memcpy(p, &v, 4);
+}
+
+static void PutI64(uint8_t* p, int64_t v) {
+    memcpy(p, &v, 8);
+}
+
+/**
+ * ppoll 等 fd 可读，至多等到 untilNs。
+ *
+ * @return >0: 可读；0: 到期；<0: -errno（含 POLLERR / POLLHUP 时的 -EIO）
+ */
+static int WaitReadableUntil(int fd, int64_t untilNs, ChannelMetrics* m) {
+    struct pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    for (;;) {
+        int64_t left = untilNs - NowNs();
+        if (left < 0) left = 0;
+        struct timespec ts{};
+        ts.tv_sec = static_cast<time_t>(left / 1000000000LL);
+        ts.tv_nsec = static_cast<long>(left % 1000000000LL);
+        uint64_t start = (m != nullptr) ? MetricsNowNs() : 0;
+        int ret = ppoll(&pfd, 1, &ts, nullptr);
+        if (ret < 0) {
+            int err = errno;
+            if (err == EINTR) continue;
+            MetricsError(m, err);
+            return -err;
+        }
+        if (ret == 0) return 0;
+        if (m != nullptr) m->pollWait.Record(MetricsNowNs() - start);
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            LOGE("poll revents error: 0x%x", pfd.revents);
+            return -EIO;
+        }
+        return ret;
+    }
+}
+
+SerialPoller* SerialPoller::Create(const PollerParams& params, std::vector<PollRequestSpec> requests) {
+    if (requests.empty() || params.gapUs < 0 || params.charNs < 0 || params.retries < 0) return nullptr;
+    if (params.protocol != POLL_PROTOCOL_RAW && params.protocol != POLL_PROTOCOL_MODBUS_RTU) return nullptr;
+    for (const auto& r : requests) {
+        if (r.frame.empty() || r.frame.size() > POLL_MAX_RESPONSE || r.periodMs < 0 || r.timeoutMs <= 0 ||
+            r.responseLength > POLL_MAX_RESPONSE) {
+            return nullptr;
+        }
+        // Modbus RTU 请求至少是 地址 + 功能码 + CRC
+        if (params.protocol == POLL_PROTOCOL_MODBUS_RTU && r.frame.size() < 4) return nullptr;
+    }
+    return new (std::nothrow) SerialPoller(params, std::move(requests));
+}
+
+SerialPoller::SerialPoller(const PollerParams& params, std::vector<PollRequestSpec> requests)
+        : params_(params),
+          gapNs_(static_cast<int64_t>(params.gapUs) * 1000LL),
+          requests_(std::move(requests)),
+          nextDue_(requests_.size(), NowNs()) {
+}
+
+int SerialPoller::Run(int fd, uint8_t* out, int maxRecords, int budgetMs) {
+    if (out == nullptr || maxRecords <= 0) return -EINVAL;
+    const int64_t deadline = NowNs() + static_cast<int64_t>(budgetMs) * 1000000LL;
+
+    int count = 0;
+    while (count < maxRecords) {
+        // 最早到期的请求；多条同时到期时按注册顺序
+        size_t index = 0;
+        for (size_t i = 1; i < nextDue_.size(); ++i) {
+            if (nextDue_[i] < nextDue_[index]) index = i;
+        }
+        const int64_t due = nextDue_[index];
+        int64_t now = NowNs();
+        if (due > now) {
+            // 已有结果就先交付；否则空等到期（期间线路上的字节读掉丢弃）
+            if (count > 0 || now >= deadline) break;
+            int ret = AwaitSilence(fd, std::min(due, deadline));
+            if (ret < 0) return ret;
+            continue;
+        }
+
+        uint64_t late = static_cast<uint64_t>(now - due);
+        if (late > maxLatenessNs_.load(std::memory_order_relaxed)) {
+            maxLatenessNs_.store(late, std::memory_order_relaxed);
+        }
+
+        int ret = Transact(fd, index, due, out + static_cast<size_t>(count) * POLL_RECORD_SIZE);
+        if (ret < 0) return count > 0 ? count : ret;
+        ++count;
+
+        // 排下一次：保持相位，错过的周期直接跳过，不补发
+        const int64_t period = static_cast<int64_t>(requests_[index].periodMs) * 1000000LL;
+        now = NowNs();
+        if (period <= 0) {
+            nextDue_[index] = now;
+        } else {
+            int64_t next = due + period;
+            if (next <= now) {
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+                next += ((now - next) / period + 1) * period;
+            }
+            nextDue_[index] = next;
+        }
+
+        if (now >= deadline) break;
+    }
+    return count;
+}
+
+int SerialPoller::Transact(int fd, size_t index, int64_t dueNs, uint8_t* rec) {
+    const PollRequestSpec& req = requests_[index];
+    ChannelMetrics* m = MetricsFor(fd);
+    const size_t size = req.frame.size();
+    // Modbus 广播（地址 0）没有应答
+    const bool noResponse = req.responseLength < 0 ||
+                            (params_.protocol == POLL_PROTOCOL_MODBUS_RTU && req.frame[0] == 0);
+
+    int status = POLL_TIMEOUT;
+    int attempts = 0;
+    int got = 0;
+    int64_t sentNs = 0;
+    int64_t lastNs = 0;
+    for (;;) {
+        ++attempts;
+        int ret = AwaitSilence(fd, 0);
+        if (ret < 0) return ret;
+
+        struct iovec iov{const_cast<uint8_t*>(req.frame.data()), size};
+        int err = 0;
+        int64_t start = NowNs();
+        size_t written = SerialWriteFully(fd, &iov, 1, req.timeoutMs, m, &err);
+        int64_t now = NowNs();
+        if (written != size) {
+            if (err != ETIMEDOUT) return -err;
+            status = POLL_IO_ERROR;
+            got = 0;
+            lastLineNs_ = now;
+            break;
+        }
+        // write 返回时数据可能还在 UART FIFO 里，按字符时间估算最后一个字节离开的时刻
+        sentNs = std::max(now, start + static_cast<int64_t>(size) * params_.charNs);
+        lastLineNs_ = sentNs;
+
+        got = 0;
+        lastNs = 0;
+        if (noResponse) {
+            status = POLL_OK;
+            break;
+        }
+        ret = Receive(fd, req, sentNs + static_cast<int64_t>(req.timeoutMs) * 1000000LL, &got, &lastNs);
+        if (ret < 0) return ret;
+        if (lastNs != 0) lastLineNs_ = lastNs;
+
+        status = Classify(req, got, ret == 1);
+        if ((status == POLL_TIMEOUT || status == POLL_BAD_CRC) && attempts <= params_.retries) {
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        break;
+    }
+
+    transactions_.fetch_add(1, std::memory_order_relaxed);
+    switch (status) {
+        case POLL_TIMEOUT: timeouts_.fetch_add(1, std::memory_order_relaxed); break;
+        case POLL_BAD_CRC: badCrc_.fetch_add(1, std::memory_order_relaxed); break;
+        case POLL_MISMATCH: mismatches_.fetch_add(1, std::memory_order_relaxed); break;
+        case POLL_EXCEPTION: exceptions_.fetch_add(1, std::memory_order_relaxed); break;
+        default: break;
+    }
+
+    int len = std::min(got, POLL_MAX_RESPONSE);
+    PutI32(rec, req.tag);
+    rec[4] = static_cast<uint8_t>(status);
+    rec[5] = static_cast<uint8_t>(std::min(attempts, 255));
+    PutU16(rec + 6, static_cast<uint16_t>(len));
+    PutI64(rec + 8, dueNs);
+    PutI64(rec + 16, sentNs);
+    PutI64(rec + 24, lastNs);
+    memcpy(rec + POLL_RECORD_HEADER, rx_, static_cast<size_t>(len));
+    return 0;
+}
+
+/**
+ * 收应答直到完整、超时或（长度未知时）字节间静默超过帧间隔。
+ *
+ * 长度已知时 got 不超过该长度，多读到的字节计入 strayBytes_。
+ *
+ * @return 1: 应答完整；0: 超时（got 可能是半截应答）；<0: -errno
+ */
+int SerialPoller::Receive(int fd, const PollRequestSpec& req, int64_t deadlineNs, int* got, int64_t* lastNs) {
+    ChannelMetrics* m = MetricsFor(fd);
+    int expected = ExpectedLength(req, 0);
+    for (;;) {
+        // 长度未知且已经收到数据时，静默满帧间隔即视为应答结束；
+        // 长度已知时一直等到收满或超时（USB 转串口按块上报，块间隔不代表帧结束）
+        const bool silenceEnds = expected == 0 && *got > 0;
+        int64_t until = silenceEnds ? std::min(deadlineNs, *lastNs + gapNs_) : deadlineNs;
+        int ret = WaitReadableUntil(fd, until, m);
+        if (ret < 0) return ret;
+        if (ret == 0) {
+            if (silenceEnds) return 1;
+            if (NowNs() >= deadlineNs) return 0;
+            continue;
+        }
+
+        int64_t readyNs = NowNs();
+        size_t room = sizeof(rx_) - static_cast<size_t>(*got);
+        ssize_t n = MetricsRead(fd, rx_ + *got, room, m);
+        if (n < 0) {
+            if (n == -EINTR || n == -EAGAIN) continue;
+            LOGE("poll: read failed: %s", strerror(static_cast<int>(-n)));
+            return static_cast<int>(n);
+        }
+        if (n == 0) continue;
+        CaptureSerial(fd, CAPTURE_RX, rx_ + *got, static_cast<size_t>(n));
+        *got += static_cast<int>(n);
+        *lastNs = readyNs;
+
+        expected = ExpectedLength(req, *got);
+        if (expected > 0 && *got >= expected) {
+            // 一次 read 可能把应答后面的字节也带进来：只留应答本身，多出来的记为杂散字节，
+            // lastNs 已更新，下一次 AwaitSilence 从这里起等满帧间隔
+            if (*got > expected) {
+                strayBytes_.fetch_add(static_cast<uint64_t>(*got - expected), std::memory_order_relaxed);
+                *got = expected;
+            }
+            return 1;
+        }
+        if (static_cast<size_t>(*got) >= sizeof(rx_)) return 1;
+    }
+}
+
+/**
+ * 应答的完整长度。
+ *
+ * @return >0: 长度；0: 未知，按字节间静默判定结束；<0: 还要再收几个字节才能判断
+ */
+int SerialPoller::ExpectedLength(const PollRequestSpec& req, int got) const {
+    if (req.responseLength > 0) return req.responseLength;
+    if (params_.protocol != POLL_PROTOCOL_MODBUS_RTU) return 0;
+    if (got < 2) return -1;
+
+    const uint8_t function = rx_[1];
+    if (function & 0x80) return 5;   // 地址 + 功能码 + 异常码 + CRC
+    switch (function) {
+        case 0x01:
+        case 0x02:
+        case 0x03:
+        case 0x04:
+        case 0x0C:
+        case 0x11:
+        case 0x14:
+        case 0x15:
+        case 0x17:
+            // 地址 + 功能码 + 字节数 + 数据 + CRC
+            return got < 3 ? -1 : 5 + rx_[2];
+        case 0x05:
+        case 0x06:
+        case 0x08:
+        case 0x0F:
+        case 0x10:
+            return 8;
+        case 0x16:
+            return 10;
+        default:
+            return 0;
+    }
+}
+
+int SerialPoller::Classify(const PollRequestSpec& req, int got, bool complete) const {
+    if (got == 0 || !complete) return POLL_TIMEOUT;
+    if (params_.protocol != POLL_PROTOCOL_MODBUS_RTU) return POLL_OK;
+
+    if (got < 4 || got > POLL_MAX_RESPONSE) return POLL_BAD_CRC;
+    uint16_t crc = Crc16Modbus(rx_, static_cast<size_t>(got - 2));
+    uint16_t received = static_cast<uint16_t>(rx_[got - 2] | (rx_[got - 1] << 8));
+    if (crc != received) return POLL_BAD_CRC;
+    if (rx_[0] != req.frame[0] || (rx_[1] & 0x7F) != (req.frame[1] & 0x7F)) return POLL_MISMATCH;
+    if (rx_[1] & 0x80) return POLL_EXCEPTION;
+    return POLL_OK;
+}
+
+/**
+ * 等到 untilNs，并且线路已经静默满帧间隔；期间收到的字节读掉丢弃。
+ */
+int SerialPoller::AwaitSilence(int fd, int64_t untilNs) {
+    ChannelMetrics* m = MetricsFor(fd);
+    for (;;) {
+        int64_t target = std::max(untilNs, lastLineNs_ + gapNs_);
+        if (NowNs() >= target) return 0;
+        int ret = WaitReadableUntil(fd, target, m);
+        if (ret < 0) return ret;
+        if (ret > 0) {
+            ret = Discard(fd);
+            if (ret < 0) return ret;
+        }
+    }
+}
+
+/**
+ * 非阻塞地读掉 fd 里已有的数据（VMIN = VTIME = 0，没有数据时 read 立即返回 0）。
+ */
+int SerialPoller::Discard(int fd) {
+    ChannelMetrics* m = MetricsFor(fd);
+    uint8_t scratch[256];
+    for (;;) {
+        ssize_t n = MetricsRead(fd, scratch, sizeof(scratch), m);
+        if (n < 0) {
+            if (n == -EINTR) continue;
+            if (n == -EAGAIN) return 0;
+            LOGE("poll: discard read failed: %s", strerror(static_cast<int>(-n)));
+            return static_cast<int>(n);
+        }
+        if (n == 0) return 0;
+        CaptureSerial(fd, CAPTURE_RX, scratch, static_cast<size_t>(n));
+        strayBytes_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        lastLineNs_ = NowNs();
+        if (static_cast<size_t>(n) < sizeof(scratch)) return 0;
+    }
+}
+
+void SerialPoller::Stats(PollerStats* out) const {
+    out->transactions = transactions_.load(std::memory_order_relaxed);
+    out->timeouts = timeouts_.load(std::memory_order_relaxed);
+    out->badCrc = badCrc_.load(std::memory_order_relaxed);
+    out->mismatches = mismatches_.load(std::memory_order_relaxed);
+    out->exceptions = exceptions_.load(std::memory_order_relaxed);
+    out->retries = retries_.load(std::memory_order_relaxed);
+    out->strayBytes = strayBytes_.load(std::memory_order_relaxed);
+    out->overruns = overruns_.load(std::memory_order_relaxed);
+    out->maxLatenessNs = maxLatenessNs_.load(std::memory_order_relaxed);
+}
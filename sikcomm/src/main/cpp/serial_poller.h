@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+/**
+ * 串口循环轮询引擎（RS485 / Modbus 主站）。
+ *
+ * 一组请求，每条有自己的周期和应答超时。Run() 在调用线程里按到期时间依次执行事务：
+ * 等线路静默满帧间隔 → 写请求 → 等应答（按协议判定完整 / 字节间静默结束）→ 校验并和请求配对，
+ * 结果按定长记录写进调用方的缓冲区，一次 Run() 交付一批。
+ *
+ * 事务之间收到的字节（迟到的应答、线路噪声）直接读掉丢弃并计数，不会被当成下一条请求的应答。
+ * 同一个实例只允许在一个线程里调用 Run()（对应通道的 IO 协程），Stats() 可以在任意线程调用。
+ */
+
+// 应答判定方式（和 Kotlin PollProtocol 的顺序保持一致）
+enum {
+    POLL_PROTOCOL_RAW = 0,          // 按 responseLength 或字节间静默判定应答结束，不校验
+    POLL_PROTOCOL_MODBUS_RTU = 1    // 按功能码推算应答长度，校验 CRC、从站地址和功能码
+};
+
+// 结果状态（和 Kotlin PollResults.STATUS_* 保持一致）
+enum {
+    POLL_OK = 0,
+    POLL_TIMEOUT = 1,        // 超时没有（完整的）应答
+    POLL_BAD_CRC = 2,        // 应答 CRC 错误
+    POLL_MISMATCH = 3,       // 应答的从站地址 / 功能码和请求不符
+    POLL_EXCEPTION = 4,      // Modbus 异常应答（功能码最高位置 1），数据照常交付
+    POLL_IO_ERROR = 5        // 写请求失败
+};
+
+// 结果记录（小端）：
+// [0..3] tag，[4] 状态，[5] 尝试次数，[6..7] 应答长度，
+// [8..15] 计划执行时间，[16..23] 请求最后一个字节发出的时间（估算），[24..31] 收到应答最后一块数据的时间，
+// [32..] 应答原始字节（含 CRC），都是 CLOCK_MONOTONIC 纳秒
+static const int POLL_MAX_RESPONSE = 256;
+static const int POLL_RECORD_HEADER = 32;
+static const int POLL_RECORD_SIZE = POLL_RECORD_HEADER + POLL_MAX_RESPONSE;
+
+struct PollerParams {
+    int protocol = POLL_PROTOCOL_MODBUS_RTU;
+    int gapUs = 1750;        // 帧间静默：发送前线路至少空闲这么久；应答中字节间隔超过它视为应答结束
+    int charNs = 0;          // 每个字符在线路上的传输时间，用来估算请求真正发完的时刻
+    int retries = 0;         // 超时 / CRC 错误时的立即重试次数
+};
+
+struct PollRequestSpec {
+    int32_t tag = 0;
+    int periodMs = 0;        // 0 表示每轮都执行（尽快）
+    int timeoutMs = 100;     // 从请求发完开始计
+    int responseLength = 0;  // >0 时收满该长度即结束；0 按协议 / 静默判定；<0 表示不等应答
+    std::vector<uint8_t> frame;
+};
+
+struct PollerStats {
+    uint64_t transactions;   // 完成的事务数（含失败）
+    uint64_t timeouts;
+    uint64_t badCrc;
+    uint64_t mismatches;
+    uint64_t exceptions;
+    uint64_t retries;
+    uint64_t strayBytes;     // 事务之外收到并丢弃的字节数
+    uint64_t overruns;       // 请求到期时已经错过了至少一个周期的次数
+    uint64_t maxLatenessNs;  // 实际开始时间相对计划时间的最大延后
+};
+
+class SerialPoller {
+public:
+    /**
+     * @return nullptr: 参数非法（没有请求、请求为空或超过 POLL_MAX_RESPONSE 等）
+     */
+    static SerialPoller* Create(const PollerParams& params, std::vector<PollRequestSpec> requests);
+
+    SerialPoller(const SerialPoller&) = delete;
+    SerialPoller& operator=(const SerialPoller&) = delete;
+
+    /**
+     * 执行到期的事务，结果写进 out（每条 POLL_RECORD_SIZE 字节）。
+     *
+     * - 有到期请求时连续执行，直到 out 写满、没有到期请求或 budgetMs 用完；
+     * - 一条结果都还没有时，等到下一条请求到期（至多 budgetMs），期间收到的字节丢弃；
+     * - 已经有结果而下一条请求还没到期时立即返回，结果尽早交付。
+     *
+     * @return >=0: 写进 out 的结果数；<0: -errno（fd 出错，应停止轮询）
+     */
+    int Run(int fd, uint8_t* out, int maxRecords, int budgetMs);
+
+    void Stats(PollerStats* out) const;
+
+private:
+    SerialPoller(const PollerParams& params, std::vector<PollRequestSpec> requests);
+
+    int Transact(int fd, size_t index, int64_t dueNs, uint8_t* rec);
+    int Receive(int fd, const PollRequestSpec& req, int64_t deadlineNs, int* got, int64_t* lastNs);
+    int Classify(const PollRequestSpec& req, int got, bool complete) const;
+    int ExpectedLength(const PollRequestSpec& req, int got) const;
+    int AwaitSilence(int fd, int64_t untilNs);
+    int Discard(int fd);
+
+    const PollerParams params_;
+    const int64_t gapNs_;
+    const std::vector<PollRequestSpec> requests_;
+    std::vector<int64_t> nextDue_;
+
+    int64_t lastLineNs_ = 0;     // 线路上最后一次有数据（收到的字节 / 请求发完）的时间
+    uint8_t rx_[POLL_MAX_RESPONSE + 64];
+
+    std::atomic<uint64_t> transactions_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> badCrc_{0};
+    std::atomic<uint64_t> mismatches_{0};
+    std::atomic<uint64_t> exceptions_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> strayBytes_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> maxLatenessNs_{0};
+};
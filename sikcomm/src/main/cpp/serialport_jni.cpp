@@ -1,56 +1,29 @@
 #include <jni.h>
+#include <algorithm>
 #include <string>
-#include <fcntl.h>
-#include <unistd.h>
-#include <termios.h>
-#include <poll.h>
-#include <cstdio>
+#include <vector>
 #include <errno.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <android/log.h>
+#include <stdint.h>
+#include <sys/uio.h>
 
 #define LOG_TAG "NativeSerial"
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
-
-/**
- * 使用 su（交互式，无 -c）执行 chmod
- * su 必须是无交互授权 / 已默认允许的那种，否则会卡住。
- */
-static bool chmod_with_su(const std::string& path, mode_t mode) {
-    // 起一个 su shell，往 stdin 写命令
-    FILE* fp = popen("su", "w");
-    if (!fp) {
-        LOGE("popen(\"su\") failed");
-        return false;
-    }
-
-    // 写 chmod 命令
-    // 注意末尾一定要有换行，不然 shell 不执行
-    fprintf(fp, "chmod %o \"%s\"\n", mode, path.c_str());
-    // 不放心可以顺带再 ls 一下：
-    // fprintf(fp, "ls -l \"%s\"\n", path.c_str());
-    // 退出 su
-    fprintf(fp, "exit\n");
-    fflush(fp);
-
-    int status = pclose(fp);
-    if (status == -1) {
-        LOGE("pclose(su) failed");
-        return false;
-    }
-
-    if (WIFEXITED(status)) {
-        int code = WEXITSTATUS(status);
-        LOGI("su chmod exit code = %d", code);
-        return code == 0;
-    } else {
-        LOGW("su terminated abnormally");
-        return false;
-    }
-}
+#include "comm_log.h"
+#include "comm_capture.h"
+#include "serial_io.h"
+
+// VMIN > 0 时 read 先读进栈上缓冲区，单次至多这么多字节
+static const int SERIAL_JNI_READ_CHUNK = 4096;
+
+// open() latency 参数数组下标（和 Kotlin NativeSerial.LATENCY_* 保持一致）
+enum {
+    LATENCY_LOW_LATENCY = 0,
+    LATENCY_USB_TIMER_MS,
+    LATENCY_VMIN,
+    LATENCY_VTIME,
+    LATENCY_FLUSH_ON_OPEN,
+    LATENCY_COUNT
+};
 
 // jstring → std::string
 static std::string JStringToString(JNIEnv* env, jstring jstr) {
@@ -62,107 +35,24 @@ static std::string JStringToString(JNIEnv* env, jstring jstr) {
     return res;
 }
 
-// 波特率映射
-static speed_t GetBaudrate(jint baudRate) {
-    switch (baudRate) {
-        case 0: return B0;
-        case 50: return B50;
-        case 75: return B75;
-        case 110: return B110;
-        case 134: return B134;
-        case 150: return B150;
-        case 200: return B200;
-        case 300: return B300;
-        case 600: return B600;
-        case 1200: return B1200;
-        case 1800: return B1800;
-        case 2400: return B2400;
-        case 4800: return B4800;
-        case 9600: return B9600;
-        case 19200: return B19200;
-        case 38400: return B38400;
-        case 57600: return B57600;
-        case 115200: return B115200;
-        case 230400: return B230400;
-#ifdef B460800
-        case 460800: return B460800;
-#endif
-#ifdef B921600
-        case 921600: return B921600;
-#endif
-        default:
-            return B0;
-    }
-}
-
-// 串口参数配置
-static int ConfigurePort(int fd, jint baudRate, jint dataBits, jint stopBits, jint parity) {
-    struct termios options{};
-    if (tcgetattr(fd, &options) != 0) {
-        LOGE("tcgetattr failed: %s", strerror(errno));
-        return -errno;
-    }
-
-    cfmakeraw(&options);
-
-    speed_t speed = GetBaudrate(baudRate);
-    if (speed == B0) {
-        LOGE("Unsupported baudrate: %d", baudRate);
-        return -EINVAL;
-    }
-    cfsetispeed(&options, speed);
-    cfsetospeed(&options, speed);
-
-    // 数据位
-    options.c_cflag &= ~CSIZE;
-    switch (dataBits) {
-        case 5: options.c_cflag |= CS5; break;
-        case 6: options.c_cflag |= CS6; break;
-        case 7: options.c_cflag |= CS7; break;
-        case 8:
-        default: options.c_cflag |= CS8; break;
-    }
-
-    // 停止位
-    if (stopBits == 2) {
-        options.c_cflag |= CSTOPB;
-    } else {
-        options.c_cflag &= ~CSTOPB;
-    }
-
-    // 校验位：0 无，1 奇，2 偶
-    options.c_cflag &= ~(PARENB | PARODD);
-    if (parity == 1) {            // 奇
-        options.c_cflag |= (PARENB | PARODD);
-    } else if (parity == 2) {     // 偶
-        options.c_cflag |= PARENB;
-        options.c_cflag &= ~PARODD;
-    }
-
-    // 允许接收，忽略 modem 线
-    options.c_cflag |= (CLOCAL | CREAD);
-
-    // 不用软件流控
-    options.c_iflag &= ~(IXON | IXOFF | IXANY);
-
-    // 原样输出
-    options.c_oflag &= ~OPOST;
-
-    options.c_cc[VMIN]  = 0;
-    options.c_cc[VTIME] = 0;
-
-    if (tcsetattr(fd, TCSANOW, &options) != 0) {
-        LOGE("tcsetattr failed: %s", strerror(errno));
-        return -errno;
-    }
-
-    return 0;
+/**
+ * 取 direct ByteBuffer 的 [offset, offset + length) 区间地址，越界返回 nullptr。
+ */
+static uint8_t* DirectRegion(JNIEnv* env, jobject jBuffer, jint offset, jint length) {
+    if (jBuffer == nullptr || offset < 0 || length <= 0) return nullptr;
+    auto* base = static_cast<uint8_t*>(env->GetDirectBufferAddress(jBuffer));
+    jlong capacity = env->GetDirectBufferCapacity(jBuffer);
+    if (base == nullptr || capacity < 0) return nullptr;
+    if (static_cast<jlong>(offset) + length > capacity) return nullptr;
+    return base + offset;
 }
 
 extern "C" {
 
 /**
- * jlong open(String path, int baudRate, int dataBits, int stopBits, int parity)
+ * jlong open(String path, int baudRate, int dataBits, int stopBits, int parity, int[] latency)
+ *
+ * latency 为 null 时保持驱动默认（VMIN = VTIME = 0，不改驱动延迟）。
  */
 JNIEXPORT jlong JNICALL
 Java_com_sik_comm_NativeSerial_open(
@@ -172,7 +62,8 @@ Java_com_sik_comm_NativeSerial_open(
         jint baudRate,
         jint dataBits,
         jint stopBits,
-        jint parity
+        jint parity,
+        jintArray jLatency
 ) {
     std::string path = JStringToString(env, jPath);
     if (path.empty()) {
@@ -180,61 +71,28 @@ Java_com_sik_comm_NativeSerial_open(
         return -EINVAL;
     }
 
-    auto do_open = [&](const char* tag) -> int {
-        int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
-        if (fd < 0) {
-            int err = errno;
-            LOGE("%s open(%s) failed: %s", tag, path.c_str(), strerror(err));
-            return -err;   // 约定：负 errno
-        }
-        LOGI("%s open(%s) success, fd=%d", tag, path.c_str(), fd);
-        return fd;
-    };
-
-    // 1️⃣ 先尝试直接 open
-    int fd = do_open("first");
-    if (fd < 0) {
-        int err = -fd;
-
-        // 如果不是权限错误，没必要改权限，直接返回
-        if (err != EACCES && err != EPERM) {
-            return fd; // 负 errno
-        }
-
-        LOGW("open failed with permission error (%d: %s), try chmod_with_su...",
-             err, strerror(err));
-
-        // 2️⃣ 用 su 去把权限改成 0666
-        if (!chmod_with_su(path, 0666)) {
-            LOGE("chmod_with_su(%s) failed", path.c_str());
-            return fd;    // 还是原来的权限错误
-        }
-
-        // 3️⃣ 权限改完再试一次 open
-        fd = do_open("after_chmod");
-        if (fd < 0) {
-            // 改完权限还不行，那就真没辙了
-            return fd;
+    SerialLatencyParams lat;
+    if (jLatency != nullptr) {
+        if (env->GetArrayLength(jLatency) < LATENCY_COUNT) {
+            LOGE("open: latency params too short");
+            return -EINVAL;
         }
+        jint p[LATENCY_COUNT];
+        env->GetIntArrayRegion(jLatency, 0, LATENCY_COUNT, p);
+        lat.lowLatency = p[LATENCY_LOW_LATENCY] != 0;
+        lat.usbTimerMs = p[LATENCY_USB_TIMER_MS];
+        lat.vmin = p[LATENCY_VMIN];
+        lat.vtime = p[LATENCY_VTIME];
+        lat.flushOnOpen = p[LATENCY_FLUSH_ON_OPEN] != 0;
     }
 
-    // 走到这里，fd > 0，说明 open 已经成功了
-
-    // 清掉非阻塞
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags != -1) {
-        fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
-    }
-
-    int cfg = ConfigurePort(fd, baudRate, dataBits, stopBits, parity);
-    if (cfg != 0) {
-        int err = -cfg;
-        LOGE("ConfigurePort failed: %d (%s)", cfg, strerror(err));
-        ::close(fd);
-        return cfg;  // 按你原来的约定：cfg 已经是负 errno
-    }
+    SerialPortConfig config;
+    config.baudRate = baudRate;
+    config.dataBits = dataBits;
+    config.stopBits = stopBits;
+    config.parity = parity;
 
-    LOGI("ConfigurePort success on %s, fd=%d", path.c_str(), fd);
+    int fd = SerialOpen(path.c_str(), config, jLatency != nullptr ? &lat : nullptr);
     return static_cast<jlong>(fd);
 }
 
@@ -258,31 +116,14 @@ Java_com_sik_comm_NativeSerial_write(
     jsize arrayLen = env->GetArrayLength(jData);
     if (offset < 0 || length < 0 || offset + length > arrayLen) return -EINVAL;
 
-    struct pollfd pfd{};
-    pfd.fd = fd;
-    pfd.events = POLLOUT;
-
-    int ret = poll(&pfd, 1, timeoutMs);
-    if (ret < 0) {
-        int err = errno;
-        LOGE("write poll failed: %s", strerror(err));
-        return -err;
-    } else if (ret == 0) {
-        return 0; // 超时
-    }
-
     jbyte* buf = env->GetByteArrayElements(jData, nullptr);
     if (buf == nullptr) return -ENOMEM;
 
-    ssize_t written = ::write(fd, buf + offset, static_cast<size_t>(length));
-    int savedErr = errno;
+    struct iovec iov{buf + offset, static_cast<size_t>(length)};
+    int err = 0;
+    size_t written = SerialWriteFully(fd, &iov, 1, timeoutMs, MetricsFor(fd), &err);
     env->ReleaseByteArrayElements(jData, buf, JNI_ABORT);
-
-    if (written < 0) {
-        LOGE("write failed: %s", strerror(savedErr));
-        return -savedErr;
-    }
-    return static_cast<jint>(written);
+    return SerialWriteResult(written, err);
 }
 
 /**
@@ -315,55 +156,256 @@ Java_com_sik_comm_NativeSerial_read(
         return -EINVAL;
     }
 
-    struct pollfd pfd{};
-    pfd.fd = fd;
-    pfd.events = POLLIN;
-
-    LOGI("read: fd=%d, offset=%d, length=%d, timeout=%d",
+    LOGV("read: fd=%d, offset=%d, length=%d, timeout=%d",
          fd, offset, length, timeoutMs);
 
-    int ret = poll(&pfd, 1, timeoutMs);
-    if (ret < 0) {
-        int err = errno;
-        LOGE("read: poll failed: %s", strerror(err));
-        return -err;
-    } else if (ret == 0) {
-        LOGI("read: poll timeout, no data");
-        return 0; // 超时无数据
+    ChannelMetrics* m = MetricsFor(fd);
+    int ret = SerialWaitReadable(fd, timeoutMs, m);
+    if (ret <= 0) {
+        return ret; // 0 超时无数据，<0 错误
     }
 
-    LOGI("read: poll ret=%d, revents=0x%x", ret, pfd.revents);
-
-    // 这里必须判断下是不是 POLLIN，不然 POLLERR/POLLHUP 也会进来
-    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-        LOGE("read: poll error revents=0x%x", pfd.revents);
-        return -EIO;
-    }
-    if (!(pfd.revents & POLLIN)) {
-        LOGW("read: revents=0x%x but no POLLIN, skip", pfd.revents);
-        return 0;
+    // VMIN > 0 时 ::read 可能阻塞到凑够 VMIN 字节或字节间隔超时，不能占着临界区（会挡住 GC）：
+    // 先读进栈上缓冲区再拷进数组
+    if (SerialReadMayBlock(fd)) {
+        uint8_t chunk[SERIAL_JNI_READ_CHUNK];
+        size_t want = std::min(static_cast<size_t>(length), sizeof(chunk));
+        ssize_t n = MetricsRead(fd, chunk, want, m);
+        if (n < 0) {
+            LOGE("read: ::read failed: %s", strerror(static_cast<int>(-n)));
+            return static_cast<jint>(n);
+        }
+        if (n > 0) {
+            CaptureSerial(fd, CAPTURE_RX, chunk, static_cast<size_t>(n));
+            env->SetByteArrayRegion(jBuffer, offset, static_cast<jsize>(n), reinterpret_cast<const jbyte*>(chunk));
+        }
+        LOGV("read: got %zd bytes", n);
+        return static_cast<jint>(n);
     }
 
-    jbyte* buf = env->GetByteArrayElements(jBuffer, nullptr);
+    // VMIN = 0 且 poll 已确认可读，::read 立即返回，临界区很短，
+    // 用 GetPrimitiveArrayCritical 避免整块数组拷入拷出
+    void* buf = env->GetPrimitiveArrayCritical(jBuffer, nullptr);
     if (buf == nullptr) {
-        LOGE("read: GetByteArrayElements failed");
+        LOGE("read: GetPrimitiveArrayCritical failed");
         return -ENOMEM;
     }
 
-    ssize_t n = ::read(fd, buf + offset, static_cast<size_t>(length));
-    int savedErr = errno;
+    ssize_t n = MetricsRead(fd, static_cast<uint8_t*>(buf) + offset, static_cast<size_t>(length), m);
+    if (n > 0) CaptureSerial(fd, CAPTURE_RX, static_cast<uint8_t*>(buf) + offset, static_cast<size_t>(n));
 
-    env->ReleaseByteArrayElements(jBuffer, buf, 0);
+    env->ReleasePrimitiveArrayCritical(jBuffer, buf, 0);
 
     if (n < 0) {
-        LOGE("read: ::read failed: %s", strerror(savedErr));
-        return -savedErr;
+        LOGE("read: ::read failed: %s", strerror(static_cast<int>(-n)));
+        return static_cast<jint>(n);
+    }
+
+    LOGV("read: got %zd bytes", n);
+    return static_cast<jint>(n);
+}
+
+/**
+ * int writeDirect(long handle, ByteBuffer buffer, int offset, int length, int timeoutMs)
+ *
+ * buffer 必须是 direct ByteBuffer，数据直接从 native 内存写给内核，不经过 JNI 数组拷贝。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_writeDirect(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jobject jBuffer,
+        jint offset,
+        jint length,
+        jint timeoutMs
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+
+    uint8_t* buf = DirectRegion(env, jBuffer, offset, length);
+    if (buf == nullptr) return -EINVAL;
+
+    struct iovec iov{buf, static_cast<size_t>(length)};
+    int err = 0;
+    size_t written = SerialWriteFully(fd, &iov, 1, timeoutMs, MetricsFor(fd), &err);
+    return SerialWriteResult(written, err);
+}
+
+/**
+ * int readDirect(long handle, ByteBuffer buffer, int offset, int length, int timeoutMs, long[] stamp)
+ *
+ * buffer 必须是 direct ByteBuffer，内核直接把数据读进这块内存，Kotlin 侧可以原地读取。
+ * stamp 不为 null 时，读到数据后把 poll 返回时的 CLOCK_MONOTONIC（纳秒）写进 stamp[0]。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_readDirect(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jobject jBuffer,
+        jint offset,
+        jint length,
+        jint timeoutMs,
+        jlongArray jStamp
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+
+    uint8_t* buf = DirectRegion(env, jBuffer, offset, length);
+    if (buf == nullptr) {
+        LOGE("readDirect: invalid buffer offset=%d length=%d", offset, length);
+        return -EINVAL;
     }
 
-    LOGI("read: got %zd bytes", n);
+    int64_t readyNs = 0;
+    ssize_t n = SerialRead(fd, buf, static_cast<size_t>(length), timeoutMs, &readyNs);
+    if (n > 0 && jStamp != nullptr && env->GetArrayLength(jStamp) > 0) {
+        jlong stamp = static_cast<jlong>(readyNs);
+        env->SetLongArrayRegion(jStamp, 0, 1, &stamp);
+    }
     return static_cast<jint>(n);
 }
 
+/**
+ * int writeGather(long handle, ByteBuffer buffer, int[] lengths, int count, int timeoutMs, int[] written)
+ *
+ * 把 buffer 中首尾相接的 count 段数据（每段长度见 lengths）用 writev 一次性写出，
+ * 写不完就继续 poll + writev，直到全部写完或 timeoutMs 到期。
+ * 每段实际写入的字节数写回 written[i]，用于分别通知各自的调用方。
+ *
+ * @return >=0: 总写入字节数；<0: 一个字节都没写出时的 -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_writeGather(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jobject jBuffer,
+        jintArray jLengths,
+        jint count,
+        jint timeoutMs,
+        jintArray jWritten
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    if (jLengths == nullptr || jWritten == nullptr || count <= 0) return -EINVAL;
+    if (env->GetArrayLength(jLengths) < count || env->GetArrayLength(jWritten) < count) {
+        return -EINVAL;
+    }
+
+    std::vector<jint> lengths(static_cast<size_t>(count));
+    env->GetIntArrayRegion(jLengths, 0, count, lengths.data());
+
+    jlong total = 0;
+    for (jint len : lengths) {
+        if (len < 0) return -EINVAL;
+        total += len;
+    }
+    if (total == 0 || total > INT32_MAX) return -EINVAL;
+
+    uint8_t* base = DirectRegion(env, jBuffer, 0, static_cast<jint>(total));
+    if (base == nullptr) return -EINVAL;
+
+    std::vector<struct iovec> iov(static_cast<size_t>(count));
+    size_t off = 0;
+    for (jint i = 0; i < count; ++i) {
+        iov[i].iov_base = base + off;
+        iov[i].iov_len = static_cast<size_t>(lengths[i]);
+        off += iov[i].iov_len;
+    }
+
+    int err = 0;
+    size_t written = SerialWriteFully(fd, iov.data(), count, timeoutMs, MetricsFor(fd), &err);
+    if (err != 0 && err != ETIMEDOUT) {
+        LOGE("writeGather: %zu/%lld bytes written: %s", written,
+             static_cast<long long>(total), strerror(err));
+    }
+
+    // 按顺序把总写入量摊回各段
+    size_t left = written;
+    for (jint i = 0; i < count; ++i) {
+        size_t n = left < static_cast<size_t>(lengths[i]) ? left : static_cast<size_t>(lengths[i]);
+        lengths[i] = static_cast<jint>(n);
+        left -= n;
+    }
+    env->SetIntArrayRegion(jWritten, 0, count, lengths.data());
+    return SerialWriteResult(written, err);
+}
+
+/**
+ * int waitIdle(long handle, int micros)
+ *
+ * 半双工 turnaround：用 ppoll 等待线路静默 micros 微秒，只等待不读取。
+ * 静默到期是正常结果，不计入 pollTimeouts。
+ *
+ * @return 0: 线路静默；1: 有数据到达；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_waitIdle(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jint micros
+) {
+    int fd = static_cast<int>(handle);
+    if (fd <= 0) return -EBADF;
+    return SerialWaitIdle(fd, micros);
+}
+
+/**
+ * int drain(long handle)
+ *
+ * tcdrain：阻塞到输出队列里的数据全部从 UART 发出。
+ *
+ * @return 0: 成功；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_drain(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    int fd = static_cast<int>(handle);
+    if (fd <= 0) return -EBADF;
+    return SerialDrain(fd);
+}
+
+/**
+ * int flush(long handle, int queue)
+ *
+ * @return 0: 成功；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_flush(
+        JNIEnv*,
+        jclass,
+        jlong handle,
+        jint queue
+) {
+    int fd = static_cast<int>(handle);
+    if (fd <= 0) return -EBADF;
+    return SerialFlush(fd, queue);
+}
+
+/**
+ * int getBaudRate(long handle)
+ *
+ * 驱动实际生效的波特率（TCGETS2 的 c_ospeed，非标准波特率时可能和请求值略有出入）。
+ *
+ * @return >0: 波特率；<0: -errno
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeSerial_getBaudRate(
+        JNIEnv*,
+        jclass,
+        jlong handle
+) {
+    int fd = static_cast<int>(handle);
+    if (fd <= 0) return -EBADF;
+    return SerialGetBaudrate(fd);
+}
+
 /**
  * void close(long handle)
  */
@@ -373,11 +415,7 @@ Java_com_sik_comm_NativeSerial_close(
         jclass,
         jlong handle
 ) {
-    int fd = static_cast<int>(handle);
-    if (fd >= 0) {
-        ::close(fd);
-        LOGI("close fd=%d", fd);
-    }
+    SerialClose(static_cast<int>(handle));
 }
 
 } // extern "C"
@@ -1,26 +1,23 @@
 #include <jni.h>
 #include <string>
+#include <algorithm>
+#include <vector>
 #include <errno.h>
-#include <string.h>
-#include <unistd.h>
-#include <poll.h>
-#include <sys/socket.h>
-#include <sys/ioctl.h>
-#include <net/if.h>
-#include <linux/can.h>
-#include <linux/can/raw.h>
-#include <android/log.h>
 
 #define LOG_TAG "NativeCan"
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
-
-// flags bit 定义（和 Kotlin 那边保持一致）
-static const int CAN_FLAG_EXTENDED = 0x01;
-static const int CAN_FLAG_RTR      = 0x02;
-static const int CAN_FLAG_FD       = 0x04;
-static const int CAN_FLAG_BRS      = 0x08;
+#include "comm_log.h"
+#include "can_io.h"
+#include "can_netlink.h"
+
+// bringUp() 参数数组下标（和 Kotlin NativeCan.LINK_* 保持一致），-1 / 0 表示不修改
+static const int LINK_BITRATE           = 0;
+static const int LINK_SAMPLE_POINT      = 1;   // 千分比
+static const int LINK_DATA_BITRATE      = 2;
+static const int LINK_DATA_SAMPLE_POINT = 3;   // 千分比
+static const int LINK_FD                = 4;   // -1 不修改，0 关闭，1 打开
+static const int LINK_RESTART_MS        = 5;
+static const int LINK_TX_QUEUE_LEN      = 6;
+static const int LINK_PARAM_COUNT       = 7;
 
 static std::string JStringToString(JNIEnv* env, jstring jstr) {
     if (jstr == nullptr) return {};
@@ -32,94 +29,74 @@ static std::string JStringToString(JNIEnv* env, jstring jstr) {
 }
 
 /**
- * 打开 AF_INET socket，获取/设置 if flags。
+ * 从 Kotlin 传来的 IntArray 读取过滤器描述（[id, mask, flags] 三元组）。
+ *
+ * @return >=0: 过滤器个数；<0: -EINVAL
  */
-static int SetIfUpDown(const std::string& ifName, bool up) {
-    int s = ::socket(AF_INET, SOCK_DGRAM, 0);
-    if (s < 0) {
-        int err = errno;
-        LOGE("socket(AF_INET) failed: %s", strerror(err));
-        return -err;
-    }
-
-    struct ifreq ifr{};
-    std::strncpy(ifr.ifr_name, ifName.c_str(), IFNAMSIZ - 1);
-
-    if (ioctl(s, SIOCGIFFLAGS, &ifr) < 0) {
-        int err = errno;
-        LOGE("SIOCGIFFLAGS(%s) failed: %s", ifName.c_str(), strerror(err));
-        ::close(s);
-        return -err;
-    }
-
-    if (up) {
-        ifr.ifr_flags |= IFF_UP;
-    } else {
-        ifr.ifr_flags &= ~IFF_UP;
-    }
-
-    if (ioctl(s, SIOCSIFFLAGS, &ifr) < 0) {
-        int err = errno;
-        LOGE("SIOCSIFFLAGS(%s) failed: %s", ifName.c_str(), strerror(err));
-        ::close(s);
-        return -err;
-    }
-
-    ::close(s);
-    return 0;
+static int ReadFilterSpec(JNIEnv* env, jintArray jSpec, std::vector<jint>* spec) {
+    if (jSpec == nullptr) return 0;
+    jsize len = env->GetArrayLength(jSpec);
+    if (len % 3 != 0) return -EINVAL;
+    spec->resize(static_cast<size_t>(len));
+    if (len > 0) env->GetIntArrayRegion(jSpec, 0, len, spec->data());
+    return len / 3;
 }
 
+extern "C" {
+
 /**
- * 获取 ifindex。
+ * int bringUp(String ifName, int[] params)
+ *
+ * 通过 rtnetlink 一次往返完成 bitrate / 采样点 / 数据段 bitrate / FD / restart-ms / txqueuelen 配置并 up，
+ * 不再需要 `ip link`。没有任何 CAN 参数时只做 up（vcan 也适用）。
+ *
+ * @return 0: 成功；<0: -errno
  */
-static int GetIfIndex(const std::string& ifName) {
-    int s = ::socket(AF_INET, SOCK_DGRAM, 0);
-    if (s < 0) {
-        int err = errno;
-        LOGE("socket(AF_INET) failed: %s", strerror(err));
-        return -err;
-    }
-
-    struct ifreq ifr{};
-    std::strncpy(ifr.ifr_name, ifName.c_str(), IFNAMSIZ - 1);
-
-    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0) {
-        int err = errno;
-        LOGE("SIOCGIFINDEX(%s) failed: %s", ifName.c_str(), strerror(err));
-        ::close(s);
-        return -err;
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCan_bringUp(
+        JNIEnv* env,
+        jclass,
+        jstring jIfName,
+        jintArray params
+) {
+    std::string ifName = JStringToString(env, jIfName);
+    if (ifName.empty() || params == nullptr || env->GetArrayLength(params) < LINK_PARAM_COUNT) {
+        return -EINVAL;
     }
-
-    ::close(s);
-    return ifr.ifr_ifindex;
+    jint p[LINK_PARAM_COUNT];
+    env->GetIntArrayRegion(params, 0, LINK_PARAM_COUNT, p);
+
+    CanLinkConfig config;
+    config.bitrate = p[LINK_BITRATE] > 0 ? static_cast<uint32_t>(p[LINK_BITRATE]) : 0;
+    config.samplePoint = p[LINK_SAMPLE_POINT] > 0 ? static_cast<uint32_t>(p[LINK_SAMPLE_POINT]) : 0;
+    config.dataBitrate = p[LINK_DATA_BITRATE] > 0 ? static_cast<uint32_t>(p[LINK_DATA_BITRATE]) : 0;
+    config.dataSamplePoint =
+            p[LINK_DATA_SAMPLE_POINT] > 0 ? static_cast<uint32_t>(p[LINK_DATA_SAMPLE_POINT]) : 0;
+    config.fd = p[LINK_FD];
+    config.restartMs = p[LINK_RESTART_MS];
+    config.txQueueLen = p[LINK_TX_QUEUE_LEN];
+
+    return CanLinkConfigure(ifName.c_str(), config); // 0 ok, <0 -errno
 }
 
-extern "C" {
-
 /**
- * int bringUp(String ifName, int bitrate, boolean fdMode)
+ * int restart(String ifName)
  *
- * 注意：这里我们只负责 up 接口，不动 bitrate 和 FD 设置。
- * bitrate / fdMode 只是预留参数，如果你以后要加 netlink/ip 配置再搞。
+ * bus-off 快速恢复：IFLA_CAN_RESTART 直接重启控制器，不 down / up 接口。
+ *
+ * @return 0: 成功；-EBUSY: 不在 bus-off；-EINVAL: 已配置 restart-ms 自动恢复；其它 <0: -errno
  */
 JNIEXPORT jint JNICALL
-Java_com_sik_comm_NativeCan_bringUp(
+Java_com_sik_comm_NativeCan_restart(
         JNIEnv* env,
         jclass,
-        jstring jIfName,
-        jint bitrate,
-        jboolean fdMode
+        jstring jIfName
 ) {
     std::string ifName = JStringToString(env, jIfName);
     if (ifName.empty()) {
         return -EINVAL;
     }
-
-    LOGI("bringUp(%s), bitrate=%d, fdMode=%s (bitrate is not configured here)",
-         ifName.c_str(), bitrate, fdMode ? "true" : "false");
-
-    int ret = SetIfUpDown(ifName, true);
-    return ret; // 0 ok, <0 -errno
+    return CanLinkRestart(ifName.c_str());
 }
 
 /**
@@ -137,23 +114,28 @@ Java_com_sik_comm_NativeCan_bringDown(
     }
 
     LOGI("bringDown(%s)", ifName.c_str());
-    int ret = SetIfUpDown(ifName, false);
-    return ret;
+    return CanSetIfUp(ifName.c_str(), false);
 }
 
 /**
- * long open(String ifName)
+ * long open(String ifName, boolean fdMode, int[] filters, int errorMask)
  *
  * 逻辑：
- * 1. 先尝试把接口 up（SetIfUpDown）
+ * 1. 先尝试把接口 up（CanSetIfUp）
  * 2. 获取 ifindex
- * 3. socket(PF_CAN, SOCK_RAW, CAN_RAW) + bind
+ * 3. socket(PF_CAN, SOCK_RAW, CAN_RAW)
+ * 4. fdMode 时打开 CAN_RAW_FD_FRAMES（接口 MTU 需为 72，vcan 可用 `ip link set vcan0 mtu 72`）
+ * 5. 设置 CAN_RAW_FILTER / CAN_RAW_ERR_FILTER（在 bind 之前，避免收到未过滤的帧）
+ * 6. bind
  */
 JNIEXPORT jlong JNICALL
 Java_com_sik_comm_NativeCan_open(
         JNIEnv* env,
         jclass,
-        jstring jIfName
+        jstring jIfName,
+        jboolean fdMode,
+        jintArray jFilters,
+        jint errorMask
 ) {
     std::string ifName = JStringToString(env, jIfName);
     if (ifName.empty()) {
@@ -161,50 +143,45 @@ Java_com_sik_comm_NativeCan_open(
         return -EINVAL;
     }
 
-    // 尝试 up 一下接口（失败的话就直接返回错误）
-    int upRet = SetIfUpDown(ifName, true);
-    if (upRet < 0) {
-        LOGE("open: SetIfUpDown(%s) failed: %d", ifName.c_str(), upRet);
-        return upRet;
-    }
-
-    int ifindex = GetIfIndex(ifName);
-    if (ifindex < 0) {
-        LOGE("open: GetIfIndex(%s) failed: %d", ifName.c_str(), ifindex);
-        return ifindex;
-    }
+    std::vector<jint> spec;
+    int count = ReadFilterSpec(env, jFilters, &spec);
+    if (count < 0) return count;
 
-    int fd = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
-    if (fd < 0) {
-        int err = errno;
-        LOGE("socket(PF_CAN) failed: %s", strerror(err));
-        return -err;
-    }
-
-    struct sockaddr_can addr{};
-    addr.can_family = AF_CAN;
-    addr.can_ifindex = ifindex;
-
-    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
-        int err = errno;
-        LOGE("bind(can, %s) failed: %s", ifName.c_str(), strerror(err));
-        ::close(fd);
-        return -err;
-    }
-
-    LOGI("CAN open(%s) success, fd=%d", ifName.c_str(), fd);
+    int fd = CanOpen(ifName.c_str(), fdMode == JNI_TRUE, spec.data(), count, errorMask);
     return static_cast<jlong>(fd);
 }
 
+/**
+ * int setFilters(long handle, int[] filters, int errorMask)
+ *
+ * 运行时替换过滤器，filters 格式同 open。
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCan_setFilters(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jintArray jFilters,
+        jint errorMask
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    std::vector<jint> spec;
+    int count = ReadFilterSpec(env, jFilters, &spec);
+    if (count < 0) return count;
+    return CanSetFilters(fd, spec.data(), count, errorMask);
+}
+
 /**
  * int write(long handle, int frameId, int flags, byte[] data, int offset, int length, int timeoutMs)
  *
- * 只支持经典 CAN，length <= 8
  * flags:
  *  bit0: 扩展帧
- *  bit1: RTR
- *  bit2: FD (不支持 -> -ENOTSUP)
- *  bit3: BRS (不支持 -> -ENOTSUP)
+ *  bit1: RTR（仅经典帧）
+ *  bit2: FD，length <= 64，非 DLC 档位长度会补 0 对齐；否则经典帧 length <= 8
+ *  bit3: BRS（仅 FD 帧）
+ *
+ * FD 帧要求 open 时 fdMode = true，否则内核返回 -EINVAL。
  */
 JNIEXPORT jint JNICALL
 Java_com_sik_comm_NativeCan_write(
@@ -221,62 +198,16 @@ Java_com_sik_comm_NativeCan_write(
     int fd = static_cast<int>(handle);
     if (fd < 0) return -EBADF;
 
-    if (flags & (CAN_FLAG_FD | CAN_FLAG_BRS)) {
-        // 当前实现不支持 CAN FD
-        return -ENOTSUP;
-    }
-
     if (jData == nullptr || length <= 0) return -EINVAL;
-    if (length > 8) return -EINVAL; // 经典 CAN 最多 8 字节
+    if (length > CANFD_MAX_DLEN) return -EINVAL;
 
     jsize arrayLen = env->GetArrayLength(jData);
     if (offset < 0 || length < 0 || offset + length > arrayLen) return -EINVAL;
 
-    struct pollfd pfd{};
-    pfd.fd = fd;
-    pfd.events = POLLOUT;
-
-    int pret = poll(&pfd, 1, timeoutMs);
-    if (pret < 0) {
-        int err = errno;
-        LOGE("CAN write poll failed: %s", strerror(err));
-        return -err;
-    } else if (pret == 0) {
-        return 0; // 超时
-    }
-
-    jbyte* buf = env->GetByteArrayElements(jData, nullptr);
-    if (buf == nullptr) return -ENOMEM;
+    uint8_t payload[CANFD_MAX_DLEN];
+    env->GetByteArrayRegion(jData, offset, length, reinterpret_cast<jbyte*>(payload));
 
-    struct can_frame frame{};
-    canid_t cid = 0;
-
-    if (flags & CAN_FLAG_EXTENDED) {
-        cid = static_cast<canid_t>(frameId & CAN_EFF_MASK);
-        cid |= CAN_EFF_FLAG;
-    } else {
-        cid = static_cast<canid_t>(frameId & CAN_SFF_MASK);
-    }
-
-    if (flags & CAN_FLAG_RTR) {
-        cid |= CAN_RTR_FLAG;
-    }
-
-    frame.can_id = cid;
-    frame.can_dlc = static_cast<__u8>(length);
-    memcpy(frame.data, buf + offset, static_cast<size_t>(length));
-
-    env->ReleaseByteArrayElements(jData, buf, JNI_ABORT);
-
-    ssize_t n = ::write(fd, &frame, sizeof(frame));
-    int savedErr = errno;
-
-    if (n < 0) {
-        LOGE("CAN write failed: %s", strerror(savedErr));
-        return -savedErr;
-    }
-
-    return static_cast<jint>(n);
+    return CanWriteFrame(fd, frameId, flags, payload, length, timeoutMs);
 }
 
 /**
@@ -304,69 +235,112 @@ Java_com_sik_comm_NativeCan_read(
 
     if (jOutFrameId == nullptr || jOutFlags == nullptr || jData == nullptr) return -EINVAL;
     if (maxLen <= 0) return -EINVAL;
-    if (maxLen > 8) maxLen = 8; // 经典 CAN 限制
 
     jsize arrLen = env->GetArrayLength(jData);
     if (offset < 0 || offset >= arrLen) return -EINVAL;
 
-    struct pollfd pfd{};
-    pfd.fd = fd;
-    pfd.events = POLLIN;
-
-    int pret = poll(&pfd, 1, timeoutMs);
-    if (pret < 0) {
-        int err = errno;
-        LOGE("CAN read poll failed: %s", strerror(err));
-        return -err;
-    } else if (pret == 0) {
-        return 0; // 超时
+    jint frameId = 0;
+    jint flags = 0;
+    uint8_t payload[CANFD_MAX_DLEN];
+    int frameLen = CanReadFrame(fd, &frameId, &flags, payload, timeoutMs);
+    if (frameLen <= 0) {
+        return frameLen; // 0 超时（空 payload 帧对调用方同样是 0），<0 错误
     }
 
-    struct can_frame frame{};
-    ssize_t n = ::read(fd, &frame, sizeof(frame));
-    int savedErr = errno;
+    // 写回 outFrameId/outFlags
+    env->SetIntArrayRegion(jOutFrameId, 0, 1, &frameId);
+    env->SetIntArrayRegion(jOutFlags, 0, 1, &flags);
 
-    if (n < 0) {
-        LOGE("CAN read failed: %s", strerror(savedErr));
-        return -savedErr;
-    }
+    // 写 payload（缓冲区太小 / maxLen 不够时只写得下的部分）
+    int copyLen = std::min<int>(frameLen, std::min<int>(maxLen, arrLen - offset));
+    env->SetByteArrayRegion(jData, offset, copyLen, reinterpret_cast<jbyte*>(payload));
 
-    // 解析 frame
-    jint frameId = 0;
-    jint flags = 0;
-
-    if (frame.can_id & CAN_EFF_FLAG) {
-        frameId = static_cast<jint>(frame.can_id & CAN_EFF_MASK);
-        flags |= CAN_FLAG_EXTENDED;
-    } else {
-        frameId = static_cast<jint>(frame.can_id & CAN_SFF_MASK);
-    }
+    return static_cast<jint>(frameLen);
+}
 
-    if (frame.can_id & CAN_RTR_FLAG) {
-        flags |= CAN_FLAG_RTR;
+/**
+ * int readBatch(long handle, byte[] out, int maxFrames, int timeoutMs)
+ *
+ * 一次 poll + 一次 recvmmsg 收走 socket 里已排队的帧（最多 maxFrames 帧），
+ * 按 CAN_RECORD_SIZE 定长记录打包进 out，只做一次 JNI 数组写回。
+ * 每条记录带上内核给的接收时间戳（有硬件时间戳时用硬件的）。
+ *
+ * 返回值：
+ *  >0: 本次收到的帧数
+ *  0: 超时
+ *  <0: 错误
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCan_readBatch(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jbyteArray jOut,
+        jint maxFrames,
+        jint timeoutMs
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    if (jOut == nullptr || maxFrames <= 0) return -EINVAL;
+
+    jsize outLen = env->GetArrayLength(jOut);
+    int capacity = std::min<int>(maxFrames, outLen / CAN_RECORD_SIZE);
+    capacity = std::min(capacity, CAN_MAX_BATCH);
+    if (capacity <= 0) return -EINVAL;
+
+    uint8_t packed[CAN_MAX_BATCH * CAN_RECORD_SIZE];
+    int count = CanReadBatch(fd, packed, capacity, timeoutMs);
+    if (count > 0) {
+        env->SetByteArrayRegion(jOut, 0, count * CAN_RECORD_SIZE,
+                                reinterpret_cast<jbyte*>(packed));
     }
+    return static_cast<jint>(count);
+}
 
-    // 写回 outFrameId/outFlags
-    jint tmpId[1];
-    jint tmpFlags[1];
-    tmpId[0] = frameId;
-    tmpFlags[0] = flags;
-    env->SetIntArrayRegion(jOutFrameId, 0, 1, tmpId);
-    env->SetIntArrayRegion(jOutFlags, 0, 1, tmpFlags);
-
-    // 写 payload
-    jsize bufLen = env->GetArrayLength(jData);
-    if (offset + frame.can_dlc > bufLen) {
-        // 缓冲区太小，只写得下的部分
-        int copyLen = std::min<int>(frame.can_dlc, bufLen - offset);
-        env->SetByteArrayRegion(jData, offset, copyLen,
-                                reinterpret_cast<jbyte*>(frame.data));
-    } else {
-        env->SetByteArrayRegion(jData, offset, frame.can_dlc,
-                                reinterpret_cast<jbyte*>(frame.data));
+/**
+ * int writeBatch(long handle, byte[] frames, int count, int timeoutMs)
+ *
+ * frames 里按 CAN_RECORD_SIZE 定长记录依次放 count 帧，
+ * 按 CAN_MAX_BATCH 分片用 sendmmsg 推给内核。
+ *
+ * TX 队列满（ENOBUFS）时不会丢弃后续帧，而是退避后从第一个未被接受的帧继续，
+ * 直到全部发出或 timeoutMs 到期。
+ *
+ * 返回值：
+ *  >=0: 被内核接受的帧数（小于 count 表示超时，只发出了前面一部分）
+ *  <0: 错误（一帧都没发出去）
+ */
+JNIEXPORT jint JNICALL
+Java_com_sik_comm_NativeCan_writeBatch(
+        JNIEnv* env,
+        jclass,
+        jlong handle,
+        jbyteArray jFrames,
+        jint count,
+        jint timeoutMs
+) {
+    int fd = static_cast<int>(handle);
+    if (fd < 0) return -EBADF;
+    if (jFrames == nullptr || count <= 0) return -EINVAL;
+
+    jsize arrayLen = env->GetArrayLength(jFrames);
+    if (count > arrayLen / CAN_RECORD_SIZE) return -EINVAL;
+
+    int64_t deadline = CanMonotonicMs() + (timeoutMs > 0 ? timeoutMs : 0);
+
+    // 按 CAN_MAX_BATCH 分片拷到栈上，不为整个数组做 JNI 拷贝 / 临界区
+    uint8_t packed[CAN_MAX_BATCH * CAN_RECORD_SIZE];
+    int sent = 0;
+    while (sent < count) {
+        int chunk = std::min(count - sent, CAN_MAX_BATCH);
+        env->GetByteArrayRegion(jFrames, sent * CAN_RECORD_SIZE, chunk * CAN_RECORD_SIZE,
+                                reinterpret_cast<jbyte*>(packed));
+        int n = CanWriteBatch(fd, packed, chunk, deadline);
+        if (n < 0) return sent > 0 ? sent : n;
+        sent += n;
+        if (n < chunk) break;   // 超时 / 记录非法：返回已经被接受的帧数
     }
-
-    return static_cast<jint>(frame.can_dlc);
+    return static_cast<jint>(sent);
 }
 
 /**
@@ -378,11 +352,7 @@ Java_com_sik_comm_NativeCan_close(
         jclass,
         jlong handle
 ) {
-    int fd = static_cast<int>(handle);
-    if (fd >= 0) {
-        ::close(fd);
-        LOGI("CAN close fd=%d", fd);
-    }
+    CanClose(static_cast<int>(handle));
 }
 
 } // extern "C"
@@ -0,0 +1,121 @@
+package com.sik.comm
+
+/**
+ * CAN 总线监视配置（[CanConfig.busMonitor]）。
+ *
+ * 监视使用单独的 CAN_RAW socket（不带 ID 过滤器，订阅全部错误帧），统计在 reactor 线程的 native 代码里完成，
+ * 不跨 JNI；通道自己（以及本机其它 socket）发出的帧通过回环同样计入负载。
+ *
+ * @param bitrate     仲裁段波特率，null 时用 [CanConfig.bitrate]，再没有则向驱动查询（vcan 查不到，此时不计算负载）
+ * @param dataBitrate FD 数据段波特率，null 时用 [CanConfig.dataBitrate] / 驱动配置，都没有时按仲裁段
+ * @param windowMs    窗口负载 / 峰值负载的统计窗口（毫秒）
+ */
+data class CanBusMonitorConfig(
+    val bitrate: Int? = null,
+    val dataBitrate: Int? = null,
+    val windowMs: Int = 100
+) {
+
+    init {
+        require(bitrate == null || bitrate > 0) { "Invalid bitrate: $bitrate" }
+        require(dataBitrate == null || dataBitrate > 0) { "Invalid dataBitrate: $dataBitrate" }
+        require(windowMs in 1..60_000) { "Invalid windowMs: $windowMs" }
+    }
+}
+
+/**
+ * CAN 控制器错误状态（同内核 enum can_state）。
+ */
+enum class CanBusState {
+    /** 未知（vcan，或还没有收到过状态相关的错误帧） */
+    UNKNOWN,
+
+    /** 正常 */
+    ERROR_ACTIVE,
+
+    /** TEC / REC 超过 96 */
+    ERROR_WARNING,
+
+    /** TEC / REC 超过 127，只能发送隐性错误标志 */
+    ERROR_PASSIVE,
+
+    /** TEC 超过 255，控制器已离线，需要自动恢复（restartMs）或 [CanChannel.restart] */
+    BUS_OFF,
+
+    /** 接口已停止 */
+    STOPPED
+}
+
+/**
+ * CAN 总线状态快照，通过 [CanChannel.busStatus] 获取。
+ *
+ * 计数从通道 open 开始累计，只读原子计数，可以周期性调用；
+ * 真实控制器上 [state] / [txErrorCounter] / [rxErrorCounter] 会额外做一次 rtnetlink 查询，以驱动为准。
+ *
+ * 负载按每帧在总线上的精确位数（SOF 到帧间隔，含位填充；带 BRS 的 FD 帧数据段按数据段波特率）计算，
+ * 不含错误标志占用的时间。
+ *
+ * @param timestampNs         快照时间（CLOCK_MONOTONIC 纳秒）
+ * @param bitrate             计算负载使用的仲裁段波特率，0 表示未知（此时负载都为 0）
+ * @param dataBitrate         计算负载使用的数据段波特率
+ * @param frames              统计到的数据 / 远程帧数
+ * @param bits                这些帧的总位数
+ * @param busyNs              这些帧占用总线的总时间
+ * @param windowLoad          最近一个完整统计窗口的负载（0.0 ~ 1.0）
+ * @param peakLoad            统计窗口负载的最大值
+ * @param state               控制器错误状态
+ * @param txErrorCounter      发送错误计数器（TEC），-1 表示驱动不提供
+ * @param rxErrorCounter      接收错误计数器（REC），-1 表示驱动不提供
+ * @param errorFrames         收到的错误帧数
+ * @param busErrors           协议错误次数（位 / 格式 / 填充 / CRC 错误）
+ * @param ackErrors           发送无应答次数
+ * @param arbitrationLost     仲裁失败次数
+ * @param controllerOverflows 控制器收发缓冲区溢出次数（已经丢帧）
+ * @param txTimeouts          发送超时次数
+ * @param busOffCount         进入 bus-off 的次数
+ * @param restartCount        控制器重启次数
+ * @param lastErrorNs         最近一个错误帧的时间，0 表示没有
+ * @param readError           通道读循环因错误退出时的 -errno，0 表示读循环正常
+ */
+data class CanBusStatus(
+    val timestampNs: Long,
+    val bitrate: Int,
+    val dataBitrate: Int,
+    val frames: Long,
+    val bits: Long,
+    val busyNs: Long,
+    val windowLoad: Double,
+    val peakLoad: Double,
+    val state: CanBusState,
+    val txErrorCounter: Int,
+    val rxErrorCounter: Int,
+    val errorFrames: Long,
+    val busErrors: Long,
+    val ackErrors: Long,
+    val arbitrationLost: Long,
+    val controllerOverflows: Long,
+    val txTimeouts: Long,
+    val busOffCount: Long,
+    val restartCount: Long,
+    val lastErrorNs: Long,
+    val readError: Int
+) {
+
+    /**
+     * 从 previous 到本快照之间的平均负载（0.0 ~ 1.0），用于按固定周期采样。
+     */
+    fun loadSince(previous: CanBusStatus): Double {
+        val elapsed = timestampNs - previous.timestampNs
+        if (elapsed <= 0L) return 0.0
+        return ((busyNs - previous.busyNs).toDouble() / elapsed).coerceIn(0.0, 1.0)
+    }
+
+    /**
+     * 从 previous 到本快照之间的帧速率（帧 / 秒）。
+     */
+    fun framesPerSecondSince(previous: CanBusStatus): Double {
+        val elapsed = timestampNs - previous.timestampNs
+        if (elapsed <= 0L) return 0.0
+        return (frames - previous.frames) * 1e9 / elapsed
+    }
+}
@@ -0,0 +1,99 @@
+package com.sik.comm
+
+/**
+ * SocketCAN 通道。
+ *
+ * 在 [CommChannel] 的基础上提供 CAN 专有能力，通过 [SikComm.openCan] 获取。
+ */
+interface CanChannel : CommChannel {
+
+    /**
+     * 批量发送 CAN 帧。
+     *
+     * frames 中按 [CanFrames] 记录格式依次放 count 帧，
+     * 整批只切一次 IO 线程，JNI 内部用 sendmmsg 一次推多帧。
+     *
+     * 发送队列满（ENOBUFS）时会退避重试，直到全部发出或超时，
+     * 返回值小于 count 时表示只有前面这部分帧被内核接受，调用方可从该位置继续发送。
+     *
+     * @param frames    打包好的帧记录
+     * @param count     帧数
+     * @param timeoutMs 整批发送的超时时间（毫秒），如果为 null 则使用配置中的 writeTimeoutMs
+     * @return          >=0: 被接受的帧数；<0: 错误（一帧都没发出）
+     */
+    suspend fun sendFrames(frames: ByteArray, count: Int, timeoutMs: Int? = null): Int
+
+    /**
+     * 运行时替换内核过滤器和错误帧掩码（CAN_RAW_FILTER / CAN_RAW_ERR_FILTER）。
+     *
+     * @param filters   新的过滤器列表，空列表表示全部接收
+     * @param errorMask 订阅的错误帧类别（CanFrames.ERR_*），0 表示不收错误帧
+     */
+    fun setFilters(filters: List<CanFilter>, errorMask: Int = 0)
+
+    /**
+     * bus-off 后立即重启 CAN 控制器（netlink IFLA_CAN_RESTART），不 down / up 接口，socket 保持打开。
+     *
+     * 只在 [CanConfig.restartMs] 为 0（或接口未开自动恢复）时可用。
+     *
+     * @return true: 已重启；false: 控制器当前不在 bus-off，无需重启
+     */
+    fun restart(): Boolean
+
+    /**
+     * 设置或替换按 ID 分发的帧回调（带 ID / flags / DLC），null 表示不分发。
+     *
+     * 和 [setReceiver] 互不影响：两者都设置时每帧先交给 dispatcher，再把 payload 交给 receiver。
+     * ISO-TP 模式下收到的是重组后的报文，不可用。
+     */
+    fun setFrameDispatcher(dispatcher: CanDispatcher?)
+
+    /**
+     * 注册（或替换）内核定时的周期发送（CAN_BCM TX_SETUP）：立即发出一帧，之后每 intervalMicros 一帧。
+     *
+     * 定时和发送都在内核里完成，每帧没有用户态唤醒；通道关闭时所有周期发送随之停止。
+     * 周期帧不经过 metrics / capture 统计。
+     *
+     * @param frameId        CAN ID
+     * @param flags          [CanFrames.FLAG_EXTENDED] / [CanFrames.FLAG_FD] / [CanFrames.FLAG_BRS]
+     * @param data           payload（经典帧 <= 8，FD 帧 <= 64 字节）
+     * @param intervalMicros 发送周期（微秒）
+     */
+    fun startCyclic(frameId: Int, flags: Int, data: ByteArray, intervalMicros: Long)
+
+    /**
+     * 原地替换周期帧的 payload，不重置周期：下一个周期发出的就是新内容。
+     *
+     * @param sendNow 是否额外立即发出一帧新内容
+     */
+    fun updateCyclic(frameId: Int, flags: Int, data: ByteArray, sendNow: Boolean = false)
+
+    /**
+     * 停止周期发送。
+     *
+     * @return false: 没有这个周期帧
+     */
+    fun stopCyclic(frameId: Int, flags: Int = 0): Boolean
+
+    /**
+     * 注册（或替换）内核接收监视（CAN_BCM RX_SETUP）：只有内容变化或接收超时时才回调 receiver。
+     *
+     * 和原始 socket 的接收互不影响：被监视的帧照常交给 receiver / dispatcher。
+     */
+    fun watch(watch: CanWatch, receiver: CanWatchReceiver)
+
+    /**
+     * 删除接收监视。
+     *
+     * @return false: 没有这个监视
+     */
+    fun unwatch(frameId: Int, flags: Int = 0): Boolean
+
+    /**
+     * 获取总线负载 / 错误状态快照（负载、错误帧、TEC / REC、bus-off 和重启次数，以及读循环是否因错误退出）。
+     *
+     * 只有配置了 [CanConfig.busMonitor] 且通道已打开时才有，否则返回 null。可以周期性调用，
+     * 两次快照之间的平均负载用 [CanBusStatus.loadSince] 计算。
+     */
+    fun busStatus(): CanBusStatus?
+}
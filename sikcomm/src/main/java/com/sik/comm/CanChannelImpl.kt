@@ -5,25 +5,40 @@ import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.cancel
+import kotlinx.coroutines.channels.Channel
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicInteger
 
 /**
  * SocketCAN 通道实现。
  *
  * 特性：
  * - 真全双工：读写分离
- *   - 独立 readLoop 协程阻塞在 JNI read()（内部 poll + recv）
+ *   - fd 注册到全局 [CommReactor]，独立 readLoop 协程挂起等待就绪通知，空闲时不占线程
+ *   - 就绪后用 JNI readBatch()（recvmmsg）把排队的帧一次性收走，再重新等待
+ *   - 每帧带内核接收时间戳（SO_TIMESTAMPING，支持时为硬件时间戳），receiver 实现 [TimestampedReceiver] 即可拿到
  *   - send() 中直接在 Dispatchers.IO 上调用 JNI write()
+ *   - sendFrames() 整批只切一次线程，JNI 内部 sendmmsg 批量发送
  * - CommChannel 接口保持与串口一致，上层不用关心区别
+ * - 配置了 [CanConfig.isoTp] 时走 ISO-TP：send() 发整条报文，receiver 收重组好的整条报文，
+ *   分段 / 流控在 native 层（内核 CAN_ISOTP 或用户态引擎）完成
+ * - 配置了 [CanConfig.rxRing] 时读循环只把帧收进 native 接收环，receiver 在通道专用的接收线程上回调
  *
- * 当前实现只把 CAN payload 当作普通字节流上抛。
- * 如果你需要使用 frameId / flags，可在此基础上扩接口或单独封装。
+ * [CommReceiver] 只拿到 CAN payload；需要 frameId / flags / DLC 时通过 [setFrameDispatcher]
+ * 挂一个 [CanDispatcher]，按 ID（平表 / 哈希）直接分发到各自的 [CanFrameReceiver]，分发路径不分配内存。
+ *
+ * 周期发送（[startCyclic]）和接收监视（[watch]）走单独的 CAN_BCM socket，第一次使用时才打开：
+ * 定时发送、变化检测和超时都由内核完成，BCM socket 同样注册到 reactor，只在有变化 / 超时事件时唤醒。
+ *
+ * 配置了 [CanConfig.busMonitor] 时 open 额外打开一个总线监视 socket，统计在 reactor 线程的 native 代码里完成，
+ * [busStatus] 只读取快照。读循环因错误退出时错误码记在快照的 [CanBusStatus.readError] 里。
  */
 internal class CanChannelImpl(
     private val config: CanConfig
-) : CommChannel {
+) : CanChannel {
 
     override val id: String
         get() = config.id
@@ -34,43 +49,182 @@ internal class CanChannelImpl(
     @Volatile
     private var handle: Long = 0L
 
+    /**
+     * ISO-TP 句柄，null 表示按原始 CAN 帧收发。
+     */
+    @Volatile
+    private var isoTp: IsoTpRef? = null
+
     private var readJob: Job? = null
 
+    /**
+     * 接收环，null 表示在读循环里直接回调 receiver；读循环和接收线程都结束后释放。
+     */
+    private var rxRing: RxRing? = null
+
+    /**
+     * reactor 注册 token，0 表示未注册。
+     */
+    private var reactorToken: Int = 0
+
+    /**
+     * reactor 线程发来的可读通知（合并，读循环每次醒来都会把数据读干净）。
+     */
+    private val readable: Channel<Unit> = Channel(Channel.CONFLATED)
+
     @Volatile
     private var receiver: CommReceiver? = null
 
+    @Volatile
+    private var frameDispatcher: CanDispatcher? = null
+
+    /**
+     * CAN_BCM socket 句柄，0 表示还没打开；打开 / 关闭和所有 BCM 命令都在 [bcmLock] 下进行。
+     */
+    @Volatile
+    private var bcm: Long = 0L
+
+    private val bcmLock = Any()
+
+    private var bcmToken: Int = 0
+
+    private var bcmJob: Job? = null
+
+    /**
+     * reactor 线程发来的 BCM socket 可读通知。
+     */
+    private val bcmReadable: Channel<Unit> = Channel(Channel.CONFLATED)
+
+    /**
+     * 已注册的周期帧，key 见 [bcmKey]。
+     */
+    private val cyclicFrames: MutableSet<Long> = ConcurrentHashMap.newKeySet()
+
+    /**
+     * 接收监视回调，key 见 [bcmKey]。
+     */
+    private val watches = ConcurrentHashMap<Long, CanWatchReceiver>()
+
+    /**
+     * 总线监视句柄，0 表示未配置 / 已关闭；创建、销毁和读取快照都在 [monitorLock] 下进行。
+     */
+    private var busMonitor: Long = 0L
+
+    private val monitorLock = Any()
+
+    /**
+     * 读循环因错误退出时的 -errno，0 表示正常。
+     */
+    @Volatile
+    private var readError: Int = 0
+
+    /**
+     * 正在进行中的 send / sendFrames 调用数，供 metrics() 使用。
+     */
+    private val inFlightWrites = AtomicInteger(0)
+
     override fun open() {
         if (isOpen()) return
 
-        // 可选：由 JNI 负责 bringUp，如果 bitrate 未配置则跳过
-        val bitrate = config.bitrate
-        if (bitrate != null) {
-            // fdMode 目前 JNI 里是 NO-OP，你可以后续扩展
-            NativeCan.bringUp(config.ifName, bitrate, config.fdMode)
+        require(config.rxRing == null || config.isoTp == null) {
+            "rxRing is not available in ISO-TP mode (id=$id)"
         }
+        require(config.capture == null || config.isoTp == null) {
+            "capture is not available in ISO-TP mode (id=$id)"
+        }
+
+        // 可选：由 JNI 通过 netlink 配置并 up 接口，没有配置任何链路参数则跳过
+        NativeCan.bringUp(config)
 
-        val fd = NativeCan.open(config.ifName)
+        val fd = if (config.isoTp != null) {
+            val tp = NativeIsoTp.open(config)
+            isoTp = IsoTpRef(tp)
+            NativeIsoTp.fd(tp)
+        } else {
+            NativeCan.open(
+                config.ifName,
+                config.fdMode,
+                CanFilter.pack(config.filters),
+                config.errorMask
+            )
+        }
         require(fd > 0L) {
             "Failed to open CAN interface: ${config.ifName}, handle=$fd"
         }
 
         handle = fd
 
+        val capture = config.capture
+        if (capture != null) {
+            val ret = NativeCapture.start(fd, capture, id)
+            if (ret < 0) {
+                NativeCan.close(fd)
+                handle = 0L
+                throw IllegalArgumentException("Failed to start capture in ${capture.directory}, ret=$ret")
+            }
+        }
+
+        val ringConfig = config.rxRing
+        if (ringConfig != null) {
+            rxRing = try {
+                RxRing(ringConfig, id)
+            } catch (e: IllegalArgumentException) {
+                NativeCan.close(fd)
+                handle = 0L
+                throw e
+            }
+        }
+
         // 启动读循环
-        startReadLoop()
+        readError = 0
+        try {
+            startReadLoop()
+        } catch (e: IllegalStateException) {
+            // reactor 登记失败：读循环没有启动，接收环也还没挂上 job
+            rxRing?.destroyAfter()
+            rxRing = null
+            release()
+            throw e
+        }
+
+        val monitorConfig = config.busMonitor
+        if (monitorConfig != null) {
+            try {
+                startBusMonitor(monitorConfig)
+            } catch (e: IllegalStateException) {
+                release()
+                throw e
+            }
+        }
     }
 
     override fun close() {
-        readJob?.cancel()
+        release()
+        scope.cancel()
+    }
+
+    /**
+     * 关闭 socket 和读循环（不取消 scope，open 失败后可以重新 open）。
+     */
+    private fun release() {
+        val job = readJob
+        job?.cancel()
         readJob = null
+        closeBcm()
+        stopBusMonitor()
 
         val fd = handle
         if (fd != 0L) {
-            NativeCan.close(fd)
+            // 先从 reactor 注销，读协程结束后再关 fd，避免 fd 号被复用后收到错误的事件
+            val tp = isoTp
+            isoTp = null
+            CommReactor.unregisterAndCloseAfter(fd, reactorToken, listOfNotNull(job)) {
+                // ISO-TP：还在 send / receive 里的调用返回后才真正关闭
+                if (tp != null) tp.close() else NativeCan.close(fd)
+            }
+            reactorToken = 0
             handle = 0L
         }
-
-        scope.cancel()
     }
 
     override fun isOpen(): Boolean = handle != 0L
@@ -78,9 +232,12 @@ internal class CanChannelImpl(
     /**
      * 发送 CAN payload。
      *
-     * 当前实现未区分 frameId / flags：
-     * - 暂时用 frameId = 0 / flags = 0
-     * - 如果你有具体协议，可以在 CommChannel 之上再包一层，或者扩展 send()
+     * 当前实现未区分 frameId：
+     * - 暂时用 frameId = 0
+     * - fdMode 下超过 8 字节的 payload 以 FD 帧发送（按 bitrateSwitch 决定是否带 BRS）
+     * - 如果你有具体协议，可以使用 sendFrames() 自行指定 frameId / flags
+     *
+     * ISO-TP 模式下 bytes 是一整条报文，按 [IsoTpConfig.txId] 分段发送，阻塞到最后一帧发出。
      */
     override suspend fun send(bytes: ByteArray, timeoutMs: Int?): Int {
         check(isOpen()) {
@@ -93,17 +250,178 @@ internal class CanChannelImpl(
             throw IllegalStateException("CAN handle is closed during send (id=$id)")
         }
 
+        val tp = isoTp
+        if (tp != null) return sendIsoTp(tp, bytes, t)
+
+        var flags = 0
+        if (config.fdMode && bytes.size > CanFrames.MAX_CLASSIC_PAYLOAD) {
+            flags = CanFrames.FLAG_FD
+            if (config.bitrateSwitch) flags = flags or CanFrames.FLAG_BRS
+        }
+
         // 真全双工：发送直接在 IO 线程执行，不阻塞读循环
-        return withContext(Dispatchers.IO) {
-            NativeCan.write(
-                fd,
-                /*frameId=*/0,      // TODO: 按实际协议填充
-                /*flags=*/0,        // TODO: 按实际需求设置扩展帧/RTR/FD 等
-                bytes,
-                0,
-                bytes.size,
-                t
+        inFlightWrites.incrementAndGet()
+        try {
+            return withContext(Dispatchers.IO) {
+                NativeCan.write(
+                    fd,
+                    /*frameId=*/0,      // TODO: 按实际协议填充
+                    flags,
+                    bytes,
+                    0,
+                    bytes.size,
+                    t
+                )
+            }
+        } finally {
+            inFlightWrites.decrementAndGet()
+        }
+    }
+
+    /**
+     * ISO-TP 发送。用户态引擎等 FC 期间可能顺带收完了对端的报文，发完后唤醒读循环取走。
+     */
+    private suspend fun sendIsoTp(tp: IsoTpRef, bytes: ByteArray, timeoutMs: Int): Int {
+        check(tp.acquire()) {
+            "ISO-TP handle is closed during send (id=$id)"
+        }
+        inFlightWrites.incrementAndGet()
+        try {
+            return withContext(Dispatchers.IO) {
+                val n = NativeIsoTp.send(tp.handle, bytes, 0, bytes.size, timeoutMs)
+                if (NativeIsoTp.pending(tp.handle) > 0) readable.trySend(Unit)
+                n
+            }
+        } finally {
+            inFlightWrites.decrementAndGet()
+            tp.release()
+        }
+    }
+
+    override suspend fun sendFrames(frames: ByteArray, count: Int, timeoutMs: Int?): Int {
+        check(isOpen()) {
+            "CanChannelImpl#sendFrames called when channel is not open (id=$id)"
+        }
+        check(config.isoTp == null) {
+            "CanChannelImpl#sendFrames is not available in ISO-TP mode (id=$id)"
+        }
+        require(count >= 0 && count * CanFrames.RECORD_SIZE <= frames.size) {
+            "Invalid frame count: $count, buffer size=${frames.size}"
+        }
+        if (count == 0) return 0
+
+        val t = timeoutMs ?: config.writeTimeoutMs
+        val fd = handle
+        if (fd == 0L) {
+            throw IllegalStateException("CAN handle is closed during sendFrames (id=$id)")
+        }
+
+        // 整批一次线程切换 + 一次 JNI 调用
+        inFlightWrites.incrementAndGet()
+        try {
+            return withContext(Dispatchers.IO) {
+                NativeCan.writeBatch(fd, frames, count, t)
+            }
+        } finally {
+            inFlightWrites.decrementAndGet()
+        }
+    }
+
+    override fun setFilters(filters: List<CanFilter>, errorMask: Int) {
+        val fd = handle
+        check(fd != 0L) {
+            "CanChannelImpl#setFilters called when channel is not open (id=$id)"
+        }
+        check(config.isoTp == null) {
+            "CanChannelImpl#setFilters is not available in ISO-TP mode (id=$id)"
+        }
+        val ret = NativeCan.setFilters(fd, CanFilter.pack(filters), errorMask)
+        check(ret >= 0) {
+            "Failed to set CAN filters on ${config.ifName}, ret=$ret"
+        }
+    }
+
+    override fun restart(): Boolean {
+        val ret = NativeCan.restart(config.ifName)
+        if (ret == -NativeCan.EBUSY) return false
+        check(ret == 0) {
+            "Failed to restart CAN controller ${config.ifName}, ret=$ret"
+        }
+        return true
+    }
+
+    override fun startCyclic(frameId: Int, flags: Int, data: ByteArray, intervalMicros: Long) {
+        require(intervalMicros > 0) { "Invalid intervalMicros: $intervalMicros" }
+        require(flags and (CanFrames.FLAG_ESI or CanFrames.FLAG_ERROR) == 0) { "Invalid cyclic flags: $flags" }
+        synchronized(bcmLock) {
+            val ret = NativeCanBcm.txStart(openBcm(), frameId, flags, data, intervalMicros)
+            check(ret == 0) {
+                "Failed to start cyclic frame 0x${frameId.toString(16)} on ${config.ifName}, ret=$ret"
+            }
+            cyclicFrames.add(bcmKey(frameId, flags))
+        }
+    }
+
+    override fun updateCyclic(frameId: Int, flags: Int, data: ByteArray, sendNow: Boolean) {
+        synchronized(bcmLock) {
+            // 内核对不存在的任务会新建一个不带定时器的任务，这里先拦下来
+            check(bcmKey(frameId, flags) in cyclicFrames) {
+                "No cyclic frame 0x${frameId.toString(16)} (id=$id)"
+            }
+            val ret = NativeCanBcm.txUpdate(bcm, frameId, flags, data, sendNow)
+            check(ret == 0) {
+                "Failed to update cyclic frame 0x${frameId.toString(16)} on ${config.ifName}, ret=$ret"
+            }
+        }
+    }
+
+    override fun stopCyclic(frameId: Int, flags: Int): Boolean {
+        synchronized(bcmLock) {
+            if (!cyclicFrames.remove(bcmKey(frameId, flags))) return false
+            val ret = NativeCanBcm.txStop(bcm, frameId, flags)
+            check(ret == 0 || ret == -NativeCanBcm.EINVAL) {
+                "Failed to stop cyclic frame 0x${frameId.toString(16)} on ${config.ifName}, ret=$ret"
+            }
+            return true
+        }
+    }
+
+    override fun watch(watch: CanWatch, receiver: CanWatchReceiver) {
+        var options = 0
+        if (watch.checkDlc) options = options or NativeCanBcm.WATCH_CHECK_DLC
+        if (watch.announceResume) options = options or NativeCanBcm.WATCH_ANNOUNCE_RESUME
+
+        synchronized(bcmLock) {
+            val h = openBcm()
+            // 先挂回调：RX_SETUP 之后事件可能马上就到
+            val key = bcmKey(watch.frameId, watch.flags)
+            val previous = watches.put(key, receiver)
+            val ret = NativeCanBcm.rxWatch(
+                h,
+                watch.frameId,
+                watch.flags,
+                watch.mask,
+                watch.timeoutMs * 1000L,
+                watch.throttleMs * 1000L,
+                options
             )
+            if (ret != 0) {
+                if (previous != null) watches[key] = previous else watches.remove(key)
+                throw IllegalStateException(
+                    "Failed to watch CAN frame 0x${watch.frameId.toString(16)} on ${config.ifName}, ret=$ret"
+                )
+            }
+        }
+    }
+
+    override fun unwatch(frameId: Int, flags: Int): Boolean {
+        synchronized(bcmLock) {
+            if (watches.remove(bcmKey(frameId, flags)) == null) return false
+            val ret = NativeCanBcm.rxUnwatch(bcm, frameId, flags)
+            check(ret == 0 || ret == -NativeCanBcm.EINVAL) {
+                "Failed to unwatch CAN frame 0x${frameId.toString(16)} on ${config.ifName}, ret=$ret"
+            }
+            return true
         }
     }
 
@@ -111,46 +429,321 @@ internal class CanChannelImpl(
         this.receiver = receiver
     }
 
+    override fun setFrameDispatcher(dispatcher: CanDispatcher?) {
+        check(config.isoTp == null) {
+            "CanChannelImpl#setFrameDispatcher is not available in ISO-TP mode (id=$id)"
+        }
+        frameDispatcher = dispatcher
+    }
+
+    override fun metrics(): ChannelMetrics =
+        NativeMetrics.read(handle, inFlightWrites.get())
+
+    override fun rxRingStats(): RxRingStats? =
+        if (isOpen()) rxRing?.stats() else null
+
+    override fun busStatus(): CanBusStatus? = synchronized(monitorLock) {
+        val m = busMonitor
+        if (m == 0L) null else NativeCanMonitor.readStatus(m, readError)
+    }
+
+    /**
+     * 打开总线监视 socket 并登记到 reactor。
+     */
+    private fun startBusMonitor(monitorConfig: CanBusMonitorConfig) {
+        synchronized(monitorLock) {
+            val m = NativeCanMonitor.create(config, monitorConfig)
+            check(m > 0L) {
+                "Failed to start bus monitor on ${config.ifName}, ret=$m"
+            }
+            try {
+                CommReactor.attachBusMonitor(m)
+            } catch (e: IllegalStateException) {
+                NativeCanMonitor.destroy(m)
+                throw e
+            }
+            busMonitor = m
+        }
+    }
+
+    /**
+     * 先从 reactor 注销再销毁，reactor 线程之后不会再访问它。
+     */
+    private fun stopBusMonitor() {
+        synchronized(monitorLock) {
+            val m = busMonitor
+            if (m == 0L) return
+            busMonitor = 0L
+            CommReactor.detachBusMonitor(m)
+            NativeCanMonitor.destroy(m)
+        }
+    }
+
     /**
      * 启动 CAN 读循环：
-     * - 一直阻塞在 JNI read()，内部使用 poll 等待数据或超时
-     * - 读到数据就通过 CommReceiver 回调扔给上层
+     * - fd 注册到 [CommReactor]，协程挂起等待可读通知，空闲时没有任何唤醒
+     * - 可读后用 readBatch()（recvmmsg）把 socket 里排队的帧一批批收走，逐帧通过 CommReceiver 回调扔给上层
+     * - 读干净之后 rearm，等待下一次可读
+     * - ISO-TP 模式下每次取一条重组好的完整报文上抛
+     * - 配置了接收环时只收进环里，接收线程逐批回调；环满（BLOCK）时不 rearm，等接收线程腾出空间再读
      */
     private fun startReadLoop() {
+        val fd = handle
+        val token = CommReactor.register(fd) { readable.trySend(Unit) }
+        reactorToken = token
+
+        val tp = isoTp
+        val tpConfig = config.isoTp
+        if (tp != null && tpConfig != null) {
+            check(tp.acquire()) { "ISO-TP handle is closed (id=$id)" }
+            val job = scope.launch {
+                val message = ByteArray(tpConfig.maxMessageSize)
+                while (isActive && isOpen()) {
+                    readable.receive()
+                    if (!drainMessages(tp.handle, message)) break
+                    CommReactor.rearm(fd, token)
+                }
+            }
+            // 完成回调在协程体结束之后执行（包括启动前就被取消的情况），此时不会再有 receive
+            job.invokeOnCompletion { tp.release() }
+            readJob = job
+            return
+        }
+
+        val ring = rxRing
+        if (ring != null) {
+            val maxFrames = config.readBatchFrames.coerceIn(1, CanFrames.MAX_BATCH)
+            val job = scope.launch {
+                while (isActive && isOpen()) {
+                    readable.receive()
+                    when (fillRing(ring, fd, maxFrames)) {
+                        Fill.DONE -> CommReactor.rearm(fd, token)
+                        Fill.BLOCKED -> Unit
+                        Fill.ERROR -> break
+                    }
+                }
+            }
+            val batch = CanFrames.allocate(CanFrames.MAX_BATCH)
+            val consumer = ring.launchConsumer(
+                scope,
+                onRecord = { buffer, offset, length, _ ->
+                    // 环里的记录就是 readBatch 的定长记录，拷进复用数组后按原路径逐帧上抛
+                    buffer.clear()
+                    buffer.position(offset)
+                    buffer.get(batch, 0, length)
+                    deliverFrames(batch, length / CanFrames.RECORD_SIZE)
+                },
+                onSpace = { readable.trySend(Unit) }
+            )
+            ring.destroyAfter(job, consumer)
+            readJob = job
+            return
+        }
+
         readJob = scope.launch {
-            val buffer = ByteArray(72) // 经典 CAN 8 字节，CAN FD 最多 64，72 足够
-            val frameIdArr = IntArray(1)
-            val flagsArr = IntArray(1)
+            val maxFrames = config.readBatchFrames.coerceAtLeast(1)
+            val batch = CanFrames.allocate(maxFrames)
 
             while (isActive && isOpen()) {
-                val fd = handle
-                if (fd == 0L) break
+                readable.receive()
+                if (!drainFrames(fd, batch, maxFrames)) {
+                    // 读出错（例如接口被 down）：错误码已记在 readError，退出循环
+                    break
+                }
+                CommReactor.rearm(fd, token)
+            }
+        }
+    }
 
-                val n = NativeCan.read(
-                    fd,
-                    frameIdArr,
-                    flagsArr,
-                    buffer,
-                    0,
-                    buffer.size,
-                    config.readTimeoutMs
+    /**
+     * 非阻塞地把 socket 里已排队的帧全部读出并上抛。
+     *
+     * @return false 表示读出错（错误码记在 [readError]），读循环应退出
+     */
+    private fun drainFrames(fd: Long, batch: ByteArray, maxFrames: Int): Boolean {
+        while (true) {
+            val n = NativeCan.readBatch(fd, batch, maxFrames, 0)
+            if (n < 0) {
+                readError = n
+                return false
+            }
+            if (n == 0) return true
+
+            deliverFrames(batch, n)
+
+            // 没取满说明队列已经空了
+            if (n < maxFrames) return true
+        }
+    }
+
+    /**
+     * 接收环一次填充的结果。
+     */
+    private enum class Fill {
+        /** 已读干净 */
+        DONE,
+
+        /** 接收环已满（[RxOverflow.BLOCK]），暂停读取 */
+        BLOCKED,
+
+        /** 读出错，读循环应退出 */
+        ERROR
+    }
+
+    /**
+     * 非阻塞地把 socket 里已排队的帧全部收进接收环，由接收线程回调 receiver。
+     */
+    private fun fillRing(ring: RxRing, fd: Long, maxFrames: Int): Fill {
+        while (true) {
+            val n = NativeRxRing.fillCan(ring.handle, fd, maxFrames)
+            if (n == -NativeRxRing.ENOBUFS) return Fill.BLOCKED
+            if (n < 0) {
+                readError = n
+                return Fill.ERROR
+            }
+            if (n == 0) return Fill.DONE
+            ring.signal()
+            if (n < maxFrames) return Fill.DONE
+        }
+    }
+
+    /**
+     * 把批量缓冲区里的前 n 帧逐帧交给 dispatcher 和 receiver。
+     */
+    private fun deliverFrames(batch: ByteArray, n: Int) {
+        // 带 ID / flags 的按 ID 分发
+        frameDispatcher?.dispatch(batch, n)
+
+        // receiver 只拿 payload 字节，直接指向批量缓冲区，不额外拷贝
+        when (val r = receiver) {
+            null -> Unit
+            is TimestampedReceiver -> for (i in 0 until n) {
+                r.onBytesReceived(
+                    batch,
+                    CanFrames.payloadOffset(i),
+                    CanFrames.length(batch, i),
+                    CanFrames.timestamp(batch, i),
+                    CanFrames.timestampSource(batch, i)
                 )
+            }
 
-                when {
-                    n > 0 -> {
-                        // 这里只把 payload 字节上抛
-                        // frameId / flags 可通过单独接口或自定义 receiver 扩展
-                        receiver?.onBytesReceived(buffer, 0, n)
-                    }
+            else -> for (i in 0 until n) {
+                r.onBytesReceived(batch, CanFrames.payloadOffset(i), CanFrames.length(batch, i))
+            }
+        }
+    }
 
-                    n < 0 -> {
-                        // 发生错误，直接退出循环（你也可以改成重试 / 标记错误状态）
-                        break
-                    }
+    /**
+     * 非阻塞地取走所有已重组完成的 ISO-TP 报文并上抛。
+     *
+     * 过长被丢弃的报文（EMSGSIZE）只计入统计，不中断读循环。
+     *
+     * @return false 表示读出错，读循环应退出
+     */
+    private fun drainMessages(tp: Long, message: ByteArray): Boolean {
+        while (true) {
+            val n = NativeIsoTp.receive(tp, message, 0)
+            if (n == -NativeIsoTp.EMSGSIZE) continue
+            if (n < 0) {
+                readError = n
+                return false
+            }
+            if (n == 0) return true
+            receiver?.onBytesReceived(message, 0, n)
+        }
+    }
 
-                    // n == 0 -> 读超时，无数据，继续下一轮
+    /**
+     * 周期帧 / 接收监视的 key：内核按 can_id（含 EFF 位）和是否 FD 区分任务。
+     */
+    private fun bcmKey(frameId: Int, flags: Int): Long =
+        (frameId.toLong() shl 8) or (flags and (CanFrames.FLAG_EXTENDED or CanFrames.FLAG_FD)).toLong()
+
+    /**
+     * 打开 BCM socket 并启动事件读协程（已打开时直接返回），调用方需持有 [bcmLock]。
+     */
+    private fun openBcm(): Long {
+        val opened = bcm
+        if (opened != 0L) return opened
+        check(isOpen()) {
+            "CAN_BCM used when channel is not open (id=$id)"
+        }
+
+        val fd = NativeCanBcm.open(config.ifName)
+        check(fd > 0L) {
+            "Failed to open CAN_BCM socket on ${config.ifName}, ret=$fd"
+        }
+        val token = try {
+            CommReactor.register(fd) { bcmReadable.trySend(Unit) }
+        } catch (e: IllegalStateException) {
+            NativeCanBcm.close(fd)
+            throw e
+        }
+        bcm = fd
+        bcmToken = token
+
+        bcmJob = scope.launch {
+            val events = CanFrames.allocate(CanFrames.MAX_BATCH)
+            while (isActive && isOpen()) {
+                bcmReadable.receive()
+                if (!drainBcmEvents(fd, events)) break
+                CommReactor.rearm(fd, token)
+            }
+        }
+        return fd
+    }
+
+    /**
+     * 停止事件读协程并关闭 BCM socket，内核随之删除所有周期发送和接收监视。
+     */
+    private fun closeBcm() {
+        synchronized(bcmLock) {
+            val job = bcmJob
+            job?.cancel()
+            bcmJob = null
+            val fd = bcm
+            if (fd != 0L) {
+                CommReactor.unregisterAndCloseAfter(fd, bcmToken, listOfNotNull(job)) {
+                    NativeCanBcm.close(fd)
+                }
+                bcmToken = 0
+                bcm = 0L
+            }
+            cyclicFrames.clear()
+            watches.clear()
+        }
+    }
+
+    /**
+     * 非阻塞地取走所有 BCM 事件，按 key 交给各自的 [CanWatchReceiver]。
+     *
+     * @return false 表示读出错，读协程应退出
+     */
+    private fun drainBcmEvents(fd: Long, events: ByteArray): Boolean {
+        while (true) {
+            val n = NativeCanBcm.read(fd, events, CanFrames.MAX_BATCH)
+            if (n < 0) return false
+            if (n == 0) return true
+
+            for (i in 0 until n) {
+                val frameId = CanFrames.frameId(events, i)
+                val flags = CanFrames.flags(events, i)
+                val r = watches[bcmKey(frameId, flags)] ?: continue
+                when (events[i * CanFrames.RECORD_SIZE + 7].toInt()) {
+                    NativeCanBcm.EVENT_CHANGED -> r.onChanged(
+                        frameId,
+                        flags,
+                        events,
+                        CanFrames.payloadOffset(i),
+                        CanFrames.length(events, i),
+                        CanFrames.timestamp(events, i)
+                    )
+
+                    NativeCanBcm.EVENT_TIMEOUT -> r.onTimeout(frameId, flags, CanFrames.timestamp(events, i))
                 }
             }
+
+            if (n < CanFrames.MAX_BATCH) return true
         }
     }
 }
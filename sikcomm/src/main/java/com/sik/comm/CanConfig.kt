@@ -3,15 +3,43 @@ package com.sik.comm
 /**
  * SocketCAN 通道配置。
  *
- * 本配置不强制要求 JNI 去 bringUp 接口，
- * bitrate / fdMode 仅作为“可选”参数传入 JNI 层使用。
+ * 本配置不强制要求 JNI 去 bringUp 接口：bitrate / dataBitrate / restartMs / txQueueLen 都为 null 时，
+ * open 只把接口 up，链路参数完全由系统 / 上层负责。
+ * 任一不为 null 时，open 前通过 rtnetlink 一次往返完成配置并 up（相当于 `ip link set ... type can ...`，
+ * 需要 CAP_NET_ADMIN）；配置了 bitrate 时同时按 fdMode 打开 / 关闭控制器的 FD 模式。
+ * vcan 没有位时序，只能配置 txQueueLen。
+ *
+ * fdMode = true 时 socket 会打开 CAN_RAW_FD_FRAMES，可收发最多 64 字节的 CAN FD 帧，
+ * 要求接口 MTU 为 72（vcan 可用 `ip link set vcan0 mtu 72` 测试）。
+ *
+ * filters / errorMask 在 open 时通过 setsockopt 下发到内核，不关心的帧直接在内核丢弃；
+ * 运行时可通过 [CanChannel.setFilters] 替换。
+ *
+ * busMonitor 不为 null 时 open 额外打开一个总线监视 socket，统计总线负载和控制器错误状态，
+ * 通过 [CanChannel.busStatus] 取快照。
+ *
+ * isoTp 不为 null 时通道工作在 ISO-TP 模式：send() 发送整条报文（native 分段 + 流控），
+ * receiver 每次收到一条重组好的完整报文；此时 filters / errorMask / sendFrames 不可用。
  */
 data class CanConfig(
     override val id: String,
     val ifName: String,              // 如: "can0" / "can1"
-    val bitrate: Int? = null,        // 可选：如果 JNI 需要负责 `ip link set ... bitrate`
+    val bitrate: Int? = null,        // 可选：仲裁段波特率，由 JNI 通过 netlink 配置
+    val samplePoint: Float? = null,  // 可选：仲裁段采样点，如 0.875f，null 由驱动决定
+    val dataBitrate: Int? = null,    // 可选：FD 数据段波特率
+    val dataSamplePoint: Float? = null, // 可选：FD 数据段采样点
+    val restartMs: Int? = null,      // 可选：bus-off 自动恢复延时（毫秒），0 表示关闭自动恢复，改用 [CanChannel.restart]
+    val txQueueLen: Int? = null,     // 可选：接口发送队列长度（txqueuelen）
     val fdMode: Boolean = false,     // 是否 CAN FD 模式
+    val bitrateSwitch: Boolean = true, // FD 模式下 send() 发出的 FD 帧是否带 BRS
+    val filters: List<CanFilter> = emptyList(), // 内核 ID 过滤器，空表示全部接收
+    val errorMask: Int = 0,          // 订阅的错误帧类别（CanFrames.ERR_*），0 表示不收错误帧
     override val readTimeoutMs: Int = 500,
     override val writeTimeoutMs: Int = 500,
+    val readBatchFrames: Int = 32,   // 读循环每次 JNI 调用最多取回的帧数
+    val isoTp: IsoTpConfig? = null,  // ISO-TP 传输层，null 表示按原始 CAN 帧收发
+    val rxRing: RxRingConfig? = null, // 接收环：读循环只负责收进环，receiver 在专用接收线程回调（ISO-TP 模式不支持）
+    val capture: CaptureConfig? = null, // 收发抓包：native 层把每帧追加到内存映射的段文件（ISO-TP 模式不支持）
+    val busMonitor: CanBusMonitorConfig? = null, // 总线负载 / 错误状态监视，null 表示不监视
     val extra: Map<String, Any?> = emptyMap()
 ) : CommConfig
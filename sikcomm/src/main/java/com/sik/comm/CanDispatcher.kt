@@ -0,0 +1,217 @@
+package com.sik.comm
+
+/**
+ * CAN 帧按 ID 分发表，通过 [CanChannel.setFrameDispatcher] 挂到通道上。
+ *
+ * - 标准帧（11 位）：长度 2048 的平表，按 ID 直接下标；
+ * - 扩展帧（29 位）：开放寻址哈希表（IntArray 存键）。跨度不超过 [MAX_EXPANDED_RANGE] 的区间注册时展开成逐个 ID，
+ *   更大的区间单独存放，哈希未命中时才按注册顺序倒序查找；
+ * - 错误帧和没有命中任何注册的帧交给 [setDefault] 设置的回调（没有则丢弃）。
+ *
+ * 分发路径不分配内存：每帧一次数组下标或哈希探测，随后直接回调。
+ * 注册 / 注销可以在任意线程调用：加锁后整表写时复制，分发侧每批只读一次 volatile 引用，不加锁。
+ * 适合启动时一次性注册、运行中偶尔调整的场景。
+ *
+ * 同一 ID 后注册的覆盖先注册的；精确 ID（含展开的小区间）优先于大区间。
+ */
+class CanDispatcher {
+
+    /**
+     * 分发侧使用的只读快照。
+     */
+    @Volatile
+    private var table: Table = Table.EMPTY
+
+    // ---- 以下为注册信息，只在持有 this 锁时访问 ----
+
+    private val standard = arrayOfNulls<CanFrameReceiver>(STANDARD_ID_COUNT)
+    private val extended = HashMap<Int, CanFrameReceiver>()
+    private val wideRanges = ArrayList<Range>()
+    private var fallback: CanFrameReceiver? = null
+
+    /**
+     * 为单个 ID 注册回调。
+     *
+     * @param frameId  CAN ID
+     * @param receiver 回调
+     * @param extended 是否为 29 位扩展帧 ID
+     */
+    @JvmOverloads
+    fun register(frameId: Int, receiver: CanFrameReceiver, extended: Boolean = false) {
+        registerRange(frameId, frameId, receiver, extended)
+    }
+
+    /**
+     * 为闭区间 [fromId, toId] 内的所有 ID 注册回调。
+     */
+    @JvmOverloads
+    fun registerRange(fromId: Int, toId: Int, receiver: CanFrameReceiver, extended: Boolean = false) {
+        checkRange(fromId, toId, extended)
+        synchronized(this) {
+            when {
+                !extended -> standard.fill(receiver, fromId, toId + 1)
+                toId - fromId < MAX_EXPANDED_RANGE -> for (id in fromId..toId) this.extended[id] = receiver
+                else -> wideRanges.add(Range(fromId, toId, receiver))
+            }
+            publish()
+        }
+    }
+
+    /**
+     * 注销单个 ID 的回调（扩展帧只影响精确 ID / 展开的小区间，不影响大区间）。
+     */
+    @JvmOverloads
+    fun unregister(frameId: Int, extended: Boolean = false) {
+        unregisterRange(frameId, frameId, extended)
+    }
+
+    /**
+     * 注销闭区间 [fromId, toId] 内的回调；扩展帧大区间需按注册时的同一区间注销。
+     */
+    @JvmOverloads
+    fun unregisterRange(fromId: Int, toId: Int, extended: Boolean = false) {
+        checkRange(fromId, toId, extended)
+        synchronized(this) {
+            when {
+                !extended -> standard.fill(null, fromId, toId + 1)
+                toId - fromId < MAX_EXPANDED_RANGE -> for (id in fromId..toId) this.extended.remove(id)
+                else -> wideRanges.removeAll { it.from == fromId && it.to == toId }
+            }
+            publish()
+        }
+    }
+
+    /**
+     * 设置兜底回调：错误帧（[CanFrames.FLAG_ERROR]）和没有命中任何注册的帧。
+     */
+    fun setDefault(receiver: CanFrameReceiver?) {
+        synchronized(this) {
+            fallback = receiver
+            publish()
+        }
+    }
+
+    /**
+     * 清空所有注册（包括兜底回调）。
+     */
+    fun clear() {
+        synchronized(this) {
+            standard.fill(null)
+            extended.clear()
+            wideRanges.clear()
+            fallback = null
+            publish()
+        }
+    }
+
+    /**
+     * 分发批量缓冲区（[CanFrames] 记录格式）里的前 count 帧，在通道读循环（或接收线程）里调用。
+     */
+    internal fun dispatch(batch: ByteArray, count: Int) {
+        val t = table
+        for (i in 0 until count) {
+            val id = CanFrames.frameId(batch, i)
+            val flags = CanFrames.flags(batch, i)
+            val r = when {
+                flags and CanFrames.FLAG_ERROR != 0 -> null
+                flags and CanFrames.FLAG_EXTENDED != 0 -> t.extended(id)
+                else -> t.standard[id and STANDARD_ID_MASK]
+            } ?: t.fallback ?: continue
+
+            val length = CanFrames.length(batch, i)
+            r.onFrame(
+                id,
+                flags,
+                CanFrames.lengthToDlc(length),
+                batch,
+                CanFrames.payloadOffset(i),
+                length,
+                CanFrames.timestamp(batch, i)
+            )
+        }
+    }
+
+    private fun checkRange(fromId: Int, toId: Int, extended: Boolean) {
+        val max = if (extended) EXTENDED_ID_MASK else STANDARD_ID_MASK
+        require(fromId in 0..max && toId in fromId..max) {
+            "Invalid CAN id range: [$fromId, $toId], extended=$extended"
+        }
+    }
+
+    /**
+     * 按当前注册信息生成新的只读快照（调用方持有锁）。
+     */
+    private fun publish() {
+        var capacity = MIN_HASH_CAPACITY
+        while (capacity < extended.size * 2) capacity = capacity shl 1
+        val keys = IntArray(capacity) { EMPTY_KEY }
+        val values = arrayOfNulls<CanFrameReceiver>(capacity)
+        for ((id, receiver) in extended) {
+            var i = Table.slot(id, capacity - 1)
+            while (keys[i] != EMPTY_KEY) i = (i + 1) and (capacity - 1)
+            keys[i] = id
+            values[i] = receiver
+        }
+        table = Table(standard.copyOf(), keys, values, wideRanges.toTypedArray(), fallback)
+    }
+
+    private class Range(val from: Int, val to: Int, val receiver: CanFrameReceiver)
+
+    private class Table(
+        val standard: Array<CanFrameReceiver?>,
+        private val keys: IntArray,
+        private val values: Array<CanFrameReceiver?>,
+        private val ranges: Array<Range>,
+        val fallback: CanFrameReceiver?
+    ) {
+
+        fun extended(id: Int): CanFrameReceiver? {
+            val mask = keys.size - 1
+            var i = slot(id, mask)
+            while (true) {
+                val key = keys[i]
+                if (key == id) return values[i]
+                if (key == EMPTY_KEY) break
+                i = (i + 1) and mask
+            }
+            // 后注册的大区间优先
+            var j = ranges.size - 1
+            while (j >= 0) {
+                val r = ranges[j]
+                if (id in r.from..r.to) return r.receiver
+                j--
+            }
+            return null
+        }
+
+        companion object {
+            val EMPTY = Table(
+                arrayOfNulls(STANDARD_ID_COUNT),
+                IntArray(MIN_HASH_CAPACITY) { EMPTY_KEY },
+                arrayOfNulls(MIN_HASH_CAPACITY),
+                emptyArray(),
+                null
+            )
+
+            /** 乘法散列，29 位 ID 的低位往往连续，先打散再取模 */
+            fun slot(id: Int, mask: Int): Int {
+                val h = id * -0x61c88647
+                return (h xor (h ushr 16)) and mask
+            }
+        }
+    }
+
+    companion object {
+
+        /** 扩展帧区间跨度不超过该值时注册时展开到哈希表，分发为 O(1) */
+        const val MAX_EXPANDED_RANGE = 4096
+
+        private const val STANDARD_ID_COUNT = 2048
+        private const val STANDARD_ID_MASK = 0x7FF
+        private const val EXTENDED_ID_MASK = 0x1FFFFFFF
+
+        /** 哈希表空槽（合法 29 位 ID 不会是负数） */
+        private const val EMPTY_KEY = -1
+        private const val MIN_HASH_CAPACITY = 16
+    }
+}
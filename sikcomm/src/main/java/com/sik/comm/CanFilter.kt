@@ -0,0 +1,57 @@
+package com.sik.comm
+
+/**
+ * SocketCAN 内核过滤器（CAN_RAW_FILTER）。
+ *
+ * 帧满足 `(frameId & mask) == (id & mask)` 时被接收，不满足的在内核里直接丢弃，
+ * 不会唤醒读循环，也不会跨 JNI。
+ *
+ * - 标准帧过滤器只匹配标准帧，扩展帧过滤器只匹配扩展帧
+ * - inverted = true 时取反：接收“不匹配”的帧
+ * - 多个过滤器之间是“或”的关系
+ *
+ * @param id       期望的 CAN ID
+ * @param mask     参与比较的 ID 位
+ * @param extended 是否为 29 位扩展帧过滤器
+ * @param inverted 是否取反
+ */
+data class CanFilter(
+    val id: Int,
+    val mask: Int,
+    val extended: Boolean = false,
+    val inverted: Boolean = false
+) {
+
+    companion object {
+
+        /** 过滤器 flags：扩展帧（和 JNI 层 CAN_FILTER_* 保持一致） */
+        private const val FLAG_EXTENDED = 0x01
+
+        /** 过滤器 flags：取反 */
+        private const val FLAG_INVERTED = 0x02
+
+        /**
+         * 只接收指定 ID 的过滤器。
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun exact(id: Int, extended: Boolean = false): CanFilter =
+            CanFilter(id, if (extended) 0x1FFFFFFF else 0x7FF, extended)
+
+        /**
+         * 打包成 JNI 使用的 [id, mask, flags] 三元组数组。
+         */
+        internal fun pack(filters: List<CanFilter>): IntArray {
+            val spec = IntArray(filters.size * 3)
+            filters.forEachIndexed { i, f ->
+                var flags = 0
+                if (f.extended) flags = flags or FLAG_EXTENDED
+                if (f.inverted) flags = flags or FLAG_INVERTED
+                spec[i * 3] = f.id
+                spec[i * 3 + 1] = f.mask
+                spec[i * 3 + 2] = flags
+            }
+            return spec
+        }
+    }
+}
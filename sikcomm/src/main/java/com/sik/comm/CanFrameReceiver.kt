@@ -0,0 +1,31 @@
+package com.sik.comm
+
+/**
+ * CAN 帧接收回调，通过 [CanDispatcher] 按 ID 注册。
+ *
+ * 和 [CommReceiver] 只拿到 payload 不同，这里每帧都带上 ID、flags 和 DLC。
+ * data 是读循环复用的批量缓冲区（[CanFrames] 记录格式），只在回调期间有效，回调内不要做耗时操作。
+ */
+fun interface CanFrameReceiver {
+
+    /**
+     * 收到一帧时触发。
+     *
+     * @param frameId     CAN ID（标准帧 11 位 / 扩展帧 29 位，不含标志位）；错误帧为 CAN_ERR_* 类别位
+     * @param flags       [CanFrames] FLAG_* 组合
+     * @param dlc         DLC（0..15，FD 帧按长度档位换算）
+     * @param data        缓冲区数组（复用，不保证每次都是新数组）
+     * @param offset      payload 起始下标
+     * @param length      payload 长度
+     * @param timestampNs 接收时间戳（纳秒），没有时为 0，来源同 [CanFrames.timestampSource]
+     */
+    fun onFrame(
+        frameId: Int,
+        flags: Int,
+        dlc: Int,
+        data: ByteArray,
+        offset: Int,
+        length: Int,
+        timestampNs: Long
+    )
+}
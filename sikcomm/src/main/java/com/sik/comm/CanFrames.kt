@@ -0,0 +1,180 @@
+package com.sik.comm
+
+/**
+ * CAN 帧打包记录格式。
+ *
+ * 批量收发（[CanChannel.sendFrames]、JNI readBatch / writeBatch）都使用同一种定长记录，
+ * 多帧依次首尾相接放在一个 ByteArray 里，一次 JNI 调用处理一整批。
+ *
+ * 单条记录格式（小端）：
+ * - [0..3] frameId
+ * - [4]    flags（[FLAG_EXTENDED] / [FLAG_RTR] / [FLAG_FD] / [FLAG_BRS] / [FLAG_ESI] / [FLAG_ERROR]）
+ * - [5]    payload 长度
+ * - [6]    接收时间戳来源（TimestampedReceiver.SOURCE_*，发送时忽略）
+ * - [7]    保留
+ * - [8..15] 接收时间戳（纳秒，见 [TimestampedReceiver]，发送时忽略）
+ * - 之后为 payload，固定占 [MAX_PAYLOAD] 字节（经典帧只用前 8 字节）
+ */
+object CanFrames {
+
+    /** flags bit：扩展帧（和 JNI 层 CAN_FLAG_* 保持一致） */
+    const val FLAG_EXTENDED = 0x01
+
+    /** flags bit：远程帧 */
+    const val FLAG_RTR = 0x02
+
+    /** flags bit：CAN FD 帧 */
+    const val FLAG_FD = 0x04
+
+    /** flags bit：CAN FD 比特率切换 */
+    const val FLAG_BRS = 0x08
+
+    /** flags bit：CAN FD 发送节点处于被动错误状态（只在接收时出现） */
+    const val FLAG_ESI = 0x10
+
+    /**
+     * flags bit：错误帧（只在接收时出现，需要在 CanConfig.errorMask 中订阅）。
+     * 此时 frameId 为 ERR_* 错误类别位，payload 为 linux/can/error.h 定义的 8 字节错误详情。
+     */
+    const val FLAG_ERROR = 0x20
+
+    /** 错误类别：发送超时 */
+    const val ERR_TX_TIMEOUT = 0x001
+
+    /** 错误类别：仲裁失败 */
+    const val ERR_LOSTARB = 0x002
+
+    /** 错误类别：控制器问题（错误计数越限、被动错误等） */
+    const val ERR_CRTL = 0x004
+
+    /** 错误类别：协议错误 */
+    const val ERR_PROT = 0x008
+
+    /** 错误类别：收发器状态 */
+    const val ERR_TRX = 0x010
+
+    /** 错误类别：未收到 ACK */
+    const val ERR_ACK = 0x020
+
+    /** 错误类别：总线关闭（bus-off） */
+    const val ERR_BUSOFF = 0x040
+
+    /** 错误类别：总线错误 */
+    const val ERR_BUSERROR = 0x080
+
+    /** 错误类别：控制器已重启 */
+    const val ERR_RESTARTED = 0x100
+
+    /** 订阅全部错误类别 */
+    const val ERR_ALL = 0x1FFFFFFF
+
+    /** 记录头长度 */
+    const val HEADER_SIZE = 16
+
+    /** 经典 CAN 单帧最大 payload */
+    const val MAX_CLASSIC_PAYLOAD = 8
+
+    /** 单帧最大 payload（CAN FD） */
+    const val MAX_PAYLOAD = 64
+
+    /** 单条记录长度 */
+    const val RECORD_SIZE = HEADER_SIZE + MAX_PAYLOAD
+
+    /** 单次 recvmmsg / sendmmsg 最多处理的帧数（和 JNI 层 CAN_MAX_BATCH 保持一致） */
+    const val MAX_BATCH = 64
+
+    /**
+     * 分配能放下 count 帧的缓冲区。
+     */
+    @JvmStatic
+    fun allocate(count: Int): ByteArray = ByteArray(count * RECORD_SIZE)
+
+    /**
+     * 把一帧写到第 index 条记录。
+     *
+     * 经典帧 length <= 8；带 [FLAG_FD] 的帧 length <= 64，
+     * 非 DLC 档位的长度（如 10）由 JNI 层补 0 到下一档（12）。
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun put(
+        buffer: ByteArray,
+        index: Int,
+        frameId: Int,
+        flags: Int,
+        data: ByteArray,
+        offset: Int = 0,
+        length: Int = data.size
+    ) {
+        val max = if (flags and FLAG_FD != 0) MAX_PAYLOAD else MAX_CLASSIC_PAYLOAD
+        require(length in 0..max) { "CAN payload too long: $length" }
+        val base = index * RECORD_SIZE
+        buffer[base] = frameId.toByte()
+        buffer[base + 1] = (frameId ushr 8).toByte()
+        buffer[base + 2] = (frameId ushr 16).toByte()
+        buffer[base + 3] = (frameId ushr 24).toByte()
+        buffer[base + 4] = flags.toByte()
+        buffer[base + 5] = length.toByte()
+        buffer.fill(0, base + 6, base + HEADER_SIZE)
+        System.arraycopy(data, offset, buffer, base + HEADER_SIZE, length)
+    }
+
+    /** 第 index 条记录的 frameId */
+    @JvmStatic
+    fun frameId(buffer: ByteArray, index: Int): Int {
+        val base = index * RECORD_SIZE
+        return (buffer[base].toInt() and 0xFF) or
+            ((buffer[base + 1].toInt() and 0xFF) shl 8) or
+            ((buffer[base + 2].toInt() and 0xFF) shl 16) or
+            ((buffer[base + 3].toInt() and 0xFF) shl 24)
+    }
+
+    /** 第 index 条记录的 flags */
+    @JvmStatic
+    fun flags(buffer: ByteArray, index: Int): Int =
+        buffer[index * RECORD_SIZE + 4].toInt() and 0xFF
+
+    /** 第 index 条记录的 payload 长度 */
+    @JvmStatic
+    fun length(buffer: ByteArray, index: Int): Int =
+        buffer[index * RECORD_SIZE + 5].toInt() and 0xFF
+
+    /** 第 index 条记录的接收时间戳来源（TimestampedReceiver.SOURCE_*） */
+    @JvmStatic
+    fun timestampSource(buffer: ByteArray, index: Int): Int =
+        buffer[index * RECORD_SIZE + 6].toInt() and 0xFF
+
+    /** 第 index 条记录的接收时间戳（纳秒），没有时为 0 */
+    @JvmStatic
+    fun timestamp(buffer: ByteArray, index: Int): Long {
+        val base = index * RECORD_SIZE + 8
+        var ts = 0L
+        for (i in 7 downTo 0) {
+            ts = (ts shl 8) or (buffer[base + i].toLong() and 0xFF)
+        }
+        return ts
+    }
+
+    /**
+     * CAN FD DLC（0..15）对应的 payload 长度。
+     */
+    @JvmStatic
+    fun dlcToLength(dlc: Int): Int = FD_DLC_TO_LEN[dlc and 0x0F]
+
+    /**
+     * payload 长度对应的 DLC（FD 非档位长度向上取整）。
+     */
+    @JvmStatic
+    fun lengthToDlc(length: Int): Int {
+        for (dlc in FD_DLC_TO_LEN.indices) {
+            if (FD_DLC_TO_LEN[dlc] >= length) return dlc
+        }
+        return FD_DLC_TO_LEN.size - 1
+    }
+
+    private val FD_DLC_TO_LEN = intArrayOf(0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64)
+
+    /** 第 index 条记录 payload 在 buffer 中的起始下标 */
+    @JvmStatic
+    fun payloadOffset(index: Int): Int = index * RECORD_SIZE + HEADER_SIZE
+}
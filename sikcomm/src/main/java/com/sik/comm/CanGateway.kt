@@ -0,0 +1,74 @@
+package com.sik.comm
+
+import java.io.Closeable
+
+/**
+ * 进程内 CAN 网关，通过 [start] / [SikComm.startCanGateway] 创建。
+ *
+ * 转发不经过 Kotlin：内核后端由 CAN_GW 规则完成，用户态后端由 reactor 线程在 native 里
+ * recvmmsg -> 匹配 / 修改 -> sendmmsg，没有按帧的 JNI 调用和对象分配。
+ *
+ * 网关独立于 [CanChannel]：同一接口上的通道照常收发，也能收到网关转发到该接口的帧（本机回环）。
+ */
+class CanGateway private constructor(
+    private val handle: Long,
+    private val routeCount: Int
+) : Closeable {
+
+    /**
+     * 实际使用的后端（[CanGatewayMode.KERNEL] / [CanGatewayMode.USERSPACE]）。
+     */
+    val mode: CanGatewayMode =
+        if (NativeCanGateway.mode(handle) == NativeCanGateway.MODE_KERNEL) CanGatewayMode.KERNEL
+        else CanGatewayMode.USERSPACE
+
+    private val lock = Any()
+
+    private var closed = false
+
+    /**
+     * 各路由计数，顺序同创建时的路由列表；已关闭或查询失败时返回 null。
+     */
+    fun stats(): List<CanRouteStats>? = synchronized(lock) {
+        if (closed) null else NativeCanGateway.readStats(handle, routeCount)
+    }
+
+    /**
+     * 停止转发：注销 reactor、删除内核规则、关闭 socket。
+     */
+    override fun close() {
+        synchronized(lock) {
+            if (closed) return
+            closed = true
+            if (mode == CanGatewayMode.USERSPACE) CommReactor.detachGateway(handle)
+            NativeCanGateway.destroy(handle)
+        }
+    }
+
+    companion object {
+
+        /**
+         * 建立网关并开始转发。
+         *
+         * @param routes 路由列表，不能为空
+         * @param mode   后端选择
+         * @throws IllegalStateException 接口不存在 / 没有权限（KERNEL）等
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun start(routes: List<CanRoute>, mode: CanGatewayMode = CanGatewayMode.AUTO): CanGateway {
+            val h = NativeCanGateway.create(routes, mode)
+            check(h > 0L) { "Failed to start CAN gateway, ret=$h" }
+            val gateway = CanGateway(h, routes.size)
+            if (gateway.mode == CanGatewayMode.USERSPACE) {
+                try {
+                    CommReactor.attachGateway(h)
+                } catch (e: IllegalStateException) {
+                    NativeCanGateway.destroy(h)
+                    throw e
+                }
+            }
+            return gateway
+        }
+    }
+}
@@ -0,0 +1,123 @@
+package com.sik.comm
+
+/**
+ * CAN 网关的一条路由：把 [source] 上匹配 [filter] 的帧按 [modifications] 修改后转发到 [destination]。
+ *
+ * @param source        源接口名（如 "can0"）
+ * @param destination   目标接口名，不能和源相同
+ * @param filter        只转发匹配的帧，null 表示转发全部（错误帧从不转发）
+ * @param modifications 修改操作，每种 [CanFrameMod.Op] 至多一个，按 AND、OR、XOR、SET 的顺序执行
+ * @param fd            同时转发 CAN FD 帧（两端接口需工作在 FD 模式）；否则只转发经典帧
+ * @param maxHops       内核后端的跳数限制（1..255），0 使用内核默认；用户态后端忽略
+ */
+data class CanRoute(
+    val source: String,
+    val destination: String,
+    val filter: CanFilter? = null,
+    val modifications: List<CanFrameMod> = emptyList(),
+    val fd: Boolean = false,
+    val maxHops: Int = 0
+) {
+
+    init {
+        require(source.isNotEmpty() && destination.isNotEmpty()) { "Empty interface name" }
+        require(source != destination) { "Route source and destination are both $source" }
+        require(maxHops in 0..255) { "Invalid maxHops: $maxHops" }
+        require(modifications.map { it.op }.toSet().size == modifications.size) {
+            "Duplicate modification op in route $source -> $destination"
+        }
+        require(fd || modifications.none { it.fdFlags != null }) { "fdFlags requires an FD route" }
+    }
+}
+
+/**
+ * 帧修改操作（同内核 CAN_GW 的 CGW_MOD_*），对给出的字段用给出的值做 [op]，null 字段不修改。
+ *
+ * 修改后长度不合法（经典帧 > 8，FD 帧不是 DLC 档位）的帧会被丢弃并计入 [CanRouteStats.dropped]。
+ *
+ * @param op      操作
+ * @param id      CAN ID 原始值：扩展帧需带 [EFF_FLAG]（见 [setId]）
+ * @param length  payload 长度
+ * @param data    payload，最长 64 字节；短于帧长的部分不修改
+ * @param fdFlags [CanFrames.FLAG_BRS] / [CanFrames.FLAG_ESI]，只对 FD 路由有效
+ */
+data class CanFrameMod(
+    val op: Op,
+    val id: Int? = null,
+    val length: Int? = null,
+    val data: ByteArray? = null,
+    val fdFlags: Int? = null
+) {
+
+    enum class Op {
+        AND,
+        OR,
+        XOR,
+        SET
+    }
+
+    init {
+        require(id != null || length != null || data != null || fdFlags != null) { "Empty modification" }
+        require(length == null || length in 0..CanFrames.MAX_PAYLOAD) { "Invalid length: $length" }
+        require(data == null || data.size in 1..CanFrames.MAX_PAYLOAD) { "Invalid data size: ${data?.size}" }
+        require(fdFlags == null || fdFlags and (CanFrames.FLAG_BRS or CanFrames.FLAG_ESI).inv() == 0) {
+            "Invalid fdFlags: $fdFlags"
+        }
+    }
+
+    override fun equals(other: Any?): Boolean {
+        if (this === other) return true
+        if (other !is CanFrameMod) return false
+        return op == other.op && id == other.id && length == other.length &&
+            (data?.contentEquals(other.data) ?: (other.data == null)) &&
+            fdFlags == other.fdFlags
+    }
+
+    override fun hashCode(): Int {
+        var result = op.hashCode()
+        result = 31 * result + (id ?: 0)
+        result = 31 * result + (length ?: 0)
+        result = 31 * result + (data?.contentHashCode() ?: 0)
+        result = 31 * result + (fdFlags ?: 0)
+        return result
+    }
+
+    companion object {
+
+        /** CAN ID 原始值的扩展帧标志位（内核 CAN_EFF_FLAG） */
+        const val EFF_FLAG = 0x80000000.toInt()
+
+        /**
+         * 把帧改成指定 ID（同时改帧类型）。
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun setId(frameId: Int, extended: Boolean = false): CanFrameMod =
+            CanFrameMod(Op.SET, id = if (extended) (frameId and 0x1FFFFFFF) or EFF_FLAG else frameId and 0x7FF)
+    }
+}
+
+/**
+ * 网关后端。
+ */
+enum class CanGatewayMode {
+    /** 优先内核，内核规则添加失败（无权限 / 没有 can-gw 模块）时退回用户态 */
+    AUTO,
+
+    /** 内核 CAN_GW：转发在内核软中断里完成，需要 CAP_NET_ADMIN */
+    KERNEL,
+
+    /** 用户态：在 SikComm reactor 线程上 native 转发，不需要特权 */
+    USERSPACE
+}
+
+/**
+ * 单条路由的计数快照。
+ *
+ * @param handled 已转发帧数
+ * @param dropped 丢弃帧数（目标发送队列满 / 修改后长度非法）
+ */
+data class CanRouteStats(
+    val handled: Long,
+    val dropped: Long
+)
@@ -0,0 +1,78 @@
+package com.sik.comm
+
+/**
+ * CAN_BCM 接收监视，通过 [CanChannel.watch] 注册。
+ *
+ * 变化检测和超时都在内核里完成：内容不变的周期帧不会唤醒用户态，只有变化 / 超时才回调。
+ *
+ * @param frameId        CAN ID（标准帧 11 位 / 扩展帧 29 位）
+ * @param flags          [CanFrames.FLAG_EXTENDED] / [CanFrames.FLAG_FD]，和 frameId 一起区分监视
+ * @param mask           变化检测掩码（按位，最长 8 / FD 64 字节），只比较置 1 的位；null 表示每收到一帧都上报
+ * @param timeoutMs      超过这么久没收到该 ID 的帧上报一次超时，0 表示不监视
+ * @param throttleMs     两次变化上报之间的最小间隔，期间的变化由内核合并，0 表示不限速
+ * @param checkDlc       DLC 变化是否也算变化
+ * @param announceResume 超时后收到的第一帧是否总是上报（即使内容没变）
+ */
+data class CanWatch(
+    val frameId: Int,
+    val flags: Int = 0,
+    val mask: ByteArray? = null,
+    val timeoutMs: Int = 0,
+    val throttleMs: Int = 0,
+    val checkDlc: Boolean = true,
+    val announceResume: Boolean = true
+) {
+
+    init {
+        require(flags and (CanFrames.FLAG_EXTENDED or CanFrames.FLAG_FD).inv() == 0) {
+            "Invalid watch flags: $flags"
+        }
+        val maxMask = if (flags and CanFrames.FLAG_FD != 0) CanFrames.MAX_PAYLOAD else CanFrames.MAX_CLASSIC_PAYLOAD
+        require(mask == null || mask.size in 1..maxMask) { "Invalid watch mask size: ${mask?.size}" }
+        require(timeoutMs >= 0) { "Invalid timeoutMs: $timeoutMs" }
+        require(throttleMs >= 0) { "Invalid throttleMs: $throttleMs" }
+    }
+
+    override fun equals(other: Any?): Boolean {
+        if (this === other) return true
+        if (other !is CanWatch) return false
+        return frameId == other.frameId && flags == other.flags &&
+            (mask?.contentEquals(other.mask) ?: (other.mask == null)) &&
+            timeoutMs == other.timeoutMs && throttleMs == other.throttleMs &&
+            checkDlc == other.checkDlc && announceResume == other.announceResume
+    }
+
+    override fun hashCode(): Int {
+        var result = frameId
+        result = 31 * result + flags
+        result = 31 * result + (mask?.contentHashCode() ?: 0)
+        result = 31 * result + timeoutMs
+        result = 31 * result + throttleMs
+        result = 31 * result + checkDlc.hashCode()
+        result = 31 * result + announceResume.hashCode()
+        return result
+    }
+}
+
+/**
+ * [CanWatch] 事件回调，在通道的 BCM 读协程上触发，回调内不要做耗时操作。
+ */
+interface CanWatchReceiver {
+
+    /**
+     * 帧内容变化（首帧、超时后恢复、按掩码比较有变化）。
+     *
+     * @param data        复用的事件缓冲区（[CanFrames] 记录格式），只在回调期间有效
+     * @param offset      payload 起始下标
+     * @param length      payload 长度
+     * @param timestampNs 内核接收时间戳（纳秒），没有时为 0
+     */
+    fun onChanged(frameId: Int, flags: Int, data: ByteArray, offset: Int, length: Int, timestampNs: Long)
+
+    /**
+     * 超过 [CanWatch.timeoutMs] 没有收到该 ID 的帧。
+     *
+     * @param timestampNs 检测到超时的时间（CLOCK_MONOTONIC 纳秒）
+     */
+    fun onTimeout(frameId: Int, flags: Int, timestampNs: Long)
+}
@@ -0,0 +1,62 @@
+package com.sik.comm
+
+import java.io.File
+
+/**
+ * 收发抓包配置，通过 [SerialConfig.capture] / [CanConfig.capture] 开启。
+ *
+ * 通道 open 后，native 层把该 fd 上每次收到 / 发出的数据（串口为一次 read / writev 的字节块，CAN 为一帧）
+ * 连同 CLOCK_MONOTONIC 时间戳追加到内存映射的段文件里，不经过 Kotlin、不分配对象；
+ * 段写满后切到后台线程预先建好的下一段，旧段的收尾和删除也在后台线程里完成。close 时当前段截断到实际长度。
+ *
+ * 段文件为 `<directory>/<通道 id>.<段号>.sikcap`，只保留最新的 [maxSegments] 段。
+ * 抓到的文件可以用 [CommReplay] 按原始节奏回放到 vcan / pty。
+ *
+ * @param directory    抓包目录（需已存在且可写）
+ * @param segmentBytes 单段文件大小（字节）
+ * @param maxSegments  最多保留的段数，超出时删除最旧的段；0 表示不删除
+ */
+data class CaptureConfig(
+    val directory: String,
+    val segmentBytes: Long = 16L * 1024 * 1024,
+    val maxSegments: Int = 8
+) {
+
+    init {
+        require(directory.isNotEmpty()) { "capture directory is empty" }
+        require(segmentBytes >= MIN_SEGMENT_BYTES) {
+            "Invalid capture segmentBytes: $segmentBytes (>= $MIN_SEGMENT_BYTES)"
+        }
+        require(maxSegments >= 0) { "Invalid capture maxSegments: $maxSegments" }
+    }
+
+    /**
+     * 通道 channelId 的段文件路径前缀（不含 `.<段号>.sikcap`）。
+     */
+    fun pathPrefix(channelId: String): String = File(directory, channelId).path
+
+    /**
+     * 目录里通道 channelId 现有的段文件，按段号升序，可直接交给 [CommReplay]。
+     */
+    fun segmentFiles(channelId: String): List<File> {
+        val prefix = "$channelId."
+        return File(directory).listFiles().orEmpty()
+            .mapNotNull { file ->
+                val name = file.name
+                if (!name.startsWith(prefix) || !name.endsWith(SUFFIX)) return@mapNotNull null
+                val index = name.substring(prefix.length, name.length - SUFFIX.length).toIntOrNull()
+                    ?: return@mapNotNull null
+                index to file
+            }
+            .sortedBy { it.first }
+            .map { it.second }
+    }
+
+    companion object {
+        /** 最小段大小，每段至少要放得下文件头和一条最大的记录 */
+        const val MIN_SEGMENT_BYTES = 64L * 1024
+
+        /** 段文件扩展名 */
+        const val SUFFIX = ".sikcap"
+    }
+}
@@ -0,0 +1,56 @@
+package com.sik.comm
+
+/**
+ * 通道运行统计快照，通过 [CommChannel.metrics] 获取。
+ *
+ * 计数从通道 open 开始累计；“帧”对 CAN 是一帧，对串口是一次 read / write 调用。
+ *
+ * @param bytesIn         收到的字节数（CAN 为 payload 字节）
+ * @param bytesOut        发出的字节数
+ * @param framesIn        收到的帧 / 数据块数
+ * @param framesOut       发出的帧 / 数据块数
+ * @param pollTimeouts    等待超时次数
+ * @param errors          错误总次数
+ * @param errorsByErrno   按 errno 统计的错误次数
+ * @param writeQueueDepth 当前排队（或进行中）的写请求数
+ * @param pollWait        poll 等待到就绪的耗时分布
+ * @param syscall         read / write / recvmmsg / sendmmsg 本身的耗时分布
+ */
+data class ChannelMetrics(
+    val bytesIn: Long,
+    val bytesOut: Long,
+    val framesIn: Long,
+    val framesOut: Long,
+    val pollTimeouts: Long,
+    val errors: Long,
+    val errorsByErrno: Map<Int, Long>,
+    val writeQueueDepth: Int,
+    val pollWait: LatencyStats,
+    val syscall: LatencyStats
+) {
+    companion object {
+        /** 通道未打开时的空快照 */
+        @JvmField
+        val EMPTY = ChannelMetrics(
+            0, 0, 0, 0, 0, 0, emptyMap(), 0,
+            LatencyStats.EMPTY, LatencyStats.EMPTY
+        )
+    }
+}
+
+/**
+ * 耗时分布摘要（纳秒），由 native 对数直方图估算，分位数精度约 12.5%。
+ */
+data class LatencyStats(
+    val count: Long,
+    val meanNs: Long,
+    val p50Ns: Long,
+    val p90Ns: Long,
+    val p99Ns: Long,
+    val maxNs: Long
+) {
+    companion object {
+        @JvmField
+        val EMPTY = LatencyStats(0, 0, 0, 0, 0, 0)
+    }
+}
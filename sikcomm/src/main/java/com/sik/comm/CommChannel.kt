@@ -20,7 +20,7 @@ interface CommChannel {
      * 打开底层连接（幂等）。
      *
      * - 调用多次，只有第一次真正打开，后续直接返回。
-     * - 内部会启动读循环（loop），循环里通过 JNI 调用阻塞式 poll + read。
+     * - 内部会启动读循环（loop），fd 注册到全局 reactor，就绪后再通过 JNI 读取，空闲时不占线程。
      */
     fun open()
 
@@ -60,4 +60,19 @@ interface CommChannel {
      * - 推荐在调用 open() 之前就设置好 receiver，方便启动后立即处理数据。
      */
     fun setReceiver(receiver: CommReceiver?)
+
+    /**
+     * 获取通道运行统计快照（收发字节 / 帧数、超时、错误、poll 与 syscall 耗时分布）。
+     *
+     * 统计由 native 层无锁累计，调用本方法才会汇总一次，可以周期性调用。
+     * 通道未打开或实现不提供统计时返回 [ChannelMetrics.EMPTY]。
+     */
+    fun metrics(): ChannelMetrics = ChannelMetrics.EMPTY
+
+    /**
+     * 获取接收环统计快照（占用、高水位、因环满丢弃 / 暂停的次数）。
+     *
+     * 只有配置了接收环（[SerialConfig.rxRing] / [CanConfig.rxRing]）且通道已打开时才有，否则返回 null。
+     */
+    fun rxRingStats(): RxRingStats? = null
 }
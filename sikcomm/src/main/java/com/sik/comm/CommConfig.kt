@@ -6,7 +6,7 @@ package com.sik.comm
  * 所有具体的通道配置（串口、CAN）都实现这个接口。
  * 主要包含：
  * - id: 业务侧标识该通道的一个唯一 ID（比如设备 ID）
- * - readTimeoutMs: 读操作的超时时间（JNI 层 poll 的 timeout）
+ * - readTimeoutMs: 读操作的超时时间（阻塞式 JNI read 的 poll timeout）
  * - writeTimeoutMs: 写操作的超时时间（JNI 层 poll 的 timeout）
  */
 sealed interface CommConfig {
@@ -21,6 +21,8 @@ sealed interface CommConfig {
      *
      * 由 Kotlin 层传给 JNI，JNI 内部通过 poll() 使用该 timeout。
      * 当超时返回时，JNI 应该返回 0（无数据），不抛异常。
+     *
+     * 通道内置的读循环由 [CommReactor] 事件驱动，不再按该超时轮询。
      */
     val readTimeoutMs: Int
 
@@ -0,0 +1,139 @@
+package com.sik.comm
+
+import kotlinx.coroutines.Job
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * 全局唯一的 IO 就绪事件分发器。
+ *
+ * - 进程内只有一个 reactor 线程，阻塞在 epoll_wait 上，不设超时
+ * - 所有通道把 fd 注册进来，就绪时回调 [Listener]，由通道自己的协程去读
+ * - 空闲通道不占线程、不产生任何定时唤醒，通道再多线程数也不变
+ *
+ * fd 是一次性触发的：通道处理完就绪事件（把数据读干净）后必须调用 [rearm]。
+ */
+internal object CommReactor {
+
+    /**
+     * 就绪回调，在 reactor 线程上执行，只能做轻量的通知（例如唤醒协程），不能阻塞。
+     */
+    fun interface Listener {
+        fun onReady(events: Int)
+    }
+
+    private val listeners = ConcurrentHashMap<Int, Listener>()
+
+    private val nextToken = AtomicInteger(1)
+
+    /**
+     * reactor 句柄，第一次注册通道时才创建并启动线程。
+     */
+    private val reactor: Long by lazy {
+        val h = NativeReactor.create()
+        check(h > 0L) { "Failed to create reactor, ret=$h" }
+        Thread({ loop(h) }, "SikComm-Reactor").apply {
+            isDaemon = true
+            start()
+        }
+        h
+    }
+
+    /**
+     * 注册 fd。
+     *
+     * @return token，后续 [rearm] / [unregister] 使用
+     */
+    fun register(fd: Long, listener: Listener): Int {
+        val token = nextToken.getAndIncrement()
+        listeners[token] = listener
+        val ret = NativeReactor.add(reactor, fd, token)
+        if (ret < 0) {
+            listeners.remove(token)
+            throw IllegalStateException("Failed to register fd=$fd to reactor, ret=$ret")
+        }
+        return token
+    }
+
+    /**
+     * 重新等待 fd 下一次可读。
+     */
+    fun rearm(fd: Long, token: Int) {
+        // 已注销的 token 不再 rearm（fd 已从 epoll 移除，只有 close 之后 fd 号被复用才可能碰到别的通道）
+        if (!listeners.containsKey(token)) return
+        NativeReactor.rearm(reactor, fd, token)
+    }
+
+    /**
+     * 注销 fd，必须在关闭 fd 之前调用。
+     */
+    fun unregister(fd: Long, token: Int) {
+        NativeReactor.remove(reactor, fd)
+        listeners.remove(token)
+    }
+
+    /**
+     * 立即注销 fd，等 jobs 都结束后再调用 close。
+     *
+     * cancel() 不等协程结束，正在 drain 的协程还会读 fd、调用 [rearm]；fd 在它们结束前一直不关，
+     * fd 号就不会被新通道复用，迟到的读和 rearm 只落在这个已注销的 fd 上。
+     */
+    fun unregisterAndCloseAfter(fd: Long, token: Int, jobs: List<Job>, close: () -> Unit) {
+        if (token != 0) unregister(fd, token)
+        if (jobs.isEmpty()) {
+            close()
+            return
+        }
+        val remaining = AtomicInteger(jobs.size)
+        jobs.forEach { job ->
+            job.invokeOnCompletion {
+                if (remaining.decrementAndGet() == 0) close()
+            }
+        }
+    }
+
+    /**
+     * 登记用户态 CAN 网关，之后转发在 reactor 线程上完成，不经过 [Listener]。
+     */
+    fun attachGateway(gateway: Long) {
+        val ret = NativeReactor.addGateway(reactor, gateway)
+        check(ret >= 0) { "Failed to attach gateway to reactor, ret=$ret" }
+    }
+
+    /**
+     * 注销网关，必须在销毁网关之前调用。
+     */
+    fun detachGateway(gateway: Long) {
+        NativeReactor.removeGateway(reactor, gateway)
+    }
+
+    /**
+     * 登记 CAN 总线监视，之后统计在 reactor 线程上完成，不经过 [Listener]。
+     */
+    fun attachBusMonitor(monitor: Long) {
+        val ret = NativeReactor.addBusMonitor(reactor, monitor)
+        check(ret >= 0) { "Failed to attach bus monitor to reactor, ret=$ret" }
+    }
+
+    /**
+     * 注销总线监视，必须在销毁之前调用。
+     */
+    fun detachBusMonitor(monitor: Long) {
+        NativeReactor.removeBusMonitor(reactor, monitor)
+    }
+
+    private fun loop(h: Long) {
+        val tokens = IntArray(64)
+        val events = IntArray(64)
+        while (true) {
+            val n = NativeReactor.await(h, tokens, events, -1)
+            if (n < 0) {
+                // epoll 本身出错，没有恢复的办法
+                break
+            }
+            for (i in 0 until n) {
+                listeners[tokens[i]]?.onReady(events[i])
+            }
+        }
+    }
+}
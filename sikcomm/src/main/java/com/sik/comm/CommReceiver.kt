@@ -1,5 +1,7 @@
 package com.sik.comm
 
+import java.nio.ByteBuffer
+
 /**
  * 通用接收回调接口。
  *
@@ -21,3 +23,70 @@ fun interface CommReceiver {
      */
     fun onBytesReceived(data: ByteArray, offset: Int, length: Int)
 }
+
+/**
+ * direct ByteBuffer 接收回调。
+ *
+ * 串口通道把数据从内核直接读进一块复用的 direct ByteBuffer，
+ * receiver 实现该接口时会直接拿到这块内存，省去拷贝到 ByteArray 的一步。
+ *
+ * 其它通道（或需要回退时）仍然调用 [onBytesReceived]，默认包装成 ByteBuffer 转给 [onBufferReceived]。
+ */
+interface DirectBufferReceiver : CommReceiver {
+
+    /**
+     * 当底层读取到字节数据时触发。
+     *
+     * @param buffer position 到 limit 之间为本次数据；buffer 会被通道复用，只在回调期间有效
+     */
+    fun onBufferReceived(buffer: ByteBuffer)
+
+    override fun onBytesReceived(data: ByteArray, offset: Int, length: Int) {
+        onBufferReceived(ByteBuffer.wrap(data, offset, length))
+    }
+}
+
+/**
+ * 带接收时间戳的回调。
+ *
+ * 时间戳在 native 层紧贴着内核取得，不包含回调调度带来的抖动：
+ * - 串口：poll 返回（数据可读）时的 CLOCK_MONOTONIC；分帧时为帧最后一个字节所在那次读取的时间
+ * - CAN：内核 SO_TIMESTAMPING / SO_TIMESTAMPNS 接收时间戳，控制器支持时为硬件时间戳
+ *
+ * [SOURCE_MONOTONIC] / [SOURCE_KERNEL] 的时间戳和 System.nanoTime() 同一时钟，可以直接相减；
+ * [SOURCE_HARDWARE] 为控制器自己的时钟，只适合同一接口上的帧间比较。
+ *
+ * 不支持时间戳的通道（或需要回退时）仍然调用 [onBytesReceived]，默认以 [SOURCE_NONE] 转给带时间戳的版本。
+ */
+interface TimestampedReceiver : CommReceiver {
+
+    /**
+     * 当底层读取到字节数据时触发。
+     *
+     * @param data        缓冲区数组（实现可以复用 buffer）
+     * @param offset      数据起始下标
+     * @param length      有效数据长度
+     * @param timestampNs 接收时间戳（纳秒），[SOURCE_NONE] 时为 0
+     * @param source      时间戳来源（SOURCE_*）
+     */
+    fun onBytesReceived(data: ByteArray, offset: Int, length: Int, timestampNs: Long, source: Int)
+
+    override fun onBytesReceived(data: ByteArray, offset: Int, length: Int) {
+        onBytesReceived(data, offset, length, 0L, SOURCE_NONE)
+    }
+
+    companion object {
+
+        /** 没有时间戳 */
+        const val SOURCE_NONE = 0
+
+        /** native 层 poll 返回时的 CLOCK_MONOTONIC（串口） */
+        const val SOURCE_MONOTONIC = 1
+
+        /** 内核软件接收时间戳，已换算到 CLOCK_MONOTONIC（CAN） */
+        const val SOURCE_KERNEL = 2
+
+        /** 控制器硬件时间戳（CAN，设备时钟） */
+        const val SOURCE_HARDWARE = 3
+    }
+}
@@ -0,0 +1,90 @@
+package com.sik.comm
+
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.withContext
+import java.io.File
+
+/**
+ * 抓包回放：把 [CaptureConfig] 抓到的段文件按原始时间间隔（或 speed 倍速）重新发到 vcan / pty，
+ * 用于按生产环境的节奏压测上层解码。
+ *
+ * - 只回放与目标同类的记录（CAN 抓包回放到 CAN 接口，串口抓包回放到串口 / pty）；
+ * - 默认只回放接收方向的记录，includeSent = true 时连发送方向一起回放；
+ * - 节奏由 native 层按 CLOCK_MONOTONIC 绝对时间等待，多段文件按顺序连续回放；
+ * - 协程取消后在 100ms 内停止，目标 fd 随之关闭。
+ */
+object CommReplay {
+
+    /** 单次 JNI 调用的最长时间，两次之间检查取消 */
+    private const val STEP_BUDGET_MS = 100
+
+    /**
+     * 回放到 CAN 接口（通常是 vcan）。
+     *
+     * @param files       段文件，按顺序回放（见 [CaptureConfig.segmentFiles]）
+     * @param ifName      目标接口
+     * @param speed       回放倍速，1.0 为原始节奏，<=0 表示不等待、尽快发送
+     * @param fdMode      目标接口是否按 CAN FD 打开（抓包里有 FD 帧时需要）
+     * @param includeSent 是否连发送方向的记录一起回放
+     * @return            回放的帧数
+     */
+    suspend fun replayToCan(
+        files: List<File>,
+        ifName: String,
+        speed: Double = 1.0,
+        fdMode: Boolean = false,
+        includeSent: Boolean = false
+    ): Long {
+        require(files.isNotEmpty()) { "No capture files to replay" }
+        return withContext(Dispatchers.IO) {
+            val replay = NativeCapture.replayOpenCan(paths(files), ifName, fdMode, speed, includeSent)
+            require(replay > 0L) { "Failed to open replay to CAN $ifName, ret=$replay" }
+            drive(replay)
+        }
+    }
+
+    /**
+     * 回放到串口 / pty（8N1）。
+     *
+     * @param files       段文件，按顺序回放（见 [CaptureConfig.segmentFiles]）
+     * @param devicePath  目标设备，如 "/dev/pts/3"
+     * @param baudRate    目标波特率（pty 上不影响速度）
+     * @param speed       回放倍速，1.0 为原始节奏，<=0 表示不等待、尽快发送
+     * @param includeSent 是否连发送方向的记录一起回放
+     * @return            回放的数据块数
+     */
+    suspend fun replayToSerial(
+        files: List<File>,
+        devicePath: String,
+        baudRate: Int = 115200,
+        speed: Double = 1.0,
+        includeSent: Boolean = false
+    ): Long {
+        require(files.isNotEmpty()) { "No capture files to replay" }
+        return withContext(Dispatchers.IO) {
+            val replay = NativeCapture.replayOpenSerial(paths(files), devicePath, baudRate, speed, includeSent)
+            require(replay > 0L) { "Failed to open replay to $devicePath, ret=$replay" }
+            drive(replay)
+        }
+    }
+
+    private fun paths(files: List<File>): Array<String> = Array(files.size) { files[it].path }
+
+    private suspend fun drive(replay: Long): Long {
+        try {
+            while (true) {
+                currentCoroutineContext().ensureActive()
+                val ret = NativeCapture.replayStep(replay, STEP_BUDGET_MS)
+                if (ret == 1) break
+                check(ret >= 0) {
+                    "Replay failed after ${NativeCapture.replaySent(replay)} records, ret=$ret"
+                }
+            }
+            return NativeCapture.replaySent(replay)
+        } finally {
+            NativeCapture.replayClose(replay)
+        }
+    }
+}
@@ -0,0 +1,87 @@
+package com.sik.comm
+
+import java.nio.ByteBuffer
+
+/**
+ * native 校验算法。
+ *
+ * - 通用实现为 slicing-by-8 查表
+ * - CRC-32 在支持的 CPU 上自动使用 ARMv8 CRC32 指令 / x86 PCLMULQDQ（见 [backend]）
+ * - byte[] 直接在数组上计算，direct ByteBuffer 直接在 native 内存上计算，都不拷贝
+ *
+ * 16 位算法的结果在返回值的低 16 位。
+ */
+object Crc {
+
+    /**
+     * 计算校验值。
+     *
+     * @param crc 初值；分段计算时传入上一段的结果
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun compute(
+        algorithm: CrcAlgorithm,
+        data: ByteArray,
+        offset: Int = 0,
+        length: Int = data.size - offset,
+        crc: Int = algorithm.init
+    ): Int {
+        require(offset >= 0 && length >= 0 && offset + length <= data.size) {
+            "Invalid range: offset=$offset, length=$length, size=${data.size}"
+        }
+        return NativeCrc.update(algorithm.id, crc, data, offset, length)
+    }
+
+    /**
+     * 计算 buffer 中 position 到 limit 之间数据的校验值，不改变 position。
+     *
+     * direct buffer 直接在 native 内存上计算；heap buffer 使用其底层数组。
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun compute(
+        algorithm: CrcAlgorithm,
+        buffer: ByteBuffer,
+        crc: Int = algorithm.init
+    ): Int {
+        val offset = buffer.position()
+        val length = buffer.remaining()
+        return when {
+            buffer.isDirect -> NativeCrc.updateDirect(algorithm.id, crc, buffer, offset, length)
+            buffer.hasArray() -> NativeCrc.update(
+                algorithm.id, crc, buffer.array(), buffer.arrayOffset() + offset, length
+            )
+            else -> {
+                // 只读 heap buffer 拿不到数组，只能拷一份
+                val copy = ByteArray(length)
+                buffer.duplicate().get(copy)
+                NativeCrc.update(algorithm.id, crc, copy, 0, length)
+            }
+        }
+    }
+
+    /** CRC-16/MODBUS */
+    @JvmStatic
+    @JvmOverloads
+    fun crc16Modbus(data: ByteArray, offset: Int = 0, length: Int = data.size - offset): Int =
+        compute(CrcAlgorithm.CRC16_MODBUS, data, offset, length)
+
+    /** CRC-16/CCITT-FALSE */
+    @JvmStatic
+    @JvmOverloads
+    fun crc16Ccitt(data: ByteArray, offset: Int = 0, length: Int = data.size - offset): Int =
+        compute(CrcAlgorithm.CRC16_CCITT, data, offset, length)
+
+    /** CRC-32 */
+    @JvmStatic
+    @JvmOverloads
+    fun crc32(data: ByteArray, offset: Int = 0, length: Int = data.size - offset): Int =
+        compute(CrcAlgorithm.CRC32, data, offset, length)
+
+    /**
+     * 当前 CRC-32 使用的实现："armv8-crc32" / "pclmul" / "slice8"。
+     */
+    @JvmStatic
+    fun backend(): String = NativeCrc.backend()
+}
@@ -0,0 +1,20 @@
+package com.sik.comm
+
+/**
+ * 支持的校验算法。
+ *
+ * @param id    JNI 层算法编号（和 CRC_ALGO_* 保持一致）
+ * @param width 校验值字节数
+ * @param init  默认初值
+ */
+enum class CrcAlgorithm(internal val id: Int, val width: Int, internal val init: Int) {
+
+    /** CRC-16/MODBUS：poly 0x8005 反射，init 0xFFFF */
+    CRC16_MODBUS(1, 2, 0xFFFF),
+
+    /** CRC-16/CCITT-FALSE：poly 0x1021 不反射，init 0xFFFF */
+    CRC16_CCITT(2, 2, 0xFFFF),
+
+    /** CRC-32（IEEE 802.3 / zlib） */
+    CRC32(3, 4, 0)
+}
@@ -0,0 +1,64 @@
+package com.sik.comm
+
+/**
+ * 特权 fd 代理（fd broker）。
+ *
+ * 串口设备节点没有权限时，默认做法是每次 open 都起一个 su 去 chmod，单次就要几百毫秒，su 卡住时还会一直挂着。
+ * 改用常驻 helper：应用只连接一次，之后 open 遇到 EACCES / EPERM 时由 helper 代为打开设备节点，
+ * 通过 SCM_RIGHTS 把 fd 传回来，一次 open 在亚毫秒级完成。
+ *
+ * 使用方式：
+ * 1. 把 native 构建产出的 `sikcomm_fdbroker` 推到设备上，用 root 启动一次：
+ *    `su -c "/data/local/tmp/sikcomm_fdbroker sikcomm_fdbroker <应用 uid>" &`
+ * 2. 应用启动时调用 `FdBroker.connect()`，之后照常 [SikComm.open]
+ *
+ * helper 只接受启动时指定的 uid，只打开串口设备节点（/dev/ttyS*、/dev/ttyUSB* 等，符号链接先解析）；
+ * 没连接 helper（或连接已断开且重连失败）时仍退回 su chmod 的老办法。
+ */
+object FdBroker {
+
+    /** helper 默认监听的 socket 名（和 native BROKER_DEFAULT_NAME 保持一致） */
+    const val DEFAULT_NAME = "sikcomm_fdbroker"
+
+    /**
+     * 连接 helper。
+     *
+     * @param name      helper 监听的 socket 名
+     * @param timeoutMs 每次请求等待应答的超时时间（毫秒），helper 无响应时不会无限期挂住 open
+     * @return          是否连接成功
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun connect(name: String = DEFAULT_NAME, timeoutMs: Int = 1000): Boolean =
+        NativeBroker.connect(name, timeoutMs) == 0
+
+    /**
+     * 断开 helper，之后的权限错误重新走 su。
+     */
+    @JvmStatic
+    fun disconnect() = NativeBroker.disconnect()
+
+    /**
+     * 当前是否连着 helper。
+     */
+    @JvmStatic
+    fun isConnected(): Boolean = NativeBroker.isConnected()
+
+    /**
+     * 在本进程内起一个 stand-in helper（没有特权，只能打开本进程本来就能打开的节点）。
+     *
+     * 用于测试 / 开发机：不需要 root 也能走通 connect → open → SCM_RIGHTS 整条路径。
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun startLocal(name: String = DEFAULT_NAME) {
+        val ret = NativeBroker.startLocal(name)
+        check(ret == 0) { "Failed to start local fd broker $name, ret=$ret" }
+    }
+
+    /**
+     * 停止 [startLocal] 起的 stand-in helper。
+     */
+    @JvmStatic
+    fun stopLocal() = NativeBroker.stopLocal()
+}
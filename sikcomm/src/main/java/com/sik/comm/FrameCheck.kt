@@ -0,0 +1,25 @@
+package com.sik.comm
+
+/**
+ * 帧尾校验：校验值位于帧末尾 [CrcAlgorithm.width] 字节，覆盖其之前的全部字节。
+ *
+ * 配合 [SerialConfig.framing] 使用，分帧后直接在 native 层校验，
+ * 校验失败的帧被丢弃（计入 metrics 的 EBADMSG），receiver 只会收到校验通过的帧。
+ *
+ * @param algorithm 校验算法
+ * @param bigEndian 帧尾校验值是否为大端（Modbus RTU 为小端，低字节在前）
+ * @param strip     交付前是否去掉帧尾校验值
+ */
+data class FrameCheck(
+    val algorithm: CrcAlgorithm,
+    val bigEndian: Boolean = false,
+    val strip: Boolean = false
+) {
+    companion object {
+
+        /** Modbus RTU：CRC-16/MODBUS，低字节在前 */
+        @JvmStatic
+        fun modbus(strip: Boolean = false): FrameCheck =
+            FrameCheck(CrcAlgorithm.CRC16_MODBUS, bigEndian = false, strip = strip)
+    }
+}
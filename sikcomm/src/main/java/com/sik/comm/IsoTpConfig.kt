@@ -0,0 +1,56 @@
+package com.sik.comm
+
+/**
+ * ISO-TP（ISO 15765-2）传输层配置，挂在 [CanConfig.isoTp] 上启用。
+ *
+ * 启用后 CAN 通道的 send() / receiver 以“整条报文”为单位：
+ * 分段、重组、流控（FC）、BS / STmin 都在 native 层完成，UDS 诊断 / 刷写可以直接发几 KB 的报文。
+ *
+ * - preferKernel = true 时优先使用内核 CAN_ISOTP socket（Linux 5.10+），不可用时自动退回 native 用户态引擎
+ * - txDataLength > 8 时以 CAN FD 帧收发，要求 [CanConfig.fdMode] = true
+ * - 可以在 vcan 上测试：两个通道 txId / rxId 互换即可对发
+ *
+ * @param txId           发送报文使用的 CAN ID
+ * @param rxId           接收报文（以及对端 FC）的 CAN ID
+ * @param extendedId     txId / rxId 是否为 29 位扩展帧
+ * @param txDataLength   发送帧数据长度（TX_DL）：经典 CAN 为 8，FD 为 8/12/16/20/24/32/48/64
+ * @param blockSize      接收时 FC 里的 BS（对端每发多少个 CF 等一次 FC），0 表示不分块
+ * @param stMin          接收时 FC 里的 STmin（原始编码：0x00~0x7F 毫秒，0xF1~0xF9 为 100~900 微秒）
+ * @param padding        发送帧填充字节（0x00~0xFF），null 表示经典帧不填充
+ * @param maxMessageSize 可接收的最大报文长度，更长的报文回 FC 溢出
+ * @param timeoutMs      等待 FC / CF 的超时时间（N_Bs / N_Cr，毫秒）
+ * @param preferKernel   是否优先使用内核 CAN_ISOTP
+ */
+data class IsoTpConfig(
+    val txId: Int,
+    val rxId: Int,
+    val extendedId: Boolean = false,
+    val txDataLength: Int = CanFrames.MAX_CLASSIC_PAYLOAD,
+    val blockSize: Int = 0,
+    val stMin: Int = 0,
+    val padding: Int? = DEFAULT_PADDING,
+    val maxMessageSize: Int = MAX_CLASSIC_MESSAGE,
+    val timeoutMs: Int = 1000,
+    val preferKernel: Boolean = true
+) {
+
+    init {
+        require(txDataLength in FD_DATA_LENGTHS) { "Invalid ISO-TP txDataLength: $txDataLength" }
+        require(blockSize in 0..0xFF) { "Invalid ISO-TP blockSize: $blockSize" }
+        require(stMin in 0x00..0x7F || stMin in 0xF1..0xF9) { "Invalid ISO-TP stMin: $stMin" }
+        require(padding == null || padding in 0x00..0xFF) { "Invalid ISO-TP padding: $padding" }
+        require(maxMessageSize > 0) { "Invalid ISO-TP maxMessageSize: $maxMessageSize" }
+        require(timeoutMs > 0) { "Invalid ISO-TP timeoutMs: $timeoutMs" }
+    }
+
+    companion object {
+
+        /** ISO 15765-2 推荐的填充字节（减少位填充） */
+        const val DEFAULT_PADDING = 0xCC
+
+        /** 经典首帧（12 位长度）能表达的最大报文长度，FD 下更长的报文使用 32 位长度转义 */
+        const val MAX_CLASSIC_MESSAGE = 4095
+
+        private val FD_DATA_LENGTHS = setOf(8, 12, 16, 20, 24, 32, 48, 64)
+    }
+}
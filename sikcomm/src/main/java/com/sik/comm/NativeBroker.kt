@@ -0,0 +1,40 @@
+package com.sik.comm
+
+/**
+ * fd broker JNI 封装。
+ *
+ * 连接是进程级的：连上之后 [NativeSerial.open] 遇到权限错误会先请 helper 代为 open。
+ */
+internal object NativeBroker {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    /**
+     * 连接 helper（重复调用会替换旧连接）。
+     *
+     * @param name      socket 名（abstract namespace；以 '/' 开头表示文件系统路径）
+     * @param timeoutMs 每次请求等待应答的超时时间（毫秒）
+     * @return          0: 成功；<0: -errno
+     */
+    @JvmStatic
+    external fun connect(name: String, timeoutMs: Int): Int
+
+    @JvmStatic
+    external fun disconnect()
+
+    @JvmStatic
+    external fun isConnected(): Boolean
+
+    /**
+     * 在本进程内起一个没有特权的 stand-in helper 线程。
+     *
+     * @return 0: 成功；<0: -errno
+     */
+    @JvmStatic
+    external fun startLocal(name: String): Int
+
+    @JvmStatic
+    external fun stopLocal()
+}
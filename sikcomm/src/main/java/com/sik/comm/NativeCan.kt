@@ -1,5 +1,7 @@
 package com.sik.comm
 
+import kotlin.math.roundToInt
+
 /**
  * SocketCAN JNI 封装。
  *
@@ -11,20 +13,41 @@ internal object NativeCan {
         System.loadLibrary("sikcomm")
     }
 
+    // bringUp() 参数数组下标（和 JNI 层 LINK_* 保持一致）
+    private const val LINK_BITRATE = 0
+    private const val LINK_SAMPLE_POINT = 1
+    private const val LINK_DATA_BITRATE = 2
+    private const val LINK_DATA_SAMPLE_POINT = 3
+    private const val LINK_FD = 4
+    private const val LINK_RESTART_MS = 5
+    private const val LINK_TX_QUEUE_LEN = 6
+    private const val LINK_PARAM_COUNT = 7
+
+    /** restart() 返回 -EBUSY（Linux errno）表示控制器不在 bus-off */
+    const val EBUSY = 16
+
+    // bringUp() 可以容忍的错误：没有 CAP_NET_ADMIN，或接口不接受 CAN 链路参数
+    private const val EPERM = 1
+    private const val EACCES = 13
+    private const val EOPNOTSUPP = 95
+
     /**
-     * 可选：启动 CAN 接口。
+     * 启动 CAN 接口：通过 rtnetlink 一次往返配置位时序 / FD / restart-ms / txqueuelen 并 up。
      *
-     * JNI 内部可以用 `ip link set IF up type can bitrate ...` 或 netlink 实现。
-     * 也可以什么都不干，直接返回 0，完全由系统/上层负责。
+     * @param ifName 接口名
+     * @param params 见 LINK_* 下标，0 / -1 表示不修改（采样点为千分比）
+     * @return       0: 成功；<0: -errno（EOPNOTSUPP: 接口不是 CAN 控制器）
+     */
+    @JvmStatic
+    external fun bringUp(ifName: String, params: IntArray): Int
+
+    /**
+     * bus-off 快速恢复：IFLA_CAN_RESTART 直接重启控制器，不 down / up 接口。
      *
-     * @return 0 表示成功，非 0 表示失败（具体值自己定义）
+     * @return 0: 成功；-EBUSY: 不在 bus-off；-EINVAL: 已配置 restart-ms 自动恢复；其它 <0: -errno
      */
     @JvmStatic
-    external fun bringUp(
-        ifName: String,
-        bitrate: Int,
-        fdMode: Boolean
-    ): Int
+    external fun restart(ifName: String): Int
 
     /**
      * 可选：关闭 CAN 接口。
@@ -35,20 +58,40 @@ internal object NativeCan {
     /**
      * 打开 CAN socket 并绑定到指定接口。
      *
+     * @param ifName    接口名
+     * @param fdMode    是否打开 CAN_RAW_FD_FRAMES，允许收发 CAN FD 帧（接口 MTU 需为 72）
+     * @param filters   [CanFilter.pack] 打包的过滤器，null / 空数组表示不过滤
+     * @param errorMask 订阅的错误帧类别（CanFrames.ERR_*），0 表示不收错误帧
      * @return >0: 句柄（fd）；<=0: 错误
      */
     @JvmStatic
-    external fun open(ifName: String): Long
+    external fun open(
+        ifName: String,
+        fdMode: Boolean,
+        filters: IntArray?,
+        errorMask: Int
+    ): Long
+
+    /**
+     * 运行时替换内核过滤器和错误帧掩码。
+     *
+     * @param handle    打开的 CAN socket 句柄
+     * @param filters   [CanFilter.pack] 打包的过滤器，null / 空数组表示不过滤
+     * @param errorMask 订阅的错误帧类别（CanFrames.ERR_*）
+     * @return 0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun setFilters(handle: Long, filters: IntArray?, errorMask: Int): Int
 
     /**
      * 写 CAN 帧。
      *
      * @param handle    打开的 CAN socket 句柄
      * @param frameId   CAN ID
-     * @param flags     标志位: 如 扩展帧/RTR/FD 等（具体 bit 定义由你约定）
+     * @param flags     标志位: [CanFrames.FLAG_EXTENDED] / [CanFrames.FLAG_RTR] / [CanFrames.FLAG_FD] / [CanFrames.FLAG_BRS]
      * @param data      数据内容
      * @param offset    起始位置
-     * @param length    数据长度
+     * @param length    数据长度（经典帧 <= 8，FD 帧 <= 64）
      * @param timeoutMs poll 超时（毫秒）
      * @return          >=0: 已写入的字节数；0: 超时；<0: 错误
      */
@@ -68,7 +111,7 @@ internal object NativeCan {
      *
      * @param handle      打开的 CAN socket 句柄
      * @param outFrameId  输出 CAN ID 的数组，长度至少为 1
-     * @param outFlags    输出 flags 的数组，长度至少为 1
+     * @param outFlags    输出 flags 的数组，长度至少为 1（FD 帧带 FLAG_FD，以及 FLAG_BRS / FLAG_ESI）
      * @param data        存放 payload 的缓冲区
      * @param offset      起始下标
      * @param maxLen      最大读取长度
@@ -86,9 +129,86 @@ internal object NativeCan {
         timeoutMs: Int
     ): Int
 
+    /**
+     * 批量读 CAN 帧。
+     *
+     * 一次 poll 之后用 recvmmsg 收走 socket 里已排队的帧，
+     * 每帧按 [CanFrames] 定长记录依次写入 out。
+     *
+     * @param handle    打开的 CAN socket 句柄
+     * @param out       存放打包记录的缓冲区，长度至少 maxFrames * CanFrames.RECORD_SIZE
+     * @param maxFrames 本次最多读取的帧数
+     * @param timeoutMs poll 超时（毫秒）
+     * @return          >0: 读到的帧数；0: 超时；<0: 错误
+     */
+    @JvmStatic
+    external fun readBatch(
+        handle: Long,
+        out: ByteArray,
+        maxFrames: Int,
+        timeoutMs: Int
+    ): Int
+
+    /**
+     * 批量写 CAN 帧。
+     *
+     * frames 中按 [CanFrames] 记录格式放 count 帧，内部用 sendmmsg 分片发送，
+     * TX 队列满时退避重试直到全部发出或超时。
+     *
+     * @param handle    打开的 CAN socket 句柄
+     * @param frames    打包好的帧记录
+     * @param count     帧数
+     * @param timeoutMs 整批发送的超时（毫秒）
+     * @return          >=0: 被接受的帧数；<0: 错误
+     */
+    @JvmStatic
+    external fun writeBatch(
+        handle: Long,
+        frames: ByteArray,
+        count: Int,
+        timeoutMs: Int
+    ): Int
+
     /**
      * 关闭 CAN socket。
      */
     @JvmStatic
     external fun close(handle: Long)
+
+    /**
+     * 按 [CanConfig] 配置并启动接口，没有任何链路参数时返回 false（什么都不做）。
+     *
+     * 接口已经是要求的配置时 native 层不会 down / up。需要修改但没有权限（EPERM / EACCES）或接口
+     * 不支持（EOPNOTSUPP）时同样返回 false，沿用接口当前配置继续打开，由系统负责配置接口。
+     */
+    fun bringUp(config: CanConfig): Boolean {
+        if (config.bitrate == null && config.dataBitrate == null &&
+            config.restartMs == null && config.txQueueLen == null
+        ) {
+            return false
+        }
+        require(config.dataBitrate == null || config.fdMode) {
+            "CanConfig.dataBitrate requires fdMode (${config.ifName})"
+        }
+
+        val p = IntArray(LINK_PARAM_COUNT)
+        p[LINK_BITRATE] = config.bitrate ?: 0
+        p[LINK_SAMPLE_POINT] = config.samplePoint?.let { (it * 1000).roundToInt() } ?: 0
+        p[LINK_DATA_BITRATE] = config.dataBitrate ?: 0
+        p[LINK_DATA_SAMPLE_POINT] = config.dataSamplePoint?.let { (it * 1000).roundToInt() } ?: 0
+        p[LINK_FD] = when {
+            config.bitrate == null -> -1
+            config.fdMode -> 1
+            else -> 0
+        }
+        p[LINK_RESTART_MS] = config.restartMs ?: -1
+        p[LINK_TX_QUEUE_LEN] = config.txQueueLen ?: -1
+
+        val ret = bringUp(config.ifName, p)
+        if (ret == -EPERM || ret == -EACCES || ret == -EOPNOTSUPP) return false
+        check(ret == 0) {
+            "Failed to configure CAN interface ${config.ifName}, ret=$ret"
+        }
+        return true
+    }
 }
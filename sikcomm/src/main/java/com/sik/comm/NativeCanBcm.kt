@@ -0,0 +1,105 @@
+package com.sik.comm
+
+/**
+ * CAN_BCM（广播管理器）JNI 封装。
+ *
+ * 周期发送和接收变化检测 / 超时监视都由内核定时器完成，用户态只在 setup / 更新 / 事件到达时参与。
+ * setup 类调用是同步的：返回时内核已完成（或拒绝）操作。
+ */
+internal object NativeCanBcm {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    /** txStop() / rxUnwatch() 返回 -EINVAL（Linux errno）表示没有这个任务 */
+    const val EINVAL = 22
+
+    /** rxWatch() options bit：DLC 变化也算变化（和 JNI 层 CAN_BCM_WATCH_* 保持一致） */
+    const val WATCH_CHECK_DLC = 0x01
+
+    /** rxWatch() options bit：超时后收到的第一帧总是上报 */
+    const val WATCH_ANNOUNCE_RESUME = 0x02
+
+    /** 事件记录 [7]：帧内容变化（和 JNI 层 CAN_BCM_EVENT_* 保持一致） */
+    const val EVENT_CHANGED = 1
+
+    /** 事件记录 [7]：接收超时 */
+    const val EVENT_TIMEOUT = 2
+
+    /**
+     * 打开 BCM socket 并 connect 到接口。
+     *
+     * @return >0: 句柄（fd）；<0: -errno
+     */
+    @JvmStatic
+    external fun open(ifName: String): Long
+
+    /**
+     * 注册（或替换）周期发送任务，立即发出第一帧。
+     *
+     * @param flags [CanFrames.FLAG_EXTENDED] / [CanFrames.FLAG_FD] / [CanFrames.FLAG_BRS]
+     * @return 0: 成功；<0: -errno
+     */
+    @JvmStatic
+    external fun txStart(handle: Long, frameId: Int, flags: Int, data: ByteArray, intervalUs: Long): Int
+
+    /**
+     * 替换周期发送任务的内容，不重置定时器。
+     *
+     * @param announce 是否额外立即发出一帧
+     * @return 0: 成功；<0: -errno
+     */
+    @JvmStatic
+    external fun txUpdate(handle: Long, frameId: Int, flags: Int, data: ByteArray, announce: Boolean): Int
+
+    /**
+     * 删除周期发送任务。
+     *
+     * @return 0: 成功；<0: -errno（-EINVAL: 没有这个任务）
+     */
+    @JvmStatic
+    external fun txStop(handle: Long, frameId: Int, flags: Int): Int
+
+    /**
+     * 注册（或替换）接收监视。
+     *
+     * @param mask       变化检测掩码，null 表示每帧都上报
+     * @param timeoutUs  接收超时（微秒），0 表示不监视超时
+     * @param throttleUs 变化上报最小间隔（微秒），0 表示不限速
+     * @param options    WATCH_* 组合
+     * @return 0: 成功；<0: -errno
+     */
+    @JvmStatic
+    external fun rxWatch(
+        handle: Long,
+        frameId: Int,
+        flags: Int,
+        mask: ByteArray?,
+        timeoutUs: Long,
+        throttleUs: Long,
+        options: Int
+    ): Int
+
+    /**
+     * 删除接收监视。
+     *
+     * @return 0: 成功；<0: -errno（-EINVAL: 没有这个监视）
+     */
+    @JvmStatic
+    external fun rxUnwatch(handle: Long, frameId: Int, flags: Int): Int
+
+    /**
+     * 非阻塞地收走排队的事件，按 [CanFrames] 记录格式写进 out，记录 [7] 为 EVENT_*。
+     *
+     * @return >=0: 事件数；<0: -errno
+     */
+    @JvmStatic
+    external fun read(handle: Long, out: ByteArray, maxEvents: Int): Int
+
+    /**
+     * 关闭 BCM socket，内核同时删除其上所有任务。
+     */
+    @JvmStatic
+    external fun close(handle: Long)
+}
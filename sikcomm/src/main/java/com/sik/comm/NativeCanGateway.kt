@@ -0,0 +1,128 @@
+package com.sik.comm
+
+/**
+ * CAN 网关 JNI 封装。
+ */
+internal object NativeCanGateway {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    // create() 每条路由的描述（和 JNI 层 R_* 保持一致）
+    private const val R_HAS_FILTER = 0
+    private const val R_FILTER_ID = 1
+    private const val R_FILTER_MASK = 2
+    private const val R_FILTER_FLAGS = 3
+    private const val R_FD = 4
+    private const val R_MAX_HOPS = 5
+    private const val R_COUNT = 6
+
+    // create() 每个修改操作的描述（和 JNI 层 M_* 保持一致）
+    private const val M_ROUTE = 0
+    private const val M_OP = 1
+    private const val M_TARGETS = 2
+    private const val M_ID = 3
+    private const val M_LENGTH = 4
+    private const val M_FLAGS = 5
+    private const val M_COUNT = 6
+
+    /** 修改目标 bit（和 JNI 层 CAN_GW_MOD_* 保持一致） */
+    private const val MOD_ID = 0x01
+    private const val MOD_LEN = 0x02
+    private const val MOD_DATA = 0x04
+    private const val MOD_FLAGS = 0x08
+
+    /** 实际后端（和 JNI 层 CAN_GW_MODE_* 保持一致） */
+    const val MODE_KERNEL = 1
+    const val MODE_USERSPACE = 2
+
+    /**
+     * @return >0: 网关句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun create(
+        interfaces: Array<String>,
+        routes: IntArray,
+        mods: IntArray,
+        modData: ByteArray,
+        mode: Int
+    ): Long
+
+    /**
+     * @return MODE_KERNEL / MODE_USERSPACE；<0: -errno
+     */
+    @JvmStatic
+    external fun mode(gateway: Long): Int
+
+    /**
+     * 每条路由 [handled, dropped]。
+     *
+     * @return 写入的项数；<0: -errno
+     */
+    @JvmStatic
+    external fun stats(gateway: Long, out: LongArray): Int
+
+    /**
+     * 用户态后端需先 [CommReactor.detachGateway]。
+     */
+    @JvmStatic
+    external fun destroy(gateway: Long)
+
+    /**
+     * 按路由列表创建网关。
+     */
+    fun create(routes: List<CanRoute>, mode: CanGatewayMode): Long {
+        require(routes.isNotEmpty()) { "No gateway routes" }
+
+        val interfaces = ArrayList<String>(routes.size * 2)
+        val desc = IntArray(routes.size * R_COUNT)
+        val mods = ArrayList<Pair<Int, CanFrameMod>>()
+        routes.forEachIndexed { i, r ->
+            interfaces.add(r.source)
+            interfaces.add(r.destination)
+            val base = i * R_COUNT
+            r.filter?.let { f ->
+                val spec = CanFilter.pack(listOf(f))
+                desc[base + R_HAS_FILTER] = 1
+                desc[base + R_FILTER_ID] = spec[0]
+                desc[base + R_FILTER_MASK] = spec[1]
+                desc[base + R_FILTER_FLAGS] = spec[2]
+            }
+            desc[base + R_FD] = if (r.fd) 1 else 0
+            desc[base + R_MAX_HOPS] = r.maxHops
+            r.modifications.forEach { mods.add(i to it) }
+        }
+
+        val modDesc = IntArray(mods.size * M_COUNT)
+        val modData = ByteArray(mods.size * CanFrames.MAX_PAYLOAD)
+        mods.forEachIndexed { i, (route, m) ->
+            val base = i * M_COUNT
+            var targets = 0
+            if (m.id != null) targets = targets or MOD_ID
+            if (m.length != null) targets = targets or MOD_LEN
+            if (m.data != null) targets = targets or MOD_DATA
+            if (m.fdFlags != null) targets = targets or MOD_FLAGS
+            modDesc[base + M_ROUTE] = route
+            modDesc[base + M_OP] = m.op.ordinal
+            modDesc[base + M_TARGETS] = targets
+            modDesc[base + M_ID] = m.id ?: 0
+            modDesc[base + M_LENGTH] = m.length ?: 0
+            modDesc[base + M_FLAGS] = m.fdFlags ?: 0
+            // 没给出的数据字节按操作补成“不改变”的值：AND 补 0xFF，其它补 0
+            val offset = i * CanFrames.MAX_PAYLOAD
+            if (m.op == CanFrameMod.Op.AND) modData.fill(0xFF.toByte(), offset, offset + CanFrames.MAX_PAYLOAD)
+            m.data?.copyInto(modData, offset)
+        }
+        return create(interfaces.toTypedArray(), desc, modDesc, modData, mode.ordinal)
+    }
+
+    /**
+     * 读取各路由计数，失败时返回 null。
+     */
+    fun readStats(gateway: Long, routeCount: Int): List<CanRouteStats>? {
+        val out = LongArray(routeCount * 2)
+        if (stats(gateway, out) < 0) return null
+        return List(routeCount) { CanRouteStats(handled = out[it * 2], dropped = out[it * 2 + 1]) }
+    }
+}
@@ -0,0 +1,106 @@
+package com.sik.comm
+
+/**
+ * CAN 总线监视 JNI 封装。
+ *
+ * 统计在 reactor 线程上完成（[CommReactor.attachBusMonitor]），snapshot() 可以在任意线程调用。
+ */
+internal object NativeCanMonitor {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    // create() 参数数组下标（和 JNI 层 P_* 保持一致）
+    private const val P_BITRATE = 0
+    private const val P_DATA_BITRATE = 1
+    private const val P_WINDOW_MS = 2
+    private const val P_COUNT = 3
+
+    // snapshot 输出布局（和 JNI 层 BusStatsIndex 保持一致）
+    private const val IDX_TIMESTAMP_NS = 0
+    private const val IDX_BITRATE = 1
+    private const val IDX_DATA_BITRATE = 2
+    private const val IDX_FRAMES = 3
+    private const val IDX_BITS = 4
+    private const val IDX_BUSY_NS = 5
+    private const val IDX_WINDOW_LOAD_PPM = 6
+    private const val IDX_PEAK_LOAD_PPM = 7
+    private const val IDX_STATE = 8
+    private const val IDX_TX_ERRORS = 9
+    private const val IDX_RX_ERRORS = 10
+    private const val IDX_ERROR_FRAMES = 11
+    private const val IDX_BUS_ERRORS = 12
+    private const val IDX_ACK_ERRORS = 13
+    private const val IDX_ARBITRATION_LOST = 14
+    private const val IDX_OVERFLOWS = 15
+    private const val IDX_TX_TIMEOUTS = 16
+    private const val IDX_BUS_OFF = 17
+    private const val IDX_RESTARTS = 18
+    private const val IDX_LAST_ERROR_NS = 19
+    private const val STATS_SIZE = 20
+
+    /**
+     * @return >0: 监视句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun create(ifName: String, params: IntArray): Long
+
+    /**
+     * @return 写入的项数；<0: -errno
+     */
+    @JvmStatic
+    external fun snapshot(monitor: Long, out: LongArray): Int
+
+    /**
+     * 需先 [CommReactor.detachBusMonitor]。
+     */
+    @JvmStatic
+    external fun destroy(monitor: Long)
+
+    /**
+     * 按通道配置创建监视，波特率依次取监视配置、通道配置，都没有时由 native 向驱动查询。
+     */
+    fun create(config: CanConfig, monitor: CanBusMonitorConfig): Long {
+        val p = IntArray(P_COUNT)
+        p[P_BITRATE] = monitor.bitrate ?: config.bitrate ?: 0
+        p[P_DATA_BITRATE] = monitor.dataBitrate ?: config.dataBitrate ?: 0
+        p[P_WINDOW_MS] = monitor.windowMs
+        return create(config.ifName, p)
+    }
+
+    /**
+     * 读取快照，失败时返回 null。
+     *
+     * @param readError 通道读循环退出时的 -errno，0 表示正常
+     */
+    fun readStatus(monitor: Long, readError: Int): CanBusStatus? {
+        val out = LongArray(STATS_SIZE)
+        if (snapshot(monitor, out) < 0) return null
+        val state = out[IDX_STATE].toInt()
+        return CanBusStatus(
+            timestampNs = out[IDX_TIMESTAMP_NS],
+            bitrate = out[IDX_BITRATE].toInt(),
+            dataBitrate = out[IDX_DATA_BITRATE].toInt(),
+            frames = out[IDX_FRAMES],
+            bits = out[IDX_BITS],
+            busyNs = out[IDX_BUSY_NS],
+            windowLoad = out[IDX_WINDOW_LOAD_PPM] / 1e6,
+            peakLoad = out[IDX_PEAK_LOAD_PPM] / 1e6,
+            // native 状态为内核 can_state（-1 未知），Kotlin 枚举多一个 UNKNOWN 在最前
+            state = CanBusState.values().getOrElse(state + 1) { CanBusState.UNKNOWN },
+            txErrorCounter = out[IDX_TX_ERRORS].toInt(),
+            rxErrorCounter = out[IDX_RX_ERRORS].toInt(),
+            errorFrames = out[IDX_ERROR_FRAMES],
+            busErrors = out[IDX_BUS_ERRORS],
+            ackErrors = out[IDX_ACK_ERRORS],
+            arbitrationLost = out[IDX_ARBITRATION_LOST],
+            controllerOverflows = out[IDX_OVERFLOWS],
+            txTimeouts = out[IDX_TX_TIMEOUTS],
+            busOffCount = out[IDX_BUS_OFF],
+            restartCount = out[IDX_RESTARTS],
+            lastErrorNs = out[IDX_LAST_ERROR_NS],
+            readError = readError
+        )
+    }
+}
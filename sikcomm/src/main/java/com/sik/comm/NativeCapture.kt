@@ -0,0 +1,79 @@
+package com.sik.comm
+
+/**
+ * 抓包 / 回放 JNI 封装。
+ */
+internal object NativeCapture {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    /**
+     * 开始记录 handle 上的收发，fd 关闭时自动停止。
+     *
+     * @return 0: 成功；<0: -errno
+     */
+    @JvmStatic
+    external fun start(handle: Long, pathPrefix: String, segmentBytes: Long, maxSegments: Int): Int
+
+    /**
+     * 按配置开始记录通道 channelId 的收发。
+     */
+    fun start(handle: Long, config: CaptureConfig, channelId: String): Int =
+        start(handle, config.pathPrefix(channelId), config.segmentBytes, config.maxSegments)
+
+    /**
+     * 停止记录（不关闭 fd）。
+     */
+    @JvmStatic
+    external fun stop(handle: Long)
+
+    /**
+     * 打开 CAN 回放。
+     *
+     * @return >0: 回放句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun replayOpenCan(
+        paths: Array<String>,
+        ifName: String,
+        fdMode: Boolean,
+        speed: Double,
+        includeSent: Boolean
+    ): Long
+
+    /**
+     * 打开串口 / pty 回放。
+     *
+     * @return >0: 回放句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun replayOpenSerial(
+        paths: Array<String>,
+        devicePath: String,
+        baudRate: Int,
+        speed: Double,
+        includeSent: Boolean
+    ): Long
+
+    /**
+     * 回放至多 budgetMs 毫秒。
+     *
+     * @return 0: 还有记录；1: 已全部回放；<0: -errno
+     */
+    @JvmStatic
+    external fun replayStep(replay: Long, budgetMs: Int): Int
+
+    /**
+     * 已回放的记录数。
+     */
+    @JvmStatic
+    external fun replaySent(replay: Long): Long
+
+    /**
+     * 释放回放器并关闭目标 fd。
+     */
+    @JvmStatic
+    external fun replayClose(replay: Long)
+}
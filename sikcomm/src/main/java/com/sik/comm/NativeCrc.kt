@@ -0,0 +1,34 @@
+package com.sik.comm
+
+import java.nio.ByteBuffer
+
+/**
+ * 校验算法 JNI 封装，对外使用 [Crc]。
+ */
+internal object NativeCrc {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    /**
+     * 在 byte[] 上分段计算校验值。
+     *
+     * @param algorithm CrcAlgorithm.id
+     * @param crc       初值或上一段的结果
+     */
+    @JvmStatic
+    external fun update(algorithm: Int, crc: Int, data: ByteArray, offset: Int, length: Int): Int
+
+    /**
+     * 在 direct ByteBuffer 上分段计算校验值（绝对位置，不受 position 影响）。
+     */
+    @JvmStatic
+    external fun updateDirect(algorithm: Int, crc: Int, buffer: ByteBuffer, offset: Int, length: Int): Int
+
+    /**
+     * 当前 CRC-32 使用的实现名称。
+     */
+    @JvmStatic
+    external fun backend(): String
+}
@@ -0,0 +1,139 @@
+package com.sik.comm
+
+import java.nio.ByteBuffer
+
+/**
+ * 串口分帧器 JNI 封装。
+ *
+ * 分帧器持有 native 内存，必须且只能在创建它的 IO 协程里使用并 [destroy]。
+ */
+internal object NativeFramer {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    // 分帧模式（和 JNI 层 FRAMER_MODE_* 保持一致）
+    const val MODE_DELIMITER = 1
+    const val MODE_LENGTH_FIELD = 2
+    const val MODE_FIXED = 3
+    const val MODE_SILENCE = 4
+
+    // create() 参数数组下标（和 JNI 层 P_* 保持一致）
+    private const val P_MAX_FRAME_SIZE = 0
+    private const val P_DELIMITER = 1
+    private const val P_ESCAPE = 2
+    private const val P_ESCAPED_DELIMITER = 3
+    private const val P_ESCAPED_ESCAPE = 4
+    private const val P_LENGTH_OFFSET = 5
+    private const val P_LENGTH_SIZE = 6
+    private const val P_LENGTH_BIG_ENDIAN = 7
+    private const val P_LENGTH_ADJUST = 8
+    private const val P_FIXED_SIZE = 9
+    private const val P_SILENCE_GAP_US = 10
+    private const val P_CHECK_ALGORITHM = 11
+    private const val P_CHECK_BIG_ENDIAN = 12
+    private const val P_CHECK_STRIP = 13
+    private const val P_COUNT = 14
+
+    /** readFrames 输出中每帧前的记录头：int32 长度 + int64 接收时间戳（小端） */
+    const val RECORD_HEADER = 12
+
+    /**
+     * 创建分帧器。
+     *
+     * @param mode   MODE_*
+     * @param params 见 P_* 下标
+     * @return       >0: 句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun create(mode: Int, params: IntArray): Long
+
+    /**
+     * 释放分帧器。
+     */
+    @JvmStatic
+    external fun destroy(framer: Long)
+
+    /**
+     * 从串口读数据并分帧，完整帧按 [int32 长度][int64 时间戳][数据]（小端）连续写进 [out]。
+     *
+     * 时间戳为帧最后一个字节所在那次读取前 poll 返回时的 CLOCK_MONOTONIC（纳秒）。
+     *
+     * @param framer    create() 返回的句柄
+     * @param handle    串口句柄（fd）
+     * @param out       direct ByteBuffer
+     * @param capacity  out 可用长度
+     * @param timeoutMs 没有待交付帧时第一次 poll 的超时时间（毫秒）
+     * @return          >=0: 写入的帧数；<0: 错误
+     */
+    @JvmStatic
+    external fun readFrames(
+        framer: Long,
+        handle: Long,
+        out: ByteBuffer,
+        capacity: Int,
+        timeoutMs: Int
+    ): Int
+
+    /**
+     * 按 [SerialConfig] 创建分帧器，未配置分帧时返回 0。
+     */
+    fun create(config: SerialConfig): Long {
+        val framing = config.framing
+        if (framing == null) {
+            require(config.frameCheck == null) {
+                "SerialConfig.frameCheck requires SerialConfig.framing (${config.devicePath})"
+            }
+            return 0L
+        }
+        val p = IntArray(P_COUNT)
+        p[P_MAX_FRAME_SIZE] = framing.maxFrameSize
+        config.frameCheck?.let { check ->
+            p[P_CHECK_ALGORITHM] = check.algorithm.id
+            p[P_CHECK_BIG_ENDIAN] = if (check.bigEndian) 1 else 0
+            p[P_CHECK_STRIP] = if (check.strip) 1 else 0
+        }
+        val mode = when (framing) {
+            is SerialFraming.Delimiter -> {
+                p[P_DELIMITER] = framing.delimiter.toInt() and 0xFF
+                p[P_ESCAPE] = framing.escape?.let { it.toInt() and 0xFF } ?: -1
+                p[P_ESCAPED_DELIMITER] = framing.escapedDelimiter.toInt() and 0xFF
+                p[P_ESCAPED_ESCAPE] = framing.escapedEscape.toInt() and 0xFF
+                MODE_DELIMITER
+            }
+
+            is SerialFraming.LengthField -> {
+                p[P_LENGTH_OFFSET] = framing.lengthOffset
+                p[P_LENGTH_SIZE] = framing.lengthSize
+                p[P_LENGTH_BIG_ENDIAN] = if (framing.bigEndian) 1 else 0
+                p[P_LENGTH_ADJUST] = framing.lengthAdjust
+                MODE_LENGTH_FIELD
+            }
+
+            is SerialFraming.FixedSize -> {
+                p[P_FIXED_SIZE] = framing.frameSize
+                MODE_FIXED
+            }
+
+            is SerialFraming.Silence -> {
+                p[P_SILENCE_GAP_US] = if (framing.gapMicros > 0) {
+                    framing.gapMicros
+                } else {
+                    SerialFraming.modbusSilenceMicros(
+                        config.baudRate,
+                        config.dataBits,
+                        config.stopBits,
+                        config.parity
+                    )
+                }
+                MODE_SILENCE
+            }
+        }
+        val framer = create(mode, p)
+        require(framer > 0L) {
+            "Invalid serial framing for ${config.devicePath}: $framing, ret=$framer"
+        }
+        return framer
+    }
+}
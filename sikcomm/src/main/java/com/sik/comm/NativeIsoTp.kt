@@ -0,0 +1,171 @@
+package com.sik.comm
+
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * ISO-TP JNI 封装。
+ *
+ * 句柄背后是内核 CAN_ISOTP socket，或 CAN_RAW socket + native 用户态引擎。
+ * send() 阻塞到整条报文发完，应该只在 IO 线程（例如 Dispatchers.IO）中调用。
+ */
+internal object NativeIsoTp {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    // open() flags（和 JNI 层 ISOTP_FLAG_* 保持一致）
+    private const val FLAG_EXTENDED = 0x01
+    private const val FLAG_FD = 0x02
+    private const val FLAG_BRS = 0x04
+    private const val FLAG_KERNEL = 0x08
+
+    // open() 参数数组下标（和 JNI 层 P_* 保持一致）
+    private const val P_TX_DL = 0
+    private const val P_PADDING = 1
+    private const val P_BLOCK_SIZE = 2
+    private const val P_ST_MIN = 3
+    private const val P_MAX_MESSAGE_SIZE = 4
+    private const val P_TIMEOUT_MS = 5
+    private const val P_COUNT = 6
+
+    /** receive() 报文过长被丢弃时返回 -EMSGSIZE（Linux errno） */
+    const val EMSGSIZE = 90
+
+    /**
+     * 打开 ISO-TP 连接。
+     *
+     * @param ifName 接口名
+     * @param txId   发送 CAN ID
+     * @param rxId   接收 CAN ID
+     * @param flags  FLAG_*
+     * @param params 见 P_* 下标
+     * @return       >0: 句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun open(ifName: String, txId: Int, rxId: Int, flags: Int, params: IntArray): Long
+
+    /**
+     * 底层 socket 的 fd，用于注册 [CommReactor] 和读取统计。
+     */
+    @JvmStatic
+    external fun fd(handle: Long): Long
+
+    /**
+     * 是否使用的是内核 CAN_ISOTP。
+     */
+    @JvmStatic
+    external fun isKernel(handle: Long): Boolean
+
+    /**
+     * 发送一条完整报文，阻塞到最后一帧发出。
+     *
+     * @param handle    open() 返回的句柄
+     * @param data      报文
+     * @param offset    起始下标
+     * @param length    报文长度
+     * @param timeoutMs 发送超时（毫秒）
+     * @return          >=0: 发送的字节数；0: 超时；<0: 错误（ETIMEDOUT: 等 FC 超时；EMSGSIZE: 对端溢出）
+     */
+    @JvmStatic
+    external fun send(handle: Long, data: ByteArray, offset: Int, length: Int, timeoutMs: Int): Int
+
+    /**
+     * 取一条完整报文，写进 out（从下标 0 开始）。
+     *
+     * @param handle    open() 返回的句柄
+     * @param out       接收缓冲区，至少 maxMessageSize 字节
+     * @param timeoutMs 没有报文时的等待时间（毫秒）
+     * @return          >0: 报文长度；0: 没有报文；<0: 错误（EMSGSIZE: 报文过长已丢弃）
+     */
+    @JvmStatic
+    external fun receive(handle: Long, out: ByteArray, timeoutMs: Int): Int
+
+    /**
+     * 用户态引擎在 send() 等 FC 期间顺带收完、还没取走的报文数（内核模式总是 0）。
+     */
+    @JvmStatic
+    external fun pending(handle: Long): Int
+
+    /**
+     * 关闭连接，释放 native 资源。
+     */
+    @JvmStatic
+    external fun close(handle: Long)
+
+    /**
+     * 按 [CanConfig.isoTp] 打开 ISO-TP 连接。
+     */
+    fun open(config: CanConfig): Long {
+        val isoTp = requireNotNull(config.isoTp)
+        val fd = isoTp.txDataLength > CanFrames.MAX_CLASSIC_PAYLOAD
+        require(!fd || config.fdMode) {
+            "ISO-TP txDataLength ${isoTp.txDataLength} requires CanConfig.fdMode (${config.ifName})"
+        }
+
+        var flags = 0
+        if (isoTp.extendedId) flags = flags or FLAG_EXTENDED
+        if (fd) {
+            flags = flags or FLAG_FD
+            if (config.bitrateSwitch) flags = flags or FLAG_BRS
+        }
+        if (isoTp.preferKernel) flags = flags or FLAG_KERNEL
+
+        val p = IntArray(P_COUNT)
+        p[P_TX_DL] = isoTp.txDataLength
+        p[P_PADDING] = isoTp.padding ?: -1
+        p[P_BLOCK_SIZE] = isoTp.blockSize
+        p[P_ST_MIN] = isoTp.stMin
+        p[P_MAX_MESSAGE_SIZE] = isoTp.maxMessageSize
+        p[P_TIMEOUT_MS] = isoTp.timeoutMs
+
+        val handle = open(config.ifName, isoTp.txId, isoTp.rxId, flags, p)
+        require(handle > 0L) {
+            "Failed to open ISO-TP on ${config.ifName}: $isoTp, ret=$handle"
+        }
+        return handle
+    }
+}
+
+/**
+ * ISO-TP 句柄的引用计数。
+ *
+ * 通道本身、读循环和每个进行中的 send 各持有一个引用，最后一个引用释放时才 [NativeIsoTp.close]：
+ * 通道 close 时可能还有 send 阻塞在等 FC、读循环还在 receive 里，句柄要等它们都返回后再释放。
+ */
+internal class IsoTpRef(val handle: Long) {
+
+    private val refs = AtomicInteger(1)
+
+    @Volatile
+    private var closed = false
+
+    /**
+     * 增加一个引用，已经 [close] 时返回 false。
+     */
+    fun acquire(): Boolean {
+        while (true) {
+            val n = refs.get()
+            if (n <= 0) return false
+            if (refs.compareAndSet(n, n + 1)) break
+        }
+        if (closed) {
+            release()
+            return false
+        }
+        return true
+    }
+
+    fun release() {
+        if (refs.decrementAndGet() == 0) NativeIsoTp.close(handle)
+    }
+
+    /**
+     * 释放通道持有的引用，之后 [acquire] 都会失败。
+     */
+    fun close() {
+        if (closed) return
+        closed = true
+        release()
+    }
+}
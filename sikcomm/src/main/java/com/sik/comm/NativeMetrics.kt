@@ -0,0 +1,98 @@
+package com.sik.comm
+
+/**
+ * 通道统计 JNI 封装。
+ *
+ * 计数器和直方图都在 native 层按 fd 维护，热路径只做原子加；
+ * 这里只在需要时拉一次快照。
+ */
+internal object NativeMetrics {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    // snapshot 输出布局（和 JNI 层 SnapshotIndex 保持一致）
+    const val IDX_BYTES_IN = 0
+    const val IDX_BYTES_OUT = 1
+    const val IDX_FRAMES_IN = 2
+    const val IDX_FRAMES_OUT = 3
+    const val IDX_POLL_TIMEOUTS = 4
+    const val IDX_ERRORS = 5
+
+    /** poll 等待直方图摘要起始下标（count / mean / p50 / p90 / p99 / max） */
+    const val IDX_POLL_WAIT = 6
+
+    /** syscall 耗时直方图摘要起始下标（同上） */
+    const val IDX_SYSCALL = 12
+
+    /** snapshot 输出数组长度 */
+    const val SNAPSHOT_SIZE = 18
+
+    /** errorCounts 输出数组长度（下标为 errno，最后一格汇总超出范围的 errno） */
+    const val ERRNO_SLOTS = 135
+
+    /**
+     * 拉取通道统计快照。
+     *
+     * @param handle 通道句柄（fd）
+     * @param out    长度至少 [SNAPSHOT_SIZE]
+     * @return       >0: 写入项数；<0: 错误（该通道没有统计）
+     */
+    @JvmStatic
+    external fun snapshot(handle: Long, out: LongArray): Int
+
+    /**
+     * 拉取按 errno 统计的错误次数。
+     *
+     * @param handle 通道句柄（fd）
+     * @param out    长度至少 [ERRNO_SLOTS]
+     * @return       >0: 写入项数；<0: 错误
+     */
+    @JvmStatic
+    external fun errorCounts(handle: Long, out: LongArray): Int
+
+    /**
+     * 读取快照并组装成 [ChannelMetrics]。
+     *
+     * @param writeQueueDepth Kotlin 侧维护的写队列深度
+     */
+    fun read(handle: Long, writeQueueDepth: Int): ChannelMetrics {
+        if (handle == 0L) return ChannelMetrics.EMPTY.copy(writeQueueDepth = writeQueueDepth)
+
+        val snap = LongArray(SNAPSHOT_SIZE)
+        if (snapshot(handle, snap) < 0) {
+            return ChannelMetrics.EMPTY.copy(writeQueueDepth = writeQueueDepth)
+        }
+
+        val errnoCounts = LongArray(ERRNO_SLOTS)
+        val byErrno = HashMap<Int, Long>()
+        if (errorCounts(handle, errnoCounts) > 0) {
+            errnoCounts.forEachIndexed { errno, count ->
+                if (count > 0) byErrno[errno] = count
+            }
+        }
+
+        return ChannelMetrics(
+            bytesIn = snap[IDX_BYTES_IN],
+            bytesOut = snap[IDX_BYTES_OUT],
+            framesIn = snap[IDX_FRAMES_IN],
+            framesOut = snap[IDX_FRAMES_OUT],
+            pollTimeouts = snap[IDX_POLL_TIMEOUTS],
+            errors = snap[IDX_ERRORS],
+            errorsByErrno = byErrno,
+            writeQueueDepth = writeQueueDepth,
+            pollWait = latency(snap, IDX_POLL_WAIT),
+            syscall = latency(snap, IDX_SYSCALL)
+        )
+    }
+
+    private fun latency(snap: LongArray, base: Int) = LatencyStats(
+        count = snap[base],
+        meanNs = snap[base + 1],
+        p50Ns = snap[base + 2],
+        p90Ns = snap[base + 3],
+        p99Ns = snap[base + 4],
+        maxNs = snap[base + 5]
+    )
+}
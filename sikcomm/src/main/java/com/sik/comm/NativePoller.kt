@@ -0,0 +1,120 @@
+package com.sik.comm
+
+/**
+ * 串口轮询引擎 JNI 封装。
+ *
+ * run() 会阻塞等待线路（至多 budgetMs），只能在通道 IO 协程里调用；stats() 可以在任意线程调用。
+ */
+internal object NativePoller {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    // create() 参数数组下标（和 JNI 层 P_* 保持一致）
+    private const val P_PROTOCOL = 0
+    private const val P_GAP_US = 1
+    private const val P_CHAR_NS = 2
+    private const val P_RETRIES = 3
+    private const val P_COUNT = 4
+
+    // create() 每条请求的描述（和 JNI 层 R_* 保持一致）
+    private const val R_TAG = 0
+    private const val R_PERIOD_MS = 1
+    private const val R_TIMEOUT_MS = 2
+    private const val R_RESPONSE_LENGTH = 3
+    private const val R_FRAME_LENGTH = 4
+    private const val R_COUNT = 5
+
+    // stats 输出布局（和 JNI 层 PollStatsIndex 保持一致）
+    private const val IDX_TRANSACTIONS = 0
+    private const val IDX_TIMEOUTS = 1
+    private const val IDX_BAD_CRCS = 2
+    private const val IDX_MISMATCHES = 3
+    private const val IDX_EXCEPTIONS = 4
+    private const val IDX_RETRIES = 5
+    private const val IDX_STRAY_BYTES = 6
+    private const val IDX_OVERRUNS = 7
+    private const val IDX_MAX_LATENESS_NS = 8
+    private const val STATS_SIZE = 9
+
+    /**
+     * @return >0: 轮询器句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun create(params: IntArray, requests: IntArray, frames: ByteArray): Long
+
+    @JvmStatic
+    external fun destroy(poller: Long)
+
+    /**
+     * 执行到期的事务，结果按 [PollResults] 记录格式写进 out。
+     *
+     * @return >=0: 结果数；<0: -errno（fd 出错，应停止轮询）
+     */
+    @JvmStatic
+    external fun run(poller: Long, fd: Long, out: ByteArray, maxRecords: Int, budgetMs: Int): Int
+
+    /**
+     * @return 写入的项数；<0: -errno
+     */
+    @JvmStatic
+    external fun stats(poller: Long, out: LongArray): Int
+
+    /**
+     * 按串口配置创建轮询器。
+     *
+     * @param baudRate 驱动实际生效的波特率，用于计算字符时间和默认帧间静默
+     */
+    fun create(serial: SerialConfig, baudRate: Int, requests: List<PollRequest>, config: PollingConfig): Long {
+        require(requests.isNotEmpty()) { "No poll requests" }
+        val baud = if (baudRate > 0) baudRate else serial.baudRate
+
+        // 1 起始位 + 数据位 + 校验位 + 停止位
+        val bitsPerChar = 1 + serial.dataBits + (if (serial.parity != 0) 1 else 0) + serial.stopBits
+        val gapUs = config.interFrameMicros ?: maxOf(
+            SerialFraming.modbusSilenceMicros(baud, serial.dataBits, serial.stopBits, serial.parity),
+            serial.turnaroundMicros
+        )
+
+        val p = IntArray(P_COUNT)
+        p[P_PROTOCOL] = config.protocol.ordinal
+        p[P_GAP_US] = gapUs
+        p[P_CHAR_NS] = (bitsPerChar * 1_000_000_000L / baud).toInt()
+        p[P_RETRIES] = config.retries
+
+        val desc = IntArray(requests.size * R_COUNT)
+        val frames = ByteArray(requests.sumOf { it.frame.size })
+        var pos = 0
+        requests.forEachIndexed { i, r ->
+            val base = i * R_COUNT
+            desc[base + R_TAG] = r.tag
+            desc[base + R_PERIOD_MS] = r.periodMs
+            desc[base + R_TIMEOUT_MS] = r.timeoutMs
+            desc[base + R_RESPONSE_LENGTH] = r.responseLength
+            desc[base + R_FRAME_LENGTH] = r.frame.size
+            System.arraycopy(r.frame, 0, frames, pos, r.frame.size)
+            pos += r.frame.size
+        }
+        return create(p, desc, frames)
+    }
+
+    /**
+     * 读取统计快照，失败时返回 null。
+     */
+    fun readStats(poller: Long): PollingStats? {
+        val out = LongArray(STATS_SIZE)
+        if (stats(poller, out) < 0) return null
+        return PollingStats(
+            transactions = out[IDX_TRANSACTIONS],
+            timeouts = out[IDX_TIMEOUTS],
+            badCrc = out[IDX_BAD_CRCS],
+            mismatches = out[IDX_MISMATCHES],
+            exceptions = out[IDX_EXCEPTIONS],
+            retries = out[IDX_RETRIES],
+            strayBytes = out[IDX_STRAY_BYTES],
+            overruns = out[IDX_OVERRUNS],
+            maxLatenessNs = out[IDX_MAX_LATENESS_NS]
+        )
+    }
+}
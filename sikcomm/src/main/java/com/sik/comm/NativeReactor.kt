@@ -0,0 +1,106 @@
+package com.sik.comm
+
+/**
+ * epoll reactor JNI 封装。
+ *
+ * 所有通道的 fd 注册到同一个 epoll 实例上，
+ * 由 [CommReactor] 的单个线程阻塞在 [await] 上统一等待就绪事件。
+ */
+internal object NativeReactor {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    /** 就绪事件：可读（和 JNI 层 REACTOR_EVENT_* 保持一致） */
+    const val EVENT_READABLE = 0x01
+
+    /** 就绪事件：出错 / 挂断 */
+    const val EVENT_ERROR = 0x02
+
+    /**
+     * 创建 reactor。
+     *
+     * @return >0: reactor 句柄；<0: 错误
+     */
+    @JvmStatic
+    external fun create(): Long
+
+    /**
+     * 注册 fd（一次性触发，处理完之后需要 [rearm]）。
+     *
+     * @param reactor reactor 句柄
+     * @param fd      通道 fd
+     * @param token   就绪时回传的标识
+     * @return        0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun add(reactor: Long, fd: Long, token: Int): Int
+
+    /**
+     * 重新等待 fd 下一次可读。
+     *
+     * @return 0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun rearm(reactor: Long, fd: Long, token: Int): Int
+
+    /**
+     * 注销 fd，必须在关闭 fd 之前调用。
+     *
+     * @return 0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun remove(reactor: Long, fd: Long): Int
+
+    /**
+     * 把用户态 CAN 网关登记到 reactor：源 socket 就绪时在 [await] 内部直接转发，不返回 Kotlin。
+     *
+     * @param gateway [NativeCanGateway] 句柄
+     * @return        0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun addGateway(reactor: Long, gateway: Long): Int
+
+    /**
+     * 注销网关，返回后 reactor 线程不会再访问它，可以销毁。
+     *
+     * @return 0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun removeGateway(reactor: Long, gateway: Long): Int
+
+    /**
+     * 把 CAN 总线监视 socket 登记到 reactor：就绪时在 [await] 内部直接统计，不返回 Kotlin。
+     *
+     * @param monitor [NativeCanMonitor] 句柄
+     * @return        0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun addBusMonitor(reactor: Long, monitor: Long): Int
+
+    /**
+     * 注销总线监视，返回后 reactor 线程不会再访问它，可以销毁。
+     *
+     * @return 0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun removeBusMonitor(reactor: Long, monitor: Long): Int
+
+    /**
+     * 等待就绪事件（网关转发 / 总线监视在内部处理，不计入返回的事件）。
+     *
+     * @param reactor   reactor 句柄
+     * @param outTokens 输出就绪 fd 的 token
+     * @param outEvents 输出对应的 EVENT_* 位
+     * @param timeoutMs 超时（毫秒），-1 表示一直等
+     * @return          >0: 事件数；0: 超时；<0: 错误
+     */
+    @JvmStatic
+    external fun await(
+        reactor: Long,
+        outTokens: IntArray,
+        outEvents: IntArray,
+        timeoutMs: Int
+    ): Int
+}
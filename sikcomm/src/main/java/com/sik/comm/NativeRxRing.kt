@@ -0,0 +1,121 @@
+package com.sik.comm
+
+import java.nio.ByteBuffer
+
+/**
+ * 接收环形缓冲区 JNI 封装。
+ *
+ * fill* 只能在通道 IO 协程（生产者）里调用，peek / release 只能在接收线程（消费者）里调用。
+ */
+internal object NativeRxRing {
+
+    init {
+        System.loadLibrary("sikcomm")
+    }
+
+    /** fill* 返回 -ENOBUFS（Linux errno）表示 BLOCK 策略下环已满，暂停读取 */
+    const val ENOBUFS = 105
+
+    // stats 输出布局（和 JNI 层 RingStatsIndex 保持一致）
+    private const val IDX_CAPACITY = 0
+    private const val IDX_USED = 1
+    private const val IDX_HIGH_WATER = 2
+    private const val IDX_RECORDS = 3
+    private const val IDX_DROPPED_RECORDS = 4
+    private const val IDX_DROPPED_BYTES = 5
+    private const val IDX_BLOCKED = 6
+    private const val STATS_SIZE = 7
+
+    /** peek 单次最多认领的记录数（和 JNI 层 PEEK_MAX 保持一致） */
+    const val PEEK_MAX = 64
+
+    /** 每条记录前的记录头长度，分帧模式下环的容量至少要能放下两条最大帧记录 */
+    const val RECORD_HEADER = 16
+
+    /**
+     * 创建环。
+     *
+     * @param capacity 数据区大小（2 的幂）
+     * @param policy   [RxOverflow] 的 ordinal
+     * @return         >0: 句柄；<0: -errno
+     */
+    @JvmStatic
+    external fun create(capacity: Int, policy: Int): Long
+
+    /**
+     * 释放环，之后 [buffer] 返回的 ByteBuffer 不能再访问。
+     */
+    @JvmStatic
+    external fun destroy(ring: Long)
+
+    /**
+     * 包住整个数据区的 direct ByteBuffer，[peek] 返回的偏移都相对于它。
+     */
+    @JvmStatic
+    external fun buffer(ring: Long): ByteBuffer
+
+    /**
+     * 非阻塞地读一次串口，数据直接落进环里。
+     *
+     * @return >0: 字节数；0: 没有数据；-[ENOBUFS]: 环已满（BLOCK）；<0: 错误
+     */
+    @JvmStatic
+    external fun fillSerial(ring: Long, handle: Long): Int
+
+    /**
+     * 通过分帧器读一次串口，本次得到的整帧（[NativeFramer] 的记录格式）作为一条记录落进环里。
+     *
+     * @return >0: 帧数；0: 没有完整帧；-[ENOBUFS]: 环已满（BLOCK）；<0: 错误
+     */
+    @JvmStatic
+    external fun fillFrames(ring: Long, framer: Long, handle: Long): Int
+
+    /**
+     * 一次 recvmmsg 收走已排队的 CAN 帧，[CanFrames] 定长记录直接落进环里。
+     *
+     * @return >0: 帧数；0: 没有数据；-[ENOBUFS]: 环已满（BLOCK）；<0: 错误
+     */
+    @JvmStatic
+    external fun fillCan(ring: Long, handle: Long, maxFrames: Int): Int
+
+    /**
+     * 认领已写入的记录，在 [release] 之前它们不会被覆盖。
+     *
+     * @return 认领的记录数（至多 offsets.size 和 [PEEK_MAX]）；<0: 错误
+     */
+    @JvmStatic
+    external fun peek(ring: Long, offsets: IntArray, lengths: IntArray, stamps: LongArray): Int
+
+    /**
+     * 归还已认领的记录，每次 [peek] 之后都要调用（包括返回 0 时）。
+     *
+     * @return true: 生产者因环满暂停了读取，需要唤醒它
+     */
+    @JvmStatic
+    external fun release(ring: Long): Boolean
+
+    /**
+     * 拉取统计。
+     *
+     * @return >0: 写入项数；<0: 错误
+     */
+    @JvmStatic
+    external fun stats(ring: Long, out: LongArray): Int
+
+    /**
+     * 读取统计并组装成 [RxRingStats]。
+     */
+    fun readStats(ring: Long): RxRingStats? {
+        val out = LongArray(STATS_SIZE)
+        if (stats(ring, out) < 0) return null
+        return RxRingStats(
+            capacity = out[IDX_CAPACITY],
+            used = out[IDX_USED],
+            highWater = out[IDX_HIGH_WATER],
+            records = out[IDX_RECORDS],
+            droppedRecords = out[IDX_DROPPED_RECORDS],
+            droppedBytes = out[IDX_DROPPED_BYTES],
+            blocked = out[IDX_BLOCKED]
+        )
+    }
+}
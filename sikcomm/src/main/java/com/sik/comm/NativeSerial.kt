@@ -1,5 +1,7 @@
 package com.sik.comm
 
+import java.nio.ByteBuffer
+
 /**
  * 串口 JNI 封装。
  *
@@ -14,6 +16,19 @@ internal object NativeSerial {
         System.loadLibrary("sikcomm")
     }
 
+    // flush() 的 queue 参数（和 JNI 层 FLUSH_* 保持一致）
+    const val FLUSH_INPUT = 0
+    const val FLUSH_OUTPUT = 1
+    const val FLUSH_BOTH = 2
+
+    // open() latency 参数数组下标（和 JNI 层 LATENCY_* 保持一致）
+    private const val LATENCY_LOW_LATENCY = 0
+    private const val LATENCY_USB_TIMER_MS = 1
+    private const val LATENCY_VMIN = 2
+    private const val LATENCY_VTIME = 3
+    private const val LATENCY_FLUSH_ON_OPEN = 4
+    private const val LATENCY_COUNT = 5
+
     /**
      * 打开串口并配置参数。
      *
@@ -22,6 +37,7 @@ internal object NativeSerial {
      * @param dataBits  数据位
      * @param stopBits  停止位
      * @param parity    校验位
+     * @param latency   延迟档位参数（见 LATENCY_* 下标），null 保持驱动默认
      * @return          一个长整型句柄（例如 fd 或者指针），0 或负数代表失败（具体约定由你在 JNI 定）
      */
     @JvmStatic
@@ -30,18 +46,19 @@ internal object NativeSerial {
         baudRate: Int,
         dataBits: Int,
         stopBits: Int,
-        parity: Int
+        parity: Int,
+        latency: IntArray?
     ): Long
 
     /**
-     * 使用 poll + write 写入数据。
+     * 使用 poll + write 写入数据：循环写直到全部写完或 timeoutMs 到期。
      *
      * @param handle    open() 返回的句柄
      * @param data      要写入的字节数组
      * @param offset    起始下标
      * @param length    写入长度
-     * @param timeoutMs poll 的超时时间（毫秒）
-     * @return          >=0: 实际写入字节数；0: 超时；<0: 错误（具体由 JNI 约定）
+     * @param timeoutMs 整次写入的超时时间（毫秒）
+     * @return          >=0: 实际写入字节数（超时时可能小于 length）；0: 超时；<0: 错误（具体由 JNI 约定）
      */
     @JvmStatic
     external fun write(
@@ -71,6 +88,106 @@ internal object NativeSerial {
         timeoutMs: Int
     ): Int
 
+    /**
+     * [write] 的 direct ByteBuffer 版本：数据直接从 native 内存写给内核，没有 JNI 数组拷贝。
+     *
+     * @param handle    open() 返回的句柄
+     * @param buffer    direct ByteBuffer（ByteBuffer.allocateDirect）
+     * @param offset    起始下标（绝对位置，不受 position 影响）
+     * @param length    写入长度
+     * @param timeoutMs 整次写入的超时时间（毫秒）
+     * @return          >=0: 实际写入字节数（超时时可能小于 length）；0: 超时；<0: 错误
+     */
+    @JvmStatic
+    external fun writeDirect(
+        handle: Long,
+        buffer: ByteBuffer,
+        offset: Int,
+        length: Int,
+        timeoutMs: Int
+    ): Int
+
+    /**
+     * 聚合写：buffer 从 0 开始首尾相接地放着 count 段数据，一次 writev 写出，
+     * 写不完就继续 poll + writev，直到全部写完或 timeoutMs 到期。
+     *
+     * @param handle    open() 返回的句柄
+     * @param buffer    direct ByteBuffer
+     * @param lengths   每段长度
+     * @param count     段数
+     * @param timeoutMs 整次写入的超时时间（毫秒）
+     * @param written   输出：每段实际写入的字节数
+     * @return          >=0: 总写入字节数；<0: 一个字节都没写出时的错误
+     */
+    @JvmStatic
+    external fun writeGather(
+        handle: Long,
+        buffer: ByteBuffer,
+        lengths: IntArray,
+        count: Int,
+        timeoutMs: Int,
+        written: IntArray
+    ): Int
+
+    /**
+     * [read] 的 direct ByteBuffer 版本：内核直接把数据读进 buffer，Kotlin 侧原地读取。
+     *
+     * @param handle    open() 返回的句柄
+     * @param buffer    direct ByteBuffer（ByteBuffer.allocateDirect）
+     * @param offset    写入的起始下标（绝对位置，不受 position 影响）
+     * @param length    最大读取长度
+     * @param timeoutMs poll 的超时时间（毫秒）
+     * @param stamp     不为 null 时，读到数据后写入 poll 返回时的 CLOCK_MONOTONIC（纳秒）到 stamp[0]
+     * @return          >0: 实际读取字节数；0: 超时无数据；<0: 错误
+     */
+    @JvmStatic
+    external fun readDirect(
+        handle: Long,
+        buffer: ByteBuffer,
+        offset: Int,
+        length: Int,
+        timeoutMs: Int,
+        stamp: LongArray?
+    ): Int
+
+    /**
+     * 等待线路静默：至多 [micros] 微秒内没有新数据到达即返回 0（半双工 turnaround 用）。
+     *
+     * 只等待、不读取；期间有数据到达时立即返回 1，由调用方决定如何处理。
+     *
+     * @param handle open() 返回的句柄
+     * @param micros 静默时间（微秒）
+     * @return       0: 线路静默；1: 有数据到达；<0: 错误
+     */
+    @JvmStatic
+    external fun waitIdle(handle: Long, micros: Int): Int
+
+    /**
+     * tcdrain：阻塞到已写入的数据全部从 UART 发出。
+     *
+     * @return 0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun drain(handle: Long): Int
+
+    /**
+     * tcflush：丢弃驱动里尚未读取 / 尚未发出的数据。
+     *
+     * @param queue FLUSH_INPUT / FLUSH_OUTPUT / FLUSH_BOTH
+     * @return      0: 成功；<0: 错误
+     */
+    @JvmStatic
+    external fun flush(handle: Long, queue: Int): Int
+
+    /**
+     * 读取驱动实际生效的波特率（TCGETS2）。
+     *
+     * @param handle open() 返回的句柄
+     * @return       >0: 波特率；<0: 错误
+     */
+    @JvmStatic
+    external fun getBaudRate(handle: Long): Int
+
     /**
      * 关闭串口。
      *
@@ -78,4 +195,27 @@ internal object NativeSerial {
      */
     @JvmStatic
     external fun close(handle: Long)
+
+    /**
+     * 按 [SerialConfig] 打开串口（含延迟档位）。
+     */
+    fun open(config: SerialConfig): Long {
+        val latency = config.latency?.let { l ->
+            val p = IntArray(LATENCY_COUNT)
+            p[LATENCY_LOW_LATENCY] = if (l.lowLatency) 1 else 0
+            p[LATENCY_USB_TIMER_MS] = l.usbLatencyTimerMs ?: 0
+            p[LATENCY_VMIN] = l.vmin
+            p[LATENCY_VTIME] = l.vtime
+            p[LATENCY_FLUSH_ON_OPEN] = if (l.flushOnOpen) 1 else 0
+            p
+        }
+        return open(
+            config.devicePath,
+            config.baudRate,
+            config.dataBits,
+            config.stopBits,
+            config.parity,
+            latency
+        )
+    }
 }
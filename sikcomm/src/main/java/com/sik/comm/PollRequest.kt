@@ -0,0 +1,179 @@
+package com.sik.comm
+
+/**
+ * 轮询请求，交给 [SerialChannel.startPolling] 循环执行。
+ *
+ * @param tag            调用方自定义的标识，原样出现在结果里（[PollResults.tag]）
+ * @param frame          完整请求帧（Modbus RTU 含 CRC，可用 [modbus] / [modbusRead] 构造），最长 [PollResults.MAX_RESPONSE] 字节
+ * @param periodMs       执行周期（毫秒），0 表示每轮都执行（线路空闲就发）
+ * @param timeoutMs      应答超时（毫秒），从请求最后一个字节发出开始计
+ * @param responseLength 应答长度：>0 时收满即结束；0 按协议推算（Modbus RTU）或字节间静默判定；-1 表示不等应答
+ */
+data class PollRequest(
+    val tag: Int,
+    val frame: ByteArray,
+    val periodMs: Int,
+    val timeoutMs: Int = 100,
+    val responseLength: Int = 0
+) {
+
+    init {
+        require(frame.isNotEmpty() && frame.size <= PollResults.MAX_RESPONSE) {
+            "Invalid poll frame size: ${frame.size}"
+        }
+        require(periodMs >= 0) { "Invalid periodMs: $periodMs" }
+        require(timeoutMs > 0) { "Invalid timeoutMs: $timeoutMs" }
+        require(responseLength in -1..PollResults.MAX_RESPONSE) { "Invalid responseLength: $responseLength" }
+    }
+
+    override fun equals(other: Any?): Boolean {
+        if (this === other) return true
+        if (other !is PollRequest) return false
+        return tag == other.tag && frame.contentEquals(other.frame) && periodMs == other.periodMs &&
+            timeoutMs == other.timeoutMs && responseLength == other.responseLength
+    }
+
+    override fun hashCode(): Int {
+        var result = tag
+        result = 31 * result + frame.contentHashCode()
+        result = 31 * result + periodMs
+        result = 31 * result + timeoutMs
+        result = 31 * result + responseLength
+        return result
+    }
+
+    companion object {
+
+        /**
+         * Modbus RTU 请求：地址 + 功能码 + data + CRC-16（低字节在前）。
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun modbus(
+            tag: Int,
+            slave: Int,
+            function: Int,
+            data: ByteArray,
+            periodMs: Int,
+            timeoutMs: Int = 100
+        ): PollRequest {
+            require(slave in 0..247) { "Invalid Modbus slave address: $slave" }
+            require(function in 1..127) { "Invalid Modbus function: $function" }
+            val frame = ByteArray(data.size + 4)
+            frame[0] = slave.toByte()
+            frame[1] = function.toByte()
+            System.arraycopy(data, 0, frame, 2, data.size)
+            val crc = Crc.crc16Modbus(frame, 0, frame.size - 2)
+            frame[frame.size - 2] = crc.toByte()
+            frame[frame.size - 1] = (crc ushr 8).toByte()
+            return PollRequest(tag, frame, periodMs, timeoutMs, if (slave == 0) -1 else 0)
+        }
+
+        /**
+         * Modbus 读请求（01 / 02 / 03 / 04）：起始地址 + 数量，均为大端。
+         *
+         * 数量按 Modbus 规范限制：线圈 / 离散输入（01 / 02）1..2000，寄存器（03 / 04）1..125，
+         * 应答不会超过 [PollResults.MAX_RESPONSE]。
+         */
+        @JvmStatic
+        @JvmOverloads
+        fun modbusRead(
+            tag: Int,
+            slave: Int,
+            function: Int,
+            address: Int,
+            quantity: Int,
+            periodMs: Int,
+            timeoutMs: Int = 100
+        ): PollRequest {
+            require(function in 1..4) { "Not a Modbus read function: $function" }
+            val maxQuantity = if (function <= 2) 2000 else 125
+            require(address in 0..0xFFFF && quantity in 1..maxQuantity) {
+                "Invalid Modbus read range: address=$address, quantity=$quantity"
+            }
+            val data = byteArrayOf(
+                (address ushr 8).toByte(),
+                address.toByte(),
+                (quantity ushr 8).toByte(),
+                quantity.toByte()
+            )
+            return modbus(tag, slave, function, data, periodMs, timeoutMs)
+        }
+    }
+}
+
+/**
+ * 应答判定方式（顺序和 JNI 层 POLL_PROTOCOL_* 保持一致）。
+ */
+enum class PollProtocol {
+    /** 按 responseLength 或字节间静默判定应答结束，不做校验 */
+    RAW,
+
+    /** Modbus RTU：按功能码推算应答长度，校验 CRC、从站地址和功能码，识别异常应答 */
+    MODBUS_RTU
+}
+
+/**
+ * 轮询引擎配置。
+ *
+ * @param protocol         应答判定方式
+ * @param interFrameMicros 帧间静默（微秒）：发送前线路至少空闲这么久，长度未知的应答字节间隔超过它即结束；
+ *                         null 时按实际波特率取 3.5 字符（> 19200 时为 1750us），并且不小于 [SerialConfig.turnaroundMicros]
+ * @param retries          超时 / CRC 错误时立即重试的次数
+ * @param maxBatch         一批最多交付的结果数
+ * @param budgetMs         一次 native 调用最长执行多久；两次调用之间处理 send() 和 stopPolling()
+ */
+data class PollingConfig(
+    val protocol: PollProtocol = PollProtocol.MODBUS_RTU,
+    val interFrameMicros: Int? = null,
+    val retries: Int = 0,
+    val maxBatch: Int = 32,
+    val budgetMs: Int = 50
+) {
+
+    init {
+        require(interFrameMicros == null || interFrameMicros >= 0) { "Invalid interFrameMicros: $interFrameMicros" }
+        require(retries in 0..10) { "Invalid retries: $retries" }
+        require(maxBatch in 1..256) { "Invalid maxBatch: $maxBatch" }
+        require(budgetMs in 1..1000) { "Invalid budgetMs: $budgetMs" }
+    }
+}
+
+/**
+ * 轮询结果回调，在通道 IO 协程里按批触发。
+ *
+ * batch 是复用的缓冲区（[PollResults] 记录格式），只在回调期间有效，回调内不要做耗时操作。
+ */
+fun interface PollResultReceiver {
+
+    /**
+     * @param batch 结果缓冲区
+     * @param count 本批结果数
+     */
+    fun onResults(batch: ByteArray, count: Int)
+}
+
+/**
+ * 轮询统计快照，通过 [SerialChannel.pollingStats] 获取。
+ *
+ * @param transactions  完成的事务数（含失败）
+ * @param timeouts      超时次数（重试后仍失败才计）
+ * @param badCrc        CRC 错误次数
+ * @param mismatches    应答和请求不符的次数
+ * @param exceptions    Modbus 异常应答次数
+ * @param retries       重试次数
+ * @param strayBytes    事务之外收到并丢弃的字节数
+ * @param overruns      到期时已错过至少一个周期的次数（线路排不开）
+ * @param maxLatenessNs 实际开始时间相对计划时间的最大延后（纳秒）
+ */
+data class PollingStats(
+    val transactions: Long,
+    val timeouts: Long,
+    val badCrc: Long,
+    val mismatches: Long,
+    val exceptions: Long,
+    val retries: Long,
+    val strayBytes: Long,
+    val overruns: Long,
+    val maxLatenessNs: Long
+)
@@ -0,0 +1,97 @@
+package com.sik.comm
+
+/**
+ * 轮询结果记录格式（[PollResultReceiver] 收到的批量缓冲区）。
+ *
+ * 单条记录格式（小端）：
+ * - [0..3]   tag（[PollRequest.tag]）
+ * - [4]      状态（STATUS_*）
+ * - [5]      尝试次数（1 + 重试次数）
+ * - [6..7]   应答长度
+ * - [8..15]  计划执行时间
+ * - [16..23] 请求最后一个字节发出的时间（按字符时间估算）
+ * - [24..31] 收到应答最后一块数据的时间，没有应答时为 0
+ * - 之后为应答原始字节（Modbus RTU 含地址和 CRC），固定占 [MAX_RESPONSE] 字节
+ *
+ * 时间都是 CLOCK_MONOTONIC 纳秒（和 [TimestampedReceiver.SOURCE_MONOTONIC] 同一时钟）。
+ */
+object PollResults {
+
+    /** 应答完整且校验通过 */
+    const val STATUS_OK = 0
+
+    /** 超时没有（完整的）应答，收到的半截数据照常交付 */
+    const val STATUS_TIMEOUT = 1
+
+    /** 应答 CRC 错误 */
+    const val STATUS_BAD_CRC = 2
+
+    /** 应答的从站地址 / 功能码和请求不符 */
+    const val STATUS_MISMATCH = 3
+
+    /** Modbus 异常应答（功能码最高位置 1），异常码在应答第 3 个字节 */
+    const val STATUS_EXCEPTION = 4
+
+    /** 请求写超时 */
+    const val STATUS_IO_ERROR = 5
+
+    /** 记录头长度（和 JNI 层 POLL_RECORD_HEADER 保持一致） */
+    const val HEADER_SIZE = 32
+
+    /** 应答最大长度（和 JNI 层 POLL_MAX_RESPONSE 保持一致） */
+    const val MAX_RESPONSE = 256
+
+    /** 单条记录长度 */
+    const val RECORD_SIZE = HEADER_SIZE + MAX_RESPONSE
+
+    /** 第 index 条结果的 tag */
+    @JvmStatic
+    fun tag(buffer: ByteArray, index: Int): Int = readInt(buffer, index * RECORD_SIZE)
+
+    /** 第 index 条结果的状态（STATUS_*） */
+    @JvmStatic
+    fun status(buffer: ByteArray, index: Int): Int =
+        buffer[index * RECORD_SIZE + 4].toInt() and 0xFF
+
+    /** 第 index 条结果的尝试次数 */
+    @JvmStatic
+    fun attempts(buffer: ByteArray, index: Int): Int =
+        buffer[index * RECORD_SIZE + 5].toInt() and 0xFF
+
+    /** 第 index 条结果的应答长度 */
+    @JvmStatic
+    fun length(buffer: ByteArray, index: Int): Int {
+        val base = index * RECORD_SIZE + 6
+        return (buffer[base].toInt() and 0xFF) or ((buffer[base + 1].toInt() and 0xFF) shl 8)
+    }
+
+    /** 第 index 条结果的计划执行时间（纳秒） */
+    @JvmStatic
+    fun dueNs(buffer: ByteArray, index: Int): Long = readLong(buffer, index * RECORD_SIZE + 8)
+
+    /** 第 index 条结果的请求发完时间（纳秒） */
+    @JvmStatic
+    fun sentNs(buffer: ByteArray, index: Int): Long = readLong(buffer, index * RECORD_SIZE + 16)
+
+    /** 第 index 条结果的应答接收时间（纳秒），没有应答时为 0 */
+    @JvmStatic
+    fun responseNs(buffer: ByteArray, index: Int): Long = readLong(buffer, index * RECORD_SIZE + 24)
+
+    /** 第 index 条结果应答数据在 buffer 中的起始下标 */
+    @JvmStatic
+    fun payloadOffset(index: Int): Int = index * RECORD_SIZE + HEADER_SIZE
+
+    private fun readInt(buffer: ByteArray, base: Int): Int =
+        (buffer[base].toInt() and 0xFF) or
+            ((buffer[base + 1].toInt() and 0xFF) shl 8) or
+            ((buffer[base + 2].toInt() and 0xFF) shl 16) or
+            ((buffer[base + 3].toInt() and 0xFF) shl 24)
+
+    private fun readLong(buffer: ByteArray, base: Int): Long {
+        var v = 0L
+        for (i in 7 downTo 0) {
+            v = (v shl 8) or (buffer[base + i].toLong() and 0xFF)
+        }
+        return v
+    }
+}
@@ -0,0 +1,120 @@
+package com.sik.comm
+
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.asCoroutineDispatcher
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import java.nio.ByteBuffer
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * 一个通道的接收环：native 环 + 专用接收线程。
+ *
+ * - 生产者：通道 IO 协程调用 NativeRxRing.fill* 把数据读进环，写入后调用 [signal]；
+ * - 消费者：[launchConsumer] 在专用线程上等待 [signal]，认领一批记录、原地回调、归还，直到环空。
+ *
+ * native 环在生产者和消费者两个 Job 都结束后才释放（见 [destroyAfter]）。
+ */
+internal class RxRing(config: RxRingConfig, name: String) {
+
+    /**
+     * native 环句柄，释放后为 0。
+     */
+    @Volatile
+    var handle: Long = NativeRxRing.create(config.capacity, config.overflow.ordinal)
+        private set
+
+    init {
+        require(handle > 0L) {
+            "Failed to create rx ring: capacity=${config.capacity}, ret=$handle"
+        }
+    }
+
+    /**
+     * 包住整段环的 direct ByteBuffer（只在接收线程里访问）。
+     */
+    private val buffer: ByteBuffer = NativeRxRing.buffer(handle)
+
+    /**
+     * 生产者写入新记录后的通知（合并，接收线程每次醒来都会把环取空）。
+     */
+    private val ready: Channel<Unit> = Channel(Channel.CONFLATED)
+
+    private val executor = Executors.newSingleThreadExecutor { r ->
+        Thread(r, "sikcomm-rx-$name").apply { isDaemon = true }
+    }
+
+    private val dispatcher = executor.asCoroutineDispatcher()
+
+    /**
+     * 环里有新记录，唤醒接收线程。
+     */
+    fun signal() {
+        ready.trySend(Unit)
+    }
+
+    /**
+     * 在专用接收线程上启动消费循环。
+     *
+     * @param onRecord 每条记录回调一次：环的 ByteBuffer、数据偏移、长度、记录时间戳
+     * @param onSpace  生产者因环满（BLOCK）暂停过读取，归还记录后回调，调用方应重新触发一次读取
+     */
+    fun launchConsumer(
+        scope: CoroutineScope,
+        onRecord: (buffer: ByteBuffer, offset: Int, length: Int, timestampNs: Long) -> Unit,
+        onSpace: () -> Unit
+    ): Job = scope.launch(dispatcher) {
+        val ring = handle
+        val offsets = IntArray(NativeRxRing.PEEK_MAX)
+        val lengths = IntArray(NativeRxRing.PEEK_MAX)
+        val stamps = LongArray(NativeRxRing.PEEK_MAX)
+
+        while (isActive) {
+            ready.receive()
+            while (true) {
+                val n = NativeRxRing.peek(ring, offsets, lengths, stamps)
+                for (i in 0 until n) {
+                    onRecord(buffer, offsets[i], lengths[i], stamps[i])
+                }
+                if (NativeRxRing.release(ring)) onSpace()
+                if (n <= 0) break
+            }
+        }
+    }
+
+    /**
+     * 所有 jobs 结束后释放 native 环并关闭接收线程；没有 job 时立即释放。
+     */
+    fun destroyAfter(vararg jobs: Job) {
+        if (jobs.isEmpty()) {
+            destroy()
+            return
+        }
+        val remaining = AtomicInteger(jobs.size)
+        jobs.forEach { job ->
+            job.invokeOnCompletion {
+                if (remaining.decrementAndGet() == 0) destroy()
+            }
+        }
+    }
+
+    /**
+     * 统计快照，环已释放时返回 null。
+     */
+    fun stats(): RxRingStats? = synchronized(this) {
+        val ring = handle
+        if (ring == 0L) null else NativeRxRing.readStats(ring)
+    }
+
+    private fun destroy() {
+        synchronized(this) {
+            val ring = handle
+            handle = 0L
+            if (ring != 0L) NativeRxRing.destroy(ring)
+        }
+        dispatcher.close()
+    }
+}
@@ -0,0 +1,70 @@
+package com.sik.comm
+
+/**
+ * 接收环形缓冲区配置。
+ *
+ * 默认（[SerialConfig.rxRing] / [CanConfig.rxRing] 为 null）时 receiver 直接在通道的 IO 协程里回调，
+ * 回调慢会拖住读循环：串口的写、CAN 的 rearm 都要等回调返回，内核缓冲区溢出时数据悄悄丢掉。
+ *
+ * 配置本项后读路径拆成两半：
+ * - IO 协程被 reactor 唤醒后只把 fd 里的数据直接读进 native 环（无锁 SPSC，一段 mmap 内存），随即返回继续等待 / 处理写；
+ * - 通道另起一个专用接收线程，通过包住这段内存的 direct ByteBuffer 原地取出数据并回调 receiver。
+ *
+ * 环满时的行为由 [overflow] 决定，丢弃 / 暂停的情况可通过 [CommChannel.rxRingStats] 查看。
+ *
+ * @param capacity 环大小（字节），必须是 2 的幂，至少 4096；分帧时至少为最大帧长的 2 倍以上
+ * @param overflow 环满时的处理方式
+ */
+data class RxRingConfig(
+    val capacity: Int = 256 * 1024,
+    val overflow: RxOverflow = RxOverflow.DROP_OLDEST
+) {
+
+    init {
+        require(capacity >= MIN_CAPACITY && (capacity and (capacity - 1)) == 0) {
+            "Invalid rx ring capacity: $capacity (power of two, >= $MIN_CAPACITY)"
+        }
+    }
+
+    companion object {
+        /** 最小容量（和 JNI 层 RX_RING_MIN_CAPACITY 保持一致） */
+        const val MIN_CAPACITY = 4096
+    }
+}
+
+/**
+ * 接收环满时的处理方式（顺序和 JNI 层 RX_RING_* 保持一致）。
+ */
+enum class RxOverflow {
+    /** 丢弃新读到的数据，fd 照常读干净 */
+    DROP_NEWEST,
+
+    /** 丢弃环里最旧的、接收线程还没取走的数据；接收线程正占着整段环时退化为丢弃新数据 */
+    DROP_OLDEST,
+
+    /** 暂停读 fd，数据留在内核缓冲区（CAN 为 socket 接收队列），接收线程腾出空间后继续 */
+    BLOCK
+}
+
+/**
+ * 接收环运行统计快照，通过 [CommChannel.rxRingStats] 获取。
+ *
+ * “记录”是一次读取的结果：串口为一块原始字节 / 一批整帧，CAN 为一次 recvmmsg 收到的一批帧。
+ *
+ * @param capacity       环大小（字节）
+ * @param used           当前占用的字节数（含记录头）
+ * @param highWater      占用的历史最大值
+ * @param records        写入环的记录数
+ * @param droppedRecords 因环满丢弃的记录数
+ * @param droppedBytes   因环满丢弃的字节数（CAN 按定长记录计）
+ * @param blocked        BLOCK 策略下因环满暂停读取的次数
+ */
+data class RxRingStats(
+    val capacity: Long,
+    val used: Long,
+    val highWater: Long,
+    val records: Long,
+    val droppedRecords: Long,
+    val droppedBytes: Long,
+    val blocked: Long
+)
@@ -0,0 +1,49 @@
+package com.sik.comm
+
+/**
+ * 串口通道。
+ *
+ * 在 [CommChannel] 的基础上提供串口专有能力，通过 [SikComm.openSerial] 获取。
+ */
+interface SerialChannel : CommChannel {
+
+    /**
+     * 驱动实际生效的波特率。
+     *
+     * 非标准波特率（termios2 / BOTHER）由驱动按自己的时钟分频取整，可能和 [SerialConfig.baudRate] 略有出入。
+     *
+     * @return 波特率；通道未打开时返回 0
+     */
+    fun actualBaudRate(): Int
+
+    /**
+     * 开始循环轮询（RS485 / Modbus 主站）。
+     *
+     * 请求交给 native 轮询引擎，由通道 IO 协程连续执行：按各自周期到期排队，
+     * 事务之间保证帧间静默，应答在 native 层收齐、校验并和请求配对，结果成批交给 receiver。
+     * 轮询期间：
+     * - 普通 receiver 不再收到数据，事务之外收到的字节被丢弃（计入 [PollingStats.strayBytes]）；
+     * - 通道的 IO 协程在整个会话期间被轮询占用：每批事务在 native 里阻塞执行（至多 [PollingConfig.budgetMs]），
+     *   批与批之间让出一次线程；
+     * - send() 仍然可用，在两批事务之间写出（最多等一个 budgetMs），但它的应答同样会被丢弃，
+     *   需要应答的请求应放进轮询表；
+     * - 接收环 / 分帧器暂停使用。
+     *
+     * 已在轮询时再次调用会替换原来的轮询表。只支持半双工（fullDuplex = false）。
+     *
+     * @param requests 轮询表
+     * @param config   轮询引擎配置
+     * @param receiver 结果回调，在 IO 协程里触发
+     */
+    fun startPolling(requests: List<PollRequest>, config: PollingConfig, receiver: PollResultReceiver)
+
+    /**
+     * 停止轮询，通道回到普通收发。正在执行的一批事务完成后生效。
+     */
+    fun stopPolling()
+
+    /**
+     * 当前轮询的统计快照，没有在轮询时返回 null。
+     */
+    fun pollingStats(): PollingStats?
+}
@@ -9,6 +9,11 @@ import kotlinx.coroutines.cancel
 import kotlinx.coroutines.channels.Channel
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.selects.select
+import kotlinx.coroutines.yield
+import java.nio.ByteBuffer
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicReference
 
 /**
  * 串口通道实现（适用于 RS232 / RS485 / USB-Serial）。
@@ -16,19 +21,38 @@ import kotlinx.coroutines.launch
  * 特性：
  * - 使用单独一个 IO 协程负责所有 JNI 调用（read / write）
  * - 严格保证“要么发，要么收”：同一时刻只有 read 或 write 在执行，不会并发
+ * - fd 注册到全局 [CommReactor]，IO 协程挂起等待“可读通知”或“写请求”，空闲时不占线程、不定时唤醒
  * - IO 循环策略：**读优先**
- *   1. 每轮先调用一次 JNI read()（内部 poll + read，阻塞直到有数据或超时）
- *   2. 若本轮没有读到数据，再尝试处理一个写请求（从 writeQueue 非阻塞取一条）
- *   3. 写完回到下一轮，继续先读后写
+ *   1. 每轮同时等待可读通知和 writeQueue，两者都就绪时优先处理可读
+ *   2. 可读时把串口里已有的数据非阻塞地读干净，再 rearm
+ *   3. 没有可读数据时才处理写请求：已排队的请求合并成一次 writev 连续写出，写完回到下一轮
  *
  * 这样可以保证：
  * - 485 半双工场景不会在收包过程中插入 write 导致包中断
  * - 写队列再长，中间也会夹杂 read，不会饿死接收
- * - Kotlin while 循环不会空转，真正阻塞在 JNI 的 poll 上
+ * - 线路空闲时 send() 立即被处理，不用等读超时
+ *
+ * 半双工仲裁（见 [SerialConfig]）：
+ * - turnaroundMicros：最后一次收到数据后至少空闲这么久才发送，给对端留出收发切换时间
+ * - maxReadSliceMs：连续读超过这个时间且有写在排队时让出一次，先写一批再接着读
+ * - fullDuplex：RS232 等全双工线路读写互不等待，写由独立协程执行
+ *
+ * 收发都走复用的 direct ByteBuffer：内核直接读写这块内存，不再经过 JNI 数组拷贝。
+ *
+ * 配置了 [SerialConfig.framing] 时，读路径改走 native 分帧器：
+ * 一次 JNI 调用把已有数据读干净并切成整帧，receiver 每次回调拿到一整帧。
+ *
+ * receiver 实现 [TimestampedReceiver] 时，每块数据 / 每帧附带 native 层 poll 返回时的 CLOCK_MONOTONIC 时间戳。
+ *
+ * 配置了 [SerialConfig.rxRing] 时，IO 协程只把数据读进 native 接收环（分帧时为整帧），
+ * receiver 改在通道专用的接收线程上回调，回调慢不再拖住读写。
+ *
+ * [startPolling] 后 IO 协程改为反复调用 native 轮询引擎：一次 JNI 调用连续执行一批到期的事务
+ * （写请求、收应答、配对校验都在 native 层），两批之间处理排队的 send()。
  */
 internal class SerialChannelImpl(
     private val config: SerialConfig
-) : CommChannel {
+) : SerialChannel {
 
     override val id: String
         get() = config.id
@@ -51,6 +75,21 @@ internal class SerialChannelImpl(
      */
     private var ioJob: Job? = null
 
+    /**
+     * 全双工时独立写协程对应的 Job。
+     */
+    private var writerJob: Job? = null
+
+    /**
+     * reactor 注册 token，0 表示未注册。
+     */
+    private var reactorToken: Int = 0
+
+    /**
+     * reactor 线程发来的可读通知（合并，IO 循环每次醒来都会把数据读干净）。
+     */
+    private val readable: Channel<Unit> = Channel(Channel.CONFLATED)
+
     /**
      * 当前设置的接收回调。
      * 通过 setReceiver() 设置 / 替换。
@@ -62,26 +101,94 @@ internal class SerialChannelImpl(
      * 写请求队列。
      *
      * - 所有 send() 调用都会投递一个 WriteJob 到这里
-     * - IO 协程在每轮 read 之后，非阻塞尝试从队列取出一条写请求处理
+     * - IO 协程在没有可读数据时从队列取出写请求，连同已排队的请求一起合并写出
      * - 使用 Channel.UNLIMITED，避免业务高频 send 时直接挂起
      */
     private val writeQueue: Channel<WriteJob> =
         Channel(capacity = Channel.UNLIMITED)
 
+    /**
+     * writeQueue 中尚未执行的写请求数，供 metrics() 使用。
+     */
+    private val pendingWrites = AtomicInteger(0)
+
+    /**
+     * 读缓冲区大小：分帧时至少能放下一整帧（含长度头）。
+     */
+    private val readBufferSize: Int =
+        maxOf(READ_BUFFER_SIZE, (config.framing?.maxFrameSize ?: 0) + NativeFramer.RECORD_HEADER)
+
+    /**
+     * 普通 CommReceiver 使用的复用数组（只在回调 receiver 的线程里访问：IO 协程，配置了接收环时为接收线程）。
+     */
+    private val readArray = ByteArray(readBufferSize)
+
+    /**
+     * 读操作复用的 direct buffer（只在 IO 协程里访问）。
+     */
+    private val readBuffer: ByteBuffer = ByteBuffer.allocateDirect(readBufferSize)
+
+    /**
+     * readDirect 回写接收时间戳用的复用数组（只在 IO 协程里访问）。
+     */
+    private val readStamp = LongArray(1)
+
+    /**
+     * native 分帧器句柄，0 表示不分帧；归 IO 协程所有，协程结束后释放。
+     */
+    private var framer: Long = 0L
+
+    /**
+     * 接收环，null 表示在 IO 协程里直接回调 receiver；IO 协程和接收线程都结束后释放。
+     */
+    private var rxRing: RxRing? = null
+
+    /**
+     * startPolling / stopPolling 投递给 IO 协程的切换请求：[PollSession] 或 [StopPolling]，
+     * IO 协程每轮开始时取走；还没被取走就被替换的会话由替换方释放。
+     */
+    private val pendingPoll = AtomicReference<Any?>(null)
+
+    /**
+     * IO 协程正在执行的轮询会话（只由 IO 协程切换和释放），供 pollingStats() 使用。
+     */
+    @Volatile
+    private var activePoll: PollSession? = null
+
+    /**
+     * 最后一次收到数据的时间（System.nanoTime，只在 IO 协程里访问），用于半双工 turnaround。
+     */
+    private var lastRxNanos: Long = 0L
+
+    /**
+     * 写操作复用的 direct buffer（只在写数据的协程里访问），不够大时按需扩容。
+     */
+    private var writeBuffer: ByteBuffer = ByteBuffer.allocateDirect(READ_BUFFER_SIZE)
+
+    /**
+     * 合并写复用的请求列表和每段长度 / 实际写入数（只在写数据的协程里访问）。
+     */
+    private val writeBatch = ArrayList<WriteJob>(MAX_COALESCE_JOBS)
+    private val writeLengths = IntArray(MAX_COALESCE_JOBS)
+    private val writtenCounts = IntArray(MAX_COALESCE_JOBS)
+
     override fun open() {
         if (isOpen()) {
             // 幂等：已经打开就直接返回
             return
         }
 
-        // 调 JNI 打开串口并配置 termios
-        val fd = NativeSerial.open(
-            config.devicePath,
-            config.baudRate,
-            config.dataBits,
-            config.stopBits,
-            config.parity
-        )
+        val ringConfig = config.rxRing
+        val framing = config.framing
+        if (ringConfig != null && framing != null) {
+            // 环里一条记录至少要放得下一整帧
+            require(ringConfig.capacity >= 2 * (framing.maxFrameSize + NativeFramer.RECORD_HEADER + 2 * NativeRxRing.RECORD_HEADER)) {
+                "rxRing.capacity ${ringConfig.capacity} is too small for maxFrameSize ${framing.maxFrameSize}"
+            }
+        }
+
+        // 调 JNI 打开串口并配置 termios（以及可选的延迟档位）
+        val fd = NativeSerial.open(config)
 
         require(fd > 0L) {
             "Failed to open serial port: ${config.devicePath}, handle=$fd"
@@ -89,19 +196,74 @@ internal class SerialChannelImpl(
 
         handle = fd
 
+        val capture = config.capture
+        if (capture != null) {
+            val ret = NativeCapture.start(fd, capture, id)
+            if (ret < 0) {
+                NativeSerial.close(fd)
+                handle = 0L
+                throw IllegalArgumentException("Failed to start capture in ${capture.directory}, ret=$ret")
+            }
+        }
+
+        // 分帧器配置非法时这里直接抛出，不留下半打开的通道
+        framer = try {
+            NativeFramer.create(config)
+        } catch (e: IllegalArgumentException) {
+            NativeSerial.close(fd)
+            handle = 0L
+            throw e
+        }
+
+        if (ringConfig != null) {
+            rxRing = try {
+                RxRing(ringConfig, id)
+            } catch (e: IllegalArgumentException) {
+                if (framer != 0L) NativeFramer.destroy(framer)
+                framer = 0L
+                NativeSerial.close(fd)
+                handle = 0L
+                throw e
+            }
+        }
+
         // 启动 IO 循环
-        startIoLoop()
+        try {
+            startIoLoop()
+        } catch (e: IllegalStateException) {
+            // reactor 登记失败：IO 循环没有启动，分帧器和接收环也还没挂上 job
+            rxRing?.destroyAfter()
+            rxRing = null
+            if (framer != 0L) NativeFramer.destroy(framer)
+            framer = 0L
+            NativeSerial.close(fd)
+            handle = 0L
+            throw e
+        }
     }
 
     override fun close() {
-        // 停止 IO 循环
-        ioJob?.cancel()
+        // 停止 IO 循环（cancel 不等协程结束，fd 等它们结束后再关）
+        val jobs = listOfNotNull(ioJob, writerJob)
+        jobs.forEach { it.cancel() }
         ioJob = null
+        writerJob = null
+        // 还没被 IO 协程取走的轮询会话（正在执行的由 IO 协程结束时释放）
+        (pendingPoll.getAndSet(null) as? PollSession)?.release()
 
         // 关闭底层 fd
         val fd = handle
         if (fd != 0L) {
-            NativeSerial.close(fd)
+            // 先从 reactor 注销，IO 协程结束后再关 fd，避免 fd 号被复用后收到错误的事件
+            val discard = config.latency?.discardOnClose == true
+            CommReactor.unregisterAndCloseAfter(fd, reactorToken, jobs) {
+                if (discard) {
+                    // 丢掉没发完的数据，close 不会卡在 closing_wait 上
+                    NativeSerial.flush(fd, NativeSerial.FLUSH_OUTPUT)
+                }
+                NativeSerial.close(fd)
+            }
+            reactorToken = 0
             handle = 0L
         }
 
@@ -118,15 +280,15 @@ internal class SerialChannelImpl(
 
         val t = timeoutMs ?: config.writeTimeoutMs
 
-        // 这里可以选择 copy 或直接用原数组：
-        // - 如果业务层会复用/修改原数组，建议 copy
-        // - 如果确认不会修改，可直接用 bytes
+        // 先 copy 一份：调用方协程在等待结果时被取消，写请求仍留在队列里稍后写出，
+        // 这时调用方可能已经在复用 bytes
         val job = WriteJob(
             data = bytes.copyOf(),
             timeoutMs = t
         )
 
         // 投递写请求给 IO 协程
+        pendingWrites.incrementAndGet()
         writeQueue.send(job)
 
         // 挂起等待写结果
@@ -137,85 +299,442 @@ internal class SerialChannelImpl(
         this.receiver = receiver
     }
 
+    override fun metrics(): ChannelMetrics =
+        NativeMetrics.read(handle, pendingWrites.get())
+
+    override fun rxRingStats(): RxRingStats? =
+        if (isOpen()) rxRing?.stats() else null
+
+    override fun actualBaudRate(): Int {
+        val fd = handle
+        if (fd == 0L) return 0
+        return NativeSerial.getBaudRate(fd).coerceAtLeast(0)
+    }
+
+    override fun startPolling(requests: List<PollRequest>, config: PollingConfig, receiver: PollResultReceiver) {
+        check(isOpen()) {
+            "SerialChannelImpl#startPolling called when channel is not open (id=$id)"
+        }
+        check(!this.config.fullDuplex) {
+            "Polling is only available on half-duplex channels (id=$id)"
+        }
+        if (config.protocol == PollProtocol.MODBUS_RTU) {
+            require(requests.all { it.frame.size >= 4 }) { "Modbus RTU request shorter than 4 bytes (id=$id)" }
+        }
+
+        val poller = NativePoller.create(this.config, actualBaudRate(), requests, config)
+        require(poller > 0L) {
+            "Failed to create poller (id=$id), ret=$poller"
+        }
+        (pendingPoll.getAndSet(PollSession(poller, config, receiver)) as? PollSession)?.release()
+        // IO 协程可能正挂起在 select 上，补一个可读通知把它唤醒
+        readable.trySend(Unit)
+    }
+
+    override fun stopPolling() {
+        (pendingPoll.getAndSet(StopPolling) as? PollSession)?.release()
+        readable.trySend(Unit)
+    }
+
+    override fun pollingStats(): PollingStats? = activePoll?.stats()
+
     /**
      * 启动 IO 循环：
      *
      * while (active && open) {
-     *   1. 先尝试 read()
-     *   2. 若本轮没有读到数据，再尝试处理一条 writeQueue 里的写请求
+     *   select {
+     *     1. 可读通知 -> 把数据读干净，rearm（读片超时且有写在排队时让出）
+     *     2. 写请求   -> 等 turnaround 间隔后把已排队的请求合并写出
+     *   }
      * }
      *
-     * read() / write() 内部由 JNI 使用 poll() 控制阻塞与超时，
-     * 因此 while 循环不会空转。
+     * select 偏向第一个分支，两者同时就绪时默认先读；
+     * 上一轮读片因超过 maxReadSliceMs 让出时，下一轮先写一批再继续读（公平调度）。
+     * 等待期间协程挂起在 select 上，由 reactor 线程唤醒，因此 while 循环不会空转。
+     *
+     * fullDuplex 时读写互不等待：IO 循环只负责读，另起一个写协程消费 writeQueue。
+     *
+     * 有轮询会话时每轮改为 [pollOnce]，不再等可读通知。
      */
     private fun startIoLoop() {
-        ioJob = scope.launch {
-            val buffer = ByteArray(4096)
-
-            while (isActive && isOpen()) {
-                // -------- 1. 先读 --------
-                val fdForRead = handle
-                if (fdForRead == 0L) {
-                    // 已关闭，退出循环
-                    break
-                }
-
-                val n = NativeSerial.read(
-                    fdForRead,
-                    buffer,
-                    0,
-                    buffer.size,
-                    config.readTimeoutMs
-                )
+        val fd = handle
+        val token = CommReactor.register(fd) { readable.trySend(Unit) }
+        reactorToken = token
+
+        val job = scope.launch {
+            // 上一轮读片是否让出过，让出后下一轮先写
+            var preferWrite = false
+            // 正在执行的轮询会话，只在本协程里切换和释放
+            var polling: PollSession? = null
+
+            try {
+                while (isActive && isOpen()) {
+                    val change = pendingPoll.getAndSet(null)
+                    if (change != null) {
+                        polling?.release()
+                        polling = change as? PollSession
+                        activePoll = polling
+                        // 回到普通收发：轮询期间 reactor 可能已经通知过，补一次把积压的数据读掉
+                        if (polling == null) readable.trySend(Unit)
+                    }
 
-                when {
-                    n > 0 -> {
-                        // 读到了数据，优先处理接收
-                        receiver?.onBytesReceived(buffer, 0, n)
-                        // 读取到数据后，继续下一轮循环，继续 read 优先
+                    val session = polling
+                    if (session != null) {
+                        if (!pollOnce(session, fd)) break
+                        // 批与批之间让出线程，同一调度器上的其它协程（包括 send 的调用方）有机会运行
+                        yield()
                         continue
                     }
 
-                    n < 0 -> {
+                    val ok = select<Boolean> {
+                        if (preferWrite && !config.fullDuplex) {
+                            writeQueue.onReceive { writeJob ->
+                                preferWrite = false
+                                performWrite(writeJob)
+                                true
+                            }
+                        }
+
+                        // -------- 1. 读优先 --------
+                        readable.onReceive {
+                            when (drain(fd)) {
+                                Drain.DONE -> {
+                                    CommReactor.rearm(fd, token)
+                                    true
+                                }
+
+                                Drain.YIELD -> {
+                                    // 数据没读完：不 rearm，自己补一个可读通知，写完一条后接着读
+                                    readable.trySend(Unit)
+                                    preferWrite = true
+                                    true
+                                }
+
+                                Drain.BLOCKED -> {
+                                    // 接收环已满：不 rearm，接收线程腾出空间后补发可读通知
+                                    true
+                                }
+
+                                Drain.ERROR -> false
+                            }
+                        }
+
+                        // -------- 2. 没有可读数据时处理写请求 --------
+                        if (!preferWrite && !config.fullDuplex) {
+                            writeQueue.onReceive { writeJob ->
+                                performWrite(writeJob)
+                                true
+                            }
+                        }
+                    }
+
+                    if (!ok) {
                         // 发生错误，直接退出循环（也可以在这里打标记）
                         break
                     }
+                }
+            } finally {
+                polling?.release()
+                activePoll = null
+            }
+        }
+        val f = framer
+        if (f != 0L) {
+            // 完成回调在协程体结束之后执行（包括启动前就被取消的情况），此时不会再有 readFrames
+            job.invokeOnCompletion { NativeFramer.destroy(f) }
+        }
+        ioJob = job
+
+        val ring = rxRing
+        if (ring != null) {
+            val consumer = ring.launchConsumer(
+                scope,
+                onRecord = if (f != 0L) ::deliverFrameRecord else ::deliver,
+                onSpace = { readable.trySend(Unit) }
+            )
+            ring.destroyAfter(job, consumer)
+        }
 
-                    // n == 0 -> 读超时，无数据，转去看看写队列
+        if (config.fullDuplex) {
+            writerJob = scope.launch {
+                for (writeJob in writeQueue) {
+                    performWrite(writeJob)
                 }
+            }
+        }
+    }
 
-                // -------- 2. 再尝试处理一条写请求 --------
-                val writeJob = writeQueue.tryReceive().getOrNull()
-                if (writeJob != null) {
-                    val fdForWrite = handle
-                    if (fdForWrite == 0L) {
-                        // 已关闭，不再写，通知调用方失败
-                        writeJob.result.completeExceptionally(
-                            IllegalStateException("Serial handle is closed during write (id=$id)")
-                        )
-                        continue
-                    }
+    /**
+     * 轮询模式下的一轮：native 连续执行一批到期的事务（至多 budgetMs），结果成批回调，
+     * 再写出一个排队的 send()（连同合并进来的请求）。
+     *
+     * @return false: fd 出错，IO 循环应退出
+     */
+    private fun pollOnce(session: PollSession, fd: Long): Boolean {
+        val n = NativePoller.run(session.handle, fd, session.batch, session.config.maxBatch, session.config.budgetMs)
+        if (n < 0) return false
+        if (n > 0) session.receiver.onResults(session.batch, n)
+
+        writeQueue.tryReceive().getOrNull()?.let { performWrite(it) }
+        return true
+    }
+
+    /**
+     * 一次读片的结果。
+     */
+    private enum class Drain {
+        /** 已读干净 */
+        DONE,
 
-                    val written = NativeSerial.write(
-                        fdForWrite,
-                        writeJob.data,
-                        0,
-                        writeJob.data.size,
-                        writeJob.timeoutMs
-                    )
+        /** 读片超时且有写请求在排队，主动让出 */
+        YIELD,
 
-                    writeJob.result.complete(written)
+        /** 接收环已满（[RxOverflow.BLOCK]），暂停读取 */
+        BLOCKED,
 
-                    // 写完后继续 loop，下一轮又会先尝试 read()
-                    continue
-                }
+        /** 读出错，IO 循环应退出 */
+        ERROR
+    }
+
+    /**
+     * 非阻塞地读取串口里已有的数据并上抛（按是否配置分帧器选择路径）。
+     *
+     * 半双工下单次读片最长 [SerialConfig.maxReadSliceMs]，超过且有写请求排队时返回 [Drain.YIELD]。
+     */
+    private fun drain(fd: Long): Drain {
+        val sliceNs = if (config.fullDuplex || config.maxReadSliceMs <= 0) {
+            0L
+        } else {
+            config.maxReadSliceMs * 1_000_000L
+        }
+        val start = System.nanoTime()
+        val f = framer
+        val ring = rxRing
+        while (true) {
+            val n = when {
+                ring != null -> fillRingOnce(ring, f, fd)
+                f != 0L -> drainFramesOnce(f, fd)
+                else -> drainReadsOnce(fd)
+            }
+            if (n == -NativeRxRing.ENOBUFS) return Drain.BLOCKED
+            if (n < 0) return Drain.ERROR
+            if (n == 0) return Drain.DONE
+            lastRxNanos = System.nanoTime()
+            if (sliceNs > 0 && pendingWrites.get() > 0 && lastRxNanos - start >= sliceNs) {
+                return Drain.YIELD
+            }
+        }
+    }
+
+    /**
+     * 非阻塞地读一次原始字节并上抛。
+     *
+     * @return >0: 读到的字节数；0: 没有数据；<0: 错误
+     */
+    private fun drainReadsOnce(fd: Long): Int {
+        val buffer = readBuffer
+        val stamp = readStamp
+        val n = NativeSerial.readDirect(fd, buffer, 0, buffer.capacity(), 0, stamp)
+        if (n > 0) deliver(buffer, 0, n, stamp[0])
+        return n
+    }
+
+    /**
+     * 通过 native 分帧器读一次并逐帧上抛。
+     *
+     * @return >0: 帧数；0: 没有完整帧；<0: 错误
+     */
+    private fun drainFramesOnce(framer: Long, fd: Long): Int {
+        val buffer = readBuffer
+        val n = NativeFramer.readFrames(framer, fd, buffer, buffer.capacity(), 0)
+        if (n <= 0) return n
+
+        var pos = 0
+        repeat(n) {
+            pos = deliverFrame(buffer, pos)
+        }
+        return n
+    }
+
+    /**
+     * 非阻塞地读一次，数据（分帧时为本次得到的整帧）直接落进接收环，由接收线程回调 receiver。
+     *
+     * @return >0: 字节数 / 帧数；0: 没有数据；-ENOBUFS: 环已满（BLOCK）；<0: 错误
+     */
+    private fun fillRingOnce(ring: RxRing, framer: Long, fd: Long): Int {
+        val n = if (framer != 0L) {
+            NativeRxRing.fillFrames(ring.handle, framer, fd)
+        } else {
+            NativeRxRing.fillSerial(ring.handle, fd)
+        }
+        if (n > 0) ring.signal()
+        return n
+    }
+
+    /**
+     * 上抛 buffer 中 pos 处的一帧（[NativeFramer.RECORD_HEADER] 记录头 + 数据）。
+     *
+     * @return 下一帧的位置
+     */
+    private fun deliverFrame(buffer: ByteBuffer, pos: Int): Int {
+        // 记录头是小端，buffer 保持默认大端（交给 DirectBufferReceiver 的字节序不变）
+        val len = Integer.reverseBytes(buffer.getInt(pos))
+        val timestampNs = java.lang.Long.reverseBytes(buffer.getLong(pos + 4))
+        val start = pos + NativeFramer.RECORD_HEADER
+        deliver(buffer, start, len, timestampNs)
+        return start + len
+    }
+
+    /**
+     * 逐帧上抛接收环里的一条分帧记录（若干帧首尾相接，每帧自带时间戳）。
+     */
+    @Suppress("UNUSED_PARAMETER")
+    private fun deliverFrameRecord(buffer: ByteBuffer, offset: Int, length: Int, timestampNs: Long) {
+        var pos = offset
+        val end = offset + length
+        while (pos < end) {
+            pos = deliverFrame(buffer, pos)
+        }
+    }
+
+    /**
+     * 半双工 turnaround：距离最后一次收到数据至少空闲 [SerialConfig.turnaroundMicros] 才允许发送。
+     *
+     * 等待在 native 层用 ppoll 完成；等待期间又收到数据时先读走上抛，再重新计时。
+     *
+     * @param timeoutMs 最长等待时间，线路一直繁忙时放弃本次写
+     * @return true: 可以发送；false: 超时或读出错
+     */
+    private fun awaitTurnaround(fd: Long, timeoutMs: Int): Boolean {
+        val gapUs = config.turnaroundMicros
+        if (config.fullDuplex || gapUs <= 0) return true
+
+        val deadline = System.nanoTime() + timeoutMs * 1_000_000L
+        while (true) {
+            val now = System.nanoTime()
+            val remainingUs = gapUs - (now - lastRxNanos) / 1_000
+            if (remainingUs <= 0) return true
+            if (now >= deadline) return false
+
+            val ret = NativeSerial.waitIdle(fd, remainingUs.toInt())
+            if (ret == 0) return true
+            if (ret < 0) return false
+            // 线路上又来了数据：先收走，下一轮按新的 lastRxNanos 重新计时；
+            // 接收环已满（BLOCK）时收不走，按线路繁忙处理
+            when (drain(fd)) {
+                Drain.ERROR, Drain.BLOCKED -> return false
+                Drain.DONE, Drain.YIELD -> Unit
+            }
+        }
+    }
+
+    /**
+     * 把 direct buffer 里 [offset, offset + n) 的数据交给 receiver。
+     *
+     * DirectBufferReceiver 直接拿到 buffer；TimestampedReceiver 额外拿到接收时间戳；
+     * 其它 receiver 拷贝一次到复用的 ByteArray。
+     */
+    private fun deliver(buffer: ByteBuffer, offset: Int, n: Int, timestampNs: Long) {
+        val r = receiver ?: return
+        buffer.clear()
+        buffer.position(offset)
+        buffer.limit(offset + n)
+        when (r) {
+            is DirectBufferReceiver -> r.onBufferReceived(buffer)
+            is TimestampedReceiver -> {
+                buffer.get(readArray, 0, n)
+                r.onBytesReceived(readArray, 0, n, timestampNs, TimestampedReceiver.SOURCE_MONOTONIC)
+            }
 
-                // -------- 3. 当前既没读到数据，也没有写任务 --------
-                // 直接进入下一轮循环，继续 read() + writeQueue 检查
+            else -> {
+                buffer.get(readArray, 0, n)
+                r.onBytesReceived(readArray, 0, n)
             }
         }
     }
 
+    /**
+     * 执行写请求，并通知调用方结果。
+     *
+     * 把 writeQueue 里已经排队的请求一并带上（最多 [MAX_COALESCE_JOBS] 条 / 约 [MAX_COALESCE_BYTES] 字节），
+     * 依次拷进 direct buffer 后用一次 writeGather（writev）连续写出，native 层写完为止或整体超时；
+     * 整批的超时取其中最长的 timeoutMs。每个请求按自己实际写出的字节数分别完成。
+     */
+    private fun performWrite(first: WriteJob) {
+        val batch = writeBatch
+        batch.clear()
+        batch.add(first)
+        pendingWrites.decrementAndGet()
+
+        var total = first.data.size
+        var timeoutMs = first.timeoutMs
+        while (batch.size < MAX_COALESCE_JOBS && total < MAX_COALESCE_BYTES) {
+            val next = writeQueue.tryReceive().getOrNull() ?: break
+            pendingWrites.decrementAndGet()
+            batch.add(next)
+            total += next.data.size
+            timeoutMs = maxOf(timeoutMs, next.timeoutMs)
+        }
+
+        try {
+            writeBatchNow(batch, total, timeoutMs)
+        } finally {
+            batch.clear()
+        }
+    }
+
+    private fun writeBatchNow(batch: List<WriteJob>, total: Int, timeoutMs: Int) {
+        val fdForWrite = handle
+        if (fdForWrite == 0L) {
+            // 已关闭，不再写，通知调用方失败
+            batch.forEach {
+                it.result.completeExceptionally(
+                    IllegalStateException("Serial handle is closed during write (id=$id)")
+                )
+            }
+            return
+        }
+
+        if (total == 0) {
+            batch.forEach { it.result.complete(0) }
+            return
+        }
+
+        if (!awaitTurnaround(fdForWrite, timeoutMs)) {
+            // 线路一直繁忙，按写超时处理
+            batch.forEach { it.result.complete(0) }
+            return
+        }
+
+        var buffer = writeBuffer
+        if (buffer.capacity() < total) {
+            buffer = ByteBuffer.allocateDirect(total)
+            writeBuffer = buffer
+        }
+        buffer.clear()
+        batch.forEachIndexed { i, job ->
+            buffer.put(job.data)
+            writeLengths[i] = job.data.size
+        }
+
+        val ret = NativeSerial.writeGather(
+            fdForWrite,
+            buffer,
+            writeLengths,
+            batch.size,
+            timeoutMs,
+            writtenCounts
+        )
+        if (ret > 0 && config.latency?.drainAfterWrite == true) {
+            // 等数据真正移出 UART 再完成写请求，调用方可以立即切回接收
+            NativeSerial.drain(fdForWrite)
+        }
+
+        batch.forEachIndexed { i, job ->
+            job.result.complete(if (ret < 0) ret else writtenCounts[i])
+        }
+    }
+
     /**
      * 表示一次写操作请求。
      *
@@ -228,4 +747,47 @@ internal class SerialChannelImpl(
         val timeoutMs: Int,
         val result: CompletableDeferred<Int> = CompletableDeferred()
     )
+
+    /**
+     * 一个轮询会话：native 轮询器 + 结果缓冲区 + 回调。
+     *
+     * 执行中的会话只由 IO 协程释放；release / stats 互斥，释放后 stats 返回 null。
+     */
+    private class PollSession(
+        val handle: Long,
+        val config: PollingConfig,
+        val receiver: PollResultReceiver
+    ) {
+        val batch = ByteArray(config.maxBatch * PollResults.RECORD_SIZE)
+
+        private var released = false
+
+        fun stats(): PollingStats? = synchronized(this) {
+            if (released) null else NativePoller.readStats(handle)
+        }
+
+        fun release() {
+            synchronized(this) {
+                if (released) return
+                released = true
+                NativePoller.destroy(handle)
+            }
+        }
+    }
+
+    /**
+     * stopPolling() 投递给 IO 协程的切换请求。
+     */
+    private object StopPolling
+
+    private companion object {
+        /** 单次读取的缓冲区大小 */
+        const val READ_BUFFER_SIZE = 4096
+
+        /** 一次 writev 最多合并的写请求数 */
+        const val MAX_COALESCE_JOBS = 64
+
+        /** 一次 writev 合并的数据量上限（超过后不再继续带上新的请求） */
+        const val MAX_COALESCE_BYTES = 64 * 1024
+    }
 }
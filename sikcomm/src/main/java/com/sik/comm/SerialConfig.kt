@@ -9,11 +9,19 @@ package com.sik.comm
 data class SerialConfig(
     override val id: String,
     val devicePath: String,          // 如: "/dev/ttyS1" / "/dev/ttyUSB0"
-    val baudRate: Int,               // 波特率
+    val baudRate: Int,               // 波特率：标准值走 Bxxx，其它任意整数（如 250000 / 1500000 / 3000000）走 termios2 BOTHER
     val dataBits: Int = 8,
     val stopBits: Int = 1,
     val parity: Int = 0,             // 0: None, 1: Odd, 2: Even ... 具体枚举可以上层再封装
     override val readTimeoutMs: Int = 500,
     override val writeTimeoutMs: Int = 500,
+    val framing: SerialFraming? = null,  // native 分帧方式，null 表示按原始字节块上抛
+    val frameCheck: FrameCheck? = null,  // 帧尾校验，需配合 framing 使用
+    val fullDuplex: Boolean = false,     // 全双工（RS232）：读写互不等待；RS485 等半双工线路保持 false
+    val turnaroundMicros: Int = 0,       // 半双工：最后一次收到数据后至少空闲多久（微秒）才允许发送
+    val maxReadSliceMs: Int = 20,        // 半双工：连续读超过该时间且有写在排队时让出一次，0 表示不限制
+    val latency: SerialLatency? = null,  // 驱动延迟 / VMIN-VTIME / tcdrain-tcflush 档位，null 保持驱动默认
+    val rxRing: RxRingConfig? = null,    // 接收环：IO 协程只负责读进环，receiver 在专用接收线程回调；null 在 IO 协程里直接回调
+    val capture: CaptureConfig? = null,  // 收发抓包：native 层把每次读写追加到内存映射的段文件，null 不抓包
     val extra: Map<String, Any?> = emptyMap() // 预留扩展字段
 ) : CommConfig
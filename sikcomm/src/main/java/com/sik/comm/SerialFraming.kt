@@ -0,0 +1,109 @@
+package com.sik.comm
+
+/**
+ * 串口分帧方式。
+ *
+ * 配置到 [SerialConfig.framing] 后，分帧（“粘包 / 半包”处理）在 native 层完成，
+ * [CommReceiver] 每次回调拿到的都是一整帧，不再是零散的字节块。
+ *
+ * 不配置时保持原行为：读到多少上抛多少。
+ */
+sealed class SerialFraming {
+
+    /**
+     * 单帧最大长度（字节），超过时丢弃该帧并重新同步。
+     */
+    abstract val maxFrameSize: Int
+
+    /**
+     * 分隔符分帧，可选转义（SLIP 类）。
+     *
+     * - 上抛的帧不含分隔符，转义序列已还原
+     * - 连续的分隔符（空帧）直接忽略
+     *
+     * @param delimiter        帧分隔符
+     * @param escape           转义字节，null 表示不转义
+     * @param escapedDelimiter escape 之后跟该字节表示 delimiter
+     * @param escapedEscape    escape 之后跟该字节表示 escape 本身
+     */
+    data class Delimiter(
+        val delimiter: Byte,
+        val escape: Byte? = null,
+        val escapedDelimiter: Byte = 0,
+        val escapedEscape: Byte = 0,
+        override val maxFrameSize: Int = DEFAULT_MAX_FRAME_SIZE
+    ) : SerialFraming()
+
+    /**
+     * 长度字段分帧：帧内 [lengthOffset] 处有一个 [lengthSize] 字节的长度字段，
+     * 帧总长 = 长度字段值 + [lengthAdjust]。
+     *
+     * 例如 `[0xAA][len][payload...][crc16]`，len 只算 payload 时：
+     * lengthOffset = 1, lengthSize = 1, lengthAdjust = 1 + 1 + 2。
+     *
+     * 长度字段非法（小于头部或超过 [maxFrameSize]）时逐字节滑动重新同步。
+     *
+     * @param lengthSize 1 / 2 / 4
+     */
+    data class LengthField(
+        val lengthOffset: Int,
+        val lengthSize: Int,
+        val bigEndian: Boolean = false,
+        val lengthAdjust: Int = 0,
+        override val maxFrameSize: Int = DEFAULT_MAX_FRAME_SIZE
+    ) : SerialFraming()
+
+    /**
+     * 固定长度分帧。
+     */
+    data class FixedSize(
+        val frameSize: Int
+    ) : SerialFraming() {
+        override val maxFrameSize: Int
+            get() = frameSize
+    }
+
+    /**
+     * 静默分帧（Modbus RTU）：线路上超过 [gapMicros] 没有新字节即认为一帧结束。
+     *
+     * 静默检测在 native 层紧贴着 read 用 ppoll 计时，精度远高于 Kotlin 侧轮询。
+     *
+     * @param gapMicros 静默时间（微秒），0 表示按波特率自动计算 3.5 字符时间
+     */
+    data class Silence(
+        val gapMicros: Int = 0,
+        override val maxFrameSize: Int = 256
+    ) : SerialFraming()
+
+    companion object {
+
+        /** 默认单帧最大长度 */
+        const val DEFAULT_MAX_FRAME_SIZE = 4096
+
+        /**
+         * 标准 SLIP（RFC 1055）：END = 0xC0，ESC = 0xDB，ESC_END = 0xDC，ESC_ESC = 0xDD。
+         */
+        @JvmStatic
+        fun slip(maxFrameSize: Int = DEFAULT_MAX_FRAME_SIZE): Delimiter =
+            Delimiter(
+                delimiter = 0xC0.toByte(),
+                escape = 0xDB.toByte(),
+                escapedDelimiter = 0xDC.toByte(),
+                escapedEscape = 0xDD.toByte(),
+                maxFrameSize = maxFrameSize
+            )
+
+        /**
+         * 按 Modbus RTU 规则计算 3.5 字符静默时间（微秒）。
+         * 波特率 > 19200 时规范固定为 1750us。
+         */
+        @JvmStatic
+        fun modbusSilenceMicros(baudRate: Int, dataBits: Int, stopBits: Int, parity: Int): Int {
+            require(baudRate > 0) { "Invalid baudRate: $baudRate" }
+            if (baudRate > 19200) return 1750
+            // 1 起始位 + 数据位 + 校验位 + 停止位
+            val bitsPerChar = 1 + dataBits + (if (parity != 0) 1 else 0) + stopBits
+            return ((bitsPerChar * 3_500_000L + baudRate - 1) / baudRate).toInt()
+        }
+    }
+}
@@ -0,0 +1,47 @@
+package com.sik.comm
+
+/**
+ * 串口延迟档位。
+ *
+ * 不少 UART / USB 转串口驱动默认会把收到的字节攒起来再上报（FTDI 类默认 16ms），
+ * 请求-应答式的 RS485 轮询因此每一轮都白白多等几毫秒。本配置在 open 时调整驱动和 termios：
+ *
+ * - lowLatency：TIOCSSERIAL 打开 ASYNC_LOW_LATENCY，驱动收到数据立即推给 tty 层（ftdi_sio 会同时把 latency_timer 设为 1ms）
+ * - usbLatencyTimerMs：写 sysfs 的 latency_timer（只有 FTDI 等驱动提供，通常需要 root，失败只打日志）
+ * - vmin / vtime：termios 的 VMIN / VTIME。默认 0 / 0，poll 就绪后读到多少算多少；
+ *   vmin > 0 时每次读至少凑够 vmin 字节，或字节间隔超过 vtime（单位 0.1s）才返回，适合块状协议
+ * - flushOnOpen：open 后 tcflush(TCIOFLUSH)，丢掉驱动里残留的旧数据
+ * - drainAfterWrite：每批写完后 tcdrain，等数据真正移出发送移位寄存器再返回（手动切换 RS485 方向时需要）
+ * - discardOnClose：close 前 tcflush(TCOFLUSH)，避免 close 因等待未发完的数据而阻塞（closing_wait 最长 30s）
+ *
+ * 单个驱动不支持某项设置（例如 cdc-acm 不支持 TIOCSSERIAL）时只打日志，不影响 open。
+ */
+data class SerialLatency(
+    val lowLatency: Boolean = true,
+    val usbLatencyTimerMs: Int? = 1,
+    val vmin: Int = 0,
+    val vtime: Int = 0,
+    val flushOnOpen: Boolean = true,
+    val drainAfterWrite: Boolean = false,
+    val discardOnClose: Boolean = true
+) {
+
+    init {
+        require(usbLatencyTimerMs == null || usbLatencyTimerMs in 1..255) {
+            "Invalid usbLatencyTimerMs: $usbLatencyTimerMs"
+        }
+        require(vmin in 0..255) { "Invalid vmin: $vmin" }
+        require(vtime in 0..255) { "Invalid vtime: $vtime" }
+    }
+
+    companion object {
+
+        /** 请求-应答式轮询（RS485 / Modbus 主站）推荐档位 */
+        @JvmField
+        val LOW_LATENCY = SerialLatency()
+
+        /** RS485 手动方向控制：写完等数据真正发完再返回，便于立即切回接收 */
+        @JvmField
+        val RS485 = SerialLatency(drainAfterWrite = true)
+    }
+}
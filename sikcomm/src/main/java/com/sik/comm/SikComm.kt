@@ -22,4 +22,34 @@ object SikComm {
         is SerialConfig -> SerialChannelImpl(config)
         is CanConfig    -> CanChannelImpl(config)
     }
+
+    /**
+     * 创建 SocketCAN 通道，返回带 CAN 专有能力（批量收发等）的 [CanChannel]。
+     *
+     * @param config CAN 通道配置
+     * @return       CanChannel 实现
+     */
+    @JvmStatic
+    fun openCan(config: CanConfig): CanChannel = CanChannelImpl(config)
+
+    /**
+     * 创建串口通道，返回带串口专有能力（实际波特率等）的 [SerialChannel]。
+     *
+     * @param config 串口通道配置
+     * @return       SerialChannel 实现
+     */
+    @JvmStatic
+    fun openSerial(config: SerialConfig): SerialChannel = SerialChannelImpl(config)
+
+    /**
+     * 建立 CAN 网关，在接口之间转发（可修改）帧，转发不经过 Kotlin。
+     *
+     * @param routes 路由列表
+     * @param mode   后端选择，默认优先内核 CAN_GW
+     * @return       已开始转发的网关，用完需 close
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun startCanGateway(routes: List<CanRoute>, mode: CanGatewayMode = CanGatewayMode.AUTO): CanGateway =
+        CanGateway.start(routes, mode)
 }